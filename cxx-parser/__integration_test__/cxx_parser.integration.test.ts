@@ -48,6 +48,7 @@ describe('cxx_parser', () => {
               "nodes":[
                 {
                   "__TYPE":"Struct",
+                  "all_base_clazzs":[],
                   "attributes":[],
                   "base_clazzs":[],
                   "comment":"",
@@ -84,7 +85,8 @@ describe('cxx_parser', () => {
                   "namespaces":[],
                   "parent_full_scope_name": "",
                   "parent_name":"${preProcessParseFilesDir}/file1.h",
-                  "source":""
+                  "source":"",
+                  "virtual_methods":[]
                 }
               ]
             }
@@ -127,6 +129,7 @@ describe('cxx_parser', () => {
             "nodes":[
               {
                 "__TYPE":"Struct",
+                "all_base_clazzs":[],
                 "attributes":[],
                 "base_clazzs":[],
                 "comment":"",
@@ -163,7 +166,8 @@ describe('cxx_parser', () => {
                 "namespaces":[],
                 "parent_full_scope_name": "",
                 "parent_name":"${preProcessParseFilesDir}/file1.h",
-                "source":""
+                "source":"",
+                "virtual_methods":[]
               }
             ]
           }
@@ -210,6 +214,7 @@ describe('cxx_parser', () => {
             "nodes":[
               {
                 "__TYPE":"Struct",
+                "all_base_clazzs":[],
                 "attributes":[],
                 "base_clazzs":[],
                 "comment":"",
@@ -246,7 +251,8 @@ describe('cxx_parser', () => {
                 "namespaces":[],
                 "parent_full_scope_name": "",
                 "parent_name":"${preProcessParseFilesDir}/file1.h",
-                "source":""
+                "source":"",
+                "virtual_methods":[]
               }
             ]
           }
@@ -302,6 +308,7 @@ describe('cxx_parser', () => {
                     "attributes": [],
                     "comment":"",
                     "conditional_compilation_directives_infos": [],
+                    "evaluated_value": 0,
                     "file_path": "",
                     "name": "A",
                     "namespaces": [],
@@ -372,6 +379,7 @@ describe('cxx_parser', () => {
                     "attributes": [],
                     "comment":"",
                     "conditional_compilation_directives_infos": [],
+                    "evaluated_value": 0,
                     "file_path": "",
                     "name": "A",
                     "namespaces": [],
@@ -497,6 +505,7 @@ describe('cxx_parser', () => {
             "nodes":[
               {
                 "__TYPE":"Struct",
+                "all_base_clazzs":[],
                 "attributes":[],
                 "base_clazzs":[],
                 "comment":"",
@@ -533,7 +542,8 @@ describe('cxx_parser', () => {
                 "namespaces":[],
                 "parent_full_scope_name": "",
                 "parent_name":"${preProcessParseFilesDir}/file1.h",
-                "source":""
+                "source":"",
+                "virtual_methods":[]
               },
               {
                 "__TYPE": "TypeAlias",
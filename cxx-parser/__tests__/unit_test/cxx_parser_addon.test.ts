@@ -0,0 +1,115 @@
+import fs from 'fs';
+import os from 'os';
+import path from 'path';
+
+import { TerraContext } from '@agoraio-extensions/terra-core';
+
+import { generateChecksum, parseCXXAstInProcess } from '../../src/cxx_parser';
+import { CXXFile, Clazz } from '../../src/cxx_terra_node';
+
+// A fake terra addon, which delegates to the mock functions below
+const fakeAddonPath = path.join(
+  fs.mkdtempSync(path.join(os.tmpdir(), 'terra-addon-')),
+  'terra_addon.js'
+);
+fs.writeFileSync(
+  fakeAddonPath,
+  `module.exports = {
+    parse: (options) => global.fakeTerraAddon.parse(options),
+    parseSync: (options) => global.fakeTerraAddon.parseSync(options),
+  };`
+);
+process.env.TERRA_ADDON_PATH = fakeAddonPath;
+
+describe('cxx_parser addon', () => {
+  let tmpDir: string = '';
+  let file1Path: string = '';
+  let jsonFilePath: string = '';
+  let parse: jest.Mock;
+
+  const cxxFiles = () => [
+    {
+      __TYPE: 'CXXFile',
+      file_path: '/my/path/IAgoraRtcEngine.h',
+      nodes: [
+        {
+          __TYPE: 'Clazz',
+          name: 'TestClazz',
+          namespaces: ['test'],
+          methods: [],
+        },
+      ],
+    },
+  ];
+
+  beforeEach(() => {
+    tmpDir = fs.mkdtempSync(path.join(os.tmpdir(), 'terra-ut-'));
+    file1Path = path.join(tmpDir, 'file1.h');
+    fs.writeFileSync(file1Path, 'void file1_main() {}');
+    jsonFilePath = path.join(
+      tmpDir,
+      'cxx_parser',
+      `dump_json_${generateChecksum([file1Path])}.json`
+    );
+
+    parse = jest.fn(async () => cxxFiles());
+    (global as any).fakeTerraAddon = { parse: parse, parseSync: jest.fn() };
+  });
+
+  afterEach(() => {
+    fs.rmSync(tmpDir, { recursive: true, force: true });
+  });
+
+  it('caches the ast json of the addon', async () => {
+    let parseResult = await parseCXXAstInProcess(
+      new TerraContext(tmpDir),
+      [],
+      [file1Path],
+      []
+    );
+
+    expect(parse).toHaveBeenCalledTimes(1);
+    expect(fs.existsSync(jsonFilePath)).toBe(true);
+    expect(JSON.parse(fs.readFileSync(jsonFilePath, 'utf-8'))).toEqual(
+      cxxFiles()
+    );
+    let clazz = (parseResult!.nodes[0] as CXXFile).nodes[0] as Clazz;
+    expect(clazz.name).toEqual('TestClazz');
+  });
+
+  it('skips the addon with the cached ast json', async () => {
+    fs.mkdirSync(path.dirname(jsonFilePath), { recursive: true });
+    let cachedCXXFiles = cxxFiles();
+    cachedCXXFiles[0].nodes[0].name = 'CachedClazz';
+    fs.writeFileSync(jsonFilePath, JSON.stringify(cachedCXXFiles));
+
+    let parseResult = await parseCXXAstInProcess(
+      new TerraContext(tmpDir),
+      [],
+      [file1Path],
+      []
+    );
+
+    expect(parse).not.toHaveBeenCalled();
+    let clazz = (parseResult!.nodes[0] as CXXFile).nodes[0] as Clazz;
+    expect(clazz.name).toEqual('CachedClazz');
+  });
+
+  it('parses with the addon again with clean', async () => {
+    fs.mkdirSync(path.dirname(jsonFilePath), { recursive: true });
+    let cachedCXXFiles = cxxFiles();
+    cachedCXXFiles[0].nodes[0].name = 'CachedClazz';
+    fs.writeFileSync(jsonFilePath, JSON.stringify(cachedCXXFiles));
+
+    let parseResult = await parseCXXAstInProcess(
+      new TerraContext(tmpDir, '', '', true, false),
+      [],
+      [file1Path],
+      []
+    );
+
+    expect(parse).toHaveBeenCalledTimes(1);
+    let clazz = (parseResult!.nodes[0] as CXXFile).nodes[0] as Clazz;
+    expect(clazz.name).toEqual('TestClazz');
+  });
+});
@@ -0,0 +1,115 @@
+#!/bin/bash
+
+# Sweep the size of synthetic headers and report the time and memory curves of
+# the cppast_backend, failing if they grow superlinearly.
+#
+# Usage: scaling_benchmark.sh <cppast_backend> <synthetic_headers> <work-dir>
+#
+# Environment:
+#   SWEEP         The swept dimension: classes, methods or params (default: classes)
+#   SIZES         The swept sizes (default: "25 50 100 200 400")
+#   CLASSES       The number of classes when not swept (default: 50)
+#   METHODS       The number of methods per class when not swept (default: 10)
+#   PARAMS        The number of parameters per method when not swept (default: 3)
+#   NESTED_DEPTH  The depth of the nested structs per class (default: 2)
+#   MAX_EXPONENT  The maximum growth exponent between the smallest and the largest size (default: 1.3)
+
+set -e
+
+SCRIPT_PATH=$(dirname "$0")
+MY_PATH=$(realpath ${SCRIPT_PATH})
+BACKEND_BINARY=$(realpath $1)
+GENERATOR_BINARY=$(realpath $2)
+WORK_PATH=$3
+
+SWEEP=${SWEEP:-classes}
+SIZES=${SIZES:-"25 50 100 200 400"}
+CLASSES=${CLASSES:-50}
+METHODS=${METHODS:-10}
+PARAMS=${PARAMS:-3}
+NESTED_DEPTH=${NESTED_DEPTH:-2}
+MAX_EXPONENT=${MAX_EXPONENT:-1.3}
+
+if [[ "$SWEEP" != "classes" && "$SWEEP" != "methods" && "$SWEEP" != "params" ]]; then
+    echo "Unsupported sweep: $SWEEP"
+    exit 1
+fi
+
+mkdir -p ${WORK_PATH}
+WORK_PATH=$(realpath ${WORK_PATH})
+RESULT_FILE="${WORK_PATH}/scaling_${SWEEP}.csv"
+
+echo "size,seconds,allocated_bytes,peak_live_bytes,peak_rss_bytes" > ${RESULT_FILE}
+
+# The value of a key of the "total" object in the memory report
+function report_total() {
+    sed -n "s/.*\"total\":{[^}]*\"$2\":\([0-9]*\).*/\1/p" $1
+}
+
+# The cppast_backend looks up include/system_fake relative to the working directory
+pushd ${MY_PATH} > /dev/null
+
+for SIZE in ${SIZES}; do
+    case "$SWEEP" in
+        classes) ARGS="--classes=${SIZE} --methods=${METHODS} --params=${PARAMS}" ;;
+        methods) ARGS="--classes=${CLASSES} --methods=${SIZE} --params=${PARAMS}" ;;
+        params) ARGS="--classes=${CLASSES} --methods=${METHODS} --params=${SIZE}" ;;
+    esac
+
+    RUN_PATH="${WORK_PATH}/${SWEEP}_${SIZE}"
+    rm -rf ${RUN_PATH}
+    mkdir -p ${RUN_PATH}
+
+    HEADER="${RUN_PATH}/include/synthetic.h"
+    ${GENERATOR_BINARY} --output=${HEADER} --nested-depth=${NESTED_DEPTH} ${ARGS} > /dev/null
+
+    START=$(date +%s%N)
+    ${BACKEND_BINARY} \
+        --visit-headers=${HEADER} \
+        --include-header-dirs=${RUN_PATH}/include \
+        --pre-process-dir=${RUN_PATH}/preprocess \
+        --output-dir=${RUN_PATH}/dump.json \
+        --memory-report=${RUN_PATH}/memory.json \
+        --dump-json > ${RUN_PATH}/backend.log 2>&1
+    END=$(date +%s%N)
+
+    SECONDS_ELAPSED=$(awk -v start=${START} -v end=${END} 'BEGIN { printf "%.3f", (end - start) / 1e9 }')
+    ALLOCATED_BYTES=$(report_total ${RUN_PATH}/memory.json allocated_bytes)
+    PEAK_LIVE_BYTES=$(report_total ${RUN_PATH}/memory.json peak_live_bytes)
+    PEAK_RSS_BYTES=$(report_total ${RUN_PATH}/memory.json peak_rss_bytes)
+
+    echo "${SIZE},${SECONDS_ELAPSED},${ALLOCATED_BYTES},${PEAK_LIVE_BYTES},${PEAK_RSS_BYTES}" >> ${RESULT_FILE}
+done
+
+popd > /dev/null
+
+# Print the curves, and check the growth exponent log(y_n / y_1) / log(x_n / x_1)
+# of the time and the allocated bytes between the smallest and the largest size.
+# The allocated bytes are deterministic, the time is noisy but catches what is
+# not allocating, e.g., quadratic lookups. The constant startup cost only lowers
+# the exponent, so it never reports a false regression.
+awk -F',' -v sweep=${SWEEP} -v max_exponent=${MAX_EXPONENT} '
+NR == 1 {
+    printf "%10s %10s %16s %16s %16s\n", sweep, "seconds", "allocated_bytes", "peak_live_bytes", "peak_rss_bytes"
+    next
+}
+{
+    printf "%10d %10.3f %16d %16d %16d\n", $1, $2, $3, $4, $5
+    if (NR == 2) { first_size = $1; first_seconds = $2; first_bytes = $3 }
+    last_size = $1; last_seconds = $2; last_bytes = $3
+}
+END {
+    if (NR < 3 || first_size == last_size || first_seconds <= 0 || first_bytes <= 0) {
+        print "Not enough sizes to compute the growth exponents"
+        exit 0
+    }
+    time_exponent = log(last_seconds / first_seconds) / log(last_size / first_size)
+    bytes_exponent = log(last_bytes / first_bytes) / log(last_size / first_size)
+    printf "growth exponent: time %.2f, allocated bytes %.2f (max %.2f)\n", time_exponent, bytes_exponent, max_exponent
+    if (time_exponent > max_exponent || bytes_exponent > max_exponent) {
+        print "Superlinear growth detected"
+        exit 1
+    }
+}' ${RESULT_FILE}
+
+echo "Write the results to ${RESULT_FILE}"
@@ -0,0 +1,94 @@
+#!/bin/bash
+
+# Compare the --shallow parse with the full parse of the headers of a directory,
+# the Agora SDK headers in third_party/agora/rtc by default, and report their time, memory and
+# the nodes which lost semantic precision in the shallow parse.
+#
+# Usage: shallow_benchmark.sh <cppast_backend> <work-dir> [headers-dir]
+#
+# Environment:
+#   RUNS          The number of runs per mode, the fastest one is reported (default: 3)
+
+set -e
+
+SCRIPT_PATH=$(dirname "$0")
+MY_PATH=$(realpath ${SCRIPT_PATH})
+BACKEND_BINARY=$(realpath $1)
+WORK_PATH=$2
+HEADERS_PATH=$(realpath ${3:-${MY_PATH}/third_party/agora/rtc})
+
+RUNS=${RUNS:-3}
+
+mkdir -p ${WORK_PATH}
+WORK_PATH=$(realpath ${WORK_PATH})
+RESULT_FILE="${WORK_PATH}/shallow.csv"
+
+VISIT_HEADERS=$(find ${HEADERS_PATH} -name "*.h" | sort | paste -sd "," -)
+if [[ -z "${VISIT_HEADERS}" ]]; then
+    echo "No headers found in ${HEADERS_PATH}"
+    exit 1
+fi
+
+echo "mode,seconds,allocated_bytes,peak_rss_bytes" > ${RESULT_FILE}
+
+# The value of a key of the "total" object in the memory report
+function report_total() {
+    sed -n "s/.*\"total\":{[^}]*\"$2\":\([0-9]*\).*/\1/p" $1
+}
+
+# The cppast_backend looks up include/system_fake relative to the working directory
+pushd ${MY_PATH} > /dev/null
+
+for MODE in full shallow; do
+    MODE_ARGS=""
+    if [[ "$MODE" == "shallow" ]]; then
+        MODE_ARGS="--shallow --shallow-report=${WORK_PATH}/shallow_report.json"
+    fi
+
+    BEST_SECONDS=""
+    for RUN in $(seq ${RUNS}); do
+        RUN_PATH="${WORK_PATH}/${MODE}"
+        rm -rf ${RUN_PATH}
+        mkdir -p ${RUN_PATH}
+
+        START=$(date +%s%N)
+        ${BACKEND_BINARY} \
+            --visit-headers=${VISIT_HEADERS} \
+            --include-header-dirs=${HEADERS_PATH} \
+            --pre-process-dir=${RUN_PATH}/preprocess \
+            --output-dir=${RUN_PATH}/dump.json \
+            --memory-report=${RUN_PATH}/memory.json \
+            --dump-json ${MODE_ARGS} > ${RUN_PATH}/backend.log 2>&1
+        END=$(date +%s%N)
+
+        SECONDS_ELAPSED=$(awk -v start=${START} -v end=${END} 'BEGIN { printf "%.3f", (end - start) / 1e9 }')
+        if [[ -z "${BEST_SECONDS}" ]] || awk -v a=${SECONDS_ELAPSED} -v b=${BEST_SECONDS} 'BEGIN { exit !(a < b) }'; then
+            BEST_SECONDS=${SECONDS_ELAPSED}
+        fi
+    done
+
+    ALLOCATED_BYTES=$(report_total ${RUN_PATH}/memory.json allocated_bytes)
+    PEAK_RSS_BYTES=$(report_total ${RUN_PATH}/memory.json peak_rss_bytes)
+    echo "${MODE},${BEST_SECONDS},${ALLOCATED_BYTES},${PEAK_RSS_BYTES}" >> ${RESULT_FILE}
+done
+
+popd > /dev/null
+
+awk -F',' '
+NR == 1 {
+    printf "%10s %10s %16s %16s\n", "mode", "seconds", "allocated_bytes", "peak_rss_bytes"
+    next
+}
+{
+    printf "%10s %10.3f %16d %16d\n", $1, $2, $3, $4
+    seconds[$1] = $2
+}
+END {
+    if (seconds["shallow"] > 0) {
+        printf "shallow speedup: %.2fx\n", seconds["full"] / seconds["shallow"]
+    }
+}' ${RESULT_FILE}
+
+UNRESOLVED_NODES=$(sed -n 's/.*"unresolved_node_count":\([0-9]*\).*/\1/p' ${WORK_PATH}/shallow_report.json)
+echo "${UNRESOLVED_NODES} nodes lost semantic precision, see ${WORK_PATH}/shallow_report.json"
+echo "Write the results to ${RESULT_FILE}"
@@ -1,5 +1,10 @@
+// Count the heap allocations of the whole process for --memory-report
+#define TERRA_MEMORY_ACCOUNTING_HOOKS
+#include "terra_memory.hpp"
+
 #include "terra.hpp"
 #include "terra_utils.hpp"
+#include <chrono>
 #include <cxxopts.hpp>
 #include <filesystem>
 #include <fstream>
@@ -11,17 +16,189 @@
 #include <string>
 
 using namespace terra;
-void DumpJson(const std::vector<std::string> &include_header_dirs,
-              const std::vector<std::string> &pre_processed_files,
-              const std::map<std::string, std::string> &defines,
-              const std::string &output_dir) {
+
+// Compare the throughput of the json tree serialization against the direct
+// `JsonWriter` one, which `DefaultJsonGenerator` uses
+void BenchmarkJson(const ParseResult &parse_result, int iterations) {
+  DefaultJsonGenerator json_generator("");
+  std::string tree_output;
+  std::string direct_output;
+
+  auto tree_start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; i++) {
+    tree_output = json_generator.ToJson(parse_result).dump();
+  }
+  auto tree_end = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; i++) {
+    direct_output = json_generator.ToJsonString(parse_result);
+  }
+  auto direct_end = std::chrono::steady_clock::now();
+
+  double megabytes = (double)direct_output.size() * iterations / 1e6;
+  double tree_seconds =
+      std::chrono::duration<double>(tree_end - tree_start).count();
+  double direct_seconds =
+      std::chrono::duration<double>(direct_end - tree_end).count();
+
+  std::cout << "Json benchmark: " << direct_output.size() << " bytes x "
+            << iterations << " iterations" << std::endl;
+  std::cout << "  json tree: " << tree_seconds << "s, "
+            << megabytes / tree_seconds << " MB/s" << std::endl;
+  std::cout << "  direct:    " << direct_seconds << "s, "
+            << megabytes / direct_seconds << " MB/s" << std::endl;
+  std::cout << "  identical output: "
+            << (tree_output == direct_output ? "yes" : "no") << std::endl;
+}
+
+// Parse the headers in forked worker processes, see `ProcessPoolParser`
+struct WorkerProcessOptions {
+  bool enabled = false;
+  size_t count = 0;
+  int max_retries = 1;
+  int timeout_seconds = 0;
+};
+
+// The outputs of `--dump-json`, the headers to parse are in the `ParseConfig`
+struct DumpJsonOptions {
+  std::string output_dir;
+  bool is_sharded_output = false;
+  size_t jobs = 0;
+  // Diff against this previous dump if not empty
+  std::string diff_old_dump;
+  std::string diff_output;
+  int json_benchmark_iterations = 0;
+  bool is_flat = false;
+  WorkerProcessOptions worker_processes;
+  // Also dump the binary encoding if not empty
+  std::string binary_output;
+  // The report of `ParseConfig::shallow`
+  std::string shallow_report;
+};
+
+void DumpJson(const ParseConfig &parse_config,
+              const DumpJsonOptions &options) {
   DefaultVisitor rootVisitor;
-  ParseConfig parse_config{include_header_dirs, pre_processed_files, defines};
-  rootVisitor.Visit(parse_config);
+  rootVisitor.AddPass(std::make_unique<ConstantFoldingPass>());
+  rootVisitor.AddPass(std::make_unique<InheritancePass>());
+  if (options.worker_processes.enabled) {
+    rootVisitor.SetWorkerProcesses(
+        options.worker_processes.count, options.worker_processes.max_retries,
+        std::chrono::seconds(options.worker_processes.timeout_seconds));
+  }
+  {
+    MemoryAccounting::Scope memory_scope("phase", "parse");
+    rootVisitor.Visit(parse_config);
+  }
+
+  if (parse_config.shallow) {
+    nlohmann::json report = ShallowParseReport(rootVisitor.parse_result_);
+    std::ofstream osWrite(options.shallow_report, std::ofstream::trunc);
+    osWrite << report.dump();
+    osWrite.close();
+    std::cout << "Shallow parse: " << report["unresolved_node_count"]
+              << " nodes with unresolved types, dump the report to "
+              << options.shallow_report << std::endl;
+  }
+
+  if (!options.binary_output.empty()) {
+    BinaryWriter writer;
+    EncodeCXXFiles(writer, rootVisitor.parse_result_.cxx_files);
+    std::ofstream osWrite(options.binary_output,
+                          std::ofstream::binary | std::ofstream::trunc);
+    osWrite << writer.buffer;
+    osWrite.close();
+    std::cout << "Dump the binary parse result to " << options.binary_output
+              << std::endl;
+  }
+
+  if (options.json_benchmark_iterations > 0) {
+    BenchmarkJson(rootVisitor.parse_result_,
+                  options.json_benchmark_iterations);
+  }
+
+  if (!options.diff_old_dump.empty()) {
+    MemoryAccounting::Scope memory_scope("phase", "diff");
+    // Load the old dump before writing the new one, they may be the same path.
+    // The fingerprints are computed by the diff, so any dump can be diffed
+    // against and the dumps stay without them
+    std::vector<CXXFile> old_cxx_files = LoadCXXFiles(options.diff_old_dump);
+    nlohmann::json diff =
+        DiffAstDump(old_cxx_files, rootVisitor.parse_result_.cxx_files);
+
+    std::ofstream osWrite(options.diff_output, std::ofstream::trunc);
+    osWrite << diff.dump();
+    osWrite.close();
+    std::cout << "Dump the ast diff against " << options.diff_old_dump
+              << " to " << options.diff_output << std::endl;
+  }
+
+  std::unique_ptr<Generator> generator;
+  if (options.is_sharded_output) {
+    generator = std::make_unique<ShardedJsonGenerator>(options.output_dir,
+                                                       options.jobs);
+  } else {
+    generator = std::make_unique<DefaultJsonGenerator>(options.output_dir);
+  }
+
+  if (options.is_flat) {
+    FlatParseResult flat_parse_result;
+    {
+      MemoryAccounting::Scope memory_scope("phase", "flatten");
+      flat_parse_result =
+          FlatParseResult::FromParseResult(rootVisitor.parse_result_);
+    }
+    std::cout << "Flat parse result: "
+              << MemoryFootprint(rootVisitor.parse_result_)
+              << " bytes as tree, " << flat_parse_result.MemoryFootprint()
+              << " bytes flat" << std::endl;
+
+    // Only keep the flat store while generating
+    rootVisitor.parse_result_ = ParseResult();
+    MemoryAccounting::Scope memory_scope("phase", "generate");
+    generator->Generate(flat_parse_result);
+    return;
+  }
+
+  MemoryAccounting::Scope memory_scope("phase", "generate");
+  rootVisitor.Accept(generator.get());
+}
+
+void WriteMemoryReport(const std::string &memory_report) {
+  nlohmann::json report = MemoryAccounting::Instance().Report();
+  std::ofstream osWrite(memory_report, std::ofstream::trunc);
+  osWrite << report.dump();
+  osWrite.close();
+  std::cout << "Dump the memory report to " << memory_report << std::endl;
+}
+
+// Render a previous dump without parsing the headers, so that a change to the
+// generator does not have to wait for libclang
+int RenderFrom(const std::string &dump_path, const std::string &render_name,
+               const std::string &output_dir, size_t jobs,
+               const std::string &render_stamps_path) {
+  auto &factories = SyntaxRenderFactories();
+  auto factory = factories.find(render_name);
+  if (factory == factories.end()) {
+    std::cerr << "Unknown render \"" << render_name
+              << "\", the registered renders are:";
+    for (auto &it : factories) { std::cerr << " " << it.first; }
+    std::cerr << std::endl;
+    return -1;
+  }
 
-  auto default_generator = std::make_unique<DefaultJsonGenerator>(output_dir);
+  ParseResult parse_result;
+  {
+    MemoryAccounting::Scope memory_scope("phase", "load");
+    parse_result.cxx_files = LoadCXXFiles(dump_path);
+  }
+  std::cout << "Load " << parse_result.cxx_files.size() << " files from "
+            << dump_path << std::endl;
 
-  rootVisitor.Accept(default_generator.get());
+  MemoryAccounting::Scope memory_scope("phase", "generate");
+  DefaultGenerator generator(output_dir, factory->second(), jobs,
+                             render_stamps_path);
+  generator.Generate(parse_result);
+  return 0;
 }
 
 int main(int argc, char **argv) {
@@ -35,11 +212,36 @@ int main(int argc, char **argv) {
         ("visit-headers", "The C++ headers to be visited, split with \",\"", cxxopts::value<std::string>())
         ("custom-headers", "The custom C++ headers to be visited, split with \",\"", cxxopts::value<std::string>())
         ("defines-macros", "Custom macros, split with \",\"", cxxopts::value<std::string>())
-        ("dump-json", "Only dump the C++ header files to json");
+        ("dump-json", "Only dump the C++ header files to json")
+        ("sharded-output", "Dump one json file per header and a manifest.json into the output-dir, instead of a single json file")
+        ("jobs", "The number of worker threads, use all hardware threads by default", cxxopts::value<int>())
+        ("conversion-jobs", "The number of threads converting the top-level classes and enums of a parsed header, 1 by default, 0 means one per hardware thread", cxxopts::value<int>())
+        ("diff", "A previous dump (json file, sharded output dir or --binary-output file) to diff the parsed headers against", cxxopts::value<std::string>())
+        ("diff-output", "The output file of --diff, or <output-dir>.diff.json by default", cxxopts::value<std::string>())
+        ("memory-report", "Count the heap allocations and the peak RSS per phase and per header, and write them to the given json file", cxxopts::value<std::string>())
+        ("json-benchmark", "Serialize the parse result the given number of times with the json tree and the direct writer, and print their throughput", cxxopts::value<int>())
+        ("flat", "Convert the parse result to the flat columnar store and generate the json from it")
+        ("worker-processes", "Parse the headers in the given number of forked worker processes, a crashed header is retried and then skipped, 0 means one per hardware thread", cxxopts::value<int>())
+        ("worker-retries", "The number of times a header whose worker crashed or timed out is retried, 1 by default", cxxopts::value<int>())
+        ("worker-timeout", "The seconds after which a worker parsing a header is killed, no timeout by default", cxxopts::value<int>())
+        ("intern-types", "Parse the builtin and user-defined types once per header and copy them for their other occurrences")
+        ("in-memory-headers", "Read the headers reachable from the visited headers into memory once, and let libclang parse every header against them instead of reading them from disk")
+        ("binary-output", "Also dump the parse result in the compact binary encoding to the given file", cxxopts::value<std::string>())
+        ("render-from", "Render a previous dump (json file, sharded output dir or --binary-output file) instead of parsing the headers, libclang is not used", cxxopts::value<std::string>())
+        ("render", "The registered SyntaxRender used by --render-from, e.g., json to re-dump the files as json", cxxopts::value<std::string>())
+        ("render-stamps", "Keep the hashes of the files rendered by --render-from in the given file, e.g., in the build dir, so that the unchanged files are not written and formatted again", cxxopts::value<std::string>())
+        ("shallow", "Only parse the visited headers themselves, without their includes and the function bodies, the types declared in the included headers are kept as spelled and flagged as is_unresolved")
+        ("shallow-report", "The report of the nodes with unresolved types of --shallow, or <output-dir>.shallow.json by default", cxxopts::value<std::string>());
   // clang-format on
 
   auto parse_result = option_list.parse(argc, argv);
 
+  std::string memory_report = "";
+  if (parse_result.count("memory-report")) {
+    memory_report = parse_result["memory-report"].as<std::string>();
+    MemoryAccounting::Instance().Enable();
+  }
+
   std::string output_dir = "";
   std::string visit_headers = "";
   std::string pre_process_dir = "";
@@ -47,6 +249,8 @@ int main(int argc, char **argv) {
   std::vector<std::string> visit_files;
   std::vector<std::string> custom_headers;
   bool is_dump_json = false;
+  ParseConfig parse_config;
+  DumpJsonOptions dump_json_options;
 
   std::map<std::string, std::string> defines = {
       {"__GLIBC_USE\(...\)", "0"},
@@ -68,6 +272,27 @@ int main(int argc, char **argv) {
     output_dir = std::string(std::filesystem::absolute(tmp_out).c_str());
   }
 
+  if (parse_result.count("render-from")) {
+    size_t render_jobs = 0;
+    if (parse_result.count("jobs")) {
+      render_jobs = std::max(0, parse_result["jobs"].as<int>());
+    }
+    std::string render_name = parse_result.count("render")
+                                  ? parse_result["render"].as<std::string>()
+                                  : "";
+    std::string render_stamps_path =
+        parse_result.count("render-stamps")
+            ? parse_result["render-stamps"].as<std::string>()
+            : "";
+    int code = RenderFrom(parse_result["render-from"].as<std::string>(),
+                          render_name, output_dir, render_jobs,
+                          render_stamps_path);
+    if (code == 0 && !memory_report.empty()) {
+      WriteMemoryReport(memory_report);
+    }
+    return code;
+  }
+
   if (parse_result.count("pre-process-dir")) {
     pre_process_dir = parse_result["pre-process-dir"].as<std::string>();
   } else {
@@ -123,15 +348,87 @@ int main(int argc, char **argv) {
     return -1;
   }
 
+  dump_json_options.output_dir = output_dir;
+
+  if (parse_result.count("sharded-output")) {
+    dump_json_options.is_sharded_output = true;
+  }
+
+  if (parse_result.count("jobs")) {
+    dump_json_options.jobs = std::max(0, parse_result["jobs"].as<int>());
+  }
+
+  if (parse_result.count("diff")) {
+    dump_json_options.diff_old_dump = parse_result["diff"].as<std::string>();
+    if (parse_result.count("diff-output")) {
+      dump_json_options.diff_output =
+          parse_result["diff-output"].as<std::string>();
+    } else {
+      dump_json_options.diff_output = output_dir + ".diff.json";
+    }
+  }
+
+  if (parse_result.count("json-benchmark")) {
+    dump_json_options.json_benchmark_iterations =
+        std::max(0, parse_result["json-benchmark"].as<int>());
+  }
+
+  if (parse_result.count("flat")) { dump_json_options.is_flat = true; }
+
+  WorkerProcessOptions &worker_processes = dump_json_options.worker_processes;
+  if (parse_result.count("worker-processes")) {
+    worker_processes.enabled = true;
+    worker_processes.count =
+        std::max(0, parse_result["worker-processes"].as<int>());
+  }
+  if (parse_result.count("worker-retries")) {
+    worker_processes.max_retries =
+        std::max(0, parse_result["worker-retries"].as<int>());
+  }
+  if (parse_result.count("worker-timeout")) {
+    worker_processes.timeout_seconds =
+        std::max(0, parse_result["worker-timeout"].as<int>());
+  }
+
+  if (parse_result.count("conversion-jobs")) {
+    parse_config.conversion_jobs =
+        std::max(0, parse_result["conversion-jobs"].as<int>());
+  }
+
+  if (parse_result.count("intern-types")) { parse_config.intern_types = true; }
+
+  if (parse_result.count("in-memory-headers")) {
+    parse_config.in_memory_headers = true;
+  }
+
+  if (parse_result.count("binary-output")) {
+    dump_json_options.binary_output =
+        parse_result["binary-output"].as<std::string>();
+  }
+
+  if (parse_result.count("shallow")) {
+    parse_config.shallow = true;
+    if (parse_result.count("shallow-report")) {
+      dump_json_options.shallow_report =
+          parse_result["shallow-report"].as<std::string>();
+    } else {
+      dump_json_options.shallow_report = output_dir + ".shallow.json";
+    }
+  }
+
   std::vector<std::string> pre_processed_files;
   std::filesystem::path tmp_path = pre_process_dir;
   terra::PreProcessVisitFiles(tmp_path, visit_files, pre_processed_files,
                               is_dump_json);
 
   if (is_dump_json) {
-    DumpJson(include_header_dirs, pre_processed_files, defines, output_dir);
-    return 0;
+    parse_config.include_header_dirs = include_header_dirs;
+    parse_config.parse_files = pre_processed_files;
+    parse_config.defines = defines;
+    DumpJson(parse_config, dump_json_options);
   }
 
+  if (!memory_report.empty()) { WriteMemoryReport(memory_report); }
+
   return 0;
 }
@@ -0,0 +1,245 @@
+// Generates parameterized synthetic SDK headers for the scaling benchmarks,
+// see scaling_benchmark.sh
+#include <algorithm>
+#include <cxxopts.hpp>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+struct SyntheticConfig {
+  int classes = 10;
+  int methods = 10;
+  int params = 3;
+  int nested_depth = 2;
+  int enum_values = 8;
+  // Every n-th method is wrapped in an `#if` block, 0 disables them
+  int if_block_every = 4;
+  // The feature of every n-th `#if` block is defined, so both branches are
+  // parsed, 0 leaves all of them undefined
+  int defined_feature_every = 2;
+};
+
+bool IsIfBlock(const SyntheticConfig &config, int method_index) {
+  return config.if_block_every > 0 && method_index % config.if_block_every == 0;
+}
+
+bool IsFeatureDefined(const SyntheticConfig &config, int method_index) {
+  return config.defined_feature_every > 0 &&
+         (method_index / config.if_block_every) %
+                 config.defined_feature_every ==
+             0;
+}
+
+static const char *kParamTypes[] = {"int", "const char*", "unsigned int",
+                                    "double", "bool", "long long"};
+
+std::string ParamType(int class_index, int method_index, int param_index) {
+  // Reference the types declared for the class every now and then, so the
+  // type lookups are part of the measured work
+  switch ((method_index + param_index) % 8) {
+  case 5:
+    return "const SynCStruct" + std::to_string(class_index) + "*";
+  case 6:
+    return "SynEnum" + std::to_string(class_index);
+  case 7:
+    return "const SynStruct" + std::to_string(class_index) + "&";
+  default:
+    return kParamTypes[(class_index + method_index + param_index) % 6];
+  }
+}
+
+void WriteDocComment(std::ostream &os, const std::string &indent,
+                     const std::string &brief, int params) {
+  os << indent << "/**\n";
+  os << indent << " * " << brief << "\n";
+  os << indent << " *\n";
+  for (int i = 0; i < params; i++) {
+    os << indent << " * @param p" << i << " The parameter " << i << ".\n";
+  }
+  os << indent << " * @return\n";
+  os << indent << " * - 0: Success.\n";
+  os << indent << " * - < 0: Failure.\n";
+  os << indent << " */\n";
+}
+
+void WriteEnum(std::ostream &os, const SyntheticConfig &config,
+               int class_index) {
+  std::string name = "SynEnum" + std::to_string(class_index);
+
+  os << "/**\n * The C-style typedef'd enum of the class " << class_index
+     << ".\n */\n";
+  os << "typedef enum {\n";
+  for (int i = 0; i < config.enum_values; i++) {
+    os << "  /** The value " << i << ". */\n";
+    os << "  SYN_ENUM_" << class_index << "_VALUE_" << i << " = " << i
+       << ",\n";
+  }
+  os << "} " << name << ";\n\n";
+}
+
+// The C-style anonymous typedef'd struct, without constructors
+void WriteCStruct(std::ostream &os, const SyntheticConfig &config,
+                  int class_index) {
+  std::string name = "SynCStruct" + std::to_string(class_index);
+
+  os << "/**\n * The C-style typedef'd struct of the class " << class_index
+     << ".\n */\n";
+  os << "typedef struct {\n";
+  os << "  /** The enum field. */\n";
+  os << "  SynEnum" << class_index << " kind;\n";
+  for (int i = 0; i < config.params; i++) {
+    os << "  /** The field " << i << ". */\n";
+    os << "  " << kParamTypes[(class_index + i) % 6] << " field" << i << ";\n";
+  }
+  os << "} " << name << ";\n\n";
+}
+
+void WriteNestedStruct(std::ostream &os, const std::string &indent, int depth,
+                       int nested_depth) {
+  std::string name = "Nested" + std::to_string(depth);
+
+  os << indent << "/** The nested struct of depth " << depth << ". */\n";
+  os << indent << "struct " << name << " {\n";
+  os << indent << "  /** The field of depth " << depth << ". */\n";
+  os << indent << "  int field" << depth << ";\n";
+  if (depth + 1 < nested_depth) {
+    WriteNestedStruct(os, indent + "  ", depth + 1, nested_depth);
+    os << indent << "  Nested" << depth + 1 << " nested;\n";
+  }
+  os << indent << "  " << name << "() : field" << depth << "(" << depth
+     << ") {}\n";
+  os << indent << "};\n";
+}
+
+void WriteStruct(std::ostream &os, const SyntheticConfig &config,
+                 int class_index) {
+  std::string name = "SynStruct" + std::to_string(class_index);
+
+  os << "/**\n * The struct of the class " << class_index << ".\n */\n";
+  os << "struct " << name << " {\n";
+  os << "  /** The enum field. */\n";
+  os << "  SynEnum" << class_index << " kind;\n";
+  os << "  /** The name field. */\n";
+  os << "  const char* name;\n";
+  if (config.nested_depth > 0) {
+    WriteNestedStruct(os, "  ", 0, config.nested_depth);
+    os << "  /** The nested field. */\n";
+    os << "  Nested0 nested;\n";
+  }
+  os << "\n  " << name << "() : kind(SYN_ENUM_" << class_index
+     << "_VALUE_0), name(NULL) {}\n";
+  os << "};\n\n";
+}
+
+void WriteClass(std::ostream &os, const SyntheticConfig &config,
+                int class_index) {
+  std::string name = "ISynClass" + std::to_string(class_index);
+
+  os << "/**\n * The interface " << class_index << ".\n */\n";
+  os << "class " << name << " {\n";
+  os << " public:\n";
+  os << "  virtual ~" << name << "() {}\n";
+  for (int m = 0; m < config.methods; m++) {
+    bool is_if_block = IsIfBlock(config, m);
+    if (is_if_block) {
+      os << "#if defined(SYN_FEATURE_" << class_index << "_" << m << ")\n";
+    }
+
+    os << "\n";
+    WriteDocComment(os, "  ", "The method " + std::to_string(m) + ".",
+                    config.params);
+    os << "  virtual int method" << m << "(";
+    for (int p = 0; p < config.params; p++) {
+      if (p > 0) { os << ", "; }
+      os << ParamType(class_index, m, p) << " p" << p;
+    }
+    os << ") = 0;\n";
+
+    if (is_if_block) {
+      os << "#else\n";
+      os << "  /** The fallback of the method " << m << ". */\n";
+      os << "  virtual int method" << m << "() = 0;\n";
+      os << "#endif\n";
+    }
+  }
+  os << "};\n\n";
+}
+
+std::string GenerateHeader(const SyntheticConfig &config) {
+  std::ostringstream os;
+  os << "// Generated by synthetic_headers: " << config.classes
+     << " classes x " << config.methods << " methods x " << config.params
+     << " params\n";
+  os << "#pragma once\n\n";
+  os << "#ifndef NULL\n#define NULL 0\n#endif\n\n";
+  bool has_defined_features = false;
+  for (int c = 0; c < config.classes; c++) {
+    for (int m = 0; m < config.methods; m++) {
+      if (IsIfBlock(config, m) && IsFeatureDefined(config, m)) {
+        os << "#define SYN_FEATURE_" << c << "_" << m << " 1\n";
+        has_defined_features = true;
+      }
+    }
+  }
+  if (has_defined_features) {
+    os << "\n";
+  }
+  os << "namespace synthetic {\n\n";
+  for (int c = 0; c < config.classes; c++) {
+    WriteEnum(os, config, c);
+    WriteCStruct(os, config, c);
+    WriteStruct(os, config, c);
+    WriteClass(os, config, c);
+  }
+  os << "} // namespace synthetic\n";
+  return os.str();
+}
+
+int main(int argc, char **argv) {
+  cxxopts::Options option_list("synthetic_headers",
+                               "Generate synthetic SDK headers");
+
+  // clang-format off
+    option_list.add_options()
+        ("output", "The output header file", cxxopts::value<std::string>())
+        ("classes", "The number of classes", cxxopts::value<int>()->default_value("10"))
+        ("methods", "The number of methods per class", cxxopts::value<int>()->default_value("10"))
+        ("params", "The number of parameters per method", cxxopts::value<int>()->default_value("3"))
+        ("nested-depth", "The depth of the nested structs per class, 0 disables them", cxxopts::value<int>()->default_value("2"))
+        ("enum-values", "The number of values of the typedef'd enum per class", cxxopts::value<int>()->default_value("8"))
+        ("if-block-every", "Wrap every n-th method in an #if block, 0 disables them", cxxopts::value<int>()->default_value("4"))
+        ("defined-feature-every", "Define the feature of every n-th #if block, 0 leaves all of them undefined", cxxopts::value<int>()->default_value("2"));
+  // clang-format on
+
+  auto parse_result = option_list.parse(argc, argv);
+
+  if (!parse_result.count("output")) {
+    std::cerr << "The output option is missing." << std::endl;
+    return -1;
+  }
+
+  SyntheticConfig config;
+  config.classes = std::max(0, parse_result["classes"].as<int>());
+  config.methods = std::max(0, parse_result["methods"].as<int>());
+  config.params = std::max(0, parse_result["params"].as<int>());
+  config.nested_depth = std::max(0, parse_result["nested-depth"].as<int>());
+  config.enum_values = std::max(1, parse_result["enum-values"].as<int>());
+  config.if_block_every = std::max(0, parse_result["if-block-every"].as<int>());
+  config.defined_feature_every =
+      std::max(0, parse_result["defined-feature-every"].as<int>());
+
+  std::filesystem::path output = parse_result["output"].as<std::string>();
+  if (output.has_parent_path()) {
+    std::filesystem::create_directories(output.parent_path());
+  }
+
+  std::ofstream osWrite(output, std::ofstream::trunc);
+  osWrite << GenerateHeader(config);
+  osWrite.close();
+  std::cout << "Generate the synthetic header " << output.string()
+            << std::endl;
+
+  return 0;
+}
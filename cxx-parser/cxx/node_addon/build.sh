@@ -0,0 +1,37 @@
+#!/bin/bash
+
+# Build the terra Node-API module into <output-dir>/terra_addon.node
+#
+# Usage: build.sh <output-dir>
+
+set -e
+set -x
+
+SCRIPT_PATH=$(dirname "$0")
+MY_PATH=$(realpath ${SCRIPT_PATH})
+OUTPUT_PATH=$1
+
+if [ ! -d "${OUTPUT_PATH}" ]; then
+    mkdir -p ${OUTPUT_PATH}
+fi
+
+pushd ${OUTPUT_PATH}
+
+LLVM_CONFIG_BINARY=""
+if [[ ! -z "${LLVM_DOWNLOAD_URL}" ]]; then
+  echo "Use the llvm from the url: ${LLVM_DOWNLOAD_URL}"
+else
+  echo "Use the llvm from the system"
+  LLVM_CONFIG_BINARY=$(which llvm-config)
+fi
+
+cmake \
+    -DCMAKE_BUILD_TYPE=Release \
+    -DLLVM_CONFIG_BINARY=${LLVM_CONFIG_BINARY} \
+    -DLLVM_DOWNLOAD_URL=${LLVM_DOWNLOAD_URL} \
+    -DCMAKE_LIBRARY_OUTPUT_DIRECTORY=${OUTPUT_PATH} \
+    ${MY_PATH}
+
+cmake --build .
+
+popd
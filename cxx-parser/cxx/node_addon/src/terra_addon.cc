@@ -0,0 +1,321 @@
+// The Node-API module of the terra parser, so the cxx-parser can parse the
+// headers in-process instead of spawning the cppast_backend and reading its
+// json dump back.
+//
+// parse(options): Promise<CXXFile[]>, parses on a libuv worker thread
+// parseSync(options): CXXFile[], parses on the calling thread
+//
+// The options are
+// {
+//   includeHeaderDirs: string[],
+//   parseFiles: string[],
+//   defines: string[],      // the same as `--defines-macros`
+//   preProcessDir: string,  // the parse files are pre-processed into it
+// }
+//
+// The result is the same as the json dump of `cppast_backend --dump-json`,
+// but built as JS values directly, without a json text in between.
+#include <node_api.h>
+
+#include "terra.hpp"
+#include "terra_utils.hpp"
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace terra;
+
+#define NAPI_CALL(env, call)                                                   \
+  do {                                                                         \
+    if ((call) != napi_ok) {                                                   \
+      ThrowLastError(env);                                                     \
+      return nullptr;                                                          \
+    }                                                                          \
+  } while (0)
+
+struct ParseOptions {
+  std::vector<std::string> include_header_dirs;
+  std::vector<std::string> parse_files;
+  std::vector<std::string> defines;
+  std::string pre_process_dir;
+};
+
+struct ParseWork {
+  napi_async_work work = nullptr;
+  napi_deferred deferred = nullptr;
+  ParseOptions options;
+  nlohmann::json result;
+  std::string error;
+};
+
+void ThrowLastError(napi_env env) {
+  bool is_pending = false;
+  napi_is_exception_pending(env, &is_pending);
+  if (is_pending) { return; }
+
+  const napi_extended_error_info *error_info = nullptr;
+  napi_get_last_error_info(env, &error_info);
+  const char *message = error_info != nullptr && error_info->error_message
+                            ? error_info->error_message
+                            : "Unknown Node-API error";
+  napi_throw_error(env, nullptr, message);
+}
+
+bool GetString(napi_env env, napi_value value, std::string &result) {
+  size_t length = 0;
+  if (napi_get_value_string_utf8(env, value, nullptr, 0, &length) != napi_ok) {
+    return false;
+  }
+
+  result.resize(length + 1);
+  if (napi_get_value_string_utf8(env, value, &result[0], result.size(),
+                                 &length) != napi_ok) {
+    return false;
+  }
+  result.resize(length);
+  return true;
+}
+
+bool GetStringProperty(napi_env env, napi_value object, const char *name,
+                       std::string &result) {
+  napi_value value;
+  if (napi_get_named_property(env, object, name, &value) != napi_ok) {
+    return false;
+  }
+
+  napi_valuetype type;
+  napi_typeof(env, value, &type);
+  if (type == napi_undefined) { return true; }
+  return GetString(env, value, result);
+}
+
+bool GetStringArrayProperty(napi_env env, napi_value object, const char *name,
+                            std::vector<std::string> &result) {
+  napi_value value;
+  if (napi_get_named_property(env, object, name, &value) != napi_ok) {
+    return false;
+  }
+
+  napi_valuetype type;
+  napi_typeof(env, value, &type);
+  if (type == napi_undefined) { return true; }
+
+  uint32_t length = 0;
+  if (napi_get_array_length(env, value, &length) != napi_ok) { return false; }
+
+  for (uint32_t i = 0; i < length; i++) {
+    napi_value element;
+    std::string str;
+    if (napi_get_element(env, value, i, &element) != napi_ok ||
+        !GetString(env, element, str)) {
+      return false;
+    }
+    result.push_back(std::move(str));
+  }
+  return true;
+}
+
+bool GetParseOptions(napi_env env, napi_callback_info info,
+                     ParseOptions &options) {
+  size_t argc = 1;
+  napi_value argv[1];
+  if (napi_get_cb_info(env, info, &argc, argv, nullptr, nullptr) != napi_ok) {
+    return false;
+  }
+
+  napi_valuetype type = napi_undefined;
+  if (argc >= 1) { napi_typeof(env, argv[0], &type); }
+  if (type != napi_object) {
+    napi_throw_type_error(env, nullptr, "The parse options are missing.");
+    return false;
+  }
+
+  if (!GetStringArrayProperty(env, argv[0], "includeHeaderDirs",
+                              options.include_header_dirs) ||
+      !GetStringArrayProperty(env, argv[0], "parseFiles",
+                              options.parse_files) ||
+      !GetStringArrayProperty(env, argv[0], "defines", options.defines) ||
+      !GetStringProperty(env, argv[0], "preProcessDir",
+                         options.pre_process_dir)) {
+    napi_throw_type_error(env, nullptr, "The parse options are invalid.");
+    return false;
+  }
+
+  if (options.pre_process_dir.empty()) {
+    napi_throw_type_error(env, nullptr, "The preProcessDir option is missing.");
+    return false;
+  }
+
+  return true;
+}
+
+/// Parse the headers the same way as `cppast_backend --dump-json`.
+nlohmann::json RunParse(const ParseOptions &options) {
+  std::map<std::string, std::string> defines = {
+      {"__GLIBC_USE(...)", "0"},
+      {"__GNUC_PREREQ(...)", "0"},
+      {"__GLIBC_PREREQ(...)", "0"},
+      {"__glibc_clang_prereq(...)", "0"}};
+  for (auto &define : options.defines) {
+    defines.insert(std::make_pair(define, ""));
+  }
+
+  std::vector<std::string> pre_processed_files;
+  PreProcessVisitFiles(options.pre_process_dir, options.parse_files,
+                       pre_processed_files, true);
+
+  // make sure `pre_process_dir` as the first of the headers
+  std::vector<std::string> include_header_dirs;
+  include_header_dirs.push_back(options.pre_process_dir);
+  include_header_dirs.insert(include_header_dirs.end(),
+                             options.include_header_dirs.begin(),
+                             options.include_header_dirs.end());
+
+  DefaultVisitor rootVisitor;
+  rootVisitor.AddPass(std::make_unique<ConstantFoldingPass>());
+  rootVisitor.AddPass(std::make_unique<InheritancePass>());
+  ParseConfig parse_config{include_header_dirs, pre_processed_files, defines};
+  rootVisitor.Visit(parse_config);
+
+  DefaultJsonGenerator json_generator("");
+  nlohmann::json cxx_files_json = json_generator.ToJson(rootVisitor.parse_result_);
+  if (cxx_files_json.is_null()) { cxx_files_json = nlohmann::json::array(); }
+  return cxx_files_json;
+}
+
+napi_status ToJsValue(napi_env env, const nlohmann::json &json,
+                      napi_value *result) {
+  switch (json.type()) {
+  case nlohmann::json::value_t::null:
+    return napi_get_null(env, result);
+  case nlohmann::json::value_t::boolean:
+    return napi_get_boolean(env, json.get<bool>(), result);
+  case nlohmann::json::value_t::number_integer:
+    return napi_create_int64(env, json.get<int64_t>(), result);
+  case nlohmann::json::value_t::number_unsigned:
+    // Same as `JSON.parse`, which has no integers above 2^53 either
+    return napi_create_double(env, (double)json.get<uint64_t>(), result);
+  case nlohmann::json::value_t::number_float:
+    return napi_create_double(env, json.get<double>(), result);
+  case nlohmann::json::value_t::string: {
+    auto &str = json.get_ref<const std::string &>();
+    return napi_create_string_utf8(env, str.data(), str.size(), result);
+  }
+  case nlohmann::json::value_t::array: {
+    napi_status status = napi_create_array_with_length(env, json.size(), result);
+    for (size_t i = 0; status == napi_ok && i < json.size(); i++) {
+      napi_value element;
+      status = ToJsValue(env, json[i], &element);
+      if (status == napi_ok) {
+        status = napi_set_element(env, *result, (uint32_t)i, element);
+      }
+    }
+    return status;
+  }
+  case nlohmann::json::value_t::object: {
+    napi_status status = napi_create_object(env, result);
+    for (auto it = json.begin(); status == napi_ok && it != json.end(); ++it) {
+      napi_value value;
+      status = ToJsValue(env, it.value(), &value);
+      if (status == napi_ok) {
+        status = napi_set_named_property(env, *result, it.key().c_str(), value);
+      }
+    }
+    return status;
+  }
+  default:
+    return napi_get_undefined(env, result);
+  }
+}
+
+void ExecuteParse(napi_env env, void *data) {
+  ParseWork *parse_work = static_cast<ParseWork *>(data);
+  try {
+    parse_work->result = RunParse(parse_work->options);
+  } catch (const std::exception &e) {
+    parse_work->error = e.what();
+  } catch (...) { parse_work->error = "Unknown error while parsing"; }
+}
+
+void CompleteParse(napi_env env, napi_status status, void *data) {
+  std::unique_ptr<ParseWork> parse_work(static_cast<ParseWork *>(data));
+
+  if (status == napi_ok && parse_work->error.empty()) {
+    napi_value result;
+    if (ToJsValue(env, parse_work->result, &result) == napi_ok) {
+      napi_resolve_deferred(env, parse_work->deferred, result);
+      napi_delete_async_work(env, parse_work->work);
+      return;
+    }
+    parse_work->error = "Failed to convert the parse result";
+  } else if (parse_work->error.empty()) {
+    parse_work->error = "The parse was cancelled";
+  }
+
+  // The conversion may have left an exception pending, reject with it instead
+  bool is_pending = false;
+  napi_value error = nullptr;
+  napi_is_exception_pending(env, &is_pending);
+  if (is_pending) {
+    napi_get_and_clear_last_exception(env, &error);
+  } else {
+    napi_value message;
+    napi_create_string_utf8(env, parse_work->error.c_str(), NAPI_AUTO_LENGTH,
+                            &message);
+    napi_create_error(env, nullptr, message, &error);
+  }
+  napi_reject_deferred(env, parse_work->deferred, error);
+  napi_delete_async_work(env, parse_work->work);
+}
+
+napi_value Parse(napi_env env, napi_callback_info info) {
+  std::unique_ptr<ParseWork> parse_work = std::make_unique<ParseWork>();
+  if (!GetParseOptions(env, info, parse_work->options)) { return nullptr; }
+
+  napi_value promise;
+  napi_value resource_name;
+  NAPI_CALL(env, napi_create_promise(env, &parse_work->deferred, &promise));
+  NAPI_CALL(env, napi_create_string_utf8(env, "terra.parse", NAPI_AUTO_LENGTH,
+                                         &resource_name));
+  NAPI_CALL(env, napi_create_async_work(env, nullptr, resource_name,
+                                        ExecuteParse, CompleteParse,
+                                        parse_work.get(), &parse_work->work));
+  NAPI_CALL(env, napi_queue_async_work(env, parse_work->work));
+
+  // Owned by `CompleteParse` from now on
+  parse_work.release();
+  return promise;
+}
+
+napi_value ParseSync(napi_env env, napi_callback_info info) {
+  ParseOptions options;
+  if (!GetParseOptions(env, info, options)) { return nullptr; }
+
+  nlohmann::json cxx_files_json;
+  try {
+    cxx_files_json = RunParse(options);
+  } catch (const std::exception &e) {
+    napi_throw_error(env, nullptr, e.what());
+    return nullptr;
+  }
+
+  napi_value result;
+  NAPI_CALL(env, ToJsValue(env, cxx_files_json, &result));
+  return result;
+}
+
+napi_value Init(napi_env env, napi_value exports) {
+  napi_property_descriptor descriptors[] = {
+      {"parse", nullptr, Parse, nullptr, nullptr, nullptr, napi_default,
+       nullptr},
+      {"parseSync", nullptr, ParseSync, nullptr, nullptr, nullptr,
+       napi_default, nullptr},
+  };
+  NAPI_CALL(env, napi_define_properties(
+                     env, exports, sizeof(descriptors) / sizeof(descriptors[0]),
+                     descriptors));
+  return exports;
+}
+
+NAPI_MODULE(terra_addon, Init)
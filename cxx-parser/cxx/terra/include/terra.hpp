@@ -10,6 +10,7 @@
 #include <cppast/cpp_namespace.hpp>          // for cpp_namespace
 #include <cppast/libclang_parser.hpp>        // for libclang_parser, libclang_compile_config, cpp_entity,...
 #include <cppast/visitor.hpp>                // for visit()
+#include <cppast/static_visitor.hpp>         // for static_visit()
 #include <cppast/cpp_function.hpp>
 #include <cppast/cpp_class.hpp>
 #include <cppast/cpp_enum.hpp>
@@ -25,7 +26,10 @@
 #include <memory>
 #include <stdlib.h>
 #include <map>
+#include <set>
+#include <sstream>
 #include <string>
+#include <unordered_map>
 #include <filesystem>
 #include <fstream>
 #include <vector>
@@ -35,6 +39,21 @@
 #include "terra_parser.hpp"
 #include "terra_generator.hpp"
 #include "terra_utils.hpp"
+#include "terra_diff.hpp"
+#include "terra_pass.hpp"
+#include "terra_memory.hpp"
+#include "terra_json.hpp"
+#include "terra_flat.hpp"
+#include "terra_codec.hpp"
+#include "terra_process_pool.hpp"
+#include "terra_constant_folding.hpp"
+#include "terra_inheritance.hpp"
+#include "terra_ast_index.hpp"
+#include "terra_render_rope.hpp"
+#include "terra_header_file_system.hpp"
+#include "terra_json_reader.hpp"
+#include "terra_json_render.hpp"
+#include "terra_shallow_report.hpp"
 #include <variant>
 
 namespace terra
@@ -44,6 +63,34 @@ namespace terra
     private:
         std::vector<std::string> include_header_dirs_;
         ParseResult parse_result_;
+        PassManager *pass_manager_ = nullptr;
+        size_t conversion_jobs_ = 1;
+
+        /// The stream of the conversion logs of this thread, `std::cout` unless set by `print_ast`
+        static std::ostream *&log_stream()
+        {
+            thread_local std::ostream *stream = nullptr;
+            return stream;
+        }
+
+        static std::ostream &log()
+        {
+            return log_stream() != nullptr ? *log_stream() : std::cout;
+        }
+
+        /// Sends the conversion logs of this thread to `stream` while it is alive
+        struct LogScope
+        {
+            explicit LogScope(std::ostream &stream)
+            {
+                log_stream() = &stream;
+            }
+
+            ~LogScope()
+            {
+                log_stream() = nullptr;
+            }
+        };
 
         std::unique_ptr<cppast::cpp_file>
         parse_file(const cppast::libclang_compile_config &config,
@@ -56,16 +103,38 @@ namespace terra
             // the parser is used to parse the entity
             // there can be multiple parser implementations
             cppast::libclang_parser parser(type_safe::ref(logger));
+            MemoryAccounting &memory_accounting = MemoryAccounting::Instance();
+            parser.record_tu_memory_usage(memory_accounting.IsEnabled());
             // parse the file
             auto file = parser.parse(idx, filename, config);
+            for (auto &usage : parser.take_tu_memory_usage())
+            {
+                memory_accounting.AddTranslationUnitUsage({usage.file, usage.entries, usage.total});
+            }
             if (fatal_error && parser.error())
                 return nullptr;
             return file;
         }
 
+        /// The headers reachable from `filename` are given to libclang from memory, see `HeaderFileSystem`
+        static cppast::libclang_compile_config file_config(const cppast::libclang_compile_config &config,
+                                                           const ParseConfig &parse_config,
+                                                           const std::string &filename)
+        {
+            cppast::libclang_compile_config result(config);
+            if (parse_config.header_file_system != nullptr)
+            {
+                for (auto header : parse_config.header_file_system->Reachable(filename))
+                {
+                    result.add_unsaved_file(header->path, header->content.data(), header->content.size());
+                }
+            }
+            return result;
+        }
+
         void to_simple_type(SimpleType &type, const cppast::cpp_type &cpp_type, bool recursion = false)
         {
-            std::cout << "------------" << cppast::to_string(cpp_type) << " >> " << std::to_string((int)cpp_type.kind()) << "\n";
+            log() << "------------" << cppast::to_string(cpp_type) << " >> " << std::to_string((int)cpp_type.kind()) << "\n";
             if (!recursion)
             {
                 type.name = cppast::to_string(cpp_type);
@@ -87,6 +156,7 @@ namespace terra
                 auto &cpp_user_defined_type = static_cast<const cppast::cpp_user_defined_type &>(cpp_type);
                 type.name = cpp_user_defined_type.entity().name();
                 type.is_builtin_type = false;
+                type.is_unresolved = cpp_user_defined_type.is_unresolved();
                 break;
             }
             case cppast::cpp_type_kind::auto_t:
@@ -169,7 +239,7 @@ namespace terra
                         {
                             std::string arg_type_name = cppast::to_string(arg_type.value());
                             type.template_arguments.push_back(arg_type_name);
-                            std::cout << "template_instantiation_t argument: " << arg_type_name << "\n";
+                            log() << "template_instantiation_t argument: " << arg_type_name << "\n";
                         }
                     }
                 }
@@ -177,7 +247,7 @@ namespace terra
                 {
                     std::string arg_type_name = cpp_template_instantiation_type.unexposed_arguments();
                     type.template_arguments.push_back(arg_type_name);
-                    std::cout << "template_instantiation_t unexposed_arguments: " << arg_type_name << "\n";
+                    log() << "template_instantiation_t unexposed_arguments: " << arg_type_name << "\n";
                 }
 
                 type.source = cppast::to_string(cpp_type);
@@ -309,10 +379,14 @@ namespace terra
                         static_cast<const cppast::cpp_unexposed_expression &>(default_value_e);
                     default_value = cpp_unexposed_expression.expression().as_string();
                 }
+                if (default_value_e.integer_value().has_value())
+                {
+                    parameter.evaluated_value = default_value_e.integer_value().value();
+                }
             }
             parameter.default_value = default_value;
 
-            std::cout << "param type:" << parameter.type.name << " " << parameter.type.kind << " " << parameter.type.is_builtin_type << ", name:" << parameter.name << ", default value: " << parameter.default_value << "\n";
+            log() << "param type:" << parameter.type.name << " " << parameter.type.kind << " " << parameter.type.is_builtin_type << ", name:" << parameter.name << ", default value: " << parameter.default_value << "\n";
         }
 
         void parse_member_variables(
@@ -391,10 +465,10 @@ namespace terra
 
             if (cpp_enum.scope_name().has_value())
             {
-                std::cout << "enum value: " << cpp_enum.scope_name().value().name() << "\n";
+                log() << "enum value: " << cpp_enum.scope_name().value().name() << "\n";
             }
 
-            std::cout << "enum: " << enumz.name << "\n";
+            log() << "enum: " << enumz.name << "\n";
 
             std::vector<std::string> enumFullScopeList(parentFullScopeList);
             enumFullScopeList.push_back(enumz.name);
@@ -423,10 +497,14 @@ namespace terra
                     }
                     enum_constant.source = enum_constant.value;
                 }
+                if (en.integer_value().has_value())
+                {
+                    enum_constant.evaluated_value = en.integer_value().value();
+                }
 
                 enumz.enum_constants.push_back(enum_constant);
 
-                std::cout << "enum_constant: " << enum_constant.name << " = " << enum_constant.value << "\n";
+                log() << "enum_constant: " << enum_constant.name << " = " << enum_constant.value << "\n";
             }
         }
 
@@ -452,7 +530,7 @@ namespace terra
             const std::vector<std::string> &parentFullScopeList,
             const std::string &file_path)
         {
-            std::cout << "member of " << cpp_class.name() << "\n";
+            log() << "member of " << cpp_class.name() << "\n";
             std::string current_access_specifier;
             std::vector<Constructor> constructors;
             std::vector<MemberFunction> methods;
@@ -468,7 +546,7 @@ namespace terra
 
             for (auto &member : cpp_class)
             {
-                std::cout << "member.name(): " << member.name() << " (" << cppast::to_string(member.kind()) << ")"
+                log() << "member.name(): " << member.name() << " (" << cppast::to_string(member.kind()) << ")"
                           << "\n";
 
                 auto member_kind = member.kind();
@@ -516,7 +594,7 @@ namespace terra
                     // Check if it's a union
                     if (cpp_nested_class.class_kind() == cppast::cpp_class_kind::union_t)
                     {
-                        std::cout << "[nested union_t] Flattening union members: " << cpp_nested_class.name() << std::endl;
+                        log() << "[nested union_t] Flattening union members: " << cpp_nested_class.name() << std::endl;
 
                         // Flatten union members to parent struct
                         // Iterate through union's members and add them as member variables
@@ -528,13 +606,13 @@ namespace terra
                                 MemberVariable member_var;
                                 parse_member_variables(member_var, namespaceList, classFullScopeList, file_path, cpp_member_var, current_access_specifier);
                                 member_variables.push_back(member_var);
-                                std::cout << "  [union member] Added: " << member_var.name << std::endl;
+                                log() << "  [union member] Added: " << member_var.name << std::endl;
                             }
                         }
                     }
                     else
                     {
-                        std::cout << "[nested class_t] Skipping nested class/struct: " << cpp_nested_class.name() << std::endl;
+                        log() << "[nested class_t] Skipping nested class/struct: " << cpp_nested_class.name() << std::endl;
                         // Skip other nested classes/structs
                     }
                     break;
@@ -545,12 +623,12 @@ namespace terra
                 }
             }
 
-            std::cout << "[class_t] cpp_class: " << cpp_class.name() << std::endl;
+            log() << "[class_t] cpp_class: " << cpp_class.name() << std::endl;
 
             // Skip anonymous unions - they will be handled differently
             if (cpp_class.class_kind() == cppast::cpp_class_kind::union_t)
             {
-                std::cout << "[union_t] Ignoring union completely: " << cpp_class.name() << std::endl;
+                log() << "[union_t] Ignoring union completely: " << cpp_class.name() << std::endl;
                 // Skip unions completely, don't even create an empty Clazz
                 return Clazz(); // Return default-constructed Clazz that will be filtered out
             }
@@ -587,7 +665,7 @@ namespace terra
                 if (attr.scope())
                 {
                     std::string a = std::string(attr.scope().value() + "::" + attr.name());
-                    std::cout << "attribute: " << a << std::endl;
+                    log() << "attribute: " << a << std::endl;
                     out_attrs.push_back(a);
                 }
                 else
@@ -600,7 +678,7 @@ namespace terra
                         a += "(" + attr.arguments().value().as_string() + ")";
                     }
 
-                    std::cout << "attribute: " << a << std::endl;
+                    log() << "attribute: " << a << std::endl;
 
                     out_attrs.push_back(attr.name());
                 }
@@ -620,229 +698,384 @@ namespace terra
             return comment;
         }
 
-        // prints the AST of a file
-        void print_ast(std::ostream &out, const cppast::cpp_file &file)
+        /// A top-level class or enum of a file, converted on its own by `print_ast`
+        struct ConversionUnit
         {
-            // print file name
-            std::cout << "AST for '" << file.name() << "':\n";
-
-            auto file_path = std::string(file.name());
-            CXXFile cxx_file{file_path};
+            const cppast::cpp_entity *entity = nullptr;
+            /// The namespaces around the entity
+            std::vector<std::string> namespaces;
+            std::vector<NodeType> nodes;
+            std::ostringstream log;
+        };
+
+        /// The traversal of one file in `print_ast`, the handlers are selected at compile time by
+        /// `cppast::static_visit`. With `DispatchPasses`, every entity is visited and dispatched to
+        /// the entity passes first, otherwise only the containers that can hold converted entities
+        /// are descended into.
+        template <bool DispatchPasses>
+        struct AstVisitor
+        {
+            using all_containers = cppast::cpp_entity_kind_set<
+                cppast::cpp_entity_kind::file_t,
+                cppast::cpp_entity_kind::language_linkage_t,
+                cppast::cpp_entity_kind::namespace_t,
+                cppast::cpp_entity_kind::enum_t,
+                cppast::cpp_entity_kind::class_t,
+                cppast::cpp_entity_kind::alias_template_t,
+                cppast::cpp_entity_kind::variable_template_t,
+                cppast::cpp_entity_kind::function_template_t,
+                cppast::cpp_entity_kind::function_template_specialization_t,
+                cppast::cpp_entity_kind::class_template_t,
+                cppast::cpp_entity_kind::class_template_specialization_t>;
+
+            // The enum values and the function templates never hold a converted entity
+            using converted_containers = cppast::cpp_entity_kind_set<
+                cppast::cpp_entity_kind::file_t,
+                cppast::cpp_entity_kind::language_linkage_t,
+                cppast::cpp_entity_kind::namespace_t,
+                cppast::cpp_entity_kind::class_t,
+                cppast::cpp_entity_kind::alias_template_t,
+                cppast::cpp_entity_kind::variable_template_t,
+                cppast::cpp_entity_kind::class_template_t,
+                cppast::cpp_entity_kind::class_template_specialization_t>;
+
+            using children_of = std::conditional_t<DispatchPasses, all_containers, converted_containers>;
+
+            RootParser &parser;
+            const std::string &file_path;
+            CXXFile &cxx_file;
 
             std::vector<std::string> namespaceList;
             std::vector<std::string> fullScopeList;
+            /// The entities which are already converted, their nodes are appended instead of converting them again
+            const std::unordered_map<const cppast::cpp_entity *, ConversionUnit *> *converted_units = nullptr;
 
-            // std::string prefix; // the current prefix string
-            // recursively visit file and all children
-            cppast::visit(
-                file,
-                [](const cppast::cpp_entity &e)
+            template <typename T>
+            bool operator()(const T &e, const cppast::visitor_info &info)
+            {
+                if constexpr (DispatchPasses)
                 {
-                    // only visit non-templated class definitions that have the attribute set
-                    return true;
-                    //                (!cppast::is_templated(e) && e.kind() == cppast::cpp_entity_kind::class_t && cppast::is_definition(e))
-                    //                       || e.kind() == cppast::cpp_entity_kind::enum_t
-                    //                       // or all namespaces
-                    //                       || e.kind() == cppast::cpp_entity_kind::namespace_t;
-                },
-                [&](const cppast::cpp_entity &e, const cppast::visitor_info &info)
+                    parser.pass_manager_->DispatchEntity(e, info, cxx_file);
+                }
+                else if (converted_units != nullptr)
                 {
-                    // std::cout << "entity name: " << e.name() << "kind: " << cppast::to_string(e.kind()) << std::endl;
-                    if (e.kind() == cppast::cpp_entity_kind::include_directive_t)
+                    auto converted = converted_units->find(&e);
+                    if (converted != converted_units->end())
                     {
-                        auto &include_directive = static_cast<const cppast::cpp_include_directive &>(e);
-
-                        IncludeDirective include_directive_ptr; // = new IncludeDirective();
-                        include_directive_ptr.include_file_path = std::string(include_directive.full_path());
-
-                        cxx_file.nodes.push_back(include_directive_ptr);
+                        return Append(*converted->second, info);
                     }
+                }
 
-                    if (e.kind() == cppast::cpp_entity_kind::namespace_t)
-                    {
-                        auto &cpp_namespace = static_cast<const cppast::cpp_namespace &>(e);
+                return Handle(e, info);
+            }
 
-                        if (info.event == cppast::visitor_info::container_entity_enter)
-                        {
-                            std::cout << "namespace.name(): " << cpp_namespace.name() << " (" << cppast::to_string(cpp_namespace.kind()) << ")"
-                                      << "start\n";
+            // Skips the children of the converted entity, and its exit event
+            bool Append(ConversionUnit &unit, const cppast::visitor_info &info)
+            {
+                if (info.event == cppast::visitor_info::container_entity_exit)
+                {
+                    return true;
+                }
 
-                            namespaceList.push_back(cpp_namespace.name());
-                            fullScopeList.push_back(std::string(e.name()));
-                        }
-                        else if (info.event == cppast::visitor_info::container_entity_exit)
-                        {
-                            std::cout << "namespace.name(): " << cpp_namespace.name() << " (" << cppast::to_string(cpp_namespace.kind()) << ")"
-                                      << "end\n";
+                log() << unit.log.str();
+                for (auto &node : unit.nodes)
+                {
+                    cxx_file.nodes.push_back(std::move(node));
+                }
+                return info.event != cppast::visitor_info::container_entity_enter;
+            }
 
-                            namespaceList.pop_back();
-                            fullScopeList.pop_back();
-                        }
-                    }
+            bool Handle(const cppast::cpp_entity &e, const cppast::visitor_info &info)
+            {
+                return true;
+            }
 
-                    if (e.kind() == cppast::cpp_entity_kind::type_alias_t)
-                    {
-                        auto &cpp_type_alias = static_cast<const cppast::cpp_type_alias &>(e);
+            bool Handle(const cppast::cpp_include_directive &include_directive, const cppast::visitor_info &info)
+            {
+                IncludeDirective include_directive_ptr; // = new IncludeDirective();
+                include_directive_ptr.include_file_path = std::string(include_directive.full_path());
 
-                        if (cpp_type_alias.name().empty())
-                        {
-                            return false;
-                        }
+                cxx_file.nodes.push_back(include_directive_ptr);
+                return true;
+            }
 
-                        if (cxx_file.nodes.empty())
-                        {
-                            NodeType node = parse_type_alias(cpp_type_alias, namespaceList, fullScopeList, file_path);
-                            cxx_file.nodes.push_back(node);
-                            std::cout << "[type_alias_t] type name: " << cpp_type_alias.name() << ", under type: " << cppast::to_string(cpp_type_alias.underlying_type())
-                                      << std::endl;
-                            return true;
-                        }
+            bool Handle(const cppast::cpp_namespace &cpp_namespace, const cppast::visitor_info &info)
+            {
+                if (info.event == cppast::visitor_info::container_entity_enter)
+                {
+                    log() << "namespace.name(): " << cpp_namespace.name() << " (" << cppast::to_string(cpp_namespace.kind()) << ")"
+                              << "start\n";
 
-                        // If C-style definitions are used to define structs or enums, such as,
-                        // ```
-                        // typedef enum
-                        // {
-                        //     kPreloadStatusCompleted = 0,
-                        //     kPreloadStatusFailed = 1,
-                        // } PreloadStatusCode;
-                        // ```
-                        // The above code will be parsed as an enum node with an empty name. Next,
-                        // we need to fill the name of the type_alias_t to the previous node.
+                    namespaceList.push_back(cpp_namespace.name());
+                    fullScopeList.push_back(std::string(cpp_namespace.name()));
+                }
+                else if (info.event == cppast::visitor_info::container_entity_exit)
+                {
+                    log() << "namespace.name(): " << cpp_namespace.name() << " (" << cppast::to_string(cpp_namespace.kind()) << ")"
+                              << "end\n";
 
-                        auto &last_node = cxx_file.nodes.back();
+                    namespaceList.pop_back();
+                    fullScopeList.pop_back();
+                }
+                return true;
+            }
 
-                        bool isNeedFillPreNodeName = false;
-                        std::string preNodeName = "";
+            bool Handle(const cppast::cpp_type_alias &cpp_type_alias, const cppast::visitor_info &info)
+            {
+                if (cpp_type_alias.name().empty())
+                {
+                    return false;
+                }
 
-                        // need fill the previous node name if name is empty
-                        // if the name is same, do nothing
+                if (cxx_file.nodes.empty())
+                {
+                    NodeType node = parser.parse_type_alias(cpp_type_alias, namespaceList, fullScopeList, file_path);
+                    cxx_file.nodes.push_back(node);
+                    log() << "[type_alias_t] type name: " << cpp_type_alias.name() << ", under type: " << cppast::to_string(cpp_type_alias.underlying_type())
+                              << std::endl;
+                    return true;
+                }
 
-                        if (std::holds_alternative<Enumz>(last_node))
-                        {
-                            auto &enumz = std::get<Enumz>(last_node);
-                            preNodeName = enumz.name;
+                // If C-style definitions are used to define structs or enums, such as,
+                // ```
+                // typedef enum
+                // {
+                //     kPreloadStatusCompleted = 0,
+                //     kPreloadStatusFailed = 1,
+                // } PreloadStatusCode;
+                // ```
+                // The above code will be parsed as an enum node with an empty name. Next,
+                // we need to fill the name of the type_alias_t to the previous node.
 
-                            isNeedFillPreNodeName = enumz.name.empty();
-                            if (enumz.name.empty())
-                            {
-                                enumz.name = cpp_type_alias.name();
-                                std::cout << "[type_alias_t] enum name: " << enumz.name << std::endl;
-                            }
-                        }
-                        else if (std::holds_alternative<Clazz>(last_node))
-                        {
-                            auto &clazz = std::get<Clazz>(last_node);
-                            preNodeName = clazz.name;
+                auto &last_node = cxx_file.nodes.back();
 
-                            isNeedFillPreNodeName = clazz.name.empty();
-                            if (clazz.name.empty())
-                            {
-                                clazz.name = cpp_type_alias.name();
-                                std::cout << "[type_alias_t] class name: " << clazz.name << std::endl;
-                            }
-                        }
-                        else if (std::holds_alternative<Struct>(last_node))
-                        {
-                            auto &structt = std::get<Struct>(last_node);
-                            isNeedFillPreNodeName = structt.name.empty();
-                            preNodeName = structt.name;
-                            if (isNeedFillPreNodeName)
-                            {
-                                structt.name = cpp_type_alias.name();
-                                std::cout << "[type_alias_t] struct name: " << structt.name << std::endl;
-                            }
-                        }
+                bool isNeedFillPreNodeName = false;
+                std::string preNodeName = "";
 
-                        // It's the normal type alias, e.g.,
-                        // `typedef void* view_t`
-                        std::string cn = cpp_type_alias.name();
-                        if (!isNeedFillPreNodeName && preNodeName != cn)
-                        {
-                            NodeType node = parse_type_alias(cpp_type_alias, namespaceList, fullScopeList, file_path);
-                            cxx_file.nodes.push_back(node);
-                            std::cout << "[type_alias_t] type name: " << cpp_type_alias.name() << ", under type: " << cppast::to_string(cpp_type_alias.underlying_type())
-                                      << std::endl;
-                        }
+                // need fill the previous node name if name is empty
+                // if the name is same, do nothing
+
+                if (std::holds_alternative<Enumz>(last_node))
+                {
+                    auto &enumz = std::get<Enumz>(last_node);
+                    preNodeName = enumz.name;
 
-                        return true;
+                    isNeedFillPreNodeName = enumz.name.empty();
+                    if (enumz.name.empty())
+                    {
+                        enumz.name = cpp_type_alias.name();
+                        log() << "[type_alias_t] enum name: " << enumz.name << std::endl;
                     }
+                }
+                else if (std::holds_alternative<Clazz>(last_node))
+                {
+                    auto &clazz = std::get<Clazz>(last_node);
+                    preNodeName = clazz.name;
 
-                    if (e.kind() == cppast::cpp_entity_kind::class_t)
+                    isNeedFillPreNodeName = clazz.name.empty();
+                    if (clazz.name.empty())
+                    {
+                        clazz.name = cpp_type_alias.name();
+                        log() << "[type_alias_t] class name: " << clazz.name << std::endl;
+                    }
+                }
+                else if (std::holds_alternative<Struct>(last_node))
+                {
+                    auto &structt = std::get<Struct>(last_node);
+                    isNeedFillPreNodeName = structt.name.empty();
+                    preNodeName = structt.name;
+                    if (isNeedFillPreNodeName)
                     {
-                        auto &cpp_class = static_cast<const cppast::cpp_class &>(e);
+                        structt.name = cpp_type_alias.name();
+                        log() << "[type_alias_t] struct name: " << structt.name << std::endl;
+                    }
+                }
 
-                        // Handle the pre-define class, e.g, class IRtcEngineEventHandlerEx;
-                        if (cpp_class.begin() == cpp_class.end())
-                        {
-                            return true;
-                        }
+                // It's the normal type alias, e.g.,
+                // `typedef void* view_t`
+                std::string cn = cpp_type_alias.name();
+                if (!isNeedFillPreNodeName && preNodeName != cn)
+                {
+                    NodeType node = parser.parse_type_alias(cpp_type_alias, namespaceList, fullScopeList, file_path);
+                    cxx_file.nodes.push_back(node);
+                    log() << "[type_alias_t] type name: " << cpp_type_alias.name() << ", under type: " << cppast::to_string(cpp_type_alias.underlying_type())
+                              << std::endl;
+                }
 
-                        if (!info.is_old_entity())
-                        {
-                            NodeType node = parse_class(cpp_class, namespaceList, fullScopeList, file_path);
-                            cxx_file.nodes.push_back(node);
-                        }
+                return true;
+            }
 
-                        if (info.event == cppast::visitor_info::container_entity_enter)
-                        {
+            bool Handle(const cppast::cpp_class &cpp_class, const cppast::visitor_info &info)
+            {
+                // Handle the pre-define class, e.g, class IRtcEngineEventHandlerEx;
+                if (cpp_class.begin() == cpp_class.end())
+                {
+                    return true;
+                }
 
-                            std::cout << "full scope kind: '" << " (" << cppast::to_string(e.kind()) << ")\n";
+                if (!info.is_old_entity())
+                {
+                    NodeType node = parser.parse_class(cpp_class, namespaceList, fullScopeList, file_path);
+                    cxx_file.nodes.push_back(node);
+                }
 
-                            fullScopeList.push_back(std::string(e.name()));
-                            // namespaceList.push_back(std::string(e.name()));
-                        }
-                        else if (info.event == cppast::visitor_info::container_entity_exit)
-                        {
+                if (info.event == cppast::visitor_info::container_entity_enter)
+                {
 
-                            fullScopeList.pop_back();
-                            // namespaceList.pop_back();
-                        }
-                        std::cout << "full scope: '" << terra::JoinToString(fullScopeList, "::") << " end \n";
+                    log() << "full scope kind: '" << " (" << cppast::to_string(cpp_class.kind()) << ")\n";
 
-                        // return true;
-                    }
-                    else if (e.kind() == cppast::cpp_entity_kind::enum_t && !info.is_old_entity())
-                    {
-                        auto &cpp_enum = static_cast<const cppast::cpp_enum &>(e);
-                        Enumz enumz; // = new Enumz();
-                        parse_enum(enumz, namespaceList, fullScopeList, file_path, cpp_enum);
+                    fullScopeList.push_back(std::string(cpp_class.name()));
+                    // namespaceList.push_back(std::string(e.name()));
+                }
+                else if (info.event == cppast::visitor_info::container_entity_exit)
+                {
 
-                        cxx_file.nodes.push_back(enumz);
+                    fullScopeList.pop_back();
+                    // namespaceList.pop_back();
+                }
+                log() << "full scope: '" << terra::JoinToString(fullScopeList, "::") << " end \n";
 
-                        return true;
-                    }
-                    else if (e.kind() == cppast::cpp_entity_kind::variable_t && !info.is_old_entity())
-                    {
-                        std::cout << "cppast::cpp_entity_kind::variable_t: " << cppast::to_string(e.kind()) << " name: " << e.name() << std::endl;
-                        auto &cpp_variable = static_cast<const cppast::cpp_variable &>(e);
-                        Variable top_level_variable;
-                        parse_parameter(top_level_variable, namespaceList, fullScopeList, file_path, cpp_variable);
+                return true;
+            }
 
-                        cxx_file.nodes.push_back(top_level_variable);
-                        return true;
-                    }
-                    else if (e.kind() == cppast::cpp_entity_kind::unexposed_t && !info.is_old_entity())
-                    {
-                        std::cout << "cppast::cpp_entity_kind::unexposed_t: " << e.name() << std::endl;
-                    }
-                    else
-                    {
-                    }
-                    return true;
-                });
+            bool Handle(const cppast::cpp_enum &cpp_enum, const cppast::visitor_info &info)
+            {
+                if (!info.is_old_entity())
+                {
+                    Enumz enumz; // = new Enumz();
+                    parser.parse_enum(enumz, namespaceList, fullScopeList, file_path, cpp_enum);
+
+                    cxx_file.nodes.push_back(enumz);
+                }
+                return true;
+            }
+
+            bool Handle(const cppast::cpp_variable &cpp_variable, const cppast::visitor_info &info)
+            {
+                log() << "cppast::cpp_entity_kind::variable_t: " << cppast::to_string(cpp_variable.kind()) << " name: " << cpp_variable.name() << std::endl;
+                Variable top_level_variable;
+                parser.parse_parameter(top_level_variable, namespaceList, fullScopeList, file_path, cpp_variable);
+
+                cxx_file.nodes.push_back(top_level_variable);
+                return true;
+            }
+
+            bool Handle(const cppast::cpp_unexposed_entity &e, const cppast::visitor_info &info)
+            {
+                log() << "cppast::cpp_entity_kind::unexposed_t: " << e.name() << std::endl;
+                return true;
+            }
+        };
+
+        // The classes and enums in the namespaces of `container`, the type aliases are left to the traversal of the file,
+        // as the name of a typedef'd enum or class is filled into the node before them
+        template <typename Container>
+        static void collect_conversion_units(const Container &container,
+                                             std::vector<std::string> &namespaces,
+                                             std::vector<ConversionUnit> &units)
+        {
+            for (auto &child : container)
+            {
+                switch (child.kind())
+                {
+                case cppast::cpp_entity_kind::namespace_t:
+                    namespaces.push_back(child.name());
+                    collect_conversion_units(static_cast<const cppast::cpp_namespace &>(child), namespaces, units);
+                    namespaces.pop_back();
+                    break;
+                case cppast::cpp_entity_kind::class_t:
+                case cppast::cpp_entity_kind::enum_t:
+                case cppast::cpp_entity_kind::class_template_t:
+                case cppast::cpp_entity_kind::class_template_specialization_t:
+                    units.emplace_back();
+                    units.back().entity = &child;
+                    units.back().namespaces = namespaces;
+                    break;
+                default:
+                    break;
+                }
+            }
+        }
+
+        // prints the AST of a file
+        void print_ast(std::ostream &out, const cppast::cpp_file &file)
+        {
+            // print file name
+            std::cout << "AST for '" << file.name() << "':\n";
+
+            auto file_path = std::string(file.name());
+            CXXFile cxx_file{file_path};
+
+            // recursively visit file and the children that can hold converted entities
+            if (pass_manager_ != nullptr)
+            {
+                cppast::static_visit(file, AstVisitor<true>{*this, file_path, cxx_file});
+            }
+            else if (conversion_jobs_ != 1)
+            {
+                // The cppast tree is not modified anymore, so its top-level classes and enums are converted concurrently,
+                // each with its own scopes and logs. Their nodes and logs are then appended in source order
+                // by a traversal of the rest of the file.
+                std::vector<ConversionUnit> units;
+                std::vector<std::string> namespaces;
+                collect_conversion_units(file, namespaces, units);
+
+                ParallelFor(units.size(), conversion_jobs_, [&](size_t i)
+                            {
+                                ConversionUnit &unit = units[i];
+                                LogScope log_scope(unit.log);
+                                CXXFile unit_file{file_path};
+                                cppast::static_visit(*unit.entity,
+                                                     AstVisitor<false>{*this, file_path, unit_file, unit.namespaces, unit.namespaces});
+                                unit.nodes = std::move(unit_file.nodes); });
+
+                std::unordered_map<const cppast::cpp_entity *, ConversionUnit *> converted_units;
+                for (auto &unit : units)
+                {
+                    converted_units.emplace(unit.entity, &unit);
+                }
+                cppast::static_visit(file, AstVisitor<false>{*this, file_path, cxx_file, {}, {}, &converted_units});
+            }
+            else
+            {
+                cppast::static_visit(file, AstVisitor<false>{*this, file_path, cxx_file});
+            }
 
             std::cout << "AST for '" << file.name() << " end \n";
             parse_result_.cxx_files.push_back(cxx_file);
         }
 
     public:
+        /// The passes whose `OnEntity` is called during the traversal of every parsed file.
+        void SetPassManager(PassManager *pass_manager)
+        {
+            pass_manager_ = pass_manager;
+        }
+
+        /// Converts a file parsed by the caller and appends it to `GetParseResult()`, the same as `Parse` does
+        /// for every parsed file, e.g., to measure the conversion without the parse.
+        void ConvertFile(const cppast::cpp_file &file, size_t conversion_jobs = 1)
+        {
+            conversion_jobs_ = conversion_jobs;
+            print_ast(std::cout, file);
+        }
+
+        /// The files converted so far.
+        const ParseResult &GetParseResult() const
+        {
+            return parse_result_;
+        }
+
         bool Parse(const ParseConfig &parse_config, ParseResult &parse_result) override
         {
             // auto include_header_dirs = chain.get()->parse_config.get()->include_header_dirs;
             // auto parse_files = chain.get()->parse_config.get()->parse_files;
-            auto include_header_dirs = parse_config.include_header_dirs;
+            auto include_header_dirs = parse_config.header_file_system != nullptr
+                                           ? parse_config.header_file_system->IncludeDirs()
+                                           : parse_config.include_header_dirs;
             auto parse_files = parse_config.parse_files;
             auto defines = parse_config.defines;
+            conversion_jobs_ = parse_config.conversion_jobs;
             // the compile config stores compilation flags
             cppast::libclang_compile_config config;
             //        config.add_include_dir("/Users/fenglang/codes/aw/Agora-Flutter/integration_test_app/iris_integration_test/third_party/agora/rtc/include");
@@ -853,6 +1086,8 @@ namespace terra
 
             // config.write_preprocessed(true);
             // config.fast_preprocessing(true);
+            config.intern_types(parse_config.intern_types);
+            config.single_file_parse(parse_config.shallow);
             for (auto &it : defines)
             {
                 config.define_macro(it.first, it.second);
@@ -870,7 +1105,8 @@ namespace terra
 
             for (auto &file : parse_files)
             {
-                auto parsed_file = parse_file(config, logger, file, false);
+                MemoryAccounting::Scope memory_scope("header", file);
+                auto parsed_file = parse_file(file_config(config, parse_config, file), logger, file, false);
 
                 print_ast(std::cout, *parsed_file);
             }
@@ -879,7 +1115,10 @@ namespace terra
 
             // std::unique_ptr<ParseResult> result = chain.get()->Process(std::move(chain.get()->parse_config), std::unique_ptr<ParseResult>{&parse_result_});
 
-            parse_result.cxx_files = std::vector<CXXFile>(parse_result_.cxx_files);
+            {
+                MemoryAccounting::Scope memory_scope("phase", "copy_parse_result");
+                parse_result.cxx_files = std::vector<CXXFile>(parse_result_.cxx_files);
+            }
 
             return false;
         }
@@ -893,6 +1132,8 @@ namespace terra
     private:
         std::vector<std::unique_ptr<Parser>> parsers_;
         RootParser root_parser_;
+        PassManager pass_manager_;
+        std::unique_ptr<ProcessPoolParser> process_pool_parser_;
 
     public:
         DefaultVisitor() {}
@@ -902,9 +1143,49 @@ namespace terra
             parsers_.push_back(std::move(parser));
         }
 
+        /// Unlike the `Parser`s, a `Pass` does not need to re-parse the headers, see `Pass`.
+        void AddPass(std::unique_ptr<Pass> pass)
+        {
+            pass_manager_.AddPass(std::move(pass));
+        }
+
+        /// Parse the headers in `worker_count` forked worker processes instead of in this one, see `ProcessPoolParser`.
+        /// It is not used if there are entity passes, they need the cppast entities of this process.
+        void SetWorkerProcesses(size_t worker_count, int max_retries = 1,
+                                std::chrono::milliseconds shard_timeout = std::chrono::milliseconds(0))
+        {
+            process_pool_parser_ = std::make_unique<ProcessPoolParser>(
+                []()
+                { return std::make_unique<RootParser>(); },
+                worker_count, max_retries, shard_timeout);
+        }
+
         void Visit(const ParseConfig &parse_config)
         {
-            root_parser_.Parse(parse_config, parse_result_);
+            // A shallow parse does not read the included headers
+            if (parse_config.in_memory_headers && !parse_config.shallow && parse_config.header_file_system == nullptr)
+            {
+                ParseConfig in_memory_config(parse_config);
+                {
+                    MemoryAccounting::Scope memory_scope("phase", "load_headers");
+                    in_memory_config.header_file_system = std::make_shared<HeaderFileSystem>(
+                        parse_config.include_header_dirs, parse_config.parse_files);
+                }
+                Visit(in_memory_config);
+                return;
+            }
+
+            if (process_pool_parser_ != nullptr && !pass_manager_.HasEntityPasses())
+            {
+                process_pool_parser_->Parse(parse_config, parse_result_);
+            }
+            else
+            {
+                root_parser_.SetPassManager(pass_manager_.HasEntityPasses() ? &pass_manager_ : nullptr);
+                root_parser_.Parse(parse_config, parse_result_);
+            }
+
+            pass_manager_.RunPostPasses(parse_result_);
 
             for (auto &parser : parsers_)
             {
@@ -928,88 +1209,141 @@ namespace terra
 
         bool Generate(const ParseResult &parse_result) override
         {
+            std::string jsonPath = this->save_path_;
+            std::ofstream osWrite(jsonPath, std::ofstream::trunc);
+            osWrite << ToJsonString(parse_result);
+            osWrite.flush();
+            osWrite.close();
 
-            auto cxx_files = parse_result.cxx_files;
-            nlohmann::json cxx_files_json;
+            std::cout << "Dump C++ header files json to " << jsonPath.c_str() << std::endl;
+            return true;
+        }
+
+        bool Generate(const FlatParseResult &flat_parse_result) override
+        {
+            std::string jsonPath = this->save_path_;
+            std::ofstream osWrite(jsonPath, std::ofstream::trunc);
+            osWrite << ToJsonString(flat_parse_result);
+            osWrite.flush();
+            osWrite.close();
+
+            std::cout << "Dump C++ header files json to " << jsonPath.c_str() << std::endl;
+            return true;
+        }
+
+        /// The json text written by `Generate`, same as `ToJson(parse_result).dump()` but without building the json tree.
+        std::string ToJsonString(const ParseResult &parse_result)
+        {
+            JsonWriter writer;
+            WriteCXXFilesJson(writer, parse_result.cxx_files);
+            return std::move(writer.buffer);
+        }
+
+        /// The same json text as for the `ParseResult` of `flat_parse_result`, the files are materialized one at a time.
+        std::string ToJsonString(const FlatParseResult &flat_parse_result)
+        {
+            JsonWriter writer;
+            if (flat_parse_result.cxx_files.empty())
+            {
+                writer.Null();
+                return std::move(writer.buffer);
+            }
 
-            for (auto cxx_file : cxx_files)
+            writer.Raw('[');
+            bool is_first = true;
+            for (auto &cxx_file : flat_parse_result.Files())
             {
-                auto file_path = cxx_file.file_path;
-                std::string::size_type iPos = file_path.find_last_of('/') + 1;
-                std::string filename = file_path.substr(iPos, file_path.length() - iPos);
+                if (!is_first)
+                {
+                    writer.Raw(',');
+                }
+                is_first = false;
+                WriteCXXFileJson(writer, cxx_file);
+            }
+            writer.Raw(']');
+            return std::move(writer.buffer);
+        }
+
+        /// The json array of `CXXFile`s, as written by `Generate`
+        nlohmann::json ToJson(const ParseResult &parse_result)
+        {
+            nlohmann::json cxx_files_json;
 
+            for (auto &cxx_file : parse_result.cxx_files)
+            {
                 nlohmann::json fileJson;
-                fileJson["file_path"] = cxx_file.file_path;
-                fileJson["__TYPE"] = __TYPE_CXXFile;
+                CXXFile2Json(cxx_file, fileJson);
 
-                nlohmann::json nodesJson;
+                cxx_files_json.push_back(fileJson);
+            }
 
-                for (auto node : cxx_file.nodes)
-                {
-                    // 过滤掉空的 Clazz 对象（通常是由 union_t 生成的）
-                    if (std::holds_alternative<Clazz>(node))
-                    {
-                        auto &ele = std::get<Clazz>(node);
-                        // 如果是空的 Clazz 对象（名称为空），则跳过
-                        if (ele.name.empty())
-                        {
-                            std::cout << "[DefaultJsonGenerator] Filtering out empty Clazz node" << std::endl;
-                            continue;
-                        }
-                    }
+            return cxx_files_json;
+        }
 
-                    nlohmann::json eleJson;
+    protected:
+        /// Serialize a single `CXXFile`, returns the number of nodes written to `json["nodes"]`.
+        size_t CXXFile2Json(const CXXFile &cxx_file, nlohmann::json &fileJson)
+        {
+            fileJson["file_path"] = cxx_file.file_path;
+            fileJson["__TYPE"] = __TYPE_CXXFile;
 
-                    if (std::holds_alternative<IncludeDirective>(node))
-                    {
-                        auto &ele = std::get<IncludeDirective>(node);
-                        IncludeDirective2Json(&ele, eleJson);
-                    }
-                    if (std::holds_alternative<TypeAlias>(node))
-                    {
-                        auto &ele = std::get<TypeAlias>(node);
-                        TypeAlias2Json(&ele, eleJson);
-                    }
-                    if (std::holds_alternative<Clazz>(node))
-                    {
-                        auto &ele = std::get<Clazz>(node);
-                        Clazz2Json(&ele, eleJson);
-                    }
-                    if (std::holds_alternative<Struct>(node))
-                    {
-                        auto &ele = std::get<Struct>(node);
-                        Struct2Json(&ele, eleJson);
-                    }
-                    if (std::holds_alternative<Enumz>(node))
-                    {
-                        auto &ele = std::get<Enumz>(node);
-                        Enumz2Json(&ele, eleJson);
-                    }
-                    if (std::holds_alternative<Variable>(node))
+            nlohmann::json nodesJson;
+
+            for (auto &node : cxx_file.nodes)
+            {
+                // 过滤掉空的 Clazz 对象（通常是由 union_t 生成的）
+                if (std::holds_alternative<Clazz>(node))
+                {
+                    auto &ele = std::get<Clazz>(node);
+                    // 如果是空的 Clazz 对象（名称为空），则跳过
+                    if (ele.name.empty())
                     {
-                        auto &ele = std::get<Variable>(node);
-                        Variable2Json(&ele, eleJson);
+                        std::cout << "[DefaultJsonGenerator] Filtering out empty Clazz node" << std::endl;
+                        continue;
                     }
-
-                    nodesJson.push_back(eleJson);
                 }
 
-                fileJson["nodes"] = nodesJson;
+                nlohmann::json eleJson;
 
-                cxx_files_json.push_back(fileJson);
-            }
+                if (std::holds_alternative<IncludeDirective>(node))
+                {
+                    auto &ele = std::get<IncludeDirective>(node);
+                    IncludeDirective2Json(&ele, eleJson);
+                }
+                if (std::holds_alternative<TypeAlias>(node))
+                {
+                    auto &ele = std::get<TypeAlias>(node);
+                    TypeAlias2Json(&ele, eleJson);
+                }
+                if (std::holds_alternative<Clazz>(node))
+                {
+                    auto &ele = std::get<Clazz>(node);
+                    Clazz2Json(&ele, eleJson);
+                }
+                if (std::holds_alternative<Struct>(node))
+                {
+                    auto &ele = std::get<Struct>(node);
+                    Struct2Json(&ele, eleJson);
+                }
+                if (std::holds_alternative<Enumz>(node))
+                {
+                    auto &ele = std::get<Enumz>(node);
+                    Enumz2Json(&ele, eleJson);
+                }
+                if (std::holds_alternative<Variable>(node))
+                {
+                    auto &ele = std::get<Variable>(node);
+                    Variable2Json(&ele, eleJson);
+                }
 
-            std::string jsonPath = this->save_path_;
-            std::ofstream osWrite(jsonPath, std::ofstream::trunc);
-            osWrite << cxx_files_json.dump();
-            osWrite.flush();
-            osWrite.close();
+                nodesJson.push_back(eleJson);
+            }
 
-            std::cout << "Dump C++ header files json to " << jsonPath.c_str() << std::endl;
-            return true;
+            size_t node_count = nodesJson.size();
+            fileJson["nodes"] = nodesJson;
+            return node_count;
         }
 
-    private:
         const std::string __TYPE_CXXFile = "CXXFile";
         const std::string __TYPE_IncludeDirective = "IncludeDirective";
         const std::string __TYPE_TypeAlias = "TypeAlias";
@@ -1023,7 +1357,7 @@ namespace terra
         const std::string __TYPE_EnumConstant = "EnumConstant";
         const std::string __TYPE_Enumz = "Enumz";
 
-        void BaseNode2Json(BaseNode *node, nlohmann::json &json)
+        void BaseNode2Json(const BaseNode *node, nlohmann::json &json)
         {
 
             json["name"] = node->name;
@@ -1063,16 +1397,20 @@ namespace terra
             json["comment"] = node->comment;
             json["source"] = node->source;
             json["conditional_compilation_directives_infos"] = node->conditional_compilation_directives_infos;
+            if (!node->fingerprint.empty())
+            {
+                json["fingerprint"] = node->fingerprint;
+            }
         }
 
-        void IncludeDirective2Json(IncludeDirective *node, nlohmann::json &json)
+        void IncludeDirective2Json(const IncludeDirective *node, nlohmann::json &json)
         {
             BaseNode2Json(node, json);
             json["__TYPE"] = __TYPE_IncludeDirective;
             json["include_file_path"] = node->include_file_path;
         }
 
-        void TypeAlias2Json(TypeAlias *node, nlohmann::json &json)
+        void TypeAlias2Json(const TypeAlias *node, nlohmann::json &json)
         {
             BaseNode2Json(node, json);
             json["__TYPE"] = __TYPE_TypeAlias;
@@ -1081,7 +1419,7 @@ namespace terra
             json["underlyingType"] = typeJson;
         }
 
-        void Constructor2Json(Constructor *node, nlohmann::json &json)
+        void Constructor2Json(const Constructor *node, nlohmann::json &json)
         {
             BaseNode2Json(node, json);
             json["__TYPE"] = __TYPE_Constructor;
@@ -1104,7 +1442,7 @@ namespace terra
             }
         }
 
-        void Clazz2Json(Clazz *node, nlohmann::json &json)
+        void Clazz2Json(const Clazz *node, nlohmann::json &json)
         {
 
             json["__TYPE"] = __TYPE_Clazz;
@@ -1171,15 +1509,43 @@ namespace terra
                 }
                 json["base_clazzs"] = base_clazzsJson;
             }
+
+            if (node->all_base_clazzs.size() <= 0)
+            {
+                json["all_base_clazzs"] = nlohmann::json::parse("[]");
+            }
+            else
+            {
+                nlohmann::json all_base_clazzsJson;
+                for (auto &base_clazz : node->all_base_clazzs)
+                {
+                    all_base_clazzsJson.push_back(base_clazz);
+                }
+                json["all_base_clazzs"] = all_base_clazzsJson;
+            }
+
+            if (node->virtual_methods.size() <= 0)
+            {
+                json["virtual_methods"] = nlohmann::json::parse("[]");
+            }
+            else
+            {
+                nlohmann::json virtual_methodsJson;
+                for (auto &virtual_method : node->virtual_methods)
+                {
+                    virtual_methodsJson.push_back(virtual_method);
+                }
+                json["virtual_methods"] = virtual_methodsJson;
+            }
         }
 
-        void Struct2Json(Struct *node, nlohmann::json &json)
+        void Struct2Json(const Struct *node, nlohmann::json &json)
         {
             Clazz2Json(node, json);
             json["__TYPE"] = __TYPE_Struct;
         }
 
-        void Enumz2Json(Enumz *node, nlohmann::json &json)
+        void Enumz2Json(const Enumz *node, nlohmann::json &json)
         {
             BaseNode2Json(node, json);
             json["__TYPE"] = __TYPE_Enumz;
@@ -1201,7 +1567,7 @@ namespace terra
             }
         }
 
-        void MemberFunction2Json(MemberFunction *node, nlohmann::json &json)
+        void MemberFunction2Json(const MemberFunction *node, nlohmann::json &json)
         {
 
             BaseNode2Json(node, json);
@@ -1235,9 +1601,11 @@ namespace terra
             json["is_const"] = node->is_const;
             json["signature"] = node->signature;
             json["is_variadic"] = node->is_variadic;
+            json["id"] = node->id;
+            json["overridden_method"] = node->overridden_method;
         }
 
-        void Variable2Json(Variable *node, nlohmann::json &json)
+        void Variable2Json(const Variable *node, nlohmann::json &json)
         {
             BaseNode2Json(node, json);
             json["__TYPE"] = __TYPE_Variable;
@@ -1248,10 +1616,11 @@ namespace terra
             json["type"] = typeJson;
 
             json["default_value"] = node->default_value;
+            json["evaluated_value"] = OptionalInt2Json(node->evaluated_value);
             json["is_output"] = node->is_output;
         }
 
-        void SimpleType2Json(SimpleType *node, nlohmann::json &json)
+        void SimpleType2Json(const SimpleType *node, nlohmann::json &json)
         {
             json["__TYPE"] = __TYPE_SimpleType;
             json["name"] = node->name;
@@ -1259,10 +1628,15 @@ namespace terra
             json["kind"] = (int)node->kind;
             json["is_const"] = node->is_const;
             json["is_builtin_type"] = node->is_builtin_type;
+            // Only for the unresolved types, so that the dumps of a full parse stay the same
+            if (node->is_unresolved)
+            {
+                json["is_unresolved"] = true;
+            }
             json["template_arguments"] = node->template_arguments;
         }
 
-        void MemberVariable2Json(MemberVariable *node, nlohmann::json &json)
+        void MemberVariable2Json(const MemberVariable *node, nlohmann::json &json)
         {
             BaseNode2Json(node, json);
             json["__TYPE"] = __TYPE_MemberVariable;
@@ -1277,15 +1651,164 @@ namespace terra
             json["access_specifier"] = node->access_specifier;
         }
 
-        void EnumConstant2Json(EnumConstant *node, nlohmann::json &json)
+        void EnumConstant2Json(const EnumConstant *node, nlohmann::json &json)
         {
             BaseNode2Json(node, json);
             json["__TYPE"] = __TYPE_EnumConstant;
             json["name"] = node->name;
             json["value"] = node->value;
+            json["evaluated_value"] = OptionalInt2Json(node->evaluated_value);
             json["source"] = node->source;
             json["comment"] = node->comment;
         }
+
+        nlohmann::json OptionalInt2Json(const std::optional<int64_t> &value)
+        {
+            return value.has_value() ? nlohmann::json(value.value()) : nlohmann::json(nullptr);
+        }
+    };
+
+    /// Writes one json shard per `CXXFile` into `output_dir`, each shard is serialized on its own worker.
+    /// A `manifest.json` lists the shards in parse order, so consumers can load only the headers they need, e.g.,
+    /// ```
+    /// {"shards":[{"file_path":"/path/to/AgoraBase.h","hash":"...","node_count":42,"shard":"AgoraBase.h.json"}],"version":1}
+    /// ```
+    /// The manifest is only there when all the shards of the run are written.
+    class ShardedJsonGenerator : public DefaultJsonGenerator
+    {
+    private:
+        std::string output_dir_;
+        size_t concurrency_;
+
+        struct ShardInfo
+        {
+            std::string shard_name;
+            std::string hash;
+            size_t node_count = 0;
+            bool is_written = false;
+        };
+
+    public:
+        static constexpr const char *kManifestFileName = "manifest.json";
+
+        /// `concurrency == 0` means one worker per hardware thread.
+        ShardedJsonGenerator(std::string output_dir, size_t concurrency = 0)
+            : DefaultJsonGenerator(output_dir), output_dir_(output_dir), concurrency_(concurrency) {}
+
+    private:
+        /// `file_path(i)` is the path of the i-th `CXXFile`, `write_file(writer, i)` writes it and returns its node count.
+        template <typename FilePath, typename WriteFile>
+        bool GenerateShards(size_t file_count, FilePath file_path, WriteFile write_file)
+        {
+            std::filesystem::path out_dir(output_dir_);
+            std::filesystem::create_directories(out_dir);
+
+            std::vector<ShardInfo> shards(file_count);
+
+            // Assign the shard names up front so they do not depend on the worker scheduling,
+            // headers with the same file name in different directories get an index suffix,
+            // and so does a header whose shard would overwrite the manifest.
+            std::set<std::string> used_names{kManifestFileName};
+            for (size_t i = 0; i < file_count; i++)
+            {
+                std::string file_name = std::filesystem::path(file_path(i)).filename().string();
+                std::string shard_name = file_name + ".json";
+                for (size_t suffix = i; !used_names.insert(shard_name).second; suffix += file_count)
+                {
+                    shard_name = file_name + "_" + std::to_string(suffix) + ".json";
+                }
+                shards[i].shard_name = shard_name;
+            }
+
+            // The shards are written over the previous run's, so its manifest must not outlive a failed run
+            std::filesystem::path manifest_path = out_dir / kManifestFileName;
+            std::error_code ec;
+            std::filesystem::remove(manifest_path, ec);
+
+            ParallelFor(file_count, concurrency_, [&](size_t i)
+                        {
+                            JsonWriter writer;
+                            shards[i].node_count = write_file(writer, i);
+
+                            const std::string &content = writer.buffer;
+                            shards[i].hash = HashContent(content);
+
+                            std::ofstream osWrite(out_dir / shards[i].shard_name, std::ofstream::trunc | std::ofstream::binary);
+                            osWrite << content;
+                            osWrite.close();
+                            shards[i].is_written = !osWrite.fail(); });
+
+            bool is_written = true;
+            for (auto &shard : shards)
+            {
+                if (!shard.is_written)
+                {
+                    std::cerr << "Failed to write the json shard " << (out_dir / shard.shard_name).string() << std::endl;
+                    is_written = false;
+                }
+            }
+            if (!is_written)
+            {
+                // No manifest, so that a partial output is not taken for a complete one
+                return false;
+            }
+
+            nlohmann::json shardsJson = nlohmann::json::array();
+            for (size_t i = 0; i < file_count; i++)
+            {
+                nlohmann::json shardJson;
+                shardJson["file_path"] = file_path(i);
+                shardJson["shard"] = shards[i].shard_name;
+                shardJson["hash"] = shards[i].hash;
+                shardJson["node_count"] = shards[i].node_count;
+                shardsJson.push_back(shardJson);
+            }
+
+            nlohmann::json manifestJson;
+            manifestJson["version"] = 1;
+            manifestJson["shards"] = shardsJson;
+
+            // Written aside and renamed into place, so a manifest is either complete or missing
+            std::filesystem::path temp_manifest_path = out_dir / (std::string(kManifestFileName) + ".tmp");
+            std::ofstream osWrite(temp_manifest_path, std::ofstream::trunc);
+            osWrite << manifestJson.dump();
+            osWrite.close();
+            if (!osWrite.fail())
+            {
+                std::filesystem::rename(temp_manifest_path, manifest_path, ec);
+            }
+            if (osWrite.fail() || ec)
+            {
+                std::cerr << "Failed to write the manifest " << manifest_path.string() << std::endl;
+                std::filesystem::remove(temp_manifest_path, ec);
+                return false;
+            }
+
+            std::cout << "Dump " << file_count << " C++ header json shards to " << output_dir_ << std::endl;
+            return true;
+        }
+
+    public:
+        bool Generate(const ParseResult &parse_result) override
+        {
+            auto &cxx_files = parse_result.cxx_files;
+            return GenerateShards(
+                cxx_files.size(),
+                [&](size_t i)
+                { return cxx_files[i].file_path; },
+                [&](JsonWriter &writer, size_t i)
+                { return WriteCXXFileJson(writer, cxx_files[i]); });
+        }
+
+        bool Generate(const FlatParseResult &flat_parse_result) override
+        {
+            return GenerateShards(
+                flat_parse_result.cxx_files.size(),
+                [&](size_t i)
+                { return std::string(flat_parse_result.Str(flat_parse_result.cxx_files[i].file_path)); },
+                [&](JsonWriter &writer, size_t i)
+                { return WriteCXXFileJson(writer, flat_parse_result.MaterializeFile(i)); });
+        }
     };
 
     class DefaultGenerator : public Generator
@@ -1293,6 +1816,8 @@ namespace terra
     private:
         std::string output_dir_;
         std::unique_ptr<SyntaxRender> syntax_render_;
+        size_t concurrency_;
+        std::string render_stamps_path_;
 
     public:
         // void SetSyntaxRender(std::unique_ptr<SyntaxRender> syntax_render)
@@ -1300,19 +1825,66 @@ namespace terra
         //     syntax_render_ = std::move(syntax_render);
         // }
 
-        DefaultGenerator(std::string output_dir, std::unique_ptr<SyntaxRender> syntax_render) : output_dir_(output_dir), syntax_render_(std::move(syntax_render)) {}
+        /// Files are rendered concurrently on up to `concurrency` workers (`0` means one per hardware thread)
+        /// if the `syntax_render` supports it, see `SyntaxRender::IsConcurrentRenderSupported`.
+        ///
+        /// The hashes of the rendered files are kept in `render_stamps_path` to skip the unchanged files in the next run,
+        /// e.g., a file in the build dir. Keep it out of the `output_dir`, whose files are usually committed or packaged.
+        /// No stamps are kept if it is empty.
+        DefaultGenerator(std::string output_dir, std::unique_ptr<SyntaxRender> syntax_render, size_t concurrency = 0,
+                         std::string render_stamps_path = "")
+            : output_dir_(output_dir), syntax_render_(std::move(syntax_render)), concurrency_(concurrency),
+              render_stamps_path_(render_stamps_path) {}
 
         bool Generate(const ParseResult &parse_result) override
         {
-            syntax_render_.get()->SetParseResult(parse_result);
-            syntax_render_.get()->OnRenderFilesStart(parse_result, output_dir_);
+            AstIndex ast_index(parse_result);
+            SyntaxRender *syntax_render = syntax_render_.get();
+            syntax_render->SetParseResult(parse_result);
+            syntax_render->SetAstIndex(&ast_index);
+            syntax_render->LoadRenderStamps(render_stamps_path_);
+            syntax_render->OnRenderFilesStart(parse_result, output_dir_);
+
+            size_t concurrency = syntax_render->IsConcurrentRenderSupported() ? concurrency_ : 1;
+            ParallelFor(parse_result.cxx_files.size(), concurrency, [&](size_t i)
+                        { syntax_render->Render(parse_result, parse_result.cxx_files[i], output_dir_); });
+
+            syntax_render->OnRenderFilesEnd(parse_result, output_dir_);
+            syntax_render->FlushChangedFiles(output_dir_, render_stamps_path_);
+            syntax_render->SetAstIndex(nullptr);
+            syntax_render->ResetParseResult();
 
-            for (auto &file : parse_result.cxx_files)
+            return true;
+        }
+
+        /// Renders the files of `flat_parse_result` materialized one at a time if the `syntax_render` supports it,
+        /// see `SyntaxRender::SupportsFlatRender`, or converts it back to a `ParseResult` first otherwise.
+        ///
+        /// Only one file is materialized at a time to keep the memory of the flat store, so there is no cross-file
+        /// context in the tree form: the `ParseResult` passed to the hooks and `GetParseResult()` are empty, and there
+        /// is no `GetAstIndex()`. The hooks look the other files up in `GetFlatParseResult()`.
+        bool Generate(const FlatParseResult &flat_parse_result) override
+        {
+            if (!syntax_render_->SupportsFlatRender())
             {
-                syntax_render_.get()->Render(parse_result, file, output_dir_);
+                return Generator::Generate(flat_parse_result);
             }
 
-            syntax_render_.get()->OnRenderFilesEnd(parse_result, output_dir_);
+            ParseResult empty_parse_result;
+            SyntaxRender *syntax_render = syntax_render_.get();
+            syntax_render->SetFlatParseResult(&flat_parse_result);
+            syntax_render->SetParseResult(empty_parse_result);
+            syntax_render->LoadRenderStamps(render_stamps_path_);
+            syntax_render->OnRenderFilesStart(empty_parse_result, output_dir_);
+
+            size_t concurrency = syntax_render->IsConcurrentRenderSupported() ? concurrency_ : 1;
+            ParallelFor(flat_parse_result.cxx_files.size(), concurrency, [&](size_t i)
+                        { syntax_render->Render(empty_parse_result, flat_parse_result.MaterializeFile(i), output_dir_); });
+
+            syntax_render->OnRenderFilesEnd(empty_parse_result, output_dir_);
+            syntax_render->FlushChangedFiles(output_dir_, render_stamps_path_);
+            syntax_render->SetFlatParseResult(nullptr);
+            syntax_render->ResetParseResult();
 
             return true;
         }
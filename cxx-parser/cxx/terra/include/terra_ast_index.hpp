@@ -0,0 +1,438 @@
+#ifndef terra_AST_INDEX_H_
+#define terra_AST_INDEX_H_
+
+#include <algorithm>
+#include <iterator>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <variant>
+#include <vector>
+#include "terra_node.hpp"
+#include "terra_parser.hpp"
+#include "terra_utils.hpp"
+
+namespace terra
+{
+
+    /// \exclude
+    namespace detail
+    {
+        template <typename Variant>
+        struct NodePointerLists;
+
+        /// A `std::vector<const T *>` per `NodeType` alternative
+        template <typename... Ts>
+        struct NodePointerLists<std::variant<Ts...>>
+        {
+            using type = std::tuple<std::vector<const Ts *>...>;
+        };
+    }
+
+    /// Hash indexes over the nodes of a `ParseResult`, built once so that the lookups of a `SyntaxRender` do not
+    /// have to scan all the `cxx_files`.
+    ///
+    /// The full name of a node is its `parent_full_scope_name` (or its `namespaces` if empty) joined with its
+    /// `name` by `::`, e.g., `agora::rtc::IRtcEngine`, `agora::rtc::IRtcEngine::release` for a method, and
+    /// `agora::ERROR_CODE_TYPE::ERR_OK` for an enum constant.
+    ///
+    /// The index keeps pointers into the `ParseResult`, which must outlive it and must not be modified
+    /// after the index is built. All the queries are const, so it can be shared by concurrent renders.
+    class AstIndex
+    {
+    public:
+        /// A method of a class or struct, or a top-level function.
+        typedef struct MethodRef
+        {
+            const MemberFunction *method = nullptr;
+            /// The class or struct of the method, nullptr for a top-level function
+            const Clazz *parent = nullptr;
+            const CXXFile *file = nullptr;
+        } MethodRef;
+
+    private:
+        std::unordered_map<std::string, const CXXFile *> files_;
+        std::unordered_map<std::string, std::vector<const NodeType *>> nodes_by_full_name_;
+        typename detail::NodePointerLists<NodeType>::type nodes_by_kind_;
+        std::unordered_map<const BaseNode *, const CXXFile *> node_files_;
+
+        std::vector<MethodRef> methods_;
+        std::unordered_map<std::string, std::vector<size_t>> methods_by_full_name_;
+        std::unordered_map<std::string, size_t> methods_by_mangled_name_;
+        std::unordered_map<std::string, size_t> methods_by_id_;
+
+        std::unordered_map<std::string, const EnumConstant *> enum_constants_by_full_name_;
+        std::unordered_map<std::string, std::vector<const BaseNode *>> nodes_by_attribute_;
+        std::unordered_map<std::string, std::vector<const Clazz *>> derived_clazzs_;
+
+        static const std::vector<const NodeType *> &EmptyNodes()
+        {
+            static const std::vector<const NodeType *> empty;
+            return empty;
+        }
+
+        static bool IsEmptyClazz(const Clazz &clazz)
+        {
+            return clazz.methods.empty() && clazz.member_variables.empty() && clazz.constructors.empty() &&
+                   clazz.base_clazzs.empty();
+        }
+
+        void AddAttributes(const BaseNode &node)
+        {
+            for (auto &attribute : node.attributes)
+            {
+                nodes_by_attribute_[attribute].push_back(&node);
+            }
+        }
+
+        void AddMethod(const MemberFunction &method, const Clazz *parent, const CXXFile &file)
+        {
+            size_t index = methods_.size();
+            methods_.push_back(MethodRef{&method, parent, &file});
+            methods_by_full_name_[FullName(method)].push_back(index);
+            if (!method.mangled_name.empty())
+            {
+                methods_by_mangled_name_.emplace(method.mangled_name, index);
+            }
+            if (!method.id.empty())
+            {
+                methods_by_id_.emplace(method.id, index);
+            }
+            AddAttributes(method);
+        }
+
+        void AddClazz(const Clazz &clazz, const CXXFile &file)
+        {
+            for (auto &method : clazz.methods)
+            {
+                AddMethod(method, &clazz, file);
+            }
+            for (auto &member_variable : clazz.member_variables)
+            {
+                AddAttributes(member_variable);
+            }
+            for (auto &constructor : clazz.constructors)
+            {
+                AddAttributes(constructor);
+            }
+        }
+
+        // `all_base_clazzs` is only filled by `InheritancePass`, otherwise the direct bases as written are looked up
+        // from the scope of the class, so all the classes must be indexed first
+        void AddDerivedClazz(const Clazz &clazz)
+        {
+            std::unordered_set<std::string> seen;
+            auto add_base = [&](const std::string &base_full_name)
+            {
+                if (seen.insert(base_full_name).second)
+                {
+                    derived_clazzs_[base_full_name].push_back(&clazz);
+                }
+            };
+
+            if (!clazz.all_base_clazzs.empty())
+            {
+                for (auto &base : clazz.all_base_clazzs)
+                {
+                    add_base(base);
+                }
+                return;
+            }
+
+            std::vector<std::string> scope = ScopeOf(clazz);
+            for (auto &base_name : clazz.base_clazzs)
+            {
+                // `ns::Base<int>` is looked up as `ns::Base`, a base that can not be resolved is kept as written
+                std::string name(trim(std::string_view(base_name).substr(0, base_name.find('<'))));
+                const Clazz *base = LookupClazzOrStruct(scope, name);
+                add_base(base != nullptr ? FullName(*base) : base_name);
+            }
+        }
+
+        static std::vector<std::string> ScopeOf(const BaseNode &node)
+        {
+            return node.parent_full_scope_name.empty() ? node.namespaces : Split(node.parent_full_scope_name, "::");
+        }
+
+        template <typename FindFunc>
+        static auto LookupWith(const std::vector<std::string> &scope, const std::string &name, FindFunc find)
+        {
+            if (name.rfind("::", 0) == 0)
+            {
+                return find(name.substr(2));
+            }
+            std::vector<std::string> current(scope);
+            while (true)
+            {
+                current.push_back(name);
+                auto found = find(JoinToString(current, "::"));
+                current.pop_back();
+                if (found != nullptr || current.empty())
+                {
+                    return found;
+                }
+                current.pop_back();
+            }
+        }
+
+        void AddNode(const NodeType &node, const CXXFile &file)
+        {
+            std::visit([&](auto &&ele)
+                       {
+                           using T = std::decay_t<decltype(ele)>;
+                           std::get<std::vector<const T *>>(nodes_by_kind_).push_back(&ele);
+                           node_files_.emplace(&ele, &file);
+                           if constexpr (!std::is_same_v<T, IncludeDirective>)
+                           {
+                               nodes_by_full_name_[FullName(ele)].push_back(&node);
+                           }
+                           AddAttributes(ele);
+
+                           if constexpr (std::is_same_v<T, Clazz> || std::is_same_v<T, Struct>)
+                           {
+                               AddClazz(ele, file);
+                           }
+                           else if constexpr (std::is_same_v<T, MemberFunction>)
+                           {
+                               AddMethod(ele, nullptr, file);
+                           }
+                           else if constexpr (std::is_same_v<T, Enumz>)
+                           {
+                               for (auto &enum_constant : ele.enum_constants)
+                               {
+                                   enum_constants_by_full_name_.emplace(FullName(enum_constant), &enum_constant);
+                                   AddAttributes(enum_constant);
+                               }
+                           } },
+                       node);
+        }
+
+    public:
+        explicit AstIndex(const ParseResult &parse_result)
+        {
+            for (auto &file : parse_result.cxx_files)
+            {
+                files_.emplace(file.file_path, &file);
+                for (auto &node : file.nodes)
+                {
+                    AddNode(node, file);
+                }
+            }
+
+            for (auto &file : parse_result.cxx_files)
+            {
+                for (auto &node : file.nodes)
+                {
+                    if (auto clazz = std::get_if<Clazz>(&node))
+                    {
+                        AddDerivedClazz(*clazz);
+                    }
+                    else if (auto structt = std::get_if<Struct>(&node))
+                    {
+                        AddDerivedClazz(*structt);
+                    }
+                }
+            }
+        }
+
+        /// The full name of a node, see the class comment.
+        static std::string FullName(const BaseNode &node)
+        {
+            std::string scope = node.parent_full_scope_name.empty() ? JoinToString(node.namespaces, "::") : node.parent_full_scope_name;
+            return scope.empty() ? node.name : scope + "::" + node.name;
+        }
+
+        const CXXFile *FindFile(const std::string &file_path) const
+        {
+            auto it = files_.find(file_path);
+            return it == files_.end() ? nullptr : it->second;
+        }
+
+        /// The file of a top-level node of the indexed `ParseResult`, nullptr for the others.
+        const CXXFile *FileOf(const BaseNode &node) const
+        {
+            auto it = node_files_.find(&node);
+            return it == node_files_.end() ? nullptr : it->second;
+        }
+
+        /// All the top-level nodes of kind `T` in file order, e.g., `All<Struct>()`.
+        template <typename T>
+        const std::vector<const T *> &All() const
+        {
+            return std::get<std::vector<const T *>>(nodes_by_kind_);
+        }
+
+        /// The top-level nodes of kind `T` that match `predicate`, e.g.,
+        /// `Where<Enumz>([](const Enumz &e) { return e.enum_constants.size() > 10; })`.
+        template <typename T, typename Predicate>
+        std::vector<const T *> Where(Predicate predicate) const
+        {
+            std::vector<const T *> result;
+            for (const T *node : All<T>())
+            {
+                if (predicate(*node))
+                {
+                    result.push_back(node);
+                }
+            }
+            return result;
+        }
+
+        /// All the top-level nodes with this full name, e.g., the forward declarations and the definition of a class.
+        const std::vector<const NodeType *> &FindAll(const std::string &full_name) const
+        {
+            auto it = nodes_by_full_name_.find(full_name);
+            return it == nodes_by_full_name_.end() ? EmptyNodes() : it->second;
+        }
+
+        /// The top-level node of kind `T` with this full name, a definition is preferred over the forward declarations
+        /// of a class or struct.
+        template <typename T>
+        const T *Find(const std::string &full_name) const
+        {
+            const T *found = nullptr;
+            for (const NodeType *node : FindAll(full_name))
+            {
+                const T *candidate = std::get_if<T>(node);
+                if (candidate == nullptr)
+                {
+                    continue;
+                }
+                if constexpr (std::is_base_of_v<Clazz, T>)
+                {
+                    if (IsEmptyClazz(*candidate))
+                    {
+                        found = found == nullptr ? candidate : found;
+                        continue;
+                    }
+                }
+                return candidate;
+            }
+            return found;
+        }
+
+        /// Looks `name` up like C++ does from inside `scope` (e.g., `{"agora", "rtc"}`): `agora::rtc::<name>`,
+        /// then `agora::<name>`, then `<name>`. A leading `::` only looks in the global scope.
+        template <typename T>
+        const T *Lookup(const std::vector<std::string> &scope, const std::string &name) const
+        {
+            return LookupWith(scope, name, [this](const std::string &full_name)
+                              { return Find<T>(full_name); });
+        }
+
+        /// The class or struct with this full name, see `Find`.
+        const Clazz *FindClazzOrStruct(const std::string &full_name) const
+        {
+            const Clazz *clazz = Find<Clazz>(full_name);
+            const Struct *structt = Find<Struct>(full_name);
+            if (clazz == nullptr || (structt != nullptr && IsEmptyClazz(*clazz)))
+            {
+                return structt;
+            }
+            return clazz;
+        }
+
+        /// Looks the class or struct `name` up from inside `scope`, see `Lookup` and `FindClazzOrStruct`.
+        const Clazz *LookupClazzOrStruct(const std::vector<std::string> &scope, const std::string &name) const
+        {
+            return LookupWith(scope, name, [this](const std::string &full_name)
+                              { return FindClazzOrStruct(full_name); });
+        }
+
+        /// Follows a chain of `TypeAlias`es from `full_name` to the first underlying type that is not an alias,
+        /// returns nullptr if `full_name` is not a type alias. The alias names are looked up from the scope of
+        /// the alias that refers to them.
+        const SimpleType *ResolveTypeAlias(const std::string &full_name) const
+        {
+            const TypeAlias *alias = Find<TypeAlias>(full_name);
+            std::unordered_set<const TypeAlias *> seen;
+            const SimpleType *target = nullptr;
+            while (alias != nullptr && seen.insert(alias).second)
+            {
+                target = &alias->underlyingType;
+                alias = Lookup<TypeAlias>(ScopeOf(*alias), target->name);
+            }
+            return target;
+        }
+
+        /// The classes and structs that derive from the class with this full name, directly or indirectly if
+        /// `InheritancePass` ran, otherwise only directly: their `base_clazzs` are looked up from their scope, and a
+        /// base that can not be resolved is only found under its name as written.
+        const std::vector<const Clazz *> &DerivedFrom(const std::string &base_full_name) const
+        {
+            static const std::vector<const Clazz *> empty;
+            auto it = derived_clazzs_.find(base_full_name);
+            return it == derived_clazzs_.end() ? empty : it->second;
+        }
+
+        const EnumConstant *FindEnumConstant(const std::string &full_name) const
+        {
+            auto it = enum_constants_by_full_name_.find(full_name);
+            return it == enum_constants_by_full_name_.end() ? nullptr : it->second;
+        }
+
+        /// The top-level nodes and the members (methods, member variables, constructors and enum constants)
+        /// that have this attribute.
+        const std::vector<const BaseNode *> &WithAttribute(const std::string &attribute) const
+        {
+            static const std::vector<const BaseNode *> empty;
+            auto it = nodes_by_attribute_.find(attribute);
+            return it == nodes_by_attribute_.end() ? empty : it->second;
+        }
+
+        /// All the methods of the classes and structs, and the top-level functions, in file order.
+        const std::vector<MethodRef> &Methods() const
+        {
+            return methods_;
+        }
+
+        /// The methods that match `predicate`, e.g., the ones with output parameters:
+        /// `MethodsWhere([](const AstIndex::MethodRef &ref) { return AstIndex::HasOutputParameter(*ref.method); })`.
+        template <typename Predicate>
+        std::vector<MethodRef> MethodsWhere(Predicate predicate) const
+        {
+            std::vector<MethodRef> result;
+            std::copy_if(methods_.begin(), methods_.end(), std::back_inserter(result), predicate);
+            return result;
+        }
+
+        /// The overloads of the method with this full name, e.g., `agora::rtc::IRtcEngine::joinChannel`.
+        std::vector<MethodRef> FindMethods(const std::string &full_name) const
+        {
+            std::vector<MethodRef> result;
+            auto it = methods_by_full_name_.find(full_name);
+            if (it != methods_by_full_name_.end())
+            {
+                for (size_t index : it->second)
+                {
+                    result.push_back(methods_[index]);
+                }
+            }
+            return result;
+        }
+
+        const MethodRef *FindMethodByMangledName(const std::string &mangled_name) const
+        {
+            auto it = methods_by_mangled_name_.find(mangled_name);
+            return it == methods_by_mangled_name_.end() ? nullptr : &methods_[it->second];
+        }
+
+        /// The method with this `MemberFunction::id`, e.g., to follow `MemberFunction::overridden_method`.
+        const MethodRef *FindMethodById(const std::string &id) const
+        {
+            auto it = methods_by_id_.find(id);
+            return it == methods_by_id_.end() ? nullptr : &methods_[it->second];
+        }
+
+        static bool HasOutputParameter(const MemberFunction &method)
+        {
+            return std::any_of(method.parameters.begin(), method.parameters.end(),
+                               [](const Variable &parameter)
+                               { return parameter.is_output; });
+        }
+    };
+}
+
+#endif // terra_AST_INDEX_H_
@@ -0,0 +1,484 @@
+#ifndef TERRA_CODEC_H_
+#define TERRA_CODEC_H_
+
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <variant>
+#include <vector>
+#include "terra_node.hpp"
+
+namespace terra
+{
+
+    /// Appends a compact binary encoding to a growing buffer: the integers are LEB128 varints,
+    /// the strings and lists are prefixed with their size.
+    class BinaryWriter
+    {
+    public:
+        std::string buffer;
+
+        void VarUint(uint64_t value)
+        {
+            while (value >= 0x80)
+            {
+                buffer.push_back(static_cast<char>((value & 0x7f) | 0x80));
+                value >>= 7;
+            }
+            buffer.push_back(static_cast<char>(value));
+        }
+
+        void Bool(bool value)
+        {
+            buffer.push_back(value ? 1 : 0);
+        }
+
+        /// Whether there is a value, then the zigzag encoded value, so that small negative values stay short.
+        void OptionalInt(const std::optional<int64_t> &value)
+        {
+            Bool(value.has_value());
+            if (value.has_value())
+            {
+                uint64_t bits = static_cast<uint64_t>(value.value());
+                VarUint((bits << 1) ^ (value.value() < 0 ? ~uint64_t(0) : 0));
+            }
+        }
+
+        void String(const std::string &str)
+        {
+            VarUint(str.size());
+            buffer.append(str);
+        }
+
+        void StringList(const std::vector<std::string> &list)
+        {
+            VarUint(list.size());
+            for (auto &str : list)
+            {
+                String(str);
+            }
+        }
+    };
+
+    /// Reads what `BinaryWriter` wrote, throws `std::runtime_error` if the input is truncated or malformed.
+    class BinaryReader
+    {
+    private:
+        const char *data_;
+        size_t size_;
+        size_t position_ = 0;
+
+        void Require(size_t size)
+        {
+            if (size > size_ - position_)
+            {
+                throw std::runtime_error("The binary encoding is truncated");
+            }
+        }
+
+    public:
+        BinaryReader(const char *data, size_t size) : data_(data), size_(size) {}
+
+        explicit BinaryReader(const std::string &buffer) : BinaryReader(buffer.data(), buffer.size()) {}
+
+        bool AtEnd() const
+        {
+            return position_ == size_;
+        }
+
+        uint64_t VarUint()
+        {
+            uint64_t value = 0;
+            for (int shift = 0; shift < 64; shift += 7)
+            {
+                Require(1);
+                uint8_t byte = static_cast<uint8_t>(data_[position_++]);
+                value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+                if ((byte & 0x80) == 0)
+                {
+                    return value;
+                }
+            }
+            throw std::runtime_error("The binary encoding has an invalid varint");
+        }
+
+        bool Bool()
+        {
+            Require(1);
+            return data_[position_++] != 0;
+        }
+
+        std::optional<int64_t> OptionalInt()
+        {
+            if (!Bool())
+            {
+                return std::nullopt;
+            }
+            uint64_t bits = VarUint();
+            return static_cast<int64_t>((bits >> 1) ^ (~(bits & 1) + 1));
+        }
+
+        std::string String()
+        {
+            uint64_t size = VarUint();
+            Require(size);
+            std::string str(data_ + position_, size);
+            position_ += size;
+            return str;
+        }
+
+        std::vector<std::string> StringList()
+        {
+            uint64_t size = VarUint();
+            // Every element takes at least one byte, so a corrupted size can not allocate unbounded memory
+            Require(size);
+            std::vector<std::string> list;
+            list.reserve(size);
+            for (uint64_t i = 0; i < size; i++)
+            {
+                list.push_back(String());
+            }
+            return list;
+        }
+
+        /// The size of a list whose elements take at least one byte each.
+        size_t ListSize()
+        {
+            uint64_t size = VarUint();
+            Require(size);
+            return size;
+        }
+    };
+
+    /// \exclude
+    namespace detail
+    {
+        inline void EncodeBaseNode(BinaryWriter &writer, const BaseNode &node)
+        {
+            writer.String(node.name);
+            writer.StringList(node.namespaces);
+            writer.String(node.file_path);
+            writer.String(node.parent_name);
+            writer.String(node.parent_full_scope_name);
+            writer.StringList(node.attributes);
+            writer.String(node.comment);
+            writer.String(node.source);
+            writer.StringList(node.conditional_compilation_directives_infos);
+            writer.String(node.fingerprint);
+        }
+
+        inline void DecodeBaseNode(BinaryReader &reader, BaseNode &node)
+        {
+            node.name = reader.String();
+            node.namespaces = reader.StringList();
+            node.file_path = reader.String();
+            node.parent_name = reader.String();
+            node.parent_full_scope_name = reader.String();
+            node.attributes = reader.StringList();
+            node.comment = reader.String();
+            node.source = reader.String();
+            node.conditional_compilation_directives_infos = reader.StringList();
+            node.fingerprint = reader.String();
+        }
+
+        inline void EncodeSimpleType(BinaryWriter &writer, const SimpleType &type)
+        {
+            writer.String(type.name);
+            writer.String(type.source);
+            writer.VarUint(static_cast<uint64_t>(type.kind));
+            writer.Bool(type.is_const);
+            writer.Bool(type.is_builtin_type);
+            writer.Bool(type.is_unresolved);
+            writer.StringList(type.template_arguments);
+        }
+
+        inline void DecodeSimpleType(BinaryReader &reader, SimpleType &type)
+        {
+            type.name = reader.String();
+            type.source = reader.String();
+            type.kind = static_cast<SimpleTypeKind>(reader.VarUint());
+            type.is_const = reader.Bool();
+            type.is_builtin_type = reader.Bool();
+            type.is_unresolved = reader.Bool();
+            type.template_arguments = reader.StringList();
+        }
+
+        inline void EncodeVariable(BinaryWriter &writer, const Variable &variable)
+        {
+            EncodeBaseNode(writer, variable);
+            EncodeSimpleType(writer, variable.type);
+            writer.String(variable.default_value);
+            writer.OptionalInt(variable.evaluated_value);
+            writer.Bool(variable.is_output);
+        }
+
+        inline void DecodeVariable(BinaryReader &reader, Variable &variable)
+        {
+            DecodeBaseNode(reader, variable);
+            DecodeSimpleType(reader, variable.type);
+            variable.default_value = reader.String();
+            variable.evaluated_value = reader.OptionalInt();
+            variable.is_output = reader.Bool();
+        }
+
+        inline void EncodeParameters(BinaryWriter &writer, const std::vector<Variable> &parameters)
+        {
+            writer.VarUint(parameters.size());
+            for (auto &parameter : parameters)
+            {
+                EncodeVariable(writer, parameter);
+            }
+        }
+
+        inline void DecodeParameters(BinaryReader &reader, std::vector<Variable> &parameters)
+        {
+            parameters.resize(reader.ListSize());
+            for (auto &parameter : parameters)
+            {
+                DecodeVariable(reader, parameter);
+            }
+        }
+
+        inline void EncodeMemberFunction(BinaryWriter &writer, const MemberFunction &function)
+        {
+            EncodeBaseNode(writer, function);
+            writer.Bool(function.is_virtual);
+            EncodeSimpleType(writer, function.return_type);
+            EncodeParameters(writer, function.parameters);
+            writer.String(function.access_specifier);
+            writer.Bool(function.is_overriding);
+            writer.Bool(function.is_const);
+            writer.String(function.signature);
+            writer.Bool(function.is_variadic);
+            writer.String(function.mangled_name);
+            writer.String(function.id);
+            writer.String(function.overridden_method);
+        }
+
+        inline void DecodeMemberFunction(BinaryReader &reader, MemberFunction &function)
+        {
+            DecodeBaseNode(reader, function);
+            function.is_virtual = reader.Bool();
+            DecodeSimpleType(reader, function.return_type);
+            DecodeParameters(reader, function.parameters);
+            function.access_specifier = reader.String();
+            function.is_overriding = reader.Bool();
+            function.is_const = reader.Bool();
+            function.signature = reader.String();
+            function.is_variadic = reader.Bool();
+            function.mangled_name = reader.String();
+            function.id = reader.String();
+            function.overridden_method = reader.String();
+        }
+
+        inline void EncodeClazz(BinaryWriter &writer, const Clazz &clazz)
+        {
+            EncodeBaseNode(writer, clazz);
+
+            writer.VarUint(clazz.constructors.size());
+            for (auto &constructor : clazz.constructors)
+            {
+                EncodeBaseNode(writer, constructor);
+                EncodeParameters(writer, constructor.parameters);
+            }
+
+            writer.VarUint(clazz.methods.size());
+            for (auto &method : clazz.methods)
+            {
+                EncodeMemberFunction(writer, method);
+            }
+
+            writer.VarUint(clazz.member_variables.size());
+            for (auto &member_variable : clazz.member_variables)
+            {
+                EncodeBaseNode(writer, member_variable);
+                EncodeSimpleType(writer, member_variable.type);
+                writer.Bool(member_variable.is_mutable);
+                writer.String(member_variable.access_specifier);
+            }
+
+            writer.StringList(clazz.base_clazzs);
+            writer.StringList(clazz.all_base_clazzs);
+            writer.StringList(clazz.virtual_methods);
+        }
+
+        inline void DecodeClazz(BinaryReader &reader, Clazz &clazz)
+        {
+            DecodeBaseNode(reader, clazz);
+
+            clazz.constructors.resize(reader.ListSize());
+            for (auto &constructor : clazz.constructors)
+            {
+                DecodeBaseNode(reader, constructor);
+                DecodeParameters(reader, constructor.parameters);
+            }
+
+            clazz.methods.resize(reader.ListSize());
+            for (auto &method : clazz.methods)
+            {
+                DecodeMemberFunction(reader, method);
+            }
+
+            clazz.member_variables.resize(reader.ListSize());
+            for (auto &member_variable : clazz.member_variables)
+            {
+                DecodeBaseNode(reader, member_variable);
+                DecodeSimpleType(reader, member_variable.type);
+                member_variable.is_mutable = reader.Bool();
+                member_variable.access_specifier = reader.String();
+            }
+
+            clazz.base_clazzs = reader.StringList();
+            clazz.all_base_clazzs = reader.StringList();
+            clazz.virtual_methods = reader.StringList();
+        }
+
+        inline void EncodeNode(BinaryWriter &writer, const NodeType &node)
+        {
+            writer.VarUint(node.index());
+            std::visit([&](auto &&ele)
+                       {
+                           using T = std::decay_t<decltype(ele)>;
+                           if constexpr (std::is_same_v<T, IncludeDirective>)
+                           {
+                               EncodeBaseNode(writer, ele);
+                               writer.String(ele.include_file_path);
+                           }
+                           else if constexpr (std::is_same_v<T, TypeAlias>)
+                           {
+                               EncodeBaseNode(writer, ele);
+                               EncodeSimpleType(writer, ele.underlyingType);
+                           }
+                           else if constexpr (std::is_same_v<T, Clazz> || std::is_same_v<T, Struct>)
+                           {
+                               EncodeClazz(writer, ele);
+                           }
+                           else if constexpr (std::is_same_v<T, Enumz>)
+                           {
+                               EncodeBaseNode(writer, ele);
+                               writer.VarUint(ele.enum_constants.size());
+                               for (auto &enum_constant : ele.enum_constants)
+                               {
+                                   EncodeBaseNode(writer, enum_constant);
+                                   writer.String(enum_constant.value);
+                                   writer.OptionalInt(enum_constant.evaluated_value);
+                               }
+                           }
+                           else if constexpr (std::is_same_v<T, MemberFunction>)
+                           {
+                               EncodeMemberFunction(writer, ele);
+                           }
+                           else if constexpr (std::is_same_v<T, Variable>)
+                           {
+                               EncodeVariable(writer, ele);
+                           } },
+                       node);
+        }
+
+        inline NodeType DecodeNode(BinaryReader &reader)
+        {
+            switch (reader.VarUint())
+            {
+            case 0:
+            {
+                IncludeDirective include_directive;
+                DecodeBaseNode(reader, include_directive);
+                include_directive.include_file_path = reader.String();
+                return include_directive;
+            }
+            case 1:
+            {
+                TypeAlias type_alias;
+                DecodeBaseNode(reader, type_alias);
+                DecodeSimpleType(reader, type_alias.underlyingType);
+                return type_alias;
+            }
+            case 2:
+            {
+                Clazz clazz;
+                DecodeClazz(reader, clazz);
+                return clazz;
+            }
+            case 3:
+            {
+                Enumz enumz;
+                DecodeBaseNode(reader, enumz);
+                enumz.enum_constants.resize(reader.ListSize());
+                for (auto &enum_constant : enumz.enum_constants)
+                {
+                    DecodeBaseNode(reader, enum_constant);
+                    enum_constant.value = reader.String();
+                    enum_constant.evaluated_value = reader.OptionalInt();
+                }
+                return enumz;
+            }
+            case 4:
+            {
+                Struct structt;
+                DecodeClazz(reader, structt);
+                return structt;
+            }
+            case 5:
+            {
+                MemberFunction function;
+                DecodeMemberFunction(reader, function);
+                return function;
+            }
+            case 6:
+            {
+                Variable variable;
+                DecodeVariable(reader, variable);
+                return variable;
+            }
+            default:
+                throw std::runtime_error("The binary encoding has an unknown node kind");
+            }
+        }
+
+        static_assert(std::variant_size_v<NodeType> == 7, "DecodeNode must cover every NodeType alternative");
+    }
+
+    /// The version of the encoding written by `EncodeCXXFiles`, bump it when the nodes change.
+    constexpr uint64_t kBinaryCodecVersion = 4;
+
+    /// Encode the `CXXFile`s in a compact binary form, the `user_data` of the nodes is not kept.
+    inline void EncodeCXXFiles(BinaryWriter &writer, const std::vector<CXXFile> &cxx_files)
+    {
+        writer.VarUint(kBinaryCodecVersion);
+        writer.VarUint(cxx_files.size());
+        for (auto &cxx_file : cxx_files)
+        {
+            writer.String(cxx_file.file_path);
+            writer.VarUint(cxx_file.nodes.size());
+            for (auto &node : cxx_file.nodes)
+            {
+                detail::EncodeNode(writer, node);
+            }
+        }
+    }
+
+    /// Decode what `EncodeCXXFiles` wrote, throws `std::runtime_error` on a malformed input.
+    inline std::vector<CXXFile> DecodeCXXFiles(BinaryReader &reader)
+    {
+        if (reader.VarUint() != kBinaryCodecVersion)
+        {
+            throw std::runtime_error("The binary encoding has an unsupported version");
+        }
+
+        std::vector<CXXFile> cxx_files(reader.ListSize());
+        for (auto &cxx_file : cxx_files)
+        {
+            cxx_file.file_path = reader.String();
+            size_t node_count = reader.ListSize();
+            cxx_file.nodes.reserve(node_count);
+            for (size_t i = 0; i < node_count; i++)
+            {
+                cxx_file.nodes.push_back(detail::DecodeNode(reader));
+            }
+        }
+        return cxx_files;
+    }
+}
+
+#endif // TERRA_CODEC_H_
@@ -0,0 +1,1130 @@
+#ifndef terra_CONSTANT_FOLDING_H_
+#define terra_CONSTANT_FOLDING_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "terra_node.hpp"
+#include "terra_parser.hpp"
+#include "terra_pass.hpp"
+#include "terra_utils.hpp"
+
+namespace terra
+{
+
+    /// Evaluates the integer constant expressions of the parsed source text, e.g., `(ERR_BASE + 4)` or `1u << 31`.
+    ///
+    /// It supports integer, character and boolean literals, the unary, binary and conditional operators,
+    /// and casts to the builtin integer types. The identifiers are looked up with the `Resolver`.
+    /// As in C++, the right operand of `&&` and `||` is not evaluated if the left one decides the result.
+    /// `int` is 32 bits and `long` is 64 bits wide, as on the LP64 platforms.
+    /// Anything else, e.g., `sizeof`, function calls or floating point values, fails the evaluation.
+    class ConstantExpressionEvaluator
+    {
+    public:
+        /// Returns the value of a possibly qualified identifier, or `std::nullopt` if it is unknown.
+        using Resolver = std::function<std::optional<int64_t>(const std::string &name)>;
+
+        static std::optional<int64_t> Evaluate(std::string_view expression, const Resolver &resolver)
+        {
+            ConstantExpressionEvaluator evaluator(expression, resolver);
+            if (!evaluator.Tokenize())
+            {
+                return std::nullopt;
+            }
+
+            Value value;
+            if (!evaluator.Conditional(value) || evaluator.position_ != evaluator.tokens_.size())
+            {
+                return std::nullopt;
+            }
+            return static_cast<int64_t>(value.bits);
+        }
+
+    private:
+        enum class TokenKind
+        {
+            Number,
+            Identifier,
+            Punctuator,
+        };
+
+        struct Token
+        {
+            TokenKind kind;
+            std::string_view text;
+            uint64_t bits = 0;
+            bool is_unsigned = false;
+            bool is_long = false;
+        };
+
+        // An `int`, `unsigned int`, `long` or `unsigned long`, always normalized to its width
+        struct Value
+        {
+            uint64_t bits = 0;
+            bool is_unsigned = false;
+            bool is_long = false;
+
+            Value &Normalize()
+            {
+                if (!is_long)
+                {
+                    bits = is_unsigned ? static_cast<uint32_t>(bits)
+                                       : static_cast<uint64_t>(static_cast<int64_t>(static_cast<int32_t>(bits)));
+                }
+                return *this;
+            }
+
+            bool IsNegative() const
+            {
+                return !is_unsigned && static_cast<int64_t>(bits) < 0;
+            }
+
+            static Value Int(int64_t value)
+            {
+                Value result;
+                result.bits = static_cast<uint64_t>(value);
+                result.is_long = value < INT32_MIN || value > INT32_MAX;
+                return result;
+            }
+        };
+
+        std::string_view expression_;
+        const Resolver &resolver_;
+        std::vector<Token> tokens_;
+        size_t position_ = 0;
+        // Greater than 0 while parsing an operand that is not evaluated, e.g., the right operand of `0 && x`,
+        // which only has to be well-formed
+        size_t unevaluated_depth_ = 0;
+
+        ConstantExpressionEvaluator(std::string_view expression, const Resolver &resolver)
+            : expression_(expression), resolver_(resolver) {}
+
+        static bool IsIdentifierStart(char c)
+        {
+            return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+        }
+
+        static bool IsIdentifierChar(char c)
+        {
+            return IsIdentifierStart(c) || (c >= '0' && c <= '9');
+        }
+
+        static int DigitValue(char c)
+        {
+            if (c >= '0' && c <= '9')
+            {
+                return c - '0';
+            }
+            if (c >= 'a' && c <= 'f')
+            {
+                return c - 'a' + 10;
+            }
+            if (c >= 'A' && c <= 'F')
+            {
+                return c - 'A' + 10;
+            }
+            return 99;
+        }
+
+        // The type of an integer literal follows [lex.icon], e.g., a hex literal which does not fit into `int`
+        // is an `unsigned int`
+        bool LexNumber(size_t &i, Token &token)
+        {
+            size_t begin = i;
+            uint64_t base = 10;
+            if (expression_[i] == '0' && i + 1 < expression_.size())
+            {
+                char prefix = expression_[i + 1];
+                if (prefix == 'x' || prefix == 'X')
+                {
+                    base = 16;
+                    i += 2;
+                }
+                else if (prefix == 'b' || prefix == 'B')
+                {
+                    base = 2;
+                    i += 2;
+                }
+                else
+                {
+                    base = 8;
+                }
+            }
+
+            uint64_t bits = 0;
+            bool has_digits = base == 8;
+            for (; i < expression_.size(); i++)
+            {
+                char c = expression_[i];
+                if (c == '\'')
+                {
+                    continue;
+                }
+                uint64_t digit = static_cast<uint64_t>(DigitValue(c));
+                if (digit >= base)
+                {
+                    break;
+                }
+                if (bits > (UINT64_MAX - digit) / base)
+                {
+                    return false;
+                }
+                bits = bits * base + digit;
+                has_digits = true;
+            }
+            if (!has_digits)
+            {
+                return false;
+            }
+
+            bool is_unsigned = false;
+            int long_count = 0;
+            for (; i < expression_.size() && IsIdentifierChar(expression_[i]); i++)
+            {
+                char c = expression_[i];
+                if ((c == 'u' || c == 'U') && !is_unsigned)
+                {
+                    is_unsigned = true;
+                }
+                else if ((c == 'l' || c == 'L') && long_count < 2)
+                {
+                    long_count++;
+                }
+                else
+                {
+                    // A floating point literal, a user-defined literal or a malformed one
+                    return false;
+                }
+            }
+            if (i < expression_.size() && expression_[i] == '.')
+            {
+                return false;
+            }
+
+            bool is_long = long_count > 0;
+            if (!is_long && bits > (is_unsigned || base != 10 ? UINT32_MAX : static_cast<uint64_t>(INT32_MAX)))
+            {
+                is_long = true;
+            }
+            if (!is_unsigned && base != 10 && bits > (is_long ? static_cast<uint64_t>(INT64_MAX) : static_cast<uint64_t>(INT32_MAX)))
+            {
+                is_unsigned = true;
+            }
+            if (!is_unsigned && bits > static_cast<uint64_t>(INT64_MAX))
+            {
+                return false;
+            }
+
+            token.kind = TokenKind::Number;
+            token.text = expression_.substr(begin, i - begin);
+            token.bits = bits;
+            token.is_unsigned = is_unsigned;
+            token.is_long = is_long;
+            return true;
+        }
+
+        // A plain character literal is a `char`, which is signed on the supported platforms
+        bool LexCharacter(size_t &i, bool is_plain, Token &token)
+        {
+            size_t begin = i++;
+            if (i >= expression_.size())
+            {
+                return false;
+            }
+
+            uint64_t bits = 0;
+            char c = expression_[i++];
+            if (c == '\\')
+            {
+                if (i >= expression_.size())
+                {
+                    return false;
+                }
+                char escape = expression_[i++];
+                switch (escape)
+                {
+                case 'n':
+                    bits = '\n';
+                    break;
+                case 't':
+                    bits = '\t';
+                    break;
+                case 'r':
+                    bits = '\r';
+                    break;
+                case 'a':
+                    bits = '\a';
+                    break;
+                case 'b':
+                    bits = '\b';
+                    break;
+                case 'f':
+                    bits = '\f';
+                    break;
+                case 'v':
+                    bits = '\v';
+                    break;
+                case '\\':
+                case '\'':
+                case '"':
+                case '?':
+                    bits = static_cast<uint64_t>(escape);
+                    break;
+                case 'x':
+                {
+                    size_t digits = 0;
+                    for (; i < expression_.size() && DigitValue(expression_[i]) < 16 && digits < 8; i++, digits++)
+                    {
+                        bits = bits * 16 + static_cast<uint64_t>(DigitValue(expression_[i]));
+                    }
+                    if (digits == 0)
+                    {
+                        return false;
+                    }
+                    break;
+                }
+                default:
+                {
+                    if (escape < '0' || escape > '7')
+                    {
+                        return false;
+                    }
+                    bits = static_cast<uint64_t>(escape - '0');
+                    for (size_t digits = 1; i < expression_.size() && expression_[i] >= '0' && expression_[i] <= '7' && digits < 3; i++, digits++)
+                    {
+                        bits = bits * 8 + static_cast<uint64_t>(expression_[i] - '0');
+                    }
+                    break;
+                }
+                }
+            }
+            else if (c == '\'' || static_cast<unsigned char>(c) >= 0x80)
+            {
+                // Empty, or a multi-byte UTF-8 character
+                return false;
+            }
+            else
+            {
+                bits = static_cast<uint64_t>(c);
+            }
+
+            if (i >= expression_.size() || expression_[i] != '\'')
+            {
+                // A multi-character literal
+                return false;
+            }
+            i++;
+
+            token.kind = TokenKind::Number;
+            token.text = expression_.substr(begin, i - begin);
+            token.bits = is_plain ? static_cast<uint64_t>(static_cast<int64_t>(static_cast<int8_t>(bits))) : bits;
+            token.is_unsigned = token.bits > static_cast<uint64_t>(INT32_MAX);
+            return true;
+        }
+
+        bool Tokenize()
+        {
+            static constexpr std::string_view kPunctuators[] = {
+                "<<", ">>", "<=", ">=", "==", "!=", "&&", "||", "::",
+                "+", "-", "*", "/", "%", "<", ">", "&", "|", "^", "~", "!", "?", ":", "(", ")"};
+
+            size_t i = 0;
+            while (i < expression_.size())
+            {
+                char c = expression_[i];
+                if (c == ' ' || c == '\t' || c == '\n' || c == '\r')
+                {
+                    i++;
+                    continue;
+                }
+
+                Token token;
+                if (c >= '0' && c <= '9')
+                {
+                    if (!LexNumber(i, token))
+                    {
+                        return false;
+                    }
+                }
+                else if (c == '\'')
+                {
+                    if (!LexCharacter(i, true, token))
+                    {
+                        return false;
+                    }
+                }
+                else if (IsIdentifierStart(c))
+                {
+                    size_t begin = i;
+                    while (i < expression_.size() && IsIdentifierChar(expression_[i]))
+                    {
+                        i++;
+                    }
+                    std::string_view identifier = expression_.substr(begin, i - begin);
+                    if (i < expression_.size() && expression_[i] == '\'' &&
+                        (identifier == "u8" || identifier == "u" || identifier == "U" || identifier == "L"))
+                    {
+                        if (!LexCharacter(i, false, token))
+                        {
+                            return false;
+                        }
+                    }
+                    else
+                    {
+                        token.kind = TokenKind::Identifier;
+                        token.text = identifier;
+                    }
+                }
+                else
+                {
+                    bool matched = false;
+                    for (auto punctuator : kPunctuators)
+                    {
+                        if (expression_.substr(i, punctuator.size()) == punctuator)
+                        {
+                            token.kind = TokenKind::Punctuator;
+                            token.text = expression_.substr(i, punctuator.size());
+                            i += punctuator.size();
+                            matched = true;
+                            break;
+                        }
+                    }
+                    if (!matched)
+                    {
+                        return false;
+                    }
+                }
+                tokens_.push_back(token);
+            }
+            return true;
+        }
+
+        bool Peek(std::string_view punctuator) const
+        {
+            return position_ < tokens_.size() && tokens_[position_].kind == TokenKind::Punctuator &&
+                   tokens_[position_].text == punctuator;
+        }
+
+        bool Accept(std::string_view punctuator)
+        {
+            if (Peek(punctuator))
+            {
+                position_++;
+                return true;
+            }
+            return false;
+        }
+
+        // The usual arithmetic conversions of both operands to their common type
+        static void Convert(Value &lhs, Value &rhs)
+        {
+            bool is_long = lhs.is_long || rhs.is_long;
+            bool is_unsigned = lhs.is_long == rhs.is_long ? lhs.is_unsigned || rhs.is_unsigned
+                                                          : (lhs.is_long ? lhs.is_unsigned : rhs.is_unsigned);
+            for (Value *value : {&lhs, &rhs})
+            {
+                value->is_long = is_long;
+                value->is_unsigned = is_unsigned;
+                value->Normalize();
+            }
+        }
+
+        static Value Bool(bool value)
+        {
+            return Value::Int(value ? 1 : 0);
+        }
+
+        bool Binary(std::string_view op, Value lhs, Value rhs, Value &result)
+        {
+            if (op == "<<" || op == ">>")
+            {
+                // The result has the type of the left operand
+                if (rhs.IsNegative() || rhs.bits >= (lhs.is_long ? 64u : 32u))
+                {
+                    return false;
+                }
+                result = lhs;
+                if (op == "<<")
+                {
+                    result.bits = lhs.bits << rhs.bits;
+                }
+                else
+                {
+                    result.bits = lhs.is_unsigned ? lhs.bits >> rhs.bits
+                                                  : static_cast<uint64_t>(static_cast<int64_t>(lhs.bits) >> rhs.bits);
+                }
+                result.Normalize();
+                return true;
+            }
+            Convert(lhs, rhs);
+            bool less = lhs.is_unsigned ? lhs.bits < rhs.bits
+                                        : static_cast<int64_t>(lhs.bits) < static_cast<int64_t>(rhs.bits);
+            if (op == "==" || op == "!=" || op == "<" || op == ">" || op == "<=" || op == ">=")
+            {
+                bool equal = lhs.bits == rhs.bits;
+                result = Bool(op == "==" ? equal : op == "!=" ? !equal
+                                               : op == "<"    ? less
+                                               : op == ">"    ? !less && !equal
+                                               : op == "<="   ? less || equal
+                                                              : !less);
+                return true;
+            }
+
+            result = lhs;
+            if (op == "+")
+            {
+                result.bits = lhs.bits + rhs.bits;
+            }
+            else if (op == "-")
+            {
+                result.bits = lhs.bits - rhs.bits;
+            }
+            else if (op == "*")
+            {
+                result.bits = lhs.bits * rhs.bits;
+            }
+            else if (op == "/" || op == "%")
+            {
+                if (rhs.bits == 0)
+                {
+                    return false;
+                }
+                if (lhs.is_unsigned)
+                {
+                    result.bits = op == "/" ? lhs.bits / rhs.bits : lhs.bits % rhs.bits;
+                }
+                else
+                {
+                    int64_t dividend = static_cast<int64_t>(lhs.bits);
+                    int64_t divisor = static_cast<int64_t>(rhs.bits);
+                    if (dividend == INT64_MIN && divisor == -1)
+                    {
+                        return false;
+                    }
+                    result.bits = static_cast<uint64_t>(op == "/" ? dividend / divisor : dividend % divisor);
+                }
+            }
+            else if (op == "&")
+            {
+                result.bits = lhs.bits & rhs.bits;
+            }
+            else if (op == "|")
+            {
+                result.bits = lhs.bits | rhs.bits;
+            }
+            else if (op == "^")
+            {
+                result.bits = lhs.bits ^ rhs.bits;
+            }
+            else
+            {
+                return false;
+            }
+            result.Normalize();
+            return true;
+        }
+
+        // The binary operators from the lowest to the highest precedence
+        bool BinaryLevel(size_t level, Value &value)
+        {
+            static constexpr std::string_view kLevels[][6] = {
+                {"||"},
+                {"&&"},
+                {"|"},
+                {"^"},
+                {"&"},
+                {"==", "!="},
+                {"<", ">", "<=", ">="},
+                {"<<", ">>"},
+                {"+", "-"},
+                {"*", "/", "%"},
+            };
+            constexpr size_t kLevelCount = sizeof(kLevels) / sizeof(kLevels[0]);
+
+            if (level == kLevelCount)
+            {
+                return Unary(value);
+            }
+            if (!BinaryLevel(level + 1, value))
+            {
+                return false;
+            }
+
+            while (true)
+            {
+                std::string_view op;
+                for (auto candidate : kLevels[level])
+                {
+                    if (!candidate.empty() && Peek(candidate))
+                    {
+                        op = candidate;
+                        break;
+                    }
+                }
+                if (op.empty())
+                {
+                    return true;
+                }
+                position_++;
+
+                Value rhs;
+                if (op == "&&" || op == "||")
+                {
+                    // The right operand is only evaluated if the left one does not decide the result
+                    bool is_decided = (value.bits != 0) == (op == "||");
+                    unevaluated_depth_ += is_decided;
+                    bool is_parsed = BinaryLevel(level + 1, rhs);
+                    unevaluated_depth_ -= is_decided;
+                    if (!is_parsed)
+                    {
+                        return false;
+                    }
+                    value = Bool(is_decided ? value.bits != 0 : rhs.bits != 0);
+                    continue;
+                }
+                if (!BinaryLevel(level + 1, rhs) || (!Binary(op, value, rhs, value) && unevaluated_depth_ == 0))
+                {
+                    return false;
+                }
+            }
+        }
+
+        bool Conditional(Value &value)
+        {
+            if (!BinaryLevel(0, value))
+            {
+                return false;
+            }
+            if (!Accept("?"))
+            {
+                return true;
+            }
+
+            Value if_true;
+            Value if_false;
+            if (!Conditional(if_true) || !Accept(":") || !Conditional(if_false))
+            {
+                return false;
+            }
+            Convert(if_true, if_false);
+            value = value.bits != 0 ? if_true : if_false;
+            return true;
+        }
+
+        bool Unary(Value &value)
+        {
+            if (Accept("+"))
+            {
+                return Unary(value);
+            }
+            if (Accept("-"))
+            {
+                if (!Unary(value))
+                {
+                    return false;
+                }
+                value.bits = 0 - value.bits;
+                value.Normalize();
+                return true;
+            }
+            if (Accept("~"))
+            {
+                if (!Unary(value))
+                {
+                    return false;
+                }
+                value.bits = ~value.bits;
+                value.Normalize();
+                return true;
+            }
+            if (Accept("!"))
+            {
+                if (!Unary(value))
+                {
+                    return false;
+                }
+                value = Bool(value.bits == 0);
+                return true;
+            }
+
+            // A C-style cast to a builtin integer type, e.g., `(unsigned int)-1`
+            if (Peek("("))
+            {
+                size_t start = position_;
+                position_++;
+                std::string type_name;
+                if (TypeName(type_name) && Accept(")"))
+                {
+                    return Unary(value) && Cast(type_name, value);
+                }
+                position_ = start;
+            }
+            return Primary(value);
+        }
+
+        // A sequence of keywords that names a builtin integer type, e.g., `unsigned long long` or `std::uint8_t`
+        bool TypeName(std::string &type_name)
+        {
+            size_t start = position_;
+            std::string name;
+            while (position_ < tokens_.size())
+            {
+                if (tokens_[position_].kind == TokenKind::Identifier)
+                {
+                    std::string_view word = tokens_[position_].text;
+                    if (word == "const" || word == "volatile")
+                    {
+                        position_++;
+                        continue;
+                    }
+                    if (!name.empty() && name.back() != ':')
+                    {
+                        name += ' ';
+                    }
+                    name += word;
+                    position_++;
+                }
+                else if (Peek("::") && (name.empty() || name.back() != ':'))
+                {
+                    name += "::";
+                    position_++;
+                }
+                else
+                {
+                    break;
+                }
+            }
+
+            if (name.rfind("::", 0) == 0)
+            {
+                name.erase(0, 2);
+            }
+            if (name.rfind("std::", 0) == 0)
+            {
+                name.erase(0, 5);
+            }
+            Value probe;
+            if (Cast(name, probe))
+            {
+                type_name = name;
+                return true;
+            }
+            position_ = start;
+            return false;
+        }
+
+        // Converts the value to the builtin integer type, the narrow types are promoted to `int` again
+        static bool Cast(const std::string &type_name, Value &value)
+        {
+            struct IntegerType
+            {
+                std::string_view name;
+                int bits;
+                bool is_unsigned;
+            };
+            static constexpr IntegerType kIntegerTypes[] = {
+                {"bool", 1, true},
+                {"char", 8, false},
+                {"signed char", 8, false},
+                {"unsigned char", 8, true},
+                {"int8_t", 8, false},
+                {"uint8_t", 8, true},
+                {"char16_t", 16, true},
+                {"short", 16, false},
+                {"short int", 16, false},
+                {"signed short", 16, false},
+                {"unsigned short", 16, true},
+                {"unsigned short int", 16, true},
+                {"int16_t", 16, false},
+                {"uint16_t", 16, true},
+                {"char32_t", 32, true},
+                {"wchar_t", 32, false},
+                {"int", 32, false},
+                {"signed", 32, false},
+                {"signed int", 32, false},
+                {"unsigned", 32, true},
+                {"unsigned int", 32, true},
+                {"int32_t", 32, false},
+                {"uint32_t", 32, true},
+                {"long", 64, false},
+                {"long int", 64, false},
+                {"signed long", 64, false},
+                {"long long", 64, false},
+                {"long long int", 64, false},
+                {"signed long long", 64, false},
+                {"unsigned long", 64, true},
+                {"unsigned long int", 64, true},
+                {"unsigned long long", 64, true},
+                {"unsigned long long int", 64, true},
+                {"int64_t", 64, false},
+                {"uint64_t", 64, true},
+                {"intptr_t", 64, false},
+                {"uintptr_t", 64, true},
+                {"ptrdiff_t", 64, false},
+                {"size_t", 64, true},
+            };
+
+            for (auto &type : kIntegerTypes)
+            {
+                if (type.name != type_name)
+                {
+                    continue;
+                }
+                if (type.bits == 1)
+                {
+                    value = Bool(value.bits != 0);
+                }
+                else if (type.bits < 32)
+                {
+                    uint64_t mask = (uint64_t(1) << type.bits) - 1;
+                    uint64_t bits = value.bits & mask;
+                    if (!type.is_unsigned && (bits >> (type.bits - 1)) != 0)
+                    {
+                        bits |= ~mask;
+                    }
+                    value = Value::Int(static_cast<int64_t>(bits));
+                }
+                else
+                {
+                    value.is_long = type.bits == 64;
+                    value.is_unsigned = type.is_unsigned;
+                    value.Normalize();
+                }
+                return true;
+            }
+            return false;
+        }
+
+        bool Primary(Value &value)
+        {
+            if (Accept("("))
+            {
+                return Conditional(value) && Accept(")");
+            }
+            if (position_ >= tokens_.size())
+            {
+                return false;
+            }
+
+            const Token &token = tokens_[position_];
+            if (token.kind == TokenKind::Number)
+            {
+                position_++;
+                value.bits = token.bits;
+                value.is_unsigned = token.is_unsigned;
+                value.is_long = token.is_long;
+                return true;
+            }
+            if (token.kind != TokenKind::Identifier && !Peek("::"))
+            {
+                return false;
+            }
+
+            if (token.text == "true" || token.text == "false")
+            {
+                position_++;
+                value = Bool(token.text == "true");
+                return true;
+            }
+            if (token.text == "static_cast")
+            {
+                // static_cast<type>(expression)
+                position_++;
+                std::string type_name;
+                return Accept("<") && TypeName(type_name) && Accept(">") && Accept("(") &&
+                       Conditional(value) && Accept(")") && Cast(type_name, value);
+            }
+
+            // A functional cast, e.g., `uint32_t(-1)`
+            std::string type_name;
+            size_t start = position_;
+            if (TypeName(type_name))
+            {
+                if (Accept("("))
+                {
+                    return Conditional(value) && Accept(")") && Cast(type_name, value);
+                }
+                position_ = start;
+            }
+
+            // A possibly qualified identifier
+            std::string name;
+            if (Accept("::"))
+            {
+                name += "::";
+            }
+            while (position_ < tokens_.size() && tokens_[position_].kind == TokenKind::Identifier)
+            {
+                name += tokens_[position_++].text;
+                if (!Accept("::"))
+                {
+                    break;
+                }
+                name += "::";
+            }
+            if (name.empty() || name.back() == ':' || Peek("("))
+            {
+                return false;
+            }
+
+            std::optional<int64_t> resolved = resolver_(name);
+            if (!resolved.has_value())
+            {
+                return unevaluated_depth_ > 0;
+            }
+            value = Value::Int(resolved.value());
+            return true;
+        }
+    };
+
+    /// Folds the values of the enumerators and the default values of the variables and parameters
+    /// to `evaluated_value`, if they are integer constant expressions.
+    ///
+    /// `RootParser` already fills in what libclang could evaluate with `clang_Cursor_Evaluate`, this pass evaluates
+    /// the rest with `ConstantExpressionEvaluator`, e.g., for the headers whose includes could not be resolved.
+    /// The enumerators are resolved across all the parsed files, repeatedly until no more values can be folded,
+    /// so an enumerator may refer to one that is declared later or in another header.
+    class ConstantFoldingPass : public Pass
+    {
+    private:
+        struct Enumerator
+        {
+            EnumConstant *constant;
+            /// The scope of the enum, e.g., `ns::Color` for `ns::Color::kRed`, the same as `enclosing_scope` for an anonymous enum
+            std::vector<std::string> enum_scope;
+            /// The scope that contains the enum, e.g., `ns` for `ns::Color::kRed`
+            std::vector<std::string> enclosing_scope;
+        };
+
+        struct Enum
+        {
+            Enumz *enumz;
+            std::vector<std::string> scope;
+        };
+
+        std::vector<Enum> enums_;
+        std::vector<Variable *> variables_;
+        std::unordered_map<std::string, std::vector<Enumerator>> enumerators_;
+
+        static std::vector<std::string> SplitScope(const std::string &scope)
+        {
+            std::vector<std::string> components;
+            size_t begin = 0;
+            while (begin <= scope.size())
+            {
+                size_t end = scope.find("::", begin);
+                if (end == std::string::npos)
+                {
+                    end = scope.size();
+                }
+                if (end > begin)
+                {
+                    components.push_back(scope.substr(begin, end - begin));
+                }
+                begin = end + 2;
+            }
+            return components;
+        }
+
+        static std::vector<std::string> ScopeOf(const BaseNode &node)
+        {
+            return node.parent_full_scope_name.empty() ? node.namespaces : SplitScope(node.parent_full_scope_name);
+        }
+
+        static bool IsPrefix(const std::vector<std::string> &prefix, const std::vector<std::string> &scope)
+        {
+            return prefix.size() <= scope.size() && std::equal(prefix.begin(), prefix.end(), scope.begin());
+        }
+
+        static bool EndsWith(const std::vector<std::string> &scope, const std::vector<std::string> &suffix)
+        {
+            return suffix.size() <= scope.size() && std::equal(suffix.rbegin(), suffix.rend(), scope.rbegin());
+        }
+
+        // The enumerator is visible inside of its enum, and in the enclosing scope for an unscoped enum.
+        // As the scoped enums are not known, the enclosing scope is always tried.
+        std::optional<int64_t> Resolve(const std::string &name, const std::vector<std::string> &scope) const
+        {
+            std::vector<std::string> qualifiers = SplitScope(name);
+            if (qualifiers.empty())
+            {
+                return std::nullopt;
+            }
+            std::string unqualified = qualifiers.back();
+            qualifiers.pop_back();
+
+            auto found = enumerators_.find(unqualified);
+            if (found == enumerators_.end())
+            {
+                return std::nullopt;
+            }
+
+            // The candidates declared in the innermost scope win, they hide the others
+            int best_depth = -1;
+            std::optional<int64_t> value;
+            bool is_ambiguous = false;
+            for (auto &enumerator : found->second)
+            {
+                int depth = -1;
+                for (auto *candidate_scope : {&enumerator.enum_scope, &enumerator.enclosing_scope})
+                {
+                    if (qualifiers.empty() ? IsPrefix(*candidate_scope, scope) : EndsWith(*candidate_scope, qualifiers))
+                    {
+                        depth = std::max(depth, static_cast<int>(candidate_scope->size()));
+                    }
+                }
+                if (depth < 0 || depth < best_depth)
+                {
+                    continue;
+                }
+                if (depth > best_depth)
+                {
+                    best_depth = depth;
+                    value = enumerator.constant->evaluated_value;
+                    is_ambiguous = !value.has_value();
+                }
+                else if (enumerator.constant->evaluated_value != value)
+                {
+                    is_ambiguous = true;
+                }
+            }
+            if (is_ambiguous)
+            {
+                return std::nullopt;
+            }
+            return value;
+        }
+
+        std::optional<int64_t> Evaluate(const std::string &expression, const std::vector<std::string> &scope) const
+        {
+            return ConstantExpressionEvaluator::Evaluate(
+                expression, [&](const std::string &name)
+                { return Resolve(name, scope); });
+        }
+
+        // Returns whether any enumerator was folded
+        bool FoldEnum(Enumz &enumz, const std::vector<std::string> &scope)
+        {
+            bool has_folded = false;
+            std::optional<int64_t> previous;
+            for (size_t i = 0; i < enumz.enum_constants.size(); i++)
+            {
+                EnumConstant &constant = enumz.enum_constants[i];
+                if (!constant.evaluated_value.has_value())
+                {
+                    if (!constant.value.empty())
+                    {
+                        constant.evaluated_value = Evaluate(constant.value, scope);
+                    }
+                    else if (i == 0)
+                    {
+                        constant.evaluated_value = 0;
+                    }
+                    else if (previous.has_value())
+                    {
+                        constant.evaluated_value = static_cast<int64_t>(static_cast<uint64_t>(previous.value()) + 1);
+                    }
+                    has_folded = has_folded || constant.evaluated_value.has_value();
+                }
+                previous = constant.evaluated_value;
+            }
+            return has_folded;
+        }
+
+        void AddVariables(std::vector<Variable> &variables)
+        {
+            for (auto &variable : variables)
+            {
+                variables_.push_back(&variable);
+            }
+        }
+
+        void AddClazz(Clazz &clazz)
+        {
+            for (auto &constructor : clazz.constructors)
+            {
+                AddVariables(constructor.parameters);
+            }
+            for (auto &method : clazz.methods)
+            {
+                AddVariables(method.parameters);
+            }
+        }
+
+    public:
+        std::vector<size_t> NodeKinds() const override
+        {
+            return {NodeKind<Enumz>(), NodeKind<Clazz>(), NodeKind<Struct>(), NodeKind<MemberFunction>(), NodeKind<Variable>()};
+        }
+
+        void OnNode(NodeType &node, CXXFile &cxx_file) override
+        {
+            if (std::holds_alternative<Enumz>(node))
+            {
+                Enumz &enumz = std::get<Enumz>(node);
+                std::vector<std::string> enclosing_scope = ScopeOf(enumz);
+                std::vector<std::string> enum_scope(enclosing_scope);
+                if (!enumz.name.empty())
+                {
+                    enum_scope.push_back(enumz.name);
+                }
+
+                for (auto &constant : enumz.enum_constants)
+                {
+                    enumerators_[constant.name].push_back(Enumerator{&constant, enum_scope, enclosing_scope});
+                }
+                enums_.push_back(Enum{&enumz, enum_scope});
+            }
+            else if (std::holds_alternative<Clazz>(node))
+            {
+                AddClazz(std::get<Clazz>(node));
+            }
+            else if (std::holds_alternative<Struct>(node))
+            {
+                AddClazz(std::get<Struct>(node));
+            }
+            else if (std::holds_alternative<MemberFunction>(node))
+            {
+                AddVariables(std::get<MemberFunction>(node).parameters);
+            }
+            else if (std::holds_alternative<Variable>(node))
+            {
+                variables_.push_back(&std::get<Variable>(node));
+            }
+        }
+
+        void OnFinish(ParseResult &parse_result) override
+        {
+            // Every round folds at least one more enumerator, or stops
+            bool has_folded = true;
+            while (has_folded)
+            {
+                has_folded = false;
+                for (auto &enum_node : enums_)
+                {
+                    has_folded = FoldEnum(*enum_node.enumz, enum_node.scope) || has_folded;
+                }
+            }
+
+            for (auto variable : variables_)
+            {
+                if (!variable->evaluated_value.has_value() && !variable->default_value.empty())
+                {
+                    variable->evaluated_value = Evaluate(variable->default_value, ScopeOf(*variable));
+                }
+            }
+
+            enums_.clear();
+            variables_.clear();
+            enumerators_.clear();
+        }
+    };
+}
+
+#endif // terra_CONSTANT_FOLDING_H_
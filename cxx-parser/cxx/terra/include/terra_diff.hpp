@@ -0,0 +1,370 @@
+#ifndef terra_DIFF_H_
+#define terra_DIFF_H_
+
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "terra_node.hpp"
+#include "terra_parser.hpp"
+#include "terra_utils.hpp"
+
+namespace terra
+{
+
+    /// Fills `BaseNode::fingerprint` of every node in the `ParseResult`.
+    ///
+    /// The fingerprint only covers the semantic fields of a node (name, scope, attributes, types,
+    /// default values, etc.), so it does not change if only the comments or the header location change.
+    /// The fingerprint of a container (class, struct, enum, method) also covers its members.
+    class FingerprintParser : public Parser
+    {
+    private:
+        // Length-prefixed fields, so that ("ab", "c") and ("a", "bc") hash differently
+        class FieldWriter
+        {
+        public:
+            std::string buffer;
+
+            FieldWriter &Add(const std::string &field)
+            {
+                buffer += std::to_string(field.size());
+                buffer += ':';
+                buffer += field;
+                return *this;
+            }
+
+            FieldWriter &Add(const std::vector<std::string> &fields)
+            {
+                Add(std::to_string(fields.size()));
+                for (auto &f : fields)
+                {
+                    Add(f);
+                }
+                return *this;
+            }
+
+            FieldWriter &Add(bool field)
+            {
+                buffer += field ? "T" : "F";
+                return *this;
+            }
+
+            // Nothing for a missing value, so that the fingerprints of the unevaluated values stay the same
+            FieldWriter &Add(const std::optional<int64_t> &field)
+            {
+                if (field.has_value())
+                {
+                    Add(std::to_string(field.value()));
+                }
+                return *this;
+            }
+
+            FieldWriter &Add(const SimpleType &type)
+            {
+                Add(type.name).Add(type.source).Add(std::to_string((int)type.kind));
+                Add(type.is_const).Add(type.is_builtin_type).Add(type.template_arguments);
+                // Only for the unresolved types, so that the fingerprints of a full parse stay the same
+                if (type.is_unresolved)
+                {
+                    Add(type.is_unresolved);
+                }
+                return *this;
+            }
+
+            std::string Hash() const
+            {
+                return HashContent(buffer);
+            }
+        };
+
+        FieldWriter BaseNodeFields(const std::string &node_type, const BaseNode &node)
+        {
+            FieldWriter writer;
+            writer.Add(node_type).Add(node.name).Add(node.namespaces).Add(node.parent_full_scope_name);
+            writer.Add(node.attributes).Add(node.conditional_compilation_directives_infos);
+            return writer;
+        }
+
+        void FingerprintVariable(Variable &node)
+        {
+            auto writer = BaseNodeFields("Variable", node);
+            writer.Add(node.type).Add(node.default_value).Add(node.is_output).Add(node.evaluated_value);
+            node.fingerprint = writer.Hash();
+        }
+
+        void FingerprintMemberVariable(MemberVariable &node)
+        {
+            auto writer = BaseNodeFields("MemberVariable", node);
+            writer.Add(node.type).Add(node.is_mutable).Add(node.access_specifier);
+            node.fingerprint = writer.Hash();
+        }
+
+        void FingerprintMemberFunction(MemberFunction &node)
+        {
+            auto writer = BaseNodeFields("MemberFunction", node);
+            writer.Add(node.is_virtual).Add(node.return_type).Add(node.access_specifier);
+            writer.Add(node.is_overriding).Add(node.is_const).Add(node.signature);
+            writer.Add(node.is_variadic).Add(node.mangled_name).Add(node.overridden_method);
+            for (auto &param : node.parameters)
+            {
+                FingerprintVariable(param);
+                writer.Add(param.fingerprint);
+            }
+            node.fingerprint = writer.Hash();
+        }
+
+        void FingerprintConstructor(Constructor &node)
+        {
+            auto writer = BaseNodeFields("Constructor", node);
+            for (auto &param : node.parameters)
+            {
+                FingerprintVariable(param);
+                writer.Add(param.fingerprint);
+            }
+            node.fingerprint = writer.Hash();
+        }
+
+        void FingerprintClazz(const std::string &node_type, Clazz &node)
+        {
+            auto writer = BaseNodeFields(node_type, node);
+            writer.Add(node.base_clazzs).Add(node.all_base_clazzs).Add(node.virtual_methods);
+            for (auto &constructor : node.constructors)
+            {
+                FingerprintConstructor(constructor);
+                writer.Add(constructor.fingerprint);
+            }
+            for (auto &member_variable : node.member_variables)
+            {
+                FingerprintMemberVariable(member_variable);
+                writer.Add(member_variable.fingerprint);
+            }
+            for (auto &method : node.methods)
+            {
+                FingerprintMemberFunction(method);
+                writer.Add(method.fingerprint);
+            }
+            node.fingerprint = writer.Hash();
+        }
+
+        void FingerprintEnumz(Enumz &node)
+        {
+            auto writer = BaseNodeFields("Enumz", node);
+            for (auto &enum_constant : node.enum_constants)
+            {
+                auto constant_writer = BaseNodeFields("EnumConstant", enum_constant);
+                constant_writer.Add(enum_constant.value).Add(enum_constant.evaluated_value);
+                enum_constant.fingerprint = constant_writer.Hash();
+                writer.Add(enum_constant.fingerprint);
+            }
+            node.fingerprint = writer.Hash();
+        }
+
+        void FingerprintTypeAlias(TypeAlias &node)
+        {
+            auto writer = BaseNodeFields("TypeAlias", node);
+            writer.Add(node.underlyingType);
+            node.fingerprint = writer.Hash();
+        }
+
+    public:
+        /// Fills the fingerprint of `node` and of its members.
+        void Fingerprint(NodeType &node)
+        {
+            if (std::holds_alternative<Clazz>(node))
+            {
+                FingerprintClazz("Clazz", std::get<Clazz>(node));
+            }
+            else if (std::holds_alternative<Struct>(node))
+            {
+                FingerprintClazz("Struct", std::get<Struct>(node));
+            }
+            else if (std::holds_alternative<Enumz>(node))
+            {
+                FingerprintEnumz(std::get<Enumz>(node));
+            }
+            else if (std::holds_alternative<TypeAlias>(node))
+            {
+                FingerprintTypeAlias(std::get<TypeAlias>(node));
+            }
+            else if (std::holds_alternative<Variable>(node))
+            {
+                FingerprintVariable(std::get<Variable>(node));
+            }
+            else if (std::holds_alternative<MemberFunction>(node))
+            {
+                FingerprintMemberFunction(std::get<MemberFunction>(node));
+            }
+        }
+
+        bool Parse(const ParseConfig &parse_config, ParseResult &parse_result) override
+        {
+            for (auto &cxx_file : parse_result.cxx_files)
+            {
+                for (auto &node : cxx_file.nodes)
+                {
+                    Fingerprint(node);
+                }
+            }
+
+            return true;
+        }
+    };
+
+    /// Compare the `CXXFile`s of two parses by the node fingerprints, e.g., a previous dump loaded by `LoadCXXFiles`
+    /// against the parsed headers, outputs
+    /// ```
+    /// {"added":[...],"modified":[...],"removed":[...]}
+    /// ```
+    /// Classes, structs, methods, enums, enum constants and type aliases are compared, keyed by
+    /// `<__TYPE>:<full scope name>`, methods are additionally keyed by the `mangled_name` (or `signature` if it is empty).
+    ///
+    /// The fingerprints of both sides are computed here by `FingerprintParser`, so any dump can be diffed,
+    /// the `BaseNode::fingerprint`s in the `CXXFile`s are not used.
+    inline nlohmann::json DiffAstDump(const std::vector<CXXFile> &old_cxx_files, const std::vector<CXXFile> &new_cxx_files)
+    {
+        struct Entry
+        {
+            std::string type;
+            std::string file_path;
+            std::string fingerprint;
+        };
+
+        auto collect = [](const std::vector<CXXFile> &cxx_files)
+        {
+            std::map<std::string, Entry> entries;
+
+            auto add_entry = [&](const std::string &type, const BaseNode &node, const std::string *method_key)
+            {
+                std::string scope = node.parent_full_scope_name;
+                if (scope.empty())
+                {
+                    scope = JoinToString(node.namespaces, "::");
+                }
+
+                std::string key = type + ":" + (scope.empty() ? "" : scope + "::") + node.name;
+                if (method_key != nullptr)
+                {
+                    key += "#" + *method_key;
+                }
+
+                // The same declaration may appear multiple times, e.g., under different `#if` branches
+                std::string unique_key = key;
+                for (int i = 1; entries.count(unique_key); i++)
+                {
+                    unique_key = key + "#" + std::to_string(i);
+                }
+                entries[unique_key] = Entry{type, node.file_path, node.fingerprint};
+            };
+
+            auto add_method = [&](const MemberFunction &method)
+            {
+                add_entry("MemberFunction", method, method.mangled_name.empty() ? &method.signature : &method.mangled_name);
+            };
+
+            auto add_class = [&](const std::string &type, const Clazz &clazz)
+            {
+                add_entry(type, clazz, nullptr);
+                for (auto &method : clazz.methods)
+                {
+                    add_method(method);
+                }
+            };
+
+            FingerprintParser fingerprint_parser;
+            for (auto &cxx_file : cxx_files)
+            {
+                for (auto &node : cxx_file.nodes)
+                {
+                    if (std::holds_alternative<IncludeDirective>(node) || std::holds_alternative<Variable>(node))
+                    {
+                        continue;
+                    }
+
+                    // Fingerprint a copy, one node at a time, so that the `CXXFile`s are not changed
+                    NodeType fingerprinted = node;
+                    fingerprint_parser.Fingerprint(fingerprinted);
+
+                    if (std::holds_alternative<Clazz>(fingerprinted))
+                    {
+                        add_class("Clazz", std::get<Clazz>(fingerprinted));
+                    }
+                    else if (std::holds_alternative<Struct>(fingerprinted))
+                    {
+                        add_class("Struct", std::get<Struct>(fingerprinted));
+                    }
+                    else if (std::holds_alternative<Enumz>(fingerprinted))
+                    {
+                        const Enumz &enumz = std::get<Enumz>(fingerprinted);
+                        add_entry("Enumz", enumz, nullptr);
+                        for (auto &enum_constant : enumz.enum_constants)
+                        {
+                            add_entry("EnumConstant", enum_constant, nullptr);
+                        }
+                    }
+                    else if (std::holds_alternative<TypeAlias>(fingerprinted))
+                    {
+                        add_entry("TypeAlias", std::get<TypeAlias>(fingerprinted), nullptr);
+                    }
+                    else if (std::holds_alternative<MemberFunction>(fingerprinted))
+                    {
+                        add_method(std::get<MemberFunction>(fingerprinted));
+                    }
+                }
+            }
+
+            return entries;
+        };
+
+        auto to_entry_json = [](const std::string &key, const Entry &entry)
+        {
+            nlohmann::json entry_json;
+            entry_json["key"] = key;
+            entry_json["__TYPE"] = entry.type;
+            entry_json["file_path"] = entry.file_path;
+            entry_json["fingerprint"] = entry.fingerprint;
+            return entry_json;
+        };
+
+        auto old_entries = collect(old_cxx_files);
+        auto new_entries = collect(new_cxx_files);
+
+        nlohmann::json added = nlohmann::json::array();
+        nlohmann::json removed = nlohmann::json::array();
+        nlohmann::json modified = nlohmann::json::array();
+
+        for (auto &it : new_entries)
+        {
+            auto old_it = old_entries.find(it.first);
+            if (old_it == old_entries.end())
+            {
+                added.push_back(to_entry_json(it.first, it.second));
+                continue;
+            }
+
+            if (old_it->second.fingerprint != it.second.fingerprint)
+            {
+                nlohmann::json entry_json = to_entry_json(it.first, it.second);
+                entry_json["old_fingerprint"] = old_it->second.fingerprint;
+                modified.push_back(entry_json);
+            }
+        }
+
+        for (auto &it : old_entries)
+        {
+            if (!new_entries.count(it.first))
+            {
+                removed.push_back(to_entry_json(it.first, it.second));
+            }
+        }
+
+        nlohmann::json diff;
+        diff["added"] = added;
+        diff["removed"] = removed;
+        diff["modified"] = modified;
+        return diff;
+    }
+}
+
+#endif // terra_DIFF_H_
@@ -0,0 +1,1000 @@
+#ifndef TERRA_FLAT_H_
+#define TERRA_FLAT_H_
+
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+#include "terra_node.hpp"
+#include "terra_parser.hpp"
+
+namespace terra
+{
+
+    /// A string in `FlatParseResult::strings`.
+    typedef struct FlatString
+    {
+        uint32_t offset = 0;
+        uint32_t size = 0;
+    } FlatString;
+
+    /// An index range [begin, end) into one of the columns of `FlatParseResult`.
+    typedef struct FlatRange
+    {
+        uint32_t begin = 0;
+        uint32_t end = 0;
+
+        size_t size() const
+        {
+            return end - begin;
+        }
+
+        bool empty() const
+        {
+            return begin == end;
+        }
+    } FlatRange;
+
+    /// The `BaseNode` fields, the string lists are ranges of `FlatParseResult::string_lists`.
+    /// The `user_data` is not kept.
+    typedef struct FlatBaseNode
+    {
+        FlatString name;
+        FlatString file_path;
+        FlatString parent_name;
+        FlatString parent_full_scope_name;
+        FlatString comment;
+        FlatString source;
+        FlatString fingerprint;
+        FlatRange namespaces;
+        FlatRange attributes;
+        FlatRange conditional_compilation_directives_infos;
+    } FlatBaseNode;
+
+    typedef struct FlatSimpleType
+    {
+        FlatString name;
+        FlatString source;
+        FlatRange template_arguments;
+        SimpleTypeKind kind = SimpleTypeKind::value_t;
+        bool is_const = false;
+        bool is_builtin_type = false;
+        bool is_unresolved = false;
+    } FlatSimpleType;
+
+    typedef struct FlatIncludeDirective
+    {
+        FlatBaseNode base;
+        FlatString include_file_path;
+    } FlatIncludeDirective;
+
+    typedef struct FlatTypeAlias
+    {
+        FlatBaseNode base;
+        FlatSimpleType underlying_type;
+    } FlatTypeAlias;
+
+    typedef struct FlatVariable
+    {
+        FlatBaseNode base;
+        FlatSimpleType type;
+        FlatString default_value;
+        std::optional<int64_t> evaluated_value;
+        bool is_output = false;
+    } FlatVariable;
+
+    typedef struct FlatMemberFunction
+    {
+        FlatBaseNode base;
+        FlatSimpleType return_type;
+        /// Range of `FlatParseResult::variables`
+        FlatRange parameters;
+        FlatString access_specifier;
+        FlatString signature;
+        FlatString mangled_name;
+        FlatString id;
+        FlatString overridden_method;
+        bool is_virtual = false;
+        bool is_overriding = false;
+        bool is_const = false;
+        bool is_variadic = false;
+    } FlatMemberFunction;
+
+    typedef struct FlatMemberVariable
+    {
+        FlatBaseNode base;
+        FlatSimpleType type;
+        FlatString access_specifier;
+        bool is_mutable = false;
+    } FlatMemberVariable;
+
+    typedef struct FlatEnumConstant
+    {
+        FlatBaseNode base;
+        FlatString value;
+        std::optional<int64_t> evaluated_value;
+    } FlatEnumConstant;
+
+    typedef struct FlatEnumz
+    {
+        FlatBaseNode base;
+        /// Range of `FlatParseResult::enum_constants`
+        FlatRange enum_constants;
+    } FlatEnumz;
+
+    typedef struct FlatConstructor
+    {
+        FlatBaseNode base;
+        /// Range of `FlatParseResult::variables`
+        FlatRange parameters;
+    } FlatConstructor;
+
+    /// A `Clazz` or a `Struct`, see `FlatNode::kind`.
+    typedef struct FlatClazz
+    {
+        FlatBaseNode base;
+        FlatRange constructors;
+        FlatRange methods;
+        FlatRange member_variables;
+        FlatRange base_clazzs;
+        FlatRange all_base_clazzs;
+        FlatRange virtual_methods;
+    } FlatClazz;
+
+    /// The kinds of the top-level nodes, in the order of the `NodeType` alternatives.
+    enum class FlatNodeKind : uint8_t
+    {
+        include_directive = 0,
+        type_alias = 1,
+        clazz = 2,
+        enumz = 3,
+        structt = 4,
+        member_function = 5,
+        variable = 6,
+    };
+
+    static_assert(std::variant_size_v<NodeType> == 7, "FlatNodeKind must cover every NodeType alternative");
+
+    /// A top-level node, `index` is the row in the column of its `kind`, e.g., `FlatParseResult::clazzs`
+    /// for `FlatNodeKind::clazz` and `FlatNodeKind::structt`.
+    typedef struct FlatNode
+    {
+        FlatNodeKind kind = FlatNodeKind::include_directive;
+        uint32_t index = 0;
+    } FlatNode;
+
+    typedef struct FlatCXXFile
+    {
+        FlatString file_path;
+        /// Range of `FlatParseResult::nodes`
+        FlatRange nodes;
+    } FlatCXXFile;
+
+    /// A contiguous run of rows of one column.
+    template <typename T>
+    class FlatSpan
+    {
+    private:
+        const T *begin_;
+        const T *end_;
+
+    public:
+        FlatSpan(const std::vector<T> &column, FlatRange range)
+            : begin_(column.data() + range.begin), end_(column.data() + range.end) {}
+
+        const T *begin() const
+        {
+            return begin_;
+        }
+
+        const T *end() const
+        {
+            return end_;
+        }
+
+        size_t size() const
+        {
+            return end_ - begin_;
+        }
+
+        bool empty() const
+        {
+            return begin_ == end_;
+        }
+
+        const T &operator[](size_t i) const
+        {
+            return begin_[i];
+        }
+    };
+
+    class FlatParseResult;
+
+    /// Iterates the `CXXFile`s of a `FlatParseResult`, materializing one file at a time, so the tree
+    /// based consumers (`SyntaxRender`, `WriteCXXFileJson`, ...) can run over the flat store without
+    /// converting all of it back.
+    class FlatCXXFileIterator
+    {
+    private:
+        const FlatParseResult *flat_parse_result_ = nullptr;
+        size_t index_ = 0;
+        mutable CXXFile file_;
+        mutable bool is_materialized_ = false;
+
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = CXXFile;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const CXXFile *;
+        using reference = const CXXFile &;
+
+        FlatCXXFileIterator(const FlatParseResult *flat_parse_result, size_t index)
+            : flat_parse_result_(flat_parse_result), index_(index) {}
+
+        reference operator*() const;
+
+        pointer operator->() const
+        {
+            return &**this;
+        }
+
+        FlatCXXFileIterator &operator++()
+        {
+            index_++;
+            is_materialized_ = false;
+            return *this;
+        }
+
+        bool operator==(const FlatCXXFileIterator &other) const
+        {
+            return index_ == other.index_;
+        }
+
+        bool operator!=(const FlatCXXFileIterator &other) const
+        {
+            return index_ != other.index_;
+        }
+    };
+
+    class FlatCXXFileRange
+    {
+    private:
+        const FlatParseResult *flat_parse_result_;
+        size_t size_;
+
+    public:
+        FlatCXXFileRange(const FlatParseResult *flat_parse_result, size_t size)
+            : flat_parse_result_(flat_parse_result), size_(size) {}
+
+        FlatCXXFileIterator begin() const
+        {
+            return FlatCXXFileIterator(flat_parse_result_, 0);
+        }
+
+        FlatCXXFileIterator end() const
+        {
+            return FlatCXXFileIterator(flat_parse_result_, size_);
+        }
+
+        size_t size() const
+        {
+            return size_;
+        }
+    };
+
+    /// A columnar alternative to `ParseResult`: the nodes of each kind are kept in one contiguous column,
+    /// the children of a node are an index range of the column of their kind, and all the strings are
+    /// interned into one buffer. A traversal reads the columns front to back instead of chasing the
+    /// pointers of the nested vectors, and the footprint is a fraction of the tree, e.g., a `FlatVariable` is
+    /// about a quarter of a `Variable`, and the repeated namespaces, file paths and type names are stored once.
+    ///
+    /// The store is immutable once built by `FromParseResult`, so it can be read from any number of threads.
+    /// Use `Files()` or `MaterializeFile` to run the tree based consumers over it.
+    class FlatParseResult
+    {
+    public:
+        std::string strings;
+        /// The elements of the string lists, e.g., `namespaces`, `attributes` and `base_clazzs`
+        std::vector<FlatString> string_lists;
+
+        std::vector<FlatIncludeDirective> include_directives;
+        std::vector<FlatTypeAlias> type_aliases;
+        /// The `Clazz` and `Struct` nodes
+        std::vector<FlatClazz> clazzs;
+        std::vector<FlatEnumz> enums;
+        std::vector<FlatEnumConstant> enum_constants;
+        std::vector<FlatConstructor> constructors;
+        /// The methods of the classes and the top-level functions
+        std::vector<FlatMemberFunction> member_functions;
+        std::vector<FlatMemberVariable> member_variables;
+        /// The parameters and the top-level variables
+        std::vector<FlatVariable> variables;
+
+        std::vector<FlatNode> nodes;
+        std::vector<FlatCXXFile> cxx_files;
+
+    private:
+        class Builder
+        {
+        private:
+            FlatParseResult &flat_;
+            std::unordered_map<std::string, FlatString> interned_;
+
+            static uint32_t CheckedIndex(size_t index)
+            {
+                if (index > UINT32_MAX)
+                {
+                    throw std::length_error("The parse result is too large for the flat store");
+                }
+                return static_cast<uint32_t>(index);
+            }
+
+        public:
+            explicit Builder(FlatParseResult &flat) : flat_(flat) {}
+
+            FlatString Intern(const std::string &str)
+            {
+                if (str.empty())
+                {
+                    return FlatString();
+                }
+
+                auto it = interned_.find(str);
+                if (it != interned_.end())
+                {
+                    return it->second;
+                }
+
+                FlatString flat_string;
+                flat_string.offset = CheckedIndex(flat_.strings.size());
+                flat_string.size = CheckedIndex(str.size());
+                flat_.strings.append(str);
+                CheckedIndex(flat_.strings.size());
+
+                interned_.emplace(str, flat_string);
+                return flat_string;
+            }
+
+            FlatRange InternList(const std::vector<std::string> &list)
+            {
+                FlatRange range;
+                range.begin = CheckedIndex(flat_.string_lists.size());
+                for (auto &str : list)
+                {
+                    flat_.string_lists.push_back(Intern(str));
+                }
+                range.end = CheckedIndex(flat_.string_lists.size());
+                return range;
+            }
+
+            FlatBaseNode Base(const BaseNode &node)
+            {
+                FlatBaseNode base;
+                base.name = Intern(node.name);
+                base.file_path = Intern(node.file_path);
+                base.parent_name = Intern(node.parent_name);
+                base.parent_full_scope_name = Intern(node.parent_full_scope_name);
+                base.comment = Intern(node.comment);
+                base.source = Intern(node.source);
+                base.fingerprint = Intern(node.fingerprint);
+                base.namespaces = InternList(node.namespaces);
+                base.attributes = InternList(node.attributes);
+                base.conditional_compilation_directives_infos = InternList(node.conditional_compilation_directives_infos);
+                return base;
+            }
+
+            FlatSimpleType Type(const SimpleType &type)
+            {
+                FlatSimpleType flat_type;
+                flat_type.name = Intern(type.name);
+                flat_type.source = Intern(type.source);
+                flat_type.template_arguments = InternList(type.template_arguments);
+                flat_type.kind = type.kind;
+                flat_type.is_const = type.is_const;
+                flat_type.is_builtin_type = type.is_builtin_type;
+                flat_type.is_unresolved = type.is_unresolved;
+                return flat_type;
+            }
+
+            uint32_t AddVariable(const Variable &variable)
+            {
+                FlatVariable flat_variable;
+                flat_variable.base = Base(variable);
+                flat_variable.type = Type(variable.type);
+                flat_variable.default_value = Intern(variable.default_value);
+                flat_variable.evaluated_value = variable.evaluated_value;
+                flat_variable.is_output = variable.is_output;
+                flat_.variables.push_back(flat_variable);
+                return CheckedIndex(flat_.variables.size() - 1);
+            }
+
+            // Only the parameters of one function are pushed in between, so they stay contiguous
+            FlatRange AddParameters(const std::vector<Variable> &parameters)
+            {
+                FlatRange range;
+                range.begin = CheckedIndex(flat_.variables.size());
+                for (auto &parameter : parameters)
+                {
+                    AddVariable(parameter);
+                }
+                range.end = CheckedIndex(flat_.variables.size());
+                return range;
+            }
+
+            uint32_t AddMemberFunction(const MemberFunction &function)
+            {
+                FlatMemberFunction flat_function;
+                flat_function.base = Base(function);
+                flat_function.return_type = Type(function.return_type);
+                flat_function.parameters = AddParameters(function.parameters);
+                flat_function.access_specifier = Intern(function.access_specifier);
+                flat_function.signature = Intern(function.signature);
+                flat_function.mangled_name = Intern(function.mangled_name);
+                flat_function.id = Intern(function.id);
+                flat_function.overridden_method = Intern(function.overridden_method);
+                flat_function.is_virtual = function.is_virtual;
+                flat_function.is_overriding = function.is_overriding;
+                flat_function.is_const = function.is_const;
+                flat_function.is_variadic = function.is_variadic;
+                flat_.member_functions.push_back(flat_function);
+                return CheckedIndex(flat_.member_functions.size() - 1);
+            }
+
+            uint32_t AddClazz(const Clazz &clazz)
+            {
+                FlatClazz flat_clazz;
+                flat_clazz.base = Base(clazz);
+
+                flat_clazz.constructors.begin = CheckedIndex(flat_.constructors.size());
+                for (auto &constructor : clazz.constructors)
+                {
+                    FlatConstructor flat_constructor;
+                    flat_constructor.base = Base(constructor);
+                    flat_constructor.parameters = AddParameters(constructor.parameters);
+                    flat_.constructors.push_back(flat_constructor);
+                }
+                flat_clazz.constructors.end = CheckedIndex(flat_.constructors.size());
+
+                flat_clazz.methods.begin = CheckedIndex(flat_.member_functions.size());
+                for (auto &method : clazz.methods)
+                {
+                    AddMemberFunction(method);
+                }
+                flat_clazz.methods.end = CheckedIndex(flat_.member_functions.size());
+
+                flat_clazz.member_variables.begin = CheckedIndex(flat_.member_variables.size());
+                for (auto &member_variable : clazz.member_variables)
+                {
+                    FlatMemberVariable flat_member_variable;
+                    flat_member_variable.base = Base(member_variable);
+                    flat_member_variable.type = Type(member_variable.type);
+                    flat_member_variable.access_specifier = Intern(member_variable.access_specifier);
+                    flat_member_variable.is_mutable = member_variable.is_mutable;
+                    flat_.member_variables.push_back(flat_member_variable);
+                }
+                flat_clazz.member_variables.end = CheckedIndex(flat_.member_variables.size());
+
+                flat_clazz.base_clazzs = InternList(clazz.base_clazzs);
+                flat_clazz.all_base_clazzs = InternList(clazz.all_base_clazzs);
+                flat_clazz.virtual_methods = InternList(clazz.virtual_methods);
+
+                flat_.clazzs.push_back(flat_clazz);
+                return CheckedIndex(flat_.clazzs.size() - 1);
+            }
+
+            FlatNode AddNode(const NodeType &node)
+            {
+                FlatNode flat_node;
+                flat_node.kind = static_cast<FlatNodeKind>(node.index());
+                std::visit([&](auto &&ele)
+                           {
+                               using T = std::decay_t<decltype(ele)>;
+                               if constexpr (std::is_same_v<T, IncludeDirective>)
+                               {
+                                   FlatIncludeDirective flat_include_directive;
+                                   flat_include_directive.base = Base(ele);
+                                   flat_include_directive.include_file_path = Intern(ele.include_file_path);
+                                   flat_.include_directives.push_back(flat_include_directive);
+                                   flat_node.index = CheckedIndex(flat_.include_directives.size() - 1);
+                               }
+                               else if constexpr (std::is_same_v<T, TypeAlias>)
+                               {
+                                   FlatTypeAlias flat_type_alias;
+                                   flat_type_alias.base = Base(ele);
+                                   flat_type_alias.underlying_type = Type(ele.underlyingType);
+                                   flat_.type_aliases.push_back(flat_type_alias);
+                                   flat_node.index = CheckedIndex(flat_.type_aliases.size() - 1);
+                               }
+                               else if constexpr (std::is_same_v<T, Clazz> || std::is_same_v<T, Struct>)
+                               {
+                                   flat_node.index = AddClazz(ele);
+                               }
+                               else if constexpr (std::is_same_v<T, Enumz>)
+                               {
+                                   FlatEnumz flat_enumz;
+                                   flat_enumz.base = Base(ele);
+                                   flat_enumz.enum_constants.begin = CheckedIndex(flat_.enum_constants.size());
+                                   for (auto &enum_constant : ele.enum_constants)
+                                   {
+                                       FlatEnumConstant flat_enum_constant;
+                                       flat_enum_constant.base = Base(enum_constant);
+                                       flat_enum_constant.value = Intern(enum_constant.value);
+                                       flat_enum_constant.evaluated_value = enum_constant.evaluated_value;
+                                       flat_.enum_constants.push_back(flat_enum_constant);
+                                   }
+                                   flat_enumz.enum_constants.end = CheckedIndex(flat_.enum_constants.size());
+                                   flat_.enums.push_back(flat_enumz);
+                                   flat_node.index = CheckedIndex(flat_.enums.size() - 1);
+                               }
+                               else if constexpr (std::is_same_v<T, MemberFunction>)
+                               {
+                                   flat_node.index = AddMemberFunction(ele);
+                               }
+                               else if constexpr (std::is_same_v<T, Variable>)
+                               {
+                                   flat_node.index = AddVariable(ele);
+                               } },
+                           node);
+                return flat_node;
+            }
+
+            void AddFile(const CXXFile &cxx_file)
+            {
+                FlatCXXFile flat_file;
+                flat_file.file_path = Intern(cxx_file.file_path);
+
+                // The nodes of one file are contiguous, their children are added to the other columns
+                flat_file.nodes.begin = CheckedIndex(flat_.nodes.size());
+                flat_.nodes.resize(flat_.nodes.size() + cxx_file.nodes.size());
+                for (size_t i = 0; i < cxx_file.nodes.size(); i++)
+                {
+                    flat_.nodes[flat_file.nodes.begin + i] = AddNode(cxx_file.nodes[i]);
+                }
+                flat_file.nodes.end = CheckedIndex(flat_.nodes.size());
+
+                flat_.cxx_files.push_back(flat_file);
+            }
+        };
+
+        std::string String(FlatString str) const
+        {
+            return std::string(Str(str));
+        }
+
+        std::vector<std::string> StringList(FlatRange range) const
+        {
+            std::vector<std::string> list;
+            list.reserve(range.size());
+            for (auto &str : Strings(range))
+            {
+                list.push_back(String(str));
+            }
+            return list;
+        }
+
+        void ToBaseNode(const FlatBaseNode &base, BaseNode &node) const
+        {
+            node.name = String(base.name);
+            node.namespaces = StringList(base.namespaces);
+            node.file_path = String(base.file_path);
+            node.parent_name = String(base.parent_name);
+            node.parent_full_scope_name = String(base.parent_full_scope_name);
+            node.attributes = StringList(base.attributes);
+            node.comment = String(base.comment);
+            node.source = String(base.source);
+            node.conditional_compilation_directives_infos = StringList(base.conditional_compilation_directives_infos);
+            node.fingerprint = String(base.fingerprint);
+        }
+
+        SimpleType ToSimpleType(const FlatSimpleType &flat_type) const
+        {
+            SimpleType type;
+            type.name = String(flat_type.name);
+            type.source = String(flat_type.source);
+            type.kind = flat_type.kind;
+            type.is_const = flat_type.is_const;
+            type.is_builtin_type = flat_type.is_builtin_type;
+            type.is_unresolved = flat_type.is_unresolved;
+            type.template_arguments = StringList(flat_type.template_arguments);
+            return type;
+        }
+
+        std::vector<Variable> ToParameters(FlatRange range) const
+        {
+            std::vector<Variable> parameters;
+            parameters.reserve(range.size());
+            for (auto &parameter : FlatSpan<FlatVariable>(variables, range))
+            {
+                parameters.push_back(ToVariable(parameter));
+            }
+            return parameters;
+        }
+
+        template <typename T>
+        void ToClazz(const FlatClazz &flat_clazz, T &clazz) const
+        {
+            ToBaseNode(flat_clazz.base, clazz);
+
+            clazz.constructors.reserve(flat_clazz.constructors.size());
+            for (auto &flat_constructor : Constructors(flat_clazz))
+            {
+                Constructor constructor;
+                ToBaseNode(flat_constructor.base, constructor);
+                constructor.parameters = ToParameters(flat_constructor.parameters);
+                clazz.constructors.push_back(std::move(constructor));
+            }
+
+            clazz.methods.reserve(flat_clazz.methods.size());
+            for (auto &method : Methods(flat_clazz))
+            {
+                clazz.methods.push_back(ToMemberFunction(method));
+            }
+
+            clazz.member_variables.reserve(flat_clazz.member_variables.size());
+            for (auto &flat_member_variable : MemberVariables(flat_clazz))
+            {
+                MemberVariable member_variable;
+                ToBaseNode(flat_member_variable.base, member_variable);
+                member_variable.type = ToSimpleType(flat_member_variable.type);
+                member_variable.is_mutable = flat_member_variable.is_mutable;
+                member_variable.access_specifier = String(flat_member_variable.access_specifier);
+                clazz.member_variables.push_back(std::move(member_variable));
+            }
+
+            clazz.base_clazzs = StringList(flat_clazz.base_clazzs);
+            clazz.all_base_clazzs = StringList(flat_clazz.all_base_clazzs);
+            clazz.virtual_methods = StringList(flat_clazz.virtual_methods);
+        }
+
+    public:
+        /// Build the flat store of `parse_result`, the `user_data` of the nodes is not kept.
+        static FlatParseResult FromParseResult(const ParseResult &parse_result)
+        {
+            FlatParseResult flat;
+            Builder builder(flat);
+            for (auto &cxx_file : parse_result.cxx_files)
+            {
+                builder.AddFile(cxx_file);
+            }
+            flat.ShrinkToFit();
+            return flat;
+        }
+
+        std::string_view Str(FlatString str) const
+        {
+            return std::string_view(strings.data() + str.offset, str.size);
+        }
+
+        FlatSpan<FlatString> Strings(FlatRange range) const
+        {
+            return FlatSpan<FlatString>(string_lists, range);
+        }
+
+        FlatSpan<FlatNode> Nodes(const FlatCXXFile &file) const
+        {
+            return FlatSpan<FlatNode>(nodes, file.nodes);
+        }
+
+        FlatSpan<FlatConstructor> Constructors(const FlatClazz &clazz) const
+        {
+            return FlatSpan<FlatConstructor>(constructors, clazz.constructors);
+        }
+
+        FlatSpan<FlatMemberFunction> Methods(const FlatClazz &clazz) const
+        {
+            return FlatSpan<FlatMemberFunction>(member_functions, clazz.methods);
+        }
+
+        FlatSpan<FlatMemberVariable> MemberVariables(const FlatClazz &clazz) const
+        {
+            return FlatSpan<FlatMemberVariable>(member_variables, clazz.member_variables);
+        }
+
+        FlatSpan<FlatVariable> Parameters(const FlatMemberFunction &function) const
+        {
+            return FlatSpan<FlatVariable>(variables, function.parameters);
+        }
+
+        FlatSpan<FlatVariable> Parameters(const FlatConstructor &constructor) const
+        {
+            return FlatSpan<FlatVariable>(variables, constructor.parameters);
+        }
+
+        FlatSpan<FlatEnumConstant> EnumConstants(const FlatEnumz &enumz) const
+        {
+            return FlatSpan<FlatEnumConstant>(enum_constants, enumz.enum_constants);
+        }
+
+        Variable ToVariable(const FlatVariable &flat_variable) const
+        {
+            Variable variable;
+            ToBaseNode(flat_variable.base, variable);
+            variable.type = ToSimpleType(flat_variable.type);
+            variable.default_value = String(flat_variable.default_value);
+            variable.evaluated_value = flat_variable.evaluated_value;
+            variable.is_output = flat_variable.is_output;
+            return variable;
+        }
+
+        MemberFunction ToMemberFunction(const FlatMemberFunction &flat_function) const
+        {
+            MemberFunction function;
+            ToBaseNode(flat_function.base, function);
+            function.is_virtual = flat_function.is_virtual;
+            function.return_type = ToSimpleType(flat_function.return_type);
+            function.parameters = ToParameters(flat_function.parameters);
+            function.access_specifier = String(flat_function.access_specifier);
+            function.is_overriding = flat_function.is_overriding;
+            function.is_const = flat_function.is_const;
+            function.signature = String(flat_function.signature);
+            function.is_variadic = flat_function.is_variadic;
+            function.mangled_name = String(flat_function.mangled_name);
+            function.id = String(flat_function.id);
+            function.overridden_method = String(flat_function.overridden_method);
+            return function;
+        }
+
+        /// The tree node of a top-level node.
+        NodeType ToNode(const FlatNode &flat_node) const
+        {
+            switch (flat_node.kind)
+            {
+            case FlatNodeKind::include_directive:
+            {
+                auto &flat_include_directive = include_directives[flat_node.index];
+                IncludeDirective include_directive;
+                ToBaseNode(flat_include_directive.base, include_directive);
+                include_directive.include_file_path = String(flat_include_directive.include_file_path);
+                return include_directive;
+            }
+            case FlatNodeKind::type_alias:
+            {
+                auto &flat_type_alias = type_aliases[flat_node.index];
+                TypeAlias type_alias;
+                ToBaseNode(flat_type_alias.base, type_alias);
+                type_alias.underlyingType = ToSimpleType(flat_type_alias.underlying_type);
+                return type_alias;
+            }
+            case FlatNodeKind::clazz:
+            {
+                Clazz clazz;
+                ToClazz(clazzs[flat_node.index], clazz);
+                return clazz;
+            }
+            case FlatNodeKind::structt:
+            {
+                Struct structt;
+                ToClazz(clazzs[flat_node.index], structt);
+                return structt;
+            }
+            case FlatNodeKind::enumz:
+            {
+                auto &flat_enumz = enums[flat_node.index];
+                Enumz enumz;
+                ToBaseNode(flat_enumz.base, enumz);
+                enumz.enum_constants.reserve(flat_enumz.enum_constants.size());
+                for (auto &flat_enum_constant : EnumConstants(flat_enumz))
+                {
+                    EnumConstant enum_constant;
+                    ToBaseNode(flat_enum_constant.base, enum_constant);
+                    enum_constant.value = String(flat_enum_constant.value);
+                    enum_constant.evaluated_value = flat_enum_constant.evaluated_value;
+                    enumz.enum_constants.push_back(std::move(enum_constant));
+                }
+                return enumz;
+            }
+            case FlatNodeKind::member_function:
+                return ToMemberFunction(member_functions[flat_node.index]);
+            case FlatNodeKind::variable:
+                return ToVariable(variables[flat_node.index]);
+            }
+            return NodeType();
+        }
+
+        /// The `CXXFile` at `index` of `cxx_files`, as it was in the `ParseResult`.
+        CXXFile MaterializeFile(size_t index) const
+        {
+            auto &flat_file = cxx_files[index];
+            CXXFile cxx_file;
+            cxx_file.file_path = String(flat_file.file_path);
+            cxx_file.nodes.reserve(flat_file.nodes.size());
+            for (auto &flat_node : Nodes(flat_file))
+            {
+                cxx_file.nodes.push_back(ToNode(flat_node));
+            }
+            return cxx_file;
+        }
+
+        /// Iterates the materialized `CXXFile`s, one at a time.
+        FlatCXXFileRange Files() const
+        {
+            return FlatCXXFileRange(this, cxx_files.size());
+        }
+
+        ParseResult ToParseResult() const
+        {
+            ParseResult parse_result;
+            parse_result.cxx_files.reserve(cxx_files.size());
+            for (size_t i = 0; i < cxx_files.size(); i++)
+            {
+                parse_result.cxx_files.push_back(MaterializeFile(i));
+            }
+            return parse_result;
+        }
+
+        void ShrinkToFit()
+        {
+            strings.shrink_to_fit();
+            string_lists.shrink_to_fit();
+            include_directives.shrink_to_fit();
+            type_aliases.shrink_to_fit();
+            clazzs.shrink_to_fit();
+            enums.shrink_to_fit();
+            enum_constants.shrink_to_fit();
+            constructors.shrink_to_fit();
+            member_functions.shrink_to_fit();
+            member_variables.shrink_to_fit();
+            variables.shrink_to_fit();
+            nodes.shrink_to_fit();
+            cxx_files.shrink_to_fit();
+        }
+
+        /// The heap and inline bytes held by the store.
+        size_t MemoryFootprint() const
+        {
+            return sizeof(FlatParseResult) + strings.capacity() +
+                   string_lists.capacity() * sizeof(FlatString) +
+                   include_directives.capacity() * sizeof(FlatIncludeDirective) +
+                   type_aliases.capacity() * sizeof(FlatTypeAlias) +
+                   clazzs.capacity() * sizeof(FlatClazz) +
+                   enums.capacity() * sizeof(FlatEnumz) +
+                   enum_constants.capacity() * sizeof(FlatEnumConstant) +
+                   constructors.capacity() * sizeof(FlatConstructor) +
+                   member_functions.capacity() * sizeof(FlatMemberFunction) +
+                   member_variables.capacity() * sizeof(FlatMemberVariable) +
+                   variables.capacity() * sizeof(FlatVariable) +
+                   nodes.capacity() * sizeof(FlatNode) +
+                   cxx_files.capacity() * sizeof(FlatCXXFile);
+        }
+    };
+
+    inline FlatCXXFileIterator::reference FlatCXXFileIterator::operator*() const
+    {
+        if (!is_materialized_)
+        {
+            file_ = flat_parse_result_->MaterializeFile(index_);
+            is_materialized_ = true;
+        }
+        return file_;
+    }
+
+    /// \exclude
+    namespace detail
+    {
+        inline size_t StringFootprint(const std::string &str)
+        {
+            // The short strings are stored inline
+            return str.capacity() > std::string().capacity() ? str.capacity() + 1 : 0;
+        }
+
+        inline size_t StringListFootprint(const std::vector<std::string> &list)
+        {
+            size_t size = list.capacity() * sizeof(std::string);
+            for (auto &str : list)
+            {
+                size += StringFootprint(str);
+            }
+            return size;
+        }
+
+        inline size_t BaseNodeFootprint(const BaseNode &node)
+        {
+            return StringFootprint(node.name) + StringListFootprint(node.namespaces) + StringFootprint(node.file_path) +
+                   StringFootprint(node.parent_name) + StringFootprint(node.parent_full_scope_name) +
+                   StringListFootprint(node.attributes) + StringFootprint(node.comment) + StringFootprint(node.source) +
+                   StringListFootprint(node.conditional_compilation_directives_infos) + StringFootprint(node.fingerprint);
+        }
+
+        inline size_t SimpleTypeFootprint(const SimpleType &type)
+        {
+            return StringFootprint(type.name) + StringFootprint(type.source) + StringListFootprint(type.template_arguments);
+        }
+
+        inline size_t VariablesFootprint(const std::vector<Variable> &variables)
+        {
+            size_t size = variables.capacity() * sizeof(Variable);
+            for (auto &variable : variables)
+            {
+                size += BaseNodeFootprint(variable) + SimpleTypeFootprint(variable.type) + StringFootprint(variable.default_value);
+            }
+            return size;
+        }
+
+        inline size_t MemberFunctionFootprint(const MemberFunction &function)
+        {
+            return BaseNodeFootprint(function) + SimpleTypeFootprint(function.return_type) +
+                   VariablesFootprint(function.parameters) + StringFootprint(function.access_specifier) +
+                   StringFootprint(function.signature) + StringFootprint(function.mangled_name) +
+                   StringFootprint(function.id) + StringFootprint(function.overridden_method);
+        }
+
+        inline size_t ClazzFootprint(const Clazz &clazz)
+        {
+            size_t size = BaseNodeFootprint(clazz) + StringListFootprint(clazz.base_clazzs) +
+                          StringListFootprint(clazz.all_base_clazzs) + StringListFootprint(clazz.virtual_methods);
+            size += clazz.constructors.capacity() * sizeof(Constructor);
+            for (auto &constructor : clazz.constructors)
+            {
+                size += BaseNodeFootprint(constructor) + VariablesFootprint(constructor.parameters);
+            }
+            size += clazz.methods.capacity() * sizeof(MemberFunction);
+            for (auto &method : clazz.methods)
+            {
+                size += MemberFunctionFootprint(method);
+            }
+            size += clazz.member_variables.capacity() * sizeof(MemberVariable);
+            for (auto &member_variable : clazz.member_variables)
+            {
+                size += BaseNodeFootprint(member_variable) + SimpleTypeFootprint(member_variable.type) +
+                        StringFootprint(member_variable.access_specifier);
+            }
+            return size;
+        }
+    }
+
+    /// The approximate heap and inline bytes held by the tree of `parse_result`, to compare with
+    /// `FlatParseResult::MemoryFootprint`. The allocator overhead and the `user_data` are not counted.
+    inline size_t MemoryFootprint(const ParseResult &parse_result)
+    {
+        size_t size = sizeof(ParseResult) + parse_result.cxx_files.capacity() * sizeof(CXXFile);
+        for (auto &cxx_file : parse_result.cxx_files)
+        {
+            size += detail::StringFootprint(cxx_file.file_path) + cxx_file.nodes.capacity() * sizeof(NodeType);
+            for (auto &node : cxx_file.nodes)
+            {
+                size += std::visit([](auto &&ele) -> size_t
+                                   {
+                                       using T = std::decay_t<decltype(ele)>;
+                                       if constexpr (std::is_same_v<T, IncludeDirective>)
+                                       {
+                                           return detail::BaseNodeFootprint(ele) + detail::StringFootprint(ele.include_file_path);
+                                       }
+                                       else if constexpr (std::is_same_v<T, TypeAlias>)
+                                       {
+                                           return detail::BaseNodeFootprint(ele) + detail::SimpleTypeFootprint(ele.underlyingType);
+                                       }
+                                       else if constexpr (std::is_same_v<T, Clazz> || std::is_same_v<T, Struct>)
+                                       {
+                                           return detail::ClazzFootprint(ele);
+                                       }
+                                       else if constexpr (std::is_same_v<T, Enumz>)
+                                       {
+                                           size_t enum_size = detail::BaseNodeFootprint(ele) + ele.enum_constants.capacity() * sizeof(EnumConstant);
+                                           for (auto &enum_constant : ele.enum_constants)
+                                           {
+                                               enum_size += detail::BaseNodeFootprint(enum_constant) + detail::StringFootprint(enum_constant.value);
+                                           }
+                                           return enum_size;
+                                       }
+                                       else if constexpr (std::is_same_v<T, MemberFunction>)
+                                       {
+                                           return detail::MemberFunctionFootprint(ele);
+                                       }
+                                       else
+                                       {
+                                           return detail::BaseNodeFootprint(ele) + detail::SimpleTypeFootprint(ele.type) +
+                                                  detail::StringFootprint(ele.default_value);
+                                       } },
+                                   node);
+            }
+        }
+        return size;
+    }
+}
+
+#endif // TERRA_FLAT_H_
@@ -1,6 +1,24 @@
 #ifndef terra_GENERATOR_H_
 #define terra_GENERATOR_H_
 
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "terra_ast_index.hpp"
+#include "terra_flat.hpp"
+#include "terra_parser.hpp"
+#include "terra_render_rope.hpp"
+#include "terra_utils.hpp"
+
 namespace terra
 {
 
@@ -10,12 +28,94 @@ namespace terra
         virtual ~Generator() = default;
 
         virtual bool Generate(const ParseResult &parse_result) = 0;
+
+        /// Generate from the flat store, converts all of it back to a `ParseResult` by default,
+        /// override it to materialize one file at a time instead.
+        virtual bool Generate(const FlatParseResult &flat_parse_result)
+        {
+            return Generate(flat_parse_result.ToParseResult());
+        }
     };
 
+    /// Renders the `CXXFile`s of a `ParseResult` to the output files.
+    ///
+    /// Thread-safety contract: if `IsConcurrentRenderSupported()` returns true, `Render` (and so `ShouldRender`,
+    /// all the `Render*` hooks and `SaveRenderBlocks`) can be called concurrently for different files,
+    /// so they must not modify any state shared between files without synchronization.
+    /// `SetParseResult`, `OnRenderFilesStart`, `OnRenderFilesEnd` and `FormatCodes` are always called on the generator thread,
+    /// before and after all the `Render` calls.
+    ///
+    /// A `FlatParseResult` is converted back to a `ParseResult` before rendering, unless `SupportsFlatRender()` returns
+    /// true: the files are then materialized one at a time and the `ParseResult` passed to the hooks is empty,
+    /// use `GetFlatParseResult()` to look up the other files.
+    ///
+    /// Use `GetAstIndex()` in the hooks to look nodes up by full name, mangled name, attribute, file or kind instead
+    /// of scanning `GetParseResult()`. It indexes the same `ParseResult`, so there is none in a flat render.
+    ///
+    /// The member blocks passed to `RenderClass`, `RenderStruct` and `RenderEnum` are kept alive until the file is
+    /// assembled, so the returned block can reference them with `RenderedBlock::rope.AppendRef(...)` instead of
+    /// copying their text, the file is then copied once into a buffer of its final size.
+    ///
+    /// Unchanged outputs are not rewritten: the hashes of the rendered content and of the (formatted) file on disk are
+    /// kept in the render stamps file given by the generator, a file is only written and formatted again if either differs.
+    /// Without the stamps, a file is only skipped if it holds exactly the rendered content, i.e., it is not formatted.
     class SyntaxRender
     {
     private:
-        ParseResult parse_result_;
+        const ParseResult *parse_result_ = nullptr;
+        const FlatParseResult *flat_parse_result_ = nullptr;
+        const AstIndex *ast_index_ = nullptr;
+
+        typedef struct RenderStamp
+        {
+            std::string rendered_hash;
+            std::string output_hash;
+        } RenderStamp;
+
+        // Keyed by the output file path relative to the output dir
+        std::map<std::string, RenderStamp> render_stamps_;
+        // The files written in this run, keyed by the full path, with the hash of their rendered content
+        std::map<std::string, std::string> changed_files_;
+        // The stamp keys of the files rendered in this run, changed or not, the other stamps are stale
+        std::set<std::string> rendered_stamp_keys_;
+        // Guards `changed_files_` and `rendered_stamp_keys_`
+        std::mutex changed_files_mutex_;
+
+        static std::string ReadFileContent(const std::string &path)
+        {
+            std::ifstream is(path, std::ifstream::binary);
+            if (!is.is_open())
+            {
+                return "";
+            }
+            std::ostringstream content;
+            content << is.rdbuf();
+            return content.str();
+        }
+
+        static std::string StampKey(const std::string &output_dir, const std::string &full_path)
+        {
+            return std::filesystem::path(full_path).lexically_relative(output_dir).generic_string();
+        }
+
+        bool IsRenderedFileUpToDate(const std::string &output_dir, const std::string &full_path, const std::string &rendered_hash,
+                                    const std::string &render_contents)
+        {
+            if (!std::filesystem::exists(full_path))
+            {
+                return false;
+            }
+
+            std::string output_hash = HashContent(ReadFileContent(full_path));
+            auto it = render_stamps_.find(StampKey(output_dir, full_path));
+            if (it != render_stamps_.end())
+            {
+                return it->second.rendered_hash == rendered_hash && it->second.output_hash == output_hash;
+            }
+
+            // No stamp yet, it is only up to date if nothing changed it after rendering.
+            return output_hash == HashContent(render_contents);
+        }
 
     public:
         // template <typename T>
@@ -24,20 +124,179 @@ namespace terra
         public:
             // T original_node;
             std::string rendered_content;
+            /// Appended after `rendered_content`, to build a block from the nested blocks without copying them
+            RenderRope rope;
+
+            size_t size() const
+            {
+                return rendered_content.size() + rope.size();
+            }
+
+            bool empty() const
+            {
+                return rendered_content.empty() && rope.empty();
+            }
+
+            void AppendTo(std::string &output) const
+            {
+                output.append(rendered_content);
+                rope.AppendTo(output);
+            }
+
+            std::string ToString() const
+            {
+                std::string output;
+                output.reserve(size());
+                AppendTo(output);
+                return output;
+            }
         };
 
         SyntaxRender() {}
-        ~SyntaxRender() {}
+        virtual ~SyntaxRender() {}
 
-        virtual void SetParseResult(ParseResult parse_result)
+        /// The `parse_result` is shared by reference, it must outlive the rendering.
+        virtual void SetParseResult(const ParseResult &parse_result)
         {
-            parse_result_ = parse_result;
+            parse_result_ = &parse_result;
+        }
+
+        /// Drops the `ParseResult` set by `SetParseResult` when the rendering is done, as it may not outlive the render.
+        void ResetParseResult()
+        {
+            parse_result_ = nullptr;
+        }
+
+        /// The `flat_parse_result` is shared by reference, it must outlive the rendering.
+        /// Called before `SetParseResult` when rendering a `FlatParseResult`.
+        virtual void SetFlatParseResult(const FlatParseResult *flat_parse_result)
+        {
+            flat_parse_result_ = flat_parse_result;
+        }
+
+        /// The `ast_index` is shared by reference, it must outlive the rendering.
+        /// Called after `SetParseResult` with the index of the same `ParseResult`.
+        void SetAstIndex(const AstIndex *ast_index)
+        {
+            ast_index_ = ast_index;
+        }
+
+        /// Whether `Render` can be called concurrently for different files, see the thread-safety contract above.
+        virtual bool IsConcurrentRenderSupported() const
+        {
+            return false;
+        }
+
+        /// Whether a `FlatParseResult` can be rendered one materialized file at a time, i.e., the hooks do not use
+        /// `GetParseResult()`, the `parse_result` argument or `GetAstIndex()`, see the flat render above.
+        virtual bool SupportsFlatRender() const
+        {
+            return false;
         }
 
         virtual void OnRenderFilesStart(const ParseResult &parse_result, const std::string &output_dir) {}
 
         virtual void OnRenderFilesEnd(const ParseResult &parse_result, const std::string &output_dir) {}
 
+        /// Load the render stamps of the previous run from `render_stamps_path`, called before `OnRenderFilesStart`.
+        /// Nothing is loaded if it is empty. A malformed stamp file or entry is ignored, the files are then rendered again.
+        void LoadRenderStamps(const std::string &render_stamps_path)
+        {
+            render_stamps_.clear();
+            changed_files_.clear();
+            rendered_stamp_keys_.clear();
+
+            if (render_stamps_path.empty())
+            {
+                return;
+            }
+
+            std::string content = ReadFileContent(render_stamps_path);
+            nlohmann::json stamps_json = nlohmann::json::parse(content, nullptr, false);
+            if (!stamps_json.is_object())
+            {
+                return;
+            }
+
+            for (auto &it : stamps_json.items())
+            {
+                if (!it.value().is_object())
+                {
+                    continue;
+                }
+                auto rendered = it.value().find("rendered");
+                auto output = it.value().find("output");
+                if (rendered == it.value().end() || !rendered->is_string() || output == it.value().end() || !output->is_string())
+                {
+                    continue;
+                }
+
+                RenderStamp stamp;
+                stamp.rendered_hash = rendered->get<std::string>();
+                stamp.output_hash = output->get<std::string>();
+                render_stamps_[it.key()] = stamp;
+            }
+        }
+
+        /// Format all the files written in this run with one `FormatCodes` call, then save the render stamps to
+        /// `render_stamps_path` if it is not empty, called after `OnRenderFilesEnd`.
+        /// The stamps of the files which are not rendered in this run are dropped.
+        void FlushChangedFiles(const std::string &output_dir, const std::string &render_stamps_path)
+        {
+            std::vector<std::string> file_paths;
+            file_paths.reserve(changed_files_.size());
+            for (auto &it : changed_files_)
+            {
+                file_paths.push_back(it.first);
+            }
+
+            if (!file_paths.empty())
+            {
+                FormatCodes(file_paths);
+            }
+
+            for (auto &it : changed_files_)
+            {
+                RenderStamp stamp;
+                stamp.rendered_hash = it.second;
+                stamp.output_hash = HashContent(ReadFileContent(it.first));
+                render_stamps_[StampKey(output_dir, it.first)] = stamp;
+            }
+
+            for (auto it = render_stamps_.begin(); it != render_stamps_.end();)
+            {
+                if (rendered_stamp_keys_.count(it->first) == 0)
+                {
+                    it = render_stamps_.erase(it);
+                }
+                else
+                {
+                    it++;
+                }
+            }
+
+            if (!render_stamps_path.empty())
+            {
+                nlohmann::json stamps_json = nlohmann::json::object();
+                for (auto &it : render_stamps_)
+                {
+                    stamps_json[it.first] = {{"rendered", it.second.rendered_hash}, {"output", it.second.output_hash}};
+                }
+
+                std::filesystem::path stamps_dir = std::filesystem::path(render_stamps_path).parent_path();
+                if (!stamps_dir.empty())
+                {
+                    std::filesystem::create_directories(stamps_dir);
+                }
+                std::ofstream os(render_stamps_path, std::ofstream::trunc);
+                os << stamps_json.dump(2);
+            }
+
+            std::cout << "Rendered " << changed_files_.size() << " changed file(s) to " << output_dir << std::endl;
+            changed_files_.clear();
+            rendered_stamp_keys_.clear();
+        }
+
         virtual void Render(const ParseResult &parse_result, const CXXFile &file, const std::string &output_dir)
         {
 
@@ -47,14 +306,15 @@ namespace terra
             }
 
             std::vector<SyntaxRender::RenderedBlock> file_render_blocks;
+            // The member blocks may be referenced by the class, struct and enum blocks until the file is joined
+            std::deque<std::vector<SyntaxRender::RenderedBlock>> members_blocks;
 
             std::vector<IncludeDirective> include_directives;
             for (auto &node : file.nodes)
             {
                 if (std::holds_alternative<IncludeDirective>(node))
                 {
-                    IncludeDirective include_directive = std::get<IncludeDirective>(node);
-                    include_directives.push_back(include_directive);
+                    include_directives.push_back(std::get<IncludeDirective>(node));
                 }
                 else
                 {
@@ -73,8 +333,9 @@ namespace terra
                 }
                 else if (std::holds_alternative<Clazz>(node))
                 {
-                    std::vector<SyntaxRender::RenderedBlock> class_members_block;
-                    Clazz clazz = std::get<Clazz>(node);
+                    std::vector<SyntaxRender::RenderedBlock> &class_members_block = members_blocks.emplace_back();
+                    const Clazz &clazz = std::get<Clazz>(node);
+                    class_members_block.reserve(clazz.constructors.size() + clazz.member_variables.size() + clazz.methods.size());
 
                     for (auto &constructor : clazz.constructors)
                     {
@@ -95,8 +356,9 @@ namespace terra
                 }
                 else if (std::holds_alternative<Struct>(node))
                 {
-                    std::vector<SyntaxRender::RenderedBlock> class_members_block;
-                    Struct structt = std::get<Struct>(node);
+                    std::vector<SyntaxRender::RenderedBlock> &class_members_block = members_blocks.emplace_back();
+                    const Struct &structt = std::get<Struct>(node);
+                    class_members_block.reserve(structt.constructors.size() + structt.member_variables.size() + structt.methods.size());
 
                     for (auto &constructor : structt.constructors)
                     {
@@ -117,8 +379,9 @@ namespace terra
                 }
                 else if (std::holds_alternative<Enumz>(node))
                 {
-                    std::vector<SyntaxRender::RenderedBlock> enum_consts_block;
-                    Enumz enumz = std::get<Enumz>(node);
+                    std::vector<SyntaxRender::RenderedBlock> &enum_consts_block = members_blocks.emplace_back();
+                    const Enumz &enumz = std::get<Enumz>(node);
+                    enum_consts_block.reserve(enumz.enum_constants.size());
 
                     for (auto &enum_const : enumz.enum_constants)
                     {
@@ -139,38 +402,79 @@ namespace terra
 
             file_render_blocks.push_back(RenderFileEnd(file));
 
-            std::string file_contents = "";
-            int i = 0;
-            for (auto &block : file_render_blocks)
-            {
-                ++i;
-                if (!block.rendered_content.empty()) {
-                    file_contents += block.rendered_content;
-                    if (i != file_render_blocks.size())
-                        file_contents += "\n";
-                }
-            }
+            std::string file_contents = JoinRenderedBlocks(file_render_blocks);
 
             std::filesystem::path outdir(output_dir);
-            std::filesystem::path outfile(RenderedFileName(file.file_path).rendered_content);
+            std::filesystem::path outfile(RenderedFileName(file.file_path).ToString());
             std::filesystem::path full_path = outdir / outfile;
 
-            std::string parent_path = full_path.parent_path().u8string();
+            // `create_directories` reports an existing directory as success, so it is safe when files are rendered concurrently
+            std::error_code ec;
+            std::filesystem::create_directories(full_path.parent_path(), ec);
+
+            {
+                std::lock_guard<std::mutex> lock(changed_files_mutex_);
+                rendered_stamp_keys_.insert(StampKey(output_dir, full_path.string()));
+            }
 
-            if (!std::filesystem::exists(parent_path))
-            {                                                   // Check if src folder exists
-                std::filesystem::create_directory(parent_path); // create src folder
+            std::string rendered_hash = HashContent(file_contents);
+            if (IsRenderedFileUpToDate(output_dir, full_path.string(), rendered_hash, file_contents))
+            {
+                return;
             }
 
             SaveRenderBlocks(output_dir, full_path.c_str(), file_contents);
 
-            FormatCode(full_path.c_str());
+            std::lock_guard<std::mutex> lock(changed_files_mutex_);
+            changed_files_[full_path.string()] = rendered_hash;
         }
 
     protected:
         const ParseResult &GetParseResult()
         {
-            return parse_result_;
+            return *parse_result_;
+        }
+
+        /// The indexes over `GetParseResult()`, built once before the rendering starts.
+        /// Throws `std::logic_error` in a flat render, which has no index.
+        const AstIndex &GetAstIndex()
+        {
+            if (ast_index_ == nullptr)
+            {
+                throw std::logic_error("There is no AstIndex in a flat render, use GetFlatParseResult()");
+            }
+            return *ast_index_;
+        }
+
+        /// The rendered `FlatParseResult` in a flat render, or nullptr.
+        const FlatParseResult *GetFlatParseResult()
+        {
+            return flat_parse_result_;
+        }
+
+        /// Joins the non-empty blocks with "\n" into a buffer sized up front.
+        static std::string JoinRenderedBlocks(const std::vector<RenderedBlock> &blocks)
+        {
+            size_t total_size = 0;
+            for (auto &block : blocks)
+            {
+                total_size += block.size() + 1;
+            }
+
+            std::string contents;
+            contents.reserve(total_size);
+            for (size_t i = 0; i < blocks.size(); i++)
+            {
+                if (!blocks[i].empty())
+                {
+                    blocks[i].AppendTo(contents);
+                    if (i + 1 != blocks.size())
+                    {
+                        contents.push_back('\n');
+                    }
+                }
+            }
+            return contents;
         }
 
         virtual bool ShouldRender(const CXXFile &file)
@@ -254,6 +558,16 @@ namespace terra
 
         virtual void FormatCode(const std::string &file_path) {}
 
+        /// Format the files written in this run (sorted by path), override it to run the formatter once for all of them,
+        /// e.g., `clang-format -i <file_paths...>`. Calls `FormatCode` for each file by default.
+        virtual void FormatCodes(const std::vector<std::string> &file_paths)
+        {
+            for (auto &file_path : file_paths)
+            {
+                FormatCode(file_path);
+            }
+        }
+
         virtual void SaveRenderBlocks(const std::string &output_dir, const std::string &full_path, const std::string &render_contents)
         {
             std::ofstream fileSink;
@@ -263,6 +577,23 @@ namespace terra
         }
     };
 
+    typedef std::function<std::unique_ptr<SyntaxRender>()> SyntaxRenderFactory;
+
+    /// The `SyntaxRender`s which can be chosen by name, e.g., by the `--render` option of `cppast_backend`.
+    inline std::map<std::string, SyntaxRenderFactory> &SyntaxRenderFactories()
+    {
+        static std::map<std::string, SyntaxRenderFactory> factories;
+        return factories;
+    }
+
+    /// Makes the `SyntaxRender` created by `factory` available as `name`, returns true so that it can initialize
+    /// a static variable, e.g., `static bool registered = RegisterSyntaxRender("dart", ...);`.
+    inline bool RegisterSyntaxRender(const std::string &name, SyntaxRenderFactory factory)
+    {
+        SyntaxRenderFactories()[name] = std::move(factory);
+        return true;
+    }
+
 }
 
 #endif // terra_GENERATOR_H_
\ No newline at end of file
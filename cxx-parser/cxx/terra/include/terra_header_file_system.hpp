@@ -0,0 +1,267 @@
+#ifndef terra_HEADER_FILE_SYSTEM_H_
+#define terra_HEADER_FILE_SYSTEM_H_
+
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace terra
+{
+
+    /// The headers reachable from the parsed files, read once per run, so that the libclang parse of every
+    /// translation unit gets them from memory instead of re-reading them from disk, see `RootParser`.
+    ///
+    /// The `#include`s are resolved the way clang does, a quoted include relative to the including file first,
+    /// then against the include dirs in order. The include dirs which do not exist are dropped once,
+    /// and every candidate path is checked once, so a header that is missing from a dir, e.g., a system header
+    /// that is left to libclang, is not looked up there again.
+    ///
+    /// The `#include`s are followed whatever their `#if`s, a header which ends up unused is harmless,
+    /// as the content of every header is the one on disk.
+    class HeaderFileSystem
+    {
+    public:
+        struct File
+        {
+            /// `<include dir>/<name>` as clang resolves it
+            std::string path;
+            std::string content;
+            /// The `File`s included by this one
+            std::vector<const File *> includes;
+        };
+
+    private:
+        std::vector<std::string> include_dirs_;
+        std::unordered_map<std::string, std::unique_ptr<File>> files_;
+        /// Whether a candidate path is a regular file
+        std::unordered_map<std::string, bool> exists_;
+        /// `<including dir for a quoted include>\n<name>` to the resolved path, empty if not found
+        std::unordered_map<std::string, std::string> resolved_;
+
+        static std::string Normalize(const std::string &path)
+        {
+            return std::filesystem::path(path).lexically_normal().string();
+        }
+
+        static std::string JoinPath(const std::string &dir, std::string_view name)
+        {
+            if (dir.empty())
+            {
+                return std::string(name);
+            }
+            std::string path = dir;
+            if (path.back() != '/')
+            {
+                path.push_back('/');
+            }
+            path.append(name);
+            return path;
+        }
+
+        /// The names of the `#include` and `#include_next` directives, with whether they are quoted
+        static std::vector<std::pair<std::string_view, bool>> ScanIncludes(std::string_view content)
+        {
+            std::vector<std::pair<std::string_view, bool>> includes;
+            size_t pos = 0;
+            while (pos < content.size())
+            {
+                size_t line_end = content.find('\n', pos);
+                if (line_end == std::string_view::npos)
+                {
+                    line_end = content.size();
+                }
+                std::string_view line = content.substr(pos, line_end - pos);
+                pos = line_end + 1;
+
+                size_t i = line.find_first_not_of(" \t");
+                if (i == std::string_view::npos || line[i] != '#')
+                {
+                    continue;
+                }
+                i = line.find_first_not_of(" \t", i + 1);
+                if (i == std::string_view::npos || line.compare(i, 7, "include") != 0)
+                {
+                    continue;
+                }
+                i += 7;
+                if (line.compare(i, 5, "_next") == 0)
+                {
+                    i += 5;
+                }
+                i = line.find_first_not_of(" \t", i);
+                if (i == std::string_view::npos || (line[i] != '"' && line[i] != '<'))
+                {
+                    // A macro include can not be resolved without preprocessing
+                    continue;
+                }
+                bool is_quoted = line[i] == '"';
+                size_t name_end = line.find(is_quoted ? '"' : '>', i + 1);
+                if (name_end == std::string_view::npos || name_end == i + 1)
+                {
+                    continue;
+                }
+                includes.emplace_back(line.substr(i + 1, name_end - i - 1), is_quoted);
+            }
+            return includes;
+        }
+
+        bool Exists(const std::string &path)
+        {
+            auto found = exists_.find(path);
+            if (found != exists_.end())
+            {
+                return found->second;
+            }
+            std::error_code ec;
+            bool exists = std::filesystem::is_regular_file(path, ec);
+            exists_.emplace(path, exists);
+            return exists;
+        }
+
+        std::string Resolve(const std::string &including_dir, std::string_view name, bool is_quoted)
+        {
+            std::string key = (is_quoted ? including_dir : std::string()) + "\n" + std::string(name);
+            auto found = resolved_.find(key);
+            if (found != resolved_.end())
+            {
+                return found->second;
+            }
+
+            std::string path;
+            if (std::filesystem::path(name).is_absolute())
+            {
+                if (Exists(std::string(name)))
+                {
+                    path = std::string(name);
+                }
+            }
+            else
+            {
+                if (is_quoted && Exists(JoinPath(including_dir, name)))
+                {
+                    path = JoinPath(including_dir, name);
+                }
+                for (size_t i = 0; path.empty() && i < include_dirs_.size(); i++)
+                {
+                    if (Exists(JoinPath(include_dirs_[i], name)))
+                    {
+                        path = JoinPath(include_dirs_[i], name);
+                    }
+                }
+            }
+            resolved_.emplace(std::move(key), path);
+            return path;
+        }
+
+        /// Reads the file and the files it includes, `nullptr` if it can not be read
+        File *Load(const std::string &path)
+        {
+            std::string key = Normalize(path);
+            auto found = files_.find(key);
+            if (found != files_.end())
+            {
+                return found->second.get();
+            }
+
+            std::ifstream is(path, std::ios::binary);
+            if (!is)
+            {
+                return nullptr;
+            }
+            std::ostringstream content;
+            content << is.rdbuf();
+
+            File *file = (files_[key] = std::make_unique<File>()).get();
+            file->path = path;
+            file->content = content.str();
+
+            std::string including_dir = std::filesystem::path(path).parent_path().string();
+            for (auto &include : ScanIncludes(file->content))
+            {
+                std::string include_path = Resolve(including_dir, include.first, include.second);
+                if (include_path.empty())
+                {
+                    continue;
+                }
+                File *include_file = Load(include_path);
+                if (include_file != nullptr)
+                {
+                    file->includes.push_back(include_file);
+                }
+            }
+            return file;
+        }
+
+    public:
+        /// Reads the headers reachable from `parse_files`, resolved against `include_header_dirs`.
+        HeaderFileSystem(const std::vector<std::string> &include_header_dirs,
+                         const std::vector<std::string> &parse_files)
+        {
+            for (auto &dir : include_header_dirs)
+            {
+                std::error_code ec;
+                if (std::filesystem::is_directory(dir, ec))
+                {
+                    include_dirs_.push_back(dir);
+                }
+            }
+            for (auto &file : parse_files)
+            {
+                Load(file);
+            }
+        }
+
+        HeaderFileSystem(const HeaderFileSystem &) = delete;
+        HeaderFileSystem &operator=(const HeaderFileSystem &) = delete;
+
+        /// The include dirs which exist, in their order.
+        const std::vector<std::string> &IncludeDirs() const
+        {
+            return include_dirs_;
+        }
+
+        /// The headers included by `parse_file`, directly or indirectly, without `parse_file` itself.
+        std::vector<const File *> Reachable(const std::string &parse_file) const
+        {
+            std::vector<const File *> reachable;
+            auto found = files_.find(Normalize(parse_file));
+            if (found == files_.end())
+            {
+                return reachable;
+            }
+
+            const File *root = found->second.get();
+            std::unordered_set<const File *> seen{root};
+            std::vector<const File *> pending{root};
+            while (!pending.empty())
+            {
+                const File *file = pending.back();
+                pending.pop_back();
+                for (auto include : file->includes)
+                {
+                    if (seen.insert(include).second)
+                    {
+                        reachable.push_back(include);
+                        pending.push_back(include);
+                    }
+                }
+            }
+            return reachable;
+        }
+
+        size_t FileCount() const
+        {
+            return files_.size();
+        }
+    };
+}
+
+#endif // terra_HEADER_FILE_SYSTEM_H_
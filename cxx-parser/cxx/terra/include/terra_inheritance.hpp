@@ -0,0 +1,297 @@
+#ifndef terra_INHERITANCE_H_
+#define terra_INHERITANCE_H_
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include "terra_node.hpp"
+#include "terra_parser.hpp"
+#include "terra_pass.hpp"
+#include "terra_utils.hpp"
+
+namespace terra
+{
+
+    /// Resolves the `base_clazzs` of every class and struct to their definitions across all the parsed files, and fills in:
+    /// - `MemberFunction::id`, `<class full name>::<name><signature>`, e.g., `agora::rtc::IRtcEngine::release(bool)`.
+    /// - `Clazz::all_base_clazzs`, the full names of the direct and indirect bases, depth-first in declaration order.
+    ///   A base that can not be resolved is kept as written, without its own bases.
+    /// - `Clazz::virtual_methods`, the `id`s of the final overriders of all the virtual methods, including
+    ///   the inherited ones, in vtable order: the first base's methods, the class's own virtual methods which do not
+    ///   override one of them, then the other bases' methods which are not in the table yet.
+    /// - `MemberFunction::overridden_method`, the `id` of the base class method that a method overrides.
+    ///
+    /// A method overrides the virtual method of a base with the same name and `signature`,
+    /// whether or not it is marked `override`.
+    class InheritancePass : public Pass
+    {
+    private:
+        struct Slot
+        {
+            /// `<name><signature>`, which is the same for a method and its overriders
+            std::string key;
+            std::string method_id;
+        };
+
+        struct ClassInfo
+        {
+            Clazz *clazz;
+            std::vector<std::string> scope;
+            std::string full_name;
+            bool is_resolved = false;
+            bool is_resolving = false;
+            /// The resolved `base_clazzs`
+            std::vector<ClassInfo *> bases;
+            /// The `base_clazzs` as written, `nullptr` for the unresolved ones
+            std::vector<std::pair<std::string, ClassInfo *>> written_bases;
+            std::vector<Slot> slots;
+        };
+
+        std::vector<ClassInfo> classes_;
+        std::vector<MemberFunction *> functions_;
+
+        static std::vector<std::string> ScopeOf(const BaseNode &node)
+        {
+            return node.parent_full_scope_name.empty() ? node.namespaces : Split(node.parent_full_scope_name, "::");
+        }
+
+        static std::string Join(const std::vector<std::string> &scope, const std::string &name)
+        {
+            std::string full_name = JoinToString(scope, "::");
+            return full_name.empty() ? name : full_name + "::" + name;
+        }
+
+        static std::string MethodKey(const MemberFunction &method)
+        {
+            return method.name + method.signature;
+        }
+
+        // `::ns::Base<int>` is looked up as `ns::Base`
+        static std::string LookupName(const std::string &base_name)
+        {
+            std::string name = base_name.substr(0, base_name.find('<'));
+            if (name.rfind("::", 0) == 0)
+            {
+                name.erase(0, 2);
+            }
+            return std::string(trim(name));
+        }
+
+        // The definitions win over the forward declarations, which have no members or bases
+        static bool IsBetterDefinition(const Clazz &candidate, const Clazz &current)
+        {
+            auto is_empty = [](const Clazz &clazz)
+            {
+                return clazz.methods.empty() && clazz.member_variables.empty() && clazz.constructors.empty() &&
+                       clazz.base_clazzs.empty();
+            };
+            return is_empty(current) && !is_empty(candidate);
+        }
+
+        // A base name is looked up from the scope of the derived class outwards, a fully qualified one only globally
+        ClassInfo *FindClass(const std::unordered_map<std::string, ClassInfo *> &classes_by_name,
+                             const ClassInfo &derived, const std::string &base_name) const
+        {
+            std::string name = LookupName(base_name);
+            std::vector<std::string> scope;
+            if (trim(base_name).rfind("::", 0) != 0)
+            {
+                scope = derived.scope;
+            }
+            while (true)
+            {
+                auto found = classes_by_name.find(Join(scope, name));
+                if (found != classes_by_name.end() && found->second != &derived)
+                {
+                    return found->second;
+                }
+                if (scope.empty())
+                {
+                    return nullptr;
+                }
+                scope.pop_back();
+            }
+        }
+
+        // Fills in the slots of the class after the ones of its bases, a cycle of bases from a lookup error is cut
+        void Resolve(ClassInfo &info)
+        {
+            if (info.is_resolved || info.is_resolving)
+            {
+                return;
+            }
+            info.is_resolving = true;
+
+            std::unordered_set<std::string> keys;
+            auto add_base_slots = [&](ClassInfo &base)
+            {
+                Resolve(base);
+                for (auto &slot : base.slots)
+                {
+                    if (keys.insert(slot.key).second)
+                    {
+                        info.slots.push_back(slot);
+                    }
+                }
+            };
+
+            if (!info.bases.empty())
+            {
+                add_base_slots(*info.bases.front());
+            }
+
+            std::unordered_map<std::string, size_t> slot_indices;
+            for (size_t i = 0; i < info.slots.size(); i++)
+            {
+                slot_indices[info.slots[i].key] = i;
+            }
+            std::vector<Slot> own_slots;
+            for (auto &method : info.clazz->methods)
+            {
+                std::string key = MethodKey(method);
+                auto found = slot_indices.find(key);
+                if (found != slot_indices.end())
+                {
+                    method.overridden_method = info.slots[found->second].method_id;
+                    info.slots[found->second].method_id = method.id;
+                }
+                else if (method.is_virtual && keys.insert(key).second)
+                {
+                    own_slots.push_back(Slot{key, method.id});
+                }
+            }
+            info.slots.insert(info.slots.end(), own_slots.begin(), own_slots.end());
+
+            // The methods of the other bases, overridden by this class or by the first base chain
+            std::unordered_map<std::string, MemberFunction *> own_methods;
+            for (auto &method : info.clazz->methods)
+            {
+                own_methods.emplace(MethodKey(method), &method);
+            }
+            for (size_t i = 1; i < info.bases.size(); i++)
+            {
+                ClassInfo &base = *info.bases[i];
+                Resolve(base);
+                for (auto &slot : base.slots)
+                {
+                    auto own_method = own_methods.find(slot.key);
+                    if (own_method != own_methods.end())
+                    {
+                        if (own_method->second->overridden_method.empty())
+                        {
+                            own_method->second->overridden_method = slot.method_id;
+                        }
+                    }
+                    if (keys.insert(slot.key).second)
+                    {
+                        info.slots.push_back(own_method != own_methods.end() ? Slot{slot.key, own_method->second->id} : slot);
+                    }
+                }
+            }
+
+            std::vector<std::string> all_base_clazzs;
+            std::unordered_set<std::string> seen_bases{info.full_name};
+            for (auto &written_base : info.written_bases)
+            {
+                ClassInfo *base = written_base.second;
+                if (seen_bases.insert(base != nullptr ? base->full_name : written_base.first).second)
+                {
+                    all_base_clazzs.push_back(base != nullptr ? base->full_name : written_base.first);
+                }
+                if (base == nullptr)
+                {
+                    continue;
+                }
+                for (auto &indirect_base : base->clazz->all_base_clazzs)
+                {
+                    if (seen_bases.insert(indirect_base).second)
+                    {
+                        all_base_clazzs.push_back(indirect_base);
+                    }
+                }
+            }
+            info.clazz->all_base_clazzs = std::move(all_base_clazzs);
+
+            info.clazz->virtual_methods.clear();
+            info.clazz->virtual_methods.reserve(info.slots.size());
+            for (auto &slot : info.slots)
+            {
+                info.clazz->virtual_methods.push_back(slot.method_id);
+            }
+
+            info.is_resolving = false;
+            info.is_resolved = true;
+        }
+
+    public:
+        std::vector<size_t> NodeKinds() const override
+        {
+            return {NodeKind<Clazz>(), NodeKind<Struct>(), NodeKind<MemberFunction>()};
+        }
+
+        void OnNode(NodeType &node, CXXFile &cxx_file) override
+        {
+            if (std::holds_alternative<MemberFunction>(node))
+            {
+                functions_.push_back(&std::get<MemberFunction>(node));
+                return;
+            }
+
+            Clazz &clazz = std::holds_alternative<Clazz>(node) ? std::get<Clazz>(node) : std::get<Struct>(node);
+            ClassInfo info;
+            info.clazz = &clazz;
+            info.scope = ScopeOf(clazz);
+            info.full_name = Join(info.scope, clazz.name);
+            classes_.push_back(std::move(info));
+        }
+
+        void OnFinish(ParseResult &parse_result) override
+        {
+            for (auto function : functions_)
+            {
+                function->id = Join(ScopeOf(*function), function->name) + function->signature;
+            }
+
+            std::unordered_map<std::string, ClassInfo *> classes_by_name;
+            for (auto &info : classes_)
+            {
+                for (auto &method : info.clazz->methods)
+                {
+                    method.id = info.full_name + "::" + method.name + method.signature;
+                    method.overridden_method.clear();
+                }
+
+                ClassInfo *&current = classes_by_name[info.full_name];
+                if (current == nullptr || IsBetterDefinition(*info.clazz, *current->clazz))
+                {
+                    current = &info;
+                }
+            }
+
+            for (auto &info : classes_)
+            {
+                for (auto &base_name : info.clazz->base_clazzs)
+                {
+                    ClassInfo *base = FindClass(classes_by_name, info, base_name);
+                    if (base != nullptr)
+                    {
+                        info.bases.push_back(base);
+                    }
+                    info.written_bases.emplace_back(base_name, base);
+                }
+            }
+
+            for (auto &info : classes_)
+            {
+                Resolve(info);
+            }
+
+            classes_.clear();
+            functions_.clear();
+        }
+    };
+}
+
+#endif // terra_INHERITANCE_H_
@@ -0,0 +1,675 @@
+#ifndef TERRA_JSON_H_
+#define TERRA_JSON_H_
+
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <variant>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "terra_node.hpp"
+
+namespace terra
+{
+
+    /// \exclude
+    namespace detail
+    {
+        // 0: copied as is, 1: escaped, 2: not ascii, validated by nlohmann
+        struct JsonCharClassTable
+        {
+            uint8_t classes[256] = {};
+
+            constexpr JsonCharClassTable()
+            {
+                for (int c = 0; c < 256; c++)
+                {
+                    classes[c] = c >= 0x80 ? 2 : (c < 0x20 || c == '"' || c == '\\') ? 1
+                                                                                     : 0;
+                }
+            }
+        };
+
+        inline constexpr JsonCharClassTable kJsonCharClasses{};
+    }
+
+    /// Appends json text to a growing buffer, without building a `nlohmann::json` tree first.
+    ///
+    /// The output is byte-identical to `nlohmann::json::dump()` of the equivalent tree, as long as the keys of
+    /// every object are written in the order of `std::map<std::string, ...>`, see `JsonFields`.
+    class JsonWriter
+    {
+    private:
+        void Escape(char c)
+        {
+            switch (c)
+            {
+            case '"':
+                buffer.append("\\\"", 2);
+                break;
+            case '\\':
+                buffer.append("\\\\", 2);
+                break;
+            case '\b':
+                buffer.append("\\b", 2);
+                break;
+            case '\f':
+                buffer.append("\\f", 2);
+                break;
+            case '\n':
+                buffer.append("\\n", 2);
+                break;
+            case '\r':
+                buffer.append("\\r", 2);
+                break;
+            case '\t':
+                buffer.append("\\t", 2);
+                break;
+            default:
+            {
+                static constexpr const char *kHexDigits = "0123456789abcdef";
+                char escaped[6] = {'\\', 'u', '0', '0', kHexDigits[(c >> 4) & 0xF], kHexDigits[c & 0xF]};
+                buffer.append(escaped, 6);
+                break;
+            }
+            }
+        }
+
+    public:
+        std::string buffer;
+
+        void Raw(char c)
+        {
+            buffer.push_back(c);
+        }
+
+        void Raw(const char *str, size_t size)
+        {
+            buffer.append(str, size);
+        }
+
+        /// `"key":`, the keys are identifiers which never need to be escaped.
+        void Key(const char *key)
+        {
+            buffer.push_back('"');
+            buffer.append(key);
+            buffer.append("\":", 2);
+        }
+
+        void String(const std::string &str)
+        {
+            const char *begin = str.data();
+            const char *end = begin + str.size();
+            size_t start = buffer.size();
+
+            buffer.push_back('"');
+            const char *run = begin;
+            for (const char *it = begin; it != end; ++it)
+            {
+                uint8_t char_class = detail::kJsonCharClasses.classes[(unsigned char)*it];
+                if (char_class == 0)
+                {
+                    continue;
+                }
+                if (char_class == 2)
+                {
+                    // Let nlohmann validate the UTF-8 and report invalid sequences the same way as `dump()`
+                    buffer.resize(start);
+                    buffer.append(nlohmann::json(str).dump());
+                    return;
+                }
+                buffer.append(run, (size_t)(it - run));
+                Escape(*it);
+                run = it + 1;
+            }
+            buffer.append(run, (size_t)(end - run));
+            buffer.push_back('"');
+        }
+
+        void Bool(bool value)
+        {
+            if (value)
+            {
+                buffer.append("true", 4);
+            }
+            else
+            {
+                buffer.append("false", 5);
+            }
+        }
+
+        void Int(int64_t value)
+        {
+            char digits[24];
+            auto result = std::to_chars(digits, digits + sizeof(digits), value);
+            buffer.append(digits, (size_t)(result.ptr - digits));
+        }
+
+        void Null()
+        {
+            buffer.append("null", 4);
+        }
+
+        /// The value, or `null` if there is none.
+        void OptionalInt(const std::optional<int64_t> &value)
+        {
+            if (value.has_value())
+            {
+                Int(value.value());
+            }
+            else
+            {
+                Null();
+            }
+        }
+
+        void StringArray(const std::vector<std::string> &values)
+        {
+            buffer.push_back('[');
+            for (size_t i = 0; i < values.size(); i++)
+            {
+                if (i > 0)
+                {
+                    buffer.push_back(',');
+                }
+                String(values[i]);
+            }
+            buffer.push_back(']');
+        }
+    };
+
+    /// A key of the json object of `T`, and how to write its value.
+    template <typename T>
+    struct JsonField
+    {
+        const char *key;
+        void (*write)(JsonWriter &writer, const T &node);
+        /// Whether the key is written for `node`, the key is always written if it's `nullptr`.
+        bool (*is_written)(const T &node) = nullptr;
+    };
+
+    /// The fields of the json object of a node type, in the key order of `nlohmann::json::dump()`.
+    template <typename T>
+    struct JsonFields;
+
+    /// \exclude
+    namespace detail
+    {
+        constexpr int CompareJsonKeys(const char *a, const char *b)
+        {
+            while (*a != '\0' && *a == *b)
+            {
+                a++;
+                b++;
+            }
+            return (unsigned char)*a - (unsigned char)*b;
+        }
+
+        template <typename T, size_t N>
+        constexpr bool IsSortedJsonFields(const JsonField<T> (&fields)[N])
+        {
+            for (size_t i = 1; i < N; i++)
+            {
+                if (CompareJsonKeys(fields[i - 1].key, fields[i].key) >= 0)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /// The `BaseNode` fields, shared by the tables of all the node types.
+        template <typename T>
+        struct BaseNodeJsonFields
+        {
+            static void Attributes(JsonWriter &writer, const T &node) { writer.StringArray(node.attributes); }
+            static void Comment(JsonWriter &writer, const T &node) { writer.String(node.comment); }
+            static void ConditionalCompilationDirectivesInfos(JsonWriter &writer, const T &node) { writer.StringArray(node.conditional_compilation_directives_infos); }
+            static void FilePath(JsonWriter &writer, const T &node) { writer.String(node.file_path); }
+            static void Fingerprint(JsonWriter &writer, const T &node) { writer.String(node.fingerprint); }
+            // Only the dumps of a `FingerprintParser` parse have the fingerprints
+            static bool HasFingerprint(const T &node) { return !node.fingerprint.empty(); }
+            static void Name(JsonWriter &writer, const T &node) { writer.String(node.name); }
+            static void Namespaces(JsonWriter &writer, const T &node) { writer.StringArray(node.namespaces); }
+            static void ParentFullScopeName(JsonWriter &writer, const T &node) { writer.String(node.parent_full_scope_name); }
+            static void ParentName(JsonWriter &writer, const T &node) { writer.String(node.parent_name); }
+            static void Source(JsonWriter &writer, const T &node) { writer.String(node.source); }
+        };
+    }
+
+    template <typename T>
+    void WriteJson(JsonWriter &writer, const T &node)
+    {
+        static_assert(detail::IsSortedJsonFields(JsonFields<T>::fields), "The json fields must be sorted by key");
+
+        writer.Raw('{');
+        bool is_first = true;
+        for (auto &field : JsonFields<T>::fields)
+        {
+            if (field.is_written != nullptr && !field.is_written(node))
+            {
+                continue;
+            }
+            if (!is_first)
+            {
+                writer.Raw(',');
+            }
+            is_first = false;
+            writer.Key(field.key);
+            field.write(writer, node);
+        }
+        writer.Raw('}');
+    }
+
+    template <typename T>
+    void WriteJsonArray(JsonWriter &writer, const std::vector<T> &nodes)
+    {
+        writer.Raw('[');
+        for (size_t i = 0; i < nodes.size(); i++)
+        {
+            if (i > 0)
+            {
+                writer.Raw(',');
+            }
+            WriteJson(writer, nodes[i]);
+        }
+        writer.Raw(']');
+    }
+
+    template <>
+    struct JsonFields<SimpleType>
+    {
+        static constexpr JsonField<SimpleType> fields[] = {
+            {"__TYPE", [](JsonWriter &writer, const SimpleType &node)
+             { writer.Raw("\"SimpleType\"", 12); }},
+            {"is_builtin_type", [](JsonWriter &writer, const SimpleType &node)
+             { writer.Bool(node.is_builtin_type); }},
+            {"is_const", [](JsonWriter &writer, const SimpleType &node)
+             { writer.Bool(node.is_const); }},
+            // Only for the unresolved types, so that the dumps of a full parse stay the same
+            {"is_unresolved", [](JsonWriter &writer, const SimpleType &node)
+             { writer.Bool(node.is_unresolved); },
+             [](const SimpleType &node)
+             { return node.is_unresolved; }},
+            {"kind", [](JsonWriter &writer, const SimpleType &node)
+             { writer.Int((int)node.kind); }},
+            {"name", [](JsonWriter &writer, const SimpleType &node)
+             { writer.String(node.name); }},
+            {"source", [](JsonWriter &writer, const SimpleType &node)
+             { writer.String(node.source); }},
+            {"template_arguments", [](JsonWriter &writer, const SimpleType &node)
+             { writer.StringArray(node.template_arguments); }},
+        };
+    };
+
+    template <>
+    struct JsonFields<IncludeDirective>
+    {
+        using Base = detail::BaseNodeJsonFields<IncludeDirective>;
+
+        static constexpr JsonField<IncludeDirective> fields[] = {
+            {"__TYPE", [](JsonWriter &writer, const IncludeDirective &node)
+             { writer.Raw("\"IncludeDirective\"", 18); }},
+            {"attributes", Base::Attributes},
+            {"comment", Base::Comment},
+            {"conditional_compilation_directives_infos", Base::ConditionalCompilationDirectivesInfos},
+            {"file_path", Base::FilePath},
+            {"fingerprint", Base::Fingerprint, Base::HasFingerprint},
+            {"include_file_path", [](JsonWriter &writer, const IncludeDirective &node)
+             { writer.String(node.include_file_path); }},
+            {"name", Base::Name},
+            {"namespaces", Base::Namespaces},
+            {"parent_full_scope_name", Base::ParentFullScopeName},
+            {"parent_name", Base::ParentName},
+            {"source", Base::Source},
+        };
+    };
+
+    template <>
+    struct JsonFields<TypeAlias>
+    {
+        using Base = detail::BaseNodeJsonFields<TypeAlias>;
+
+        static constexpr JsonField<TypeAlias> fields[] = {
+            {"__TYPE", [](JsonWriter &writer, const TypeAlias &node)
+             { writer.Raw("\"TypeAlias\"", 11); }},
+            {"attributes", Base::Attributes},
+            {"comment", Base::Comment},
+            {"conditional_compilation_directives_infos", Base::ConditionalCompilationDirectivesInfos},
+            {"file_path", Base::FilePath},
+            {"fingerprint", Base::Fingerprint, Base::HasFingerprint},
+            {"name", Base::Name},
+            {"namespaces", Base::Namespaces},
+            {"parent_full_scope_name", Base::ParentFullScopeName},
+            {"parent_name", Base::ParentName},
+            {"source", Base::Source},
+            {"underlyingType", [](JsonWriter &writer, const TypeAlias &node)
+             { WriteJson(writer, node.underlyingType); }},
+        };
+    };
+
+    template <>
+    struct JsonFields<Variable>
+    {
+        using Base = detail::BaseNodeJsonFields<Variable>;
+
+        static constexpr JsonField<Variable> fields[] = {
+            {"__TYPE", [](JsonWriter &writer, const Variable &node)
+             { writer.Raw("\"Variable\"", 10); }},
+            {"attributes", Base::Attributes},
+            {"comment", Base::Comment},
+            {"conditional_compilation_directives_infos", Base::ConditionalCompilationDirectivesInfos},
+            {"default_value", [](JsonWriter &writer, const Variable &node)
+             { writer.String(node.default_value); }},
+            {"evaluated_value", [](JsonWriter &writer, const Variable &node)
+             { writer.OptionalInt(node.evaluated_value); }},
+            {"file_path", Base::FilePath},
+            {"fingerprint", Base::Fingerprint, Base::HasFingerprint},
+            {"is_output", [](JsonWriter &writer, const Variable &node)
+             { writer.Bool(node.is_output); }},
+            {"name", Base::Name},
+            {"namespaces", Base::Namespaces},
+            {"parent_full_scope_name", Base::ParentFullScopeName},
+            {"parent_name", Base::ParentName},
+            {"source", Base::Source},
+            {"type", [](JsonWriter &writer, const Variable &node)
+             { WriteJson(writer, node.type); }},
+        };
+    };
+
+    template <>
+    struct JsonFields<Constructor>
+    {
+        using Base = detail::BaseNodeJsonFields<Constructor>;
+
+        static constexpr JsonField<Constructor> fields[] = {
+            {"__TYPE", [](JsonWriter &writer, const Constructor &node)
+             { writer.Raw("\"Constructor\"", 13); }},
+            {"attributes", Base::Attributes},
+            {"comment", Base::Comment},
+            {"conditional_compilation_directives_infos", Base::ConditionalCompilationDirectivesInfos},
+            {"file_path", Base::FilePath},
+            {"fingerprint", Base::Fingerprint, Base::HasFingerprint},
+            {"name", Base::Name},
+            {"namespaces", Base::Namespaces},
+            {"parameters", [](JsonWriter &writer, const Constructor &node)
+             { WriteJsonArray(writer, node.parameters); }},
+            {"parent_full_scope_name", Base::ParentFullScopeName},
+            {"parent_name", Base::ParentName},
+            {"source", Base::Source},
+        };
+    };
+
+    template <>
+    struct JsonFields<MemberFunction>
+    {
+        using Base = detail::BaseNodeJsonFields<MemberFunction>;
+
+        static constexpr JsonField<MemberFunction> fields[] = {
+            {"__TYPE", [](JsonWriter &writer, const MemberFunction &node)
+             { writer.Raw("\"MemberFunction\"", 16); }},
+            {"access_specifier", [](JsonWriter &writer, const MemberFunction &node)
+             { writer.String(node.access_specifier); }},
+            {"attributes", Base::Attributes},
+            {"comment", Base::Comment},
+            {"conditional_compilation_directives_infos", Base::ConditionalCompilationDirectivesInfos},
+            {"file_path", Base::FilePath},
+            {"fingerprint", Base::Fingerprint, Base::HasFingerprint},
+            {"id", [](JsonWriter &writer, const MemberFunction &node)
+             { writer.String(node.id); }},
+            {"is_const", [](JsonWriter &writer, const MemberFunction &node)
+             { writer.Bool(node.is_const); }},
+            {"is_overriding", [](JsonWriter &writer, const MemberFunction &node)
+             { writer.Bool(node.is_overriding); }},
+            {"is_variadic", [](JsonWriter &writer, const MemberFunction &node)
+             { writer.Bool(node.is_variadic); }},
+            {"is_virtual", [](JsonWriter &writer, const MemberFunction &node)
+             { writer.Bool(node.is_virtual); }},
+            {"mangled_name", [](JsonWriter &writer, const MemberFunction &node)
+             { writer.String(node.mangled_name); }},
+            {"name", Base::Name},
+            {"namespaces", Base::Namespaces},
+            {"overridden_method", [](JsonWriter &writer, const MemberFunction &node)
+             { writer.String(node.overridden_method); }},
+            {"parameters", [](JsonWriter &writer, const MemberFunction &node)
+             { WriteJsonArray(writer, node.parameters); }},
+            {"parent_full_scope_name", Base::ParentFullScopeName},
+            {"parent_name", Base::ParentName},
+            {"return_type", [](JsonWriter &writer, const MemberFunction &node)
+             { WriteJson(writer, node.return_type); }},
+            {"signature", [](JsonWriter &writer, const MemberFunction &node)
+             { writer.String(node.signature); }},
+            {"source", Base::Source},
+        };
+    };
+
+    template <>
+    struct JsonFields<MemberVariable>
+    {
+        using Base = detail::BaseNodeJsonFields<MemberVariable>;
+
+        static constexpr JsonField<MemberVariable> fields[] = {
+            {"__TYPE", [](JsonWriter &writer, const MemberVariable &node)
+             { writer.Raw("\"MemberVariable\"", 16); }},
+            {"access_specifier", [](JsonWriter &writer, const MemberVariable &node)
+             { writer.String(node.access_specifier); }},
+            {"attributes", Base::Attributes},
+            {"comment", Base::Comment},
+            {"conditional_compilation_directives_infos", Base::ConditionalCompilationDirectivesInfos},
+            {"file_path", Base::FilePath},
+            {"fingerprint", Base::Fingerprint, Base::HasFingerprint},
+            {"is_mutable", [](JsonWriter &writer, const MemberVariable &node)
+             { writer.Bool(node.is_mutable); }},
+            {"name", Base::Name},
+            {"namespaces", Base::Namespaces},
+            {"parent_full_scope_name", Base::ParentFullScopeName},
+            {"parent_name", Base::ParentName},
+            {"source", Base::Source},
+            {"type", [](JsonWriter &writer, const MemberVariable &node)
+             { WriteJson(writer, node.type); }},
+        };
+    };
+
+    template <>
+    struct JsonFields<EnumConstant>
+    {
+        using Base = detail::BaseNodeJsonFields<EnumConstant>;
+
+        static constexpr JsonField<EnumConstant> fields[] = {
+            {"__TYPE", [](JsonWriter &writer, const EnumConstant &node)
+             { writer.Raw("\"EnumConstant\"", 14); }},
+            {"attributes", Base::Attributes},
+            {"comment", Base::Comment},
+            {"conditional_compilation_directives_infos", Base::ConditionalCompilationDirectivesInfos},
+            {"evaluated_value", [](JsonWriter &writer, const EnumConstant &node)
+             { writer.OptionalInt(node.evaluated_value); }},
+            {"file_path", Base::FilePath},
+            {"fingerprint", Base::Fingerprint, Base::HasFingerprint},
+            {"name", Base::Name},
+            {"namespaces", Base::Namespaces},
+            {"parent_full_scope_name", Base::ParentFullScopeName},
+            {"parent_name", Base::ParentName},
+            {"source", Base::Source},
+            {"value", [](JsonWriter &writer, const EnumConstant &node)
+             { writer.String(node.value); }},
+        };
+    };
+
+    template <>
+    struct JsonFields<Enumz>
+    {
+        using Base = detail::BaseNodeJsonFields<Enumz>;
+
+        static constexpr JsonField<Enumz> fields[] = {
+            {"__TYPE", [](JsonWriter &writer, const Enumz &node)
+             { writer.Raw("\"Enumz\"", 7); }},
+            {"attributes", Base::Attributes},
+            {"comment", Base::Comment},
+            {"conditional_compilation_directives_infos", Base::ConditionalCompilationDirectivesInfos},
+            {"enum_constants", [](JsonWriter &writer, const Enumz &node)
+             { WriteJsonArray(writer, node.enum_constants); }},
+            {"file_path", Base::FilePath},
+            {"fingerprint", Base::Fingerprint, Base::HasFingerprint},
+            {"name", Base::Name},
+            {"namespaces", Base::Namespaces},
+            {"parent_full_scope_name", Base::ParentFullScopeName},
+            {"parent_name", Base::ParentName},
+            {"source", Base::Source},
+        };
+    };
+
+    /// \exclude
+    namespace detail
+    {
+        /// The fields of `Clazz` and `Struct`, which only differ in `__TYPE`.
+        template <typename T>
+        struct ClazzJsonFields
+        {
+            static void Constructors(JsonWriter &writer, const T &node) { WriteJsonArray(writer, node.constructors); }
+            static void Methods(JsonWriter &writer, const T &node) { WriteJsonArray(writer, node.methods); }
+            static void MemberVariables(JsonWriter &writer, const T &node) { WriteJsonArray(writer, node.member_variables); }
+            static void BaseClazzs(JsonWriter &writer, const T &node) { writer.StringArray(node.base_clazzs); }
+            static void AllBaseClazzs(JsonWriter &writer, const T &node) { writer.StringArray(node.all_base_clazzs); }
+            static void VirtualMethods(JsonWriter &writer, const T &node) { writer.StringArray(node.virtual_methods); }
+        };
+    }
+
+    template <>
+    struct JsonFields<Clazz>
+    {
+        using Base = detail::BaseNodeJsonFields<Clazz>;
+        using Members = detail::ClazzJsonFields<Clazz>;
+
+        static constexpr JsonField<Clazz> fields[] = {
+            {"__TYPE", [](JsonWriter &writer, const Clazz &node)
+             { writer.Raw("\"Clazz\"", 7); }},
+            {"all_base_clazzs", Members::AllBaseClazzs},
+            {"attributes", Base::Attributes},
+            {"base_clazzs", Members::BaseClazzs},
+            {"comment", Base::Comment},
+            {"conditional_compilation_directives_infos", Base::ConditionalCompilationDirectivesInfos},
+            {"constructors", Members::Constructors},
+            {"file_path", Base::FilePath},
+            {"fingerprint", Base::Fingerprint, Base::HasFingerprint},
+            {"member_variables", Members::MemberVariables},
+            {"methods", Members::Methods},
+            {"name", Base::Name},
+            {"namespaces", Base::Namespaces},
+            {"parent_full_scope_name", Base::ParentFullScopeName},
+            {"parent_name", Base::ParentName},
+            {"source", Base::Source},
+            {"virtual_methods", Members::VirtualMethods},
+        };
+    };
+
+    template <>
+    struct JsonFields<Struct>
+    {
+        using Base = detail::BaseNodeJsonFields<Struct>;
+        using Members = detail::ClazzJsonFields<Struct>;
+
+        static constexpr JsonField<Struct> fields[] = {
+            {"__TYPE", [](JsonWriter &writer, const Struct &node)
+             { writer.Raw("\"Struct\"", 8); }},
+            {"all_base_clazzs", Members::AllBaseClazzs},
+            {"attributes", Base::Attributes},
+            {"base_clazzs", Members::BaseClazzs},
+            {"comment", Base::Comment},
+            {"conditional_compilation_directives_infos", Base::ConditionalCompilationDirectivesInfos},
+            {"constructors", Members::Constructors},
+            {"file_path", Base::FilePath},
+            {"fingerprint", Base::Fingerprint, Base::HasFingerprint},
+            {"member_variables", Members::MemberVariables},
+            {"methods", Members::Methods},
+            {"name", Base::Name},
+            {"namespaces", Base::Namespaces},
+            {"parent_full_scope_name", Base::ParentFullScopeName},
+            {"parent_name", Base::ParentName},
+            {"source", Base::Source},
+            {"virtual_methods", Members::VirtualMethods},
+        };
+    };
+
+    /// Write a `CXXFile` the same way as `DefaultJsonGenerator::CXXFile2Json(...).dump()`, returns the number of
+    /// nodes written to `"nodes"`.
+    inline size_t WriteCXXFileJson(JsonWriter &writer, const CXXFile &cxx_file)
+    {
+        writer.Raw("{\"__TYPE\":\"CXXFile\",", 20);
+        writer.Key("file_path");
+        writer.String(cxx_file.file_path);
+        writer.Raw(',');
+        writer.Key("nodes");
+
+        size_t nodes_start = writer.buffer.size();
+        size_t node_count = 0;
+        writer.Raw('[');
+        for (auto &node : cxx_file.nodes)
+        {
+            // 过滤掉空的 Clazz 对象（通常是由 union_t 生成的）
+            if (std::holds_alternative<Clazz>(node) && std::get<Clazz>(node).name.empty())
+            {
+                std::cout << "[DefaultJsonGenerator] Filtering out empty Clazz node" << std::endl;
+                continue;
+            }
+
+            if (node_count > 0)
+            {
+                writer.Raw(',');
+            }
+            node_count++;
+
+            std::visit([&](auto &&ele)
+                       {
+                           using T = std::decay_t<decltype(ele)>;
+                           // The top-level `MemberFunction`s are not serialized, they are written as null
+                           if constexpr (std::is_same_v<T, MemberFunction>)
+                           {
+                               writer.Null();
+                           }
+                           else
+                           {
+                               WriteJson(writer, ele);
+                           } },
+                       node);
+        }
+
+        if (node_count == 0)
+        {
+            // No node is pushed to the json array, so it stays null
+            writer.buffer.resize(nodes_start);
+            writer.Null();
+        }
+        else
+        {
+            writer.Raw(']');
+        }
+        writer.Raw('}');
+        return node_count;
+    }
+
+    /// Write the `CXXFile`s the same way as `DefaultJsonGenerator::ToJson(...).dump()`.
+    inline void WriteCXXFilesJson(JsonWriter &writer, const std::vector<CXXFile> &cxx_files)
+    {
+        if (cxx_files.empty())
+        {
+            writer.Null();
+            return;
+        }
+
+        writer.Raw('[');
+        for (size_t i = 0; i < cxx_files.size(); i++)
+        {
+            if (i > 0)
+            {
+                writer.Raw(',');
+            }
+            WriteCXXFileJson(writer, cxx_files[i]);
+        }
+        writer.Raw(']');
+    }
+}
+
+#endif // TERRA_JSON_H_
@@ -0,0 +1,746 @@
+#ifndef terra_JSON_READER_H_
+#define terra_JSON_READER_H_
+
+#include <cctype>
+#include <charconv>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "terra_codec.hpp"
+#include "terra_node.hpp"
+
+namespace terra
+{
+
+    /// A pull parser over a json text, reads the values in place without building a json tree.
+    /// Throws `std::runtime_error` on a malformed input.
+    ///
+    /// An object is read with `NextKey` until it returns false, the value of every key must be read or `Skip`ped
+    /// before the next key, an array the same way with `NextElement`. The separators are not validated,
+    /// it is meant for the dumps written by `JsonWriter`.
+    class JsonReader
+    {
+    private:
+        const char *begin_;
+        const char *pos_;
+        const char *end_;
+        /// The last key which contained an escape sequence
+        std::string key_;
+
+        [[noreturn]] void Fail(const char *what) const
+        {
+            throw std::runtime_error("Invalid json at offset " + std::to_string(pos_ - begin_) + ": " + what);
+        }
+
+        void SkipWhitespace()
+        {
+            while (pos_ != end_ && (*pos_ == ' ' || *pos_ == '\n' || *pos_ == '\r' || *pos_ == '\t'))
+            {
+                pos_++;
+            }
+        }
+
+        void ExpectLiteral(std::string_view literal)
+        {
+            if (static_cast<size_t>(end_ - pos_) < literal.size() || std::string_view(pos_, literal.size()) != literal)
+            {
+                Fail("unexpected literal");
+            }
+            pos_ += literal.size();
+        }
+
+        uint32_t Hex4()
+        {
+            if (end_ - pos_ < 4)
+            {
+                Fail("truncated \\u escape");
+            }
+            uint32_t code = 0;
+            for (int i = 0; i < 4; i++)
+            {
+                char c = *pos_++;
+                code <<= 4;
+                if (c >= '0' && c <= '9')
+                {
+                    code |= static_cast<uint32_t>(c - '0');
+                }
+                else if (c >= 'a' && c <= 'f')
+                {
+                    code |= static_cast<uint32_t>(c - 'a' + 10);
+                }
+                else if (c >= 'A' && c <= 'F')
+                {
+                    code |= static_cast<uint32_t>(c - 'A' + 10);
+                }
+                else
+                {
+                    Fail("invalid \\u escape");
+                }
+            }
+            return code;
+        }
+
+        static void AppendUtf8(std::string &out, uint32_t code)
+        {
+            if (code < 0x80)
+            {
+                out.push_back(static_cast<char>(code));
+            }
+            else if (code < 0x800)
+            {
+                out.push_back(static_cast<char>(0xC0 | (code >> 6)));
+                out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+            }
+            else if (code < 0x10000)
+            {
+                out.push_back(static_cast<char>(0xE0 | (code >> 12)));
+                out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+                out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+            }
+            else
+            {
+                out.push_back(static_cast<char>(0xF0 | (code >> 18)));
+                out.push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3F)));
+                out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+                out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+            }
+        }
+
+        /// Appends the rest of a string whose opening quote is consumed, stops after the closing quote.
+        void AppendString(std::string &out)
+        {
+            while (true)
+            {
+                const char *run = pos_;
+                while (pos_ != end_ && *pos_ != '"' && *pos_ != '\\')
+                {
+                    pos_++;
+                }
+                out.append(run, static_cast<size_t>(pos_ - run));
+                if (pos_ == end_)
+                {
+                    Fail("unterminated string");
+                }
+                if (*pos_++ == '"')
+                {
+                    return;
+                }
+
+                if (pos_ == end_)
+                {
+                    Fail("unterminated escape");
+                }
+                char c = *pos_++;
+                switch (c)
+                {
+                case '"':
+                case '\\':
+                case '/':
+                    out.push_back(c);
+                    break;
+                case 'b':
+                    out.push_back('\b');
+                    break;
+                case 'f':
+                    out.push_back('\f');
+                    break;
+                case 'n':
+                    out.push_back('\n');
+                    break;
+                case 'r':
+                    out.push_back('\r');
+                    break;
+                case 't':
+                    out.push_back('\t');
+                    break;
+                case 'u':
+                {
+                    uint32_t code = Hex4();
+                    if (code >= 0xD800 && code <= 0xDBFF)
+                    {
+                        if (end_ - pos_ < 6 || pos_[0] != '\\' || pos_[1] != 'u')
+                        {
+                            Fail("unpaired surrogate");
+                        }
+                        pos_ += 2;
+                        uint32_t low = Hex4();
+                        if (low < 0xDC00 || low > 0xDFFF)
+                        {
+                            Fail("invalid surrogate pair");
+                        }
+                        code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    else if (code >= 0xDC00 && code <= 0xDFFF)
+                    {
+                        Fail("unpaired surrogate");
+                    }
+                    AppendUtf8(out, code);
+                    break;
+                }
+                default:
+                    Fail("invalid escape");
+                }
+            }
+        }
+
+    public:
+        explicit JsonReader(std::string_view text)
+            : begin_(text.data()), pos_(text.data()), end_(text.data() + text.size()) {}
+
+        /// The next non-whitespace char, without consuming it, `'\0'` at the end of the text.
+        char Peek()
+        {
+            SkipWhitespace();
+            return pos_ == end_ ? '\0' : *pos_;
+        }
+
+        bool AtEnd()
+        {
+            return Peek() == '\0';
+        }
+
+        void Expect(char c)
+        {
+            if (Peek() != c)
+            {
+                Fail("unexpected char");
+            }
+            pos_++;
+        }
+
+        /// Consumes a `null`, returns false if the next value is not `null`.
+        bool TryNull()
+        {
+            if (Peek() != 'n')
+            {
+                return false;
+            }
+            ExpectLiteral("null");
+            return true;
+        }
+
+        /// The next key of the current object, false after its closing brace is consumed.
+        /// The returned view is valid until the next key is read.
+        bool NextKey(std::string_view &key)
+        {
+            char c = Peek();
+            if (c == '}')
+            {
+                pos_++;
+                return false;
+            }
+            if (c == ',')
+            {
+                pos_++;
+            }
+            Expect('"');
+
+            const char *start = pos_;
+            while (pos_ != end_ && *pos_ != '"' && *pos_ != '\\')
+            {
+                pos_++;
+            }
+            if (pos_ != end_ && *pos_ == '"')
+            {
+                key = std::string_view(start, static_cast<size_t>(pos_ - start));
+                pos_++;
+            }
+            else
+            {
+                key_.assign(start, static_cast<size_t>(pos_ - start));
+                AppendString(key_);
+                key = key_;
+            }
+            Expect(':');
+            return true;
+        }
+
+        /// Whether the current array has another element, false after its closing bracket is consumed.
+        bool NextElement()
+        {
+            char c = Peek();
+            if (c == ']')
+            {
+                pos_++;
+                return false;
+            }
+            if (c == ',')
+            {
+                pos_++;
+            }
+            return true;
+        }
+
+        void String(std::string &out)
+        {
+            Expect('"');
+            out.clear();
+            AppendString(out);
+        }
+
+        bool Bool()
+        {
+            if (Peek() == 't')
+            {
+                ExpectLiteral("true");
+                return true;
+            }
+            ExpectLiteral("false");
+            return false;
+        }
+
+        int64_t Int()
+        {
+            Peek();
+            int64_t value = 0;
+            auto result = std::from_chars(pos_, end_, value);
+            if (result.ec != std::errc())
+            {
+                Fail("invalid integer");
+            }
+            pos_ = result.ptr;
+            return value;
+        }
+
+        /// The value, or none for `null`.
+        std::optional<int64_t> OptionalInt()
+        {
+            if (TryNull())
+            {
+                return std::nullopt;
+            }
+            return Int();
+        }
+
+        /// An array of strings, `null` is read as an empty array.
+        void StringArray(std::vector<std::string> &out)
+        {
+            out.clear();
+            if (TryNull())
+            {
+                return;
+            }
+            Expect('[');
+            while (NextElement())
+            {
+                out.emplace_back();
+                String(out.back());
+            }
+        }
+
+        /// Skips the next value, whatever its type.
+        void Skip()
+        {
+            switch (Peek())
+            {
+            case '{':
+            {
+                pos_++;
+                std::string_view key;
+                while (NextKey(key))
+                {
+                    Skip();
+                }
+                break;
+            }
+            case '[':
+                pos_++;
+                while (NextElement())
+                {
+                    Skip();
+                }
+                break;
+            case '"':
+            {
+                std::string ignored;
+                String(ignored);
+                break;
+            }
+            case 't':
+            case 'f':
+                Bool();
+                break;
+            case 'n':
+                TryNull();
+                break;
+            default:
+            {
+                const char *start = pos_;
+                while (pos_ != end_ && (std::isdigit(static_cast<unsigned char>(*pos_)) || *pos_ == '-' || *pos_ == '+' ||
+                                        *pos_ == '.' || *pos_ == 'e' || *pos_ == 'E'))
+                {
+                    pos_++;
+                }
+                if (pos_ == start)
+                {
+                    Fail("unexpected value");
+                }
+                break;
+            }
+            }
+        }
+    };
+
+    /// \exclude
+    namespace detail
+    {
+        /// Reads the keys of an object into `node`, `read_field(reader, key, node)` returns false for the keys
+        /// it does not know, which are skipped.
+        template <typename T, typename ReadField>
+        void ReadJsonObject(JsonReader &reader, T &node, ReadField read_field)
+        {
+            reader.Expect('{');
+            std::string_view key;
+            while (reader.NextKey(key))
+            {
+                if (!read_field(reader, key, node))
+                {
+                    reader.Skip();
+                }
+            }
+        }
+
+        /// Reads the objects of an array with `read`, `null` is read as an empty array.
+        template <typename T, typename Read>
+        void ReadJsonArray(JsonReader &reader, std::vector<T> &nodes, Read read)
+        {
+            nodes.clear();
+            if (reader.TryNull())
+            {
+                return;
+            }
+            reader.Expect('[');
+            while (reader.NextElement())
+            {
+                nodes.emplace_back();
+                read(reader, nodes.back());
+            }
+        }
+
+        inline bool ReadBaseNodeField(JsonReader &reader, std::string_view key, BaseNode &node)
+        {
+            if (key == "name")
+                reader.String(node.name);
+            else if (key == "namespaces")
+                reader.StringArray(node.namespaces);
+            else if (key == "file_path")
+                reader.String(node.file_path);
+            else if (key == "parent_name")
+                reader.String(node.parent_name);
+            else if (key == "parent_full_scope_name")
+                reader.String(node.parent_full_scope_name);
+            else if (key == "attributes")
+                reader.StringArray(node.attributes);
+            else if (key == "comment")
+                reader.String(node.comment);
+            else if (key == "source")
+                reader.String(node.source);
+            else if (key == "conditional_compilation_directives_infos")
+                reader.StringArray(node.conditional_compilation_directives_infos);
+            else if (key == "fingerprint")
+                reader.String(node.fingerprint);
+            else
+                return false;
+            return true;
+        }
+
+        inline void ReadSimpleType(JsonReader &reader, SimpleType &type)
+        {
+            ReadJsonObject(reader, type, [](JsonReader &reader, std::string_view key, SimpleType &simple_type)
+                           {
+                               if (key == "name")
+                                   reader.String(simple_type.name);
+                               else if (key == "source")
+                                   reader.String(simple_type.source);
+                               else if (key == "kind")
+                                   simple_type.kind = static_cast<SimpleTypeKind>(reader.Int());
+                               else if (key == "is_const")
+                                   simple_type.is_const = reader.Bool();
+                               else if (key == "is_builtin_type")
+                                   simple_type.is_builtin_type = reader.Bool();
+                               else if (key == "is_unresolved")
+                                   simple_type.is_unresolved = reader.Bool();
+                               else if (key == "template_arguments")
+                                   reader.StringArray(simple_type.template_arguments);
+                               else
+                                   return false;
+                               return true; });
+        }
+
+        inline bool ReadVariableField(JsonReader &reader, std::string_view key, Variable &variable)
+        {
+            if (key == "type")
+                ReadSimpleType(reader, variable.type);
+            else if (key == "default_value")
+                reader.String(variable.default_value);
+            else if (key == "evaluated_value")
+                variable.evaluated_value = reader.OptionalInt();
+            else if (key == "is_output")
+                variable.is_output = reader.Bool();
+            else
+                return ReadBaseNodeField(reader, key, variable);
+            return true;
+        }
+
+        inline void ReadVariable(JsonReader &reader, Variable &variable)
+        {
+            ReadJsonObject(reader, variable, ReadVariableField);
+        }
+
+        inline bool ReadConstructorField(JsonReader &reader, std::string_view key, Constructor &constructor)
+        {
+            if (key == "parameters")
+                ReadJsonArray(reader, constructor.parameters, ReadVariable);
+            else
+                return ReadBaseNodeField(reader, key, constructor);
+            return true;
+        }
+
+        inline bool ReadMemberFunctionField(JsonReader &reader, std::string_view key, MemberFunction &function)
+        {
+            if (key == "is_virtual")
+                function.is_virtual = reader.Bool();
+            else if (key == "return_type")
+                ReadSimpleType(reader, function.return_type);
+            else if (key == "parameters")
+                ReadJsonArray(reader, function.parameters, ReadVariable);
+            else if (key == "access_specifier")
+                reader.String(function.access_specifier);
+            else if (key == "is_overriding")
+                function.is_overriding = reader.Bool();
+            else if (key == "is_const")
+                function.is_const = reader.Bool();
+            else if (key == "signature")
+                reader.String(function.signature);
+            else if (key == "is_variadic")
+                function.is_variadic = reader.Bool();
+            else if (key == "mangled_name")
+                reader.String(function.mangled_name);
+            else if (key == "id")
+                reader.String(function.id);
+            else if (key == "overridden_method")
+                reader.String(function.overridden_method);
+            else
+                return ReadBaseNodeField(reader, key, function);
+            return true;
+        }
+
+        inline bool ReadMemberVariableField(JsonReader &reader, std::string_view key, MemberVariable &member_variable)
+        {
+            if (key == "type")
+                ReadSimpleType(reader, member_variable.type);
+            else if (key == "is_mutable")
+                member_variable.is_mutable = reader.Bool();
+            else if (key == "access_specifier")
+                reader.String(member_variable.access_specifier);
+            else
+                return ReadBaseNodeField(reader, key, member_variable);
+            return true;
+        }
+
+        inline bool ReadEnumConstantField(JsonReader &reader, std::string_view key, EnumConstant &enum_constant)
+        {
+            if (key == "value")
+                reader.String(enum_constant.value);
+            else if (key == "evaluated_value")
+                enum_constant.evaluated_value = reader.OptionalInt();
+            else
+                return ReadBaseNodeField(reader, key, enum_constant);
+            return true;
+        }
+
+        inline bool ReadClazzField(JsonReader &reader, std::string_view key, Clazz &clazz)
+        {
+            if (key == "constructors")
+                ReadJsonArray(reader, clazz.constructors, [](JsonReader &reader, Constructor &constructor)
+                              { ReadJsonObject(reader, constructor, ReadConstructorField); });
+            else if (key == "methods")
+                ReadJsonArray(reader, clazz.methods, [](JsonReader &reader, MemberFunction &method)
+                              { ReadJsonObject(reader, method, ReadMemberFunctionField); });
+            else if (key == "member_variables")
+                ReadJsonArray(reader, clazz.member_variables, [](JsonReader &reader, MemberVariable &member_variable)
+                              { ReadJsonObject(reader, member_variable, ReadMemberVariableField); });
+            else if (key == "base_clazzs")
+                reader.StringArray(clazz.base_clazzs);
+            else if (key == "all_base_clazzs")
+                reader.StringArray(clazz.all_base_clazzs);
+            else if (key == "virtual_methods")
+                reader.StringArray(clazz.virtual_methods);
+            else
+                return ReadBaseNodeField(reader, key, clazz);
+            return true;
+        }
+
+        /// Reads the rest of a node object whose `__TYPE` is read, `T` is the alternative of `NodeType` it names.
+        template <typename T, typename ReadField>
+        NodeType ReadNodeFields(JsonReader &reader, ReadField read_field)
+        {
+            T node;
+            std::string_view key;
+            while (reader.NextKey(key))
+            {
+                if (!read_field(reader, key, node))
+                {
+                    reader.Skip();
+                }
+            }
+            return node;
+        }
+
+        /// Reads a node of `CXXFile::nodes`, whose `__TYPE` is its first key as written by `WriteJson`,
+        /// returns none for `null`.
+        inline std::optional<NodeType> ReadNode(JsonReader &reader)
+        {
+            if (reader.TryNull())
+            {
+                return std::nullopt;
+            }
+            reader.Expect('{');
+            std::string_view key;
+            if (!reader.NextKey(key) || key != "__TYPE")
+            {
+                throw std::runtime_error("A node of the json dump does not start with its __TYPE");
+            }
+            std::string type;
+            reader.String(type);
+
+            if (type == "IncludeDirective")
+                return ReadNodeFields<IncludeDirective>(reader, [](JsonReader &reader, std::string_view key, IncludeDirective &node)
+                                                        {
+                                                            if (key != "include_file_path")
+                                                                return ReadBaseNodeField(reader, key, node);
+                                                            reader.String(node.include_file_path);
+                                                            return true; });
+            if (type == "TypeAlias")
+                return ReadNodeFields<TypeAlias>(reader, [](JsonReader &reader, std::string_view key, TypeAlias &node)
+                                                 {
+                                                     if (key != "underlyingType")
+                                                         return ReadBaseNodeField(reader, key, node);
+                                                     ReadSimpleType(reader, node.underlyingType);
+                                                     return true; });
+            if (type == "Clazz")
+                return ReadNodeFields<Clazz>(reader, ReadClazzField);
+            if (type == "Struct")
+                return ReadNodeFields<Struct>(reader, [](JsonReader &reader, std::string_view key, Struct &node)
+                                              { return ReadClazzField(reader, key, node); });
+            if (type == "Enumz")
+                return ReadNodeFields<Enumz>(reader, [](JsonReader &reader, std::string_view key, Enumz &node)
+                                             {
+                                                 if (key != "enum_constants")
+                                                     return ReadBaseNodeField(reader, key, node);
+                                                 ReadJsonArray(reader, node.enum_constants, [](JsonReader &reader, EnumConstant &enum_constant)
+                                                               { ReadJsonObject(reader, enum_constant, ReadEnumConstantField); });
+                                                 return true; });
+            if (type == "MemberFunction")
+                return ReadNodeFields<MemberFunction>(reader, ReadMemberFunctionField);
+            if (type == "Variable")
+                return ReadNodeFields<Variable>(reader, ReadVariableField);
+
+            throw std::runtime_error("Unknown node __TYPE in the json dump: " + type);
+        }
+
+        static_assert(std::variant_size_v<NodeType> == 7, "ReadNode must cover every NodeType alternative");
+
+        inline void ReadCXXFile(JsonReader &reader, CXXFile &cxx_file)
+        {
+            ReadJsonObject(reader, cxx_file, [](JsonReader &reader, std::string_view key, CXXFile &cxx_file)
+                           {
+                               if (key == "file_path")
+                               {
+                                   reader.String(cxx_file.file_path);
+                                   return true;
+                               }
+                               if (key != "nodes")
+                               {
+                                   return false;
+                               }
+                               cxx_file.nodes.clear();
+                               if (reader.TryNull())
+                               {
+                                   return true;
+                               }
+                               reader.Expect('[');
+                               while (reader.NextElement())
+                               {
+                                   std::optional<NodeType> node = ReadNode(reader);
+                                   if (node.has_value())
+                                   {
+                                       cxx_file.nodes.push_back(std::move(node.value()));
+                                   }
+                               }
+                               return true; });
+        }
+
+        inline std::string ReadFileContent(const std::filesystem::path &path)
+        {
+            std::ifstream is(path, std::ios::binary);
+            if (!is.is_open())
+            {
+                throw std::runtime_error("Can not open the ast dump: " + path.string());
+            }
+            std::ostringstream content;
+            content << is.rdbuf();
+            return content.str();
+        }
+    }
+
+    /// Read the json array of `CXXFile`s written by `WriteCXXFilesJson`, without building a json tree.
+    /// The top-level `MemberFunction`s, written as `null`, are dropped.
+    inline std::vector<CXXFile> ReadCXXFilesJson(std::string_view json)
+    {
+        JsonReader reader(json);
+        std::vector<CXXFile> cxx_files;
+        detail::ReadJsonArray(reader, cxx_files, detail::ReadCXXFile);
+        if (!reader.AtEnd())
+        {
+            throw std::runtime_error("Unexpected content after the json dump");
+        }
+        return cxx_files;
+    }
+
+    /// Load the `CXXFile`s of a dump of `cppast_backend`: the single json file, the output dir of `--sharded-output`
+    /// (the shards are loaded in the order of its `manifest.json`), or the `EncodeCXXFiles` file of `--binary-output`.
+    /// The `user_data` of the nodes is not part of any of them.
+    inline std::vector<CXXFile> LoadCXXFiles(const std::string &dump_path)
+    {
+        std::filesystem::path path(dump_path);
+        if (std::filesystem::is_directory(path))
+        {
+            std::vector<CXXFile> cxx_files;
+            nlohmann::json manifest = nlohmann::json::parse(detail::ReadFileContent(path / "manifest.json"));
+            for (auto &shard : manifest["shards"])
+            {
+                std::string content = detail::ReadFileContent(path / shard["shard"].get<std::string>());
+                JsonReader reader(content);
+                cxx_files.emplace_back();
+                detail::ReadCXXFile(reader, cxx_files.back());
+            }
+            return cxx_files;
+        }
+
+        std::string content = detail::ReadFileContent(path);
+        // A json dump starts with `[` or `null`, the binary one with the varint of `kBinaryCodecVersion`
+        JsonReader reader(content);
+        char first = reader.Peek();
+        if (first == '[' || first == 'n')
+        {
+            return ReadCXXFilesJson(content);
+        }
+        BinaryReader binary_reader(content);
+        std::vector<CXXFile> cxx_files = DecodeCXXFiles(binary_reader);
+        if (!binary_reader.AtEnd())
+        {
+            throw std::runtime_error("Unexpected content after the binary dump");
+        }
+        return cxx_files;
+    }
+}
+
+#endif // terra_JSON_READER_H_
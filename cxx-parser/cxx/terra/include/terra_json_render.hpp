@@ -0,0 +1,65 @@
+#ifndef terra_JSON_RENDER_H_
+#define terra_JSON_RENDER_H_
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+#include "terra_generator.hpp"
+#include "terra_json.hpp"
+#include "terra_node.hpp"
+
+namespace terra
+{
+
+    /// Re-dumps every file as the same json as a shard of `ShardedJsonGenerator`, into `<file_path>.json` under the
+    /// output dir, e.g., `sdk/include/AgoraBase.h.json` for `/sdk/include/AgoraBase.h`.
+    ///
+    /// It is the trivial `SyntaxRender`, registered as `json`, to check a dump with `--render-from` or to convert
+    /// a `--binary-output` dump back to json.
+    class JsonSyntaxRender : public SyntaxRender
+    {
+    public:
+        static constexpr const char *kName = "json";
+
+        bool IsConcurrentRenderSupported() const override
+        {
+            return true;
+        }
+
+        // Each file is rendered on its own
+        bool SupportsFlatRender() const override
+        {
+            return true;
+        }
+
+    protected:
+        bool ShouldRender(const CXXFile &file) override
+        {
+            return true;
+        }
+
+        RenderedBlock RenderedFileName(const std::string &file_path) override
+        {
+            RenderedBlock block;
+            block.rendered_content = std::filesystem::path(file_path).relative_path().string() + ".json";
+            return block;
+        }
+
+        // The whole file is written here, the other hooks render nothing
+        RenderedBlock RenderIncludeDirectives(const CXXFile &file, const std::vector<IncludeDirective> &include_directives) override
+        {
+            JsonWriter writer;
+            WriteCXXFileJson(writer, file);
+            RenderedBlock block;
+            block.rendered_content = std::move(writer.buffer);
+            return block;
+        }
+    };
+
+    inline const bool kJsonSyntaxRenderRegistered = RegisterSyntaxRender(
+        JsonSyntaxRender::kName, []()
+        { return std::make_unique<JsonSyntaxRender>(); });
+}
+
+#endif // terra_JSON_RENDER_H_
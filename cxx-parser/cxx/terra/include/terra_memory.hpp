@@ -0,0 +1,366 @@
+#ifndef TERRA_MEMORY_H_
+#define TERRA_MEMORY_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#if defined(__APPLE__)
+#include <malloc/malloc.h>
+#include <sys/resource.h>
+#elif defined(__linux__)
+#include <malloc.h>
+#include <sys/resource.h>
+#endif
+
+namespace terra
+{
+
+    /// The heap allocations counted by `MemoryAccounting`.
+    struct MemoryCounters
+    {
+        uint64_t allocations = 0;
+        uint64_t deallocations = 0;
+        uint64_t allocated_bytes = 0;
+        uint64_t freed_bytes = 0;
+    };
+
+    /// Opt-in accounting of the heap allocations and the peak RSS, per phase and per header.
+    ///
+    /// The allocations are counted by the replaced global `operator new`/`operator delete`, which are only
+    /// defined in the translation unit that includes this header with `TERRA_MEMORY_ACCOUNTING_HOOKS` defined,
+    /// usually the one of `main`. The byte counts are the usable sizes of the malloc blocks.
+    ///
+    /// A `MemoryAccounting::Scope` records the allocations between its construction and destruction,
+    /// the scopes must be nested. All threads are counted, so the numbers of a scope are only exact if
+    /// nothing else runs concurrently.
+    class MemoryAccounting
+    {
+    public:
+        struct Record
+        {
+            std::string kind;
+            std::string name;
+            MemoryCounters counters;
+            // The peak of the live heap bytes during the scope
+            uint64_t peak_live_bytes = 0;
+            // The peak RSS of the process at the end of the scope
+            uint64_t peak_rss_bytes = 0;
+        };
+
+        struct TranslationUnitUsage
+        {
+            std::string file;
+            std::vector<std::pair<std::string, unsigned long>> entries;
+            unsigned long total = 0;
+        };
+
+        class Scope
+        {
+        private:
+            MemoryAccounting *accounting_ = nullptr;
+            std::string kind_;
+            std::string name_;
+            MemoryCounters start_;
+            int64_t outer_peak_live_bytes_ = 0;
+
+        public:
+            Scope(std::string kind, std::string name)
+            {
+                MemoryAccounting &accounting = MemoryAccounting::Instance();
+                if (!accounting.IsEnabled())
+                {
+                    return;
+                }
+
+                accounting_ = &accounting;
+                kind_ = std::move(kind);
+                name_ = std::move(name);
+                // Restart the peak from the current live bytes, the outer peak is restored afterwards
+                int64_t live_bytes = accounting.live_bytes_.load();
+                outer_peak_live_bytes_ = accounting.peak_live_bytes_.exchange(live_bytes);
+                start_ = accounting.Snapshot();
+            }
+
+            Scope(const Scope &) = delete;
+            Scope &operator=(const Scope &) = delete;
+
+            ~Scope()
+            {
+                if (accounting_ == nullptr)
+                {
+                    return;
+                }
+
+                MemoryCounters end = accounting_->Snapshot();
+                int64_t peak_live_bytes = accounting_->peak_live_bytes_.load();
+                accounting_->UpdatePeakLiveBytes(outer_peak_live_bytes_);
+
+                Record record;
+                record.kind = std::move(kind_);
+                record.name = std::move(name_);
+                record.counters.allocations = end.allocations - start_.allocations;
+                record.counters.deallocations = end.deallocations - start_.deallocations;
+                record.counters.allocated_bytes = end.allocated_bytes - start_.allocated_bytes;
+                record.counters.freed_bytes = end.freed_bytes - start_.freed_bytes;
+                record.peak_live_bytes = peak_live_bytes > 0 ? (uint64_t)peak_live_bytes : 0;
+                record.peak_rss_bytes = PeakRSS();
+                accounting_->AddRecord(std::move(record));
+            }
+        };
+
+    private:
+        std::atomic<bool> enabled_{false};
+        std::atomic<uint64_t> allocations_{0};
+        std::atomic<uint64_t> deallocations_{0};
+        std::atomic<uint64_t> allocated_bytes_{0};
+        std::atomic<uint64_t> freed_bytes_{0};
+        // Relative to the enabling, blocks allocated before may be freed afterwards
+        std::atomic<int64_t> live_bytes_{0};
+        std::atomic<int64_t> peak_live_bytes_{0};
+
+        std::mutex mutex_;
+        std::vector<Record> records_;
+        std::vector<TranslationUnitUsage> translation_units_;
+
+        MemoryAccounting() = default;
+
+        static size_t BlockSize(void *ptr)
+        {
+#if defined(__APPLE__)
+            return malloc_size(ptr);
+#elif defined(__linux__)
+            return malloc_usable_size(ptr);
+#else
+            return 0;
+#endif
+        }
+
+        void UpdatePeakLiveBytes(int64_t live_bytes)
+        {
+            int64_t peak = peak_live_bytes_.load(std::memory_order_relaxed);
+            while (live_bytes > peak &&
+                   !peak_live_bytes_.compare_exchange_weak(peak, live_bytes, std::memory_order_relaxed))
+            {
+            }
+        }
+
+        void AddRecord(Record record)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            records_.push_back(std::move(record));
+        }
+
+    public:
+        /// Never destroyed, the allocator hooks may still run during the static destruction.
+        static MemoryAccounting &Instance()
+        {
+            static MemoryAccounting *instance = new (std::malloc(sizeof(MemoryAccounting))) MemoryAccounting();
+            return *instance;
+        }
+
+        void Enable()
+        {
+            enabled_ = true;
+        }
+
+        bool IsEnabled() const
+        {
+            return enabled_.load(std::memory_order_relaxed);
+        }
+
+        void OnAllocate(void *ptr)
+        {
+            if (!IsEnabled())
+            {
+                return;
+            }
+
+            size_t size = BlockSize(ptr);
+            allocations_.fetch_add(1, std::memory_order_relaxed);
+            allocated_bytes_.fetch_add(size, std::memory_order_relaxed);
+            int64_t live_bytes = live_bytes_.fetch_add((int64_t)size, std::memory_order_relaxed) + (int64_t)size;
+            UpdatePeakLiveBytes(live_bytes);
+        }
+
+        void OnFree(void *ptr)
+        {
+            if (!IsEnabled())
+            {
+                return;
+            }
+
+            size_t size = BlockSize(ptr);
+            deallocations_.fetch_add(1, std::memory_order_relaxed);
+            freed_bytes_.fetch_add(size, std::memory_order_relaxed);
+            live_bytes_.fetch_sub((int64_t)size, std::memory_order_relaxed);
+        }
+
+        MemoryCounters Snapshot() const
+        {
+            MemoryCounters counters;
+            counters.allocations = allocations_.load(std::memory_order_relaxed);
+            counters.deallocations = deallocations_.load(std::memory_order_relaxed);
+            counters.allocated_bytes = allocated_bytes_.load(std::memory_order_relaxed);
+            counters.freed_bytes = freed_bytes_.load(std::memory_order_relaxed);
+            return counters;
+        }
+
+        /// The peak resident set size of the process so far, or 0 if unknown.
+        static uint64_t PeakRSS()
+        {
+#if defined(__APPLE__) || defined(__linux__)
+            struct rusage usage;
+            if (getrusage(RUSAGE_SELF, &usage) != 0)
+            {
+                return 0;
+            }
+#if defined(__APPLE__)
+            return (uint64_t)usage.ru_maxrss; // bytes
+#else
+            return (uint64_t)usage.ru_maxrss * 1024; // kilobytes
+#endif
+#else
+            return 0;
+#endif
+        }
+
+        /// Record the memory used by a libclang translation unit, see `cppast::libclang_parser::take_tu_memory_usage`.
+        void AddTranslationUnitUsage(TranslationUnitUsage usage)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            translation_units_.push_back(std::move(usage));
+        }
+
+        /// The machine-readable report of all records, in the order the scopes ended.
+        nlohmann::json Report()
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            nlohmann::json records_json = nlohmann::json::array();
+            for (auto &record : records_)
+            {
+                nlohmann::json record_json;
+                record_json["kind"] = record.kind;
+                record_json["name"] = record.name;
+                record_json["allocations"] = record.counters.allocations;
+                record_json["deallocations"] = record.counters.deallocations;
+                record_json["allocated_bytes"] = record.counters.allocated_bytes;
+                record_json["freed_bytes"] = record.counters.freed_bytes;
+                record_json["peak_live_bytes"] = record.peak_live_bytes;
+                record_json["peak_rss_bytes"] = record.peak_rss_bytes;
+                records_json.push_back(record_json);
+            }
+
+            nlohmann::json translation_units_json = nlohmann::json::array();
+            for (auto &translation_unit : translation_units_)
+            {
+                nlohmann::json entries_json = nlohmann::json::object();
+                for (auto &entry : translation_unit.entries)
+                {
+                    entries_json[entry.first] = entry.second;
+                }
+
+                nlohmann::json translation_unit_json;
+                translation_unit_json["file"] = translation_unit.file;
+                translation_unit_json["total_bytes"] = translation_unit.total;
+                translation_unit_json["entries"] = entries_json;
+                translation_units_json.push_back(translation_unit_json);
+            }
+
+            MemoryCounters counters = Snapshot();
+            nlohmann::json total_json;
+            total_json["allocations"] = counters.allocations;
+            total_json["deallocations"] = counters.deallocations;
+            total_json["allocated_bytes"] = counters.allocated_bytes;
+            total_json["freed_bytes"] = counters.freed_bytes;
+            total_json["peak_live_bytes"] = (uint64_t)std::max<int64_t>(0, peak_live_bytes_.load());
+            total_json["peak_rss_bytes"] = PeakRSS();
+
+            nlohmann::json report;
+            report["version"] = 1;
+            report["total"] = total_json;
+            report["records"] = records_json;
+            report["translation_units"] = translation_units_json;
+            return report;
+        }
+    };
+}
+
+#ifdef TERRA_MEMORY_ACCOUNTING_HOOKS
+
+void *operator new(std::size_t size)
+{
+    void *ptr = std::malloc(size == 0 ? 1 : size);
+    if (ptr == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    terra::MemoryAccounting::Instance().OnAllocate(ptr);
+    return ptr;
+}
+
+void *operator new[](std::size_t size)
+{
+    return ::operator new(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    void *ptr = std::malloc(size == 0 ? 1 : size);
+    if (ptr != nullptr)
+    {
+        terra::MemoryAccounting::Instance().OnAllocate(ptr);
+    }
+    return ptr;
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &tag) noexcept
+{
+    return ::operator new(size, tag);
+}
+
+void operator delete(void *ptr) noexcept
+{
+    if (ptr != nullptr)
+    {
+        terra::MemoryAccounting::Instance().OnFree(ptr);
+        std::free(ptr);
+    }
+}
+
+void operator delete[](void *ptr) noexcept
+{
+    ::operator delete(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+    ::operator delete(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept
+{
+    ::operator delete(ptr);
+}
+
+void operator delete(void *ptr, const std::nothrow_t &) noexcept
+{
+    ::operator delete(ptr);
+}
+
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept
+{
+    ::operator delete(ptr);
+}
+
+#endif // TERRA_MEMORY_ACCOUNTING_HOOKS
+
+#endif // TERRA_MEMORY_H_
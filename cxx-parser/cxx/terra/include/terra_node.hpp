@@ -18,6 +18,7 @@
 #include <memory>
 #include <stdlib.h>
 #include <map>
+#include <optional>
 #include <string>
 #include <filesystem>
 #include <fstream>
@@ -45,6 +46,10 @@ namespace terra
 
         std::vector<std::string> conditional_compilation_directives_infos;
 
+        /// Stable hash over the semantic fields of the node (comments and file paths excluded),
+        /// filled by `FingerprintParser`, empty if it did not run.
+        std::string fingerprint;
+
         std::any user_data;
 
         // Name with namespace
@@ -90,6 +95,9 @@ namespace terra
         SimpleTypeKind kind;
         bool is_const = false;
         bool is_builtin_type = false;
+        /// The type is declared in a header that was not parsed, see `ParseConfig::shallow`,
+        /// `name` is the type as spelled in the source, e.g., `agora::rtc::VideoCanvas`.
+        bool is_unresolved = false;
 
         /// @brief  Only and maybe have values if the `kind == SimpleTypeKind::template_t`
         std::vector<std::string> template_arguments;
@@ -116,6 +124,8 @@ namespace terra
     {
         SimpleType type;
         std::string default_value;
+        /// The value of `default_value` if it is an integer constant expression, see `ConstantFoldingPass`.
+        std::optional<int64_t> evaluated_value;
         bool is_output = false;
     } Variable;
     NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(Variable, name, type);
@@ -131,6 +141,10 @@ namespace terra
         std::string signature;
         bool is_variadic;
         std::string mangled_name;
+        /// `<class full name>::<name><signature>`, see `InheritancePass`.
+        std::string id;
+        /// The `id` of the base class method that this method overrides, see `InheritancePass`.
+        std::string overridden_method;
     } MemberFunction;
     NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(MemberFunction, name, is_virtual, return_type, parameters, access_specifier, is_overriding, signature, is_variadic, namespaces, file_path, mangled_name);
 
@@ -145,6 +159,8 @@ namespace terra
     typedef struct EnumConstant : BaseNode
     {
         std::string value;
+        /// The value of the enumerator, explicit or implicit, if it is an integer constant, see `ConstantFoldingPass`.
+        std::optional<int64_t> evaluated_value;
     } EnumConstant;
     NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(EnumConstant, name, value);
 
@@ -169,6 +185,10 @@ namespace terra
         std::vector<MemberFunction> methods;
         std::vector<MemberVariable> member_variables;
         std::vector<std::string> base_clazzs;
+        /// The full names of the direct and indirect bases, see `InheritancePass`.
+        std::vector<std::string> all_base_clazzs;
+        /// The `id`s of the final overriders of the virtual methods in vtable order, see `InheritancePass`.
+        std::vector<std::string> virtual_methods;
     } Clazz;
     NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(Clazz, name, constructors, methods, member_variables, base_clazzs, namespaces, file_path);
 
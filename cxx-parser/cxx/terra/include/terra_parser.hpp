@@ -25,6 +25,7 @@
 #include <nlohmann/json.hpp>
 #include <typeinfo>
 #include "terra_node.hpp"
+#include "terra_header_file_system.hpp"
 
 namespace terra
 {
@@ -34,6 +35,18 @@ namespace terra
         std::vector<std::string> include_header_dirs;
         std::vector<std::string> parse_files;
         std::map<std::string, std::string> defines;
+        /// Parse the builtin and user-defined types once per header, see `cppast::libclang_compile_config::intern_types`
+        bool intern_types = false;
+        /// Read the headers reachable from the `parse_files` once, and parse every file against them, see `HeaderFileSystem`
+        bool in_memory_headers = false;
+        /// The headers read for `in_memory_headers`, loaded by `DefaultVisitor::Visit`
+        std::shared_ptr<const HeaderFileSystem> header_file_system;
+        /// Only parse the `parse_files` themselves, without the headers they include and the function bodies,
+        /// see `cppast::libclang_compile_config::single_file_parse`. The types declared in the included headers
+        /// are `SimpleType::is_unresolved`.
+        bool shallow = false;
+        /// The number of threads converting the top-level classes and enums of a parsed file, 0 means one per hardware thread
+        size_t conversion_jobs = 1;
     } ParseConfig;
 
     typedef struct ParseResult
@@ -60,6 +73,8 @@ namespace terra
     class Parser
     {
     public:
+        virtual ~Parser() = default;
+
         // ParseResult original_parse_result;
         // ParseResult processed_result;
         // ParseConfig parse_config;
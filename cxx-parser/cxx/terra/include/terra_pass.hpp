@@ -0,0 +1,194 @@
+#ifndef terra_PASS_H_
+#define terra_PASS_H_
+
+#include <array>
+#include <memory>
+#include <variant>
+#include <vector>
+
+#include <cppast/cpp_entity_kind.hpp> // for the cpp_entity_kind definition
+#include <cppast/visitor.hpp>         // for visitor_info
+#include "terra_node.hpp"
+#include "terra_parser.hpp"
+#include "terra_utils.hpp"
+
+namespace terra
+{
+
+    /// \exclude
+    namespace detail
+    {
+        template <typename T, typename Variant>
+        struct NodeKindIndex;
+
+        template <typename T, typename... Ts>
+        struct NodeKindIndex<T, std::variant<Ts...>>
+        {
+            static constexpr size_t Find()
+            {
+                constexpr bool matches[] = {std::is_same_v<T, Ts>...};
+                for (size_t i = 0; i < sizeof...(Ts); i++)
+                {
+                    if (matches[i])
+                    {
+                        return i;
+                    }
+                }
+                return sizeof...(Ts);
+            }
+
+            static constexpr size_t value = Find();
+        };
+    }
+
+    /// The kind of a `NodeType` alternative, which is the same as `NodeType::index()`, e.g., `NodeKind<Clazz>()`.
+    template <typename T>
+    constexpr size_t NodeKind()
+    {
+        constexpr size_t index = detail::NodeKindIndex<T, NodeType>::value;
+        static_assert(index < std::variant_size_v<NodeType>, "T is not an alternative of NodeType");
+        return index;
+    }
+
+    /// An analysis pass that hooks into the single parse of `DefaultVisitor::Visit`, instead of re-parsing the headers
+    /// or walking the whole `ParseResult` by itself.
+    ///
+    /// A pass can subscribe to:
+    /// - cppast entity kinds (`EntityKinds`), `OnEntity` is called for them during the `cppast::static_visit` traversal
+    ///   of `RootParser`, with the `CXXFile` converted so far.
+    /// - terra node kinds (`NodeKinds`), `OnNode` is called for the top-level nodes of these kinds after all files
+    ///   are converted, followed by `OnFinish`.
+    ///
+    /// The post-conversion part of the `ReadOnlyPass`es runs concurrently, before the other passes run serially
+    /// in the order they were added.
+    class Pass
+    {
+    public:
+        virtual ~Pass() = default;
+
+        virtual std::vector<cppast::cpp_entity_kind> EntityKinds() const
+        {
+            return {};
+        }
+
+        virtual std::vector<size_t> NodeKinds() const
+        {
+            return {};
+        }
+
+        virtual void OnEntity(const cppast::cpp_entity &entity, const cppast::visitor_info &info, const CXXFile &cxx_file) {}
+
+        virtual void OnNode(NodeType &node, CXXFile &cxx_file) {}
+
+        virtual void OnFinish(ParseResult &parse_result) {}
+    };
+
+    /// A pass which only reads the nodes, its `OnNode` and `OnFinish` get const references,
+    /// so that it can run concurrently with the other read-only passes.
+    class ReadOnlyPass : public Pass
+    {
+    public:
+        virtual void OnNode(const NodeType &node, const CXXFile &cxx_file) {}
+
+        virtual void OnFinish(const ParseResult &parse_result) {}
+
+    private:
+        // Never called for a read-only pass, and can not be overridden
+        void OnNode(NodeType &node, CXXFile &cxx_file) final {}
+
+        void OnFinish(ParseResult &parse_result) final {}
+    };
+
+    class PassManager
+    {
+    private:
+        std::vector<std::unique_ptr<Pass>> passes_;
+        std::array<std::vector<Pass *>, static_cast<size_t>(cppast::cpp_entity_kind::count)> entity_passes_;
+        bool has_entity_passes_ = false;
+
+        /// Runs a `ReadOnlyPass` on a `const ParseResult`, or a `Pass` on a `ParseResult`.
+        template <typename PassT, typename ParseResultT>
+        static void RunPostPass(PassT *pass, ParseResultT &parse_result)
+        {
+            std::vector<bool> node_kinds(std::variant_size_v<NodeType>, false);
+            bool has_node_kinds = false;
+            for (auto kind : pass->NodeKinds())
+            {
+                if (kind < node_kinds.size())
+                {
+                    node_kinds[kind] = true;
+                    has_node_kinds = true;
+                }
+            }
+
+            if (has_node_kinds)
+            {
+                for (auto &cxx_file : parse_result.cxx_files)
+                {
+                    for (auto &node : cxx_file.nodes)
+                    {
+                        if (node_kinds[node.index()])
+                        {
+                            pass->OnNode(node, cxx_file);
+                        }
+                    }
+                }
+            }
+
+            pass->OnFinish(parse_result);
+        }
+
+    public:
+        void AddPass(std::unique_ptr<Pass> pass)
+        {
+            for (auto kind : pass->EntityKinds())
+            {
+                entity_passes_[static_cast<size_t>(kind)].push_back(pass.get());
+                has_entity_passes_ = true;
+            }
+            passes_.push_back(std::move(pass));
+        }
+
+        bool HasEntityPasses() const
+        {
+            return has_entity_passes_;
+        }
+
+        void DispatchEntity(const cppast::cpp_entity &entity, const cppast::visitor_info &info, const CXXFile &cxx_file)
+        {
+            for (auto pass : entity_passes_[static_cast<size_t>(entity.kind())])
+            {
+                pass->OnEntity(entity, info, cxx_file);
+            }
+        }
+
+        /// Run the post-conversion part of the passes, `concurrency == 0` means one worker per hardware thread.
+        void RunPostPasses(ParseResult &parse_result, size_t concurrency = 0)
+        {
+            std::vector<ReadOnlyPass *> read_only_passes;
+            std::vector<Pass *> passes;
+            for (auto &pass : passes_)
+            {
+                if (auto read_only_pass = dynamic_cast<ReadOnlyPass *>(pass.get()))
+                {
+                    read_only_passes.push_back(read_only_pass);
+                }
+                else
+                {
+                    passes.push_back(pass.get());
+                }
+            }
+
+            const ParseResult &const_parse_result = parse_result;
+            ParallelFor(read_only_passes.size(), concurrency, [&](size_t i)
+                        { RunPostPass(read_only_passes[i], const_parse_result); });
+
+            for (auto pass : passes)
+            {
+                RunPostPass(pass, parse_result);
+            }
+        }
+    };
+}
+
+#endif // terra_PASS_H_
@@ -0,0 +1,531 @@
+#ifndef TERRA_PROCESS_POOL_H_
+#define TERRA_PROCESS_POOL_H_
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "terra_codec.hpp"
+#include "terra_parser.hpp"
+
+#if !defined(_WIN32)
+#include <cerrno>
+#include <csignal>
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace terra
+{
+
+    /// Parses the headers in a pool of forked worker processes, so a header that crashes or hangs libclang
+    /// only loses itself instead of the whole run.
+    ///
+    /// Every header is a shard. A worker parses one shard at a time with a fresh parser of `make_parser`,
+    /// and streams its `CXXFile`s back over a pipe in the binary encoding of `EncodeCXXFiles`.
+    /// A shard whose worker dies or exceeds `shard_timeout` is retried on a new worker up to `max_retries`
+    /// times, and then skipped, see `SkippedFiles`. A shard whose parser throws is skipped right away,
+    /// the error is deterministic. The results are merged in the order of `ParseConfig::parse_files`,
+    /// whatever the scheduling.
+    ///
+    /// The parser runs in the worker, so its side effects, e.g., the entity passes, do not reach the
+    /// coordinator. Without `fork`, the shards are parsed in-process one after the other.
+    class ProcessPoolParser : public Parser
+    {
+    public:
+        typedef std::function<std::unique_ptr<Parser>()> ParserFactory;
+
+        struct SkippedFile
+        {
+            std::string file;
+            std::string reason;
+        };
+
+    private:
+        ParserFactory make_parser_;
+        size_t worker_count_;
+        int max_retries_;
+        std::chrono::milliseconds shard_timeout_;
+        std::vector<SkippedFile> skipped_files_;
+
+        // The frame a worker writes for each shard, followed by `size` bytes of payload,
+        // the encoded `CXXFile`s if `status == kShardParsed`, the error message otherwise.
+        struct FrameHeader
+        {
+            uint32_t shard;
+            uint32_t status;
+            uint64_t size;
+        };
+
+        static constexpr uint32_t kShardParsed = 0;
+        static constexpr uint32_t kShardFailed = 1;
+
+        static ParseConfig ShardConfig(const ParseConfig &parse_config, size_t shard)
+        {
+            ParseConfig shard_config;
+            shard_config.include_header_dirs = parse_config.include_header_dirs;
+            shard_config.parse_files = {parse_config.parse_files[shard]};
+            shard_config.defines = parse_config.defines;
+            shard_config.intern_types = parse_config.intern_types;
+            shard_config.in_memory_headers = parse_config.in_memory_headers;
+            shard_config.header_file_system = parse_config.header_file_system;
+            shard_config.shallow = parse_config.shallow;
+            shard_config.conversion_jobs = parse_config.conversion_jobs;
+            return shard_config;
+        }
+
+        /// Parse one shard in-process, returns the status and the payload of its frame.
+        uint32_t ParseShard(const ParseConfig &parse_config, size_t shard, std::string &payload)
+        {
+            try
+            {
+                ParseResult shard_result;
+                make_parser_()->Parse(ShardConfig(parse_config, shard), shard_result);
+
+                BinaryWriter writer;
+                EncodeCXXFiles(writer, shard_result.cxx_files);
+                payload = std::move(writer.buffer);
+                return kShardParsed;
+            }
+            catch (const std::exception &e)
+            {
+                payload = e.what();
+            }
+            catch (...)
+            {
+                payload = "Unknown error while parsing";
+            }
+            return kShardFailed;
+        }
+
+#if !defined(_WIN32)
+        struct Worker
+        {
+            pid_t pid = -1;
+            int request_fd = -1;
+            int result_fd = -1;
+            // The shard in flight, or -1 if idle
+            int64_t shard = -1;
+            std::chrono::steady_clock::time_point started;
+            std::string buffer;
+        };
+
+        static bool WriteAll(int fd, const char *data, size_t size)
+        {
+            while (size > 0)
+            {
+                ssize_t written = write(fd, data, size);
+                if (written < 0)
+                {
+                    if (errno == EINTR)
+                    {
+                        continue;
+                    }
+                    return false;
+                }
+                data += written;
+                size -= written;
+            }
+            return true;
+        }
+
+        static bool ReadAll(int fd, char *data, size_t size)
+        {
+            while (size > 0)
+            {
+                ssize_t count = read(fd, data, size);
+                if (count < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+                if (count <= 0)
+                {
+                    return false;
+                }
+                data += count;
+                size -= count;
+            }
+            return true;
+        }
+
+        // The loop of a forked worker: read a shard index, write its frame, until the request pipe is closed
+        [[noreturn]] void RunWorker(const ParseConfig &parse_config, int request_fd, int result_fd)
+        {
+            uint32_t shard;
+            while (ReadAll(request_fd, reinterpret_cast<char *>(&shard), sizeof(shard)))
+            {
+                std::string payload;
+                FrameHeader header;
+                header.shard = shard;
+                header.status = ParseShard(parse_config, shard, payload);
+                header.size = payload.size();
+
+                std::cout.flush();
+                if (!WriteAll(result_fd, reinterpret_cast<const char *>(&header), sizeof(header)) ||
+                    !WriteAll(result_fd, payload.data(), payload.size()))
+                {
+                    break;
+                }
+            }
+
+            std::cout.flush();
+            std::cerr.flush();
+            // Skip the atexit handlers and the destructors of the state inherited from the coordinator
+            _exit(0);
+        }
+
+        bool SpawnWorker(const ParseConfig &parse_config, std::vector<Worker> &workers, Worker &worker)
+        {
+            int request_pipe[2];
+            int result_pipe[2];
+            if (pipe(request_pipe) != 0)
+            {
+                return false;
+            }
+            if (pipe(result_pipe) != 0)
+            {
+                close(request_pipe[0]);
+                close(request_pipe[1]);
+                return false;
+            }
+
+            // Do not let the buffered output be written twice
+            std::cout.flush();
+            std::cerr.flush();
+
+            pid_t pid = fork();
+            if (pid < 0)
+            {
+                close(request_pipe[0]);
+                close(request_pipe[1]);
+                close(result_pipe[0]);
+                close(result_pipe[1]);
+                return false;
+            }
+
+            if (pid == 0)
+            {
+                // Keep only the own pipes, the other workers would not see the EOF of their requests
+                for (auto &other : workers)
+                {
+                    if (other.request_fd >= 0)
+                    {
+                        close(other.request_fd);
+                    }
+                    if (other.result_fd >= 0)
+                    {
+                        close(other.result_fd);
+                    }
+                }
+                close(request_pipe[1]);
+                close(result_pipe[0]);
+                RunWorker(parse_config, request_pipe[0], result_pipe[1]);
+            }
+
+            close(request_pipe[0]);
+            close(result_pipe[1]);
+
+            worker = Worker();
+            worker.pid = pid;
+            worker.request_fd = request_pipe[1];
+            worker.result_fd = result_pipe[0];
+            return true;
+        }
+
+        static std::string StopWorker(Worker &worker, bool kill_worker)
+        {
+            if (worker.request_fd >= 0)
+            {
+                close(worker.request_fd);
+            }
+            if (worker.result_fd >= 0)
+            {
+                close(worker.result_fd);
+            }
+            worker.request_fd = -1;
+            worker.result_fd = -1;
+
+            if (worker.pid < 0)
+            {
+                return "";
+            }
+
+            if (kill_worker)
+            {
+                kill(worker.pid, SIGKILL);
+            }
+
+            int status = 0;
+            while (waitpid(worker.pid, &status, 0) < 0 && errno == EINTR)
+            {
+            }
+            worker.pid = -1;
+
+            if (WIFSIGNALED(status))
+            {
+                return "the worker was killed by signal " + std::to_string(WTERMSIG(status));
+            }
+            return "the worker exited with code " + std::to_string(WEXITSTATUS(status));
+        }
+
+        void ParseInWorkers(const ParseConfig &parse_config, std::vector<std::vector<CXXFile>> &shard_results)
+        {
+            size_t shard_count = parse_config.parse_files.size();
+            std::deque<size_t> pending;
+            for (size_t i = 0; i < shard_count; i++)
+            {
+                pending.push_back(i);
+            }
+            std::vector<int> attempts(shard_count, 0);
+            size_t finished = 0;
+
+            // A worker that died must not kill the coordinator when it writes the next request
+            auto previous_sigpipe = signal(SIGPIPE, SIG_IGN);
+
+            std::vector<Worker> workers(std::min(worker_count_, shard_count));
+            for (auto &worker : workers)
+            {
+                if (!SpawnWorker(parse_config, workers, worker))
+                {
+                    throw std::runtime_error("Can not fork a parse worker: " + std::string(strerror(errno)));
+                }
+            }
+
+            auto skip = [&](size_t shard, const std::string &reason)
+            {
+                std::cerr << "[ProcessPoolParser] skip " << parse_config.parse_files[shard] << ": " << reason << std::endl;
+                skipped_files_.push_back({parse_config.parse_files[shard], reason});
+                finished++;
+            };
+
+            // The shard of a dead or hung worker is retried on a new worker
+            auto fail_worker = [&](Worker &worker, bool kill_worker, const std::string &cause)
+            {
+                int64_t in_flight = worker.shard;
+                std::string reason = cause + ", " + StopWorker(worker, kill_worker);
+                worker.shard = -1;
+
+                size_t shard = static_cast<size_t>(in_flight);
+                if (in_flight < 0)
+                {
+                    // Nothing was lost
+                }
+                else if (++attempts[shard] <= max_retries_)
+                {
+                    std::cerr << "[ProcessPoolParser] retry " << parse_config.parse_files[shard] << ": " << reason << std::endl;
+                    pending.push_front(shard);
+                }
+                else
+                {
+                    skip(shard, reason);
+                }
+
+                if (!pending.empty() && !SpawnWorker(parse_config, workers, worker))
+                {
+                    throw std::runtime_error("Can not fork a parse worker: " + std::string(strerror(errno)));
+                }
+            };
+
+            auto handle_frames = [&](Worker &worker)
+            {
+                while (worker.buffer.size() >= sizeof(FrameHeader))
+                {
+                    FrameHeader header;
+                    memcpy(&header, worker.buffer.data(), sizeof(header));
+                    if (worker.buffer.size() - sizeof(header) < header.size)
+                    {
+                        return;
+                    }
+
+                    const char *payload = worker.buffer.data() + sizeof(header);
+                    if (header.shard != worker.shard)
+                    {
+                        throw std::runtime_error("A parse worker answered an unexpected shard");
+                    }
+
+                    if (header.status == kShardParsed)
+                    {
+                        BinaryReader reader(payload, header.size);
+                        shard_results[header.shard] = DecodeCXXFiles(reader);
+                        finished++;
+                    }
+                    else
+                    {
+                        skip(header.shard, std::string(payload, header.size));
+                    }
+
+                    worker.buffer.erase(0, sizeof(header) + header.size);
+                    worker.shard = -1;
+                }
+            };
+
+            while (finished < shard_count)
+            {
+                // Hand the pending shards to the idle workers
+                for (auto &worker : workers)
+                {
+                    if (worker.pid < 0 || worker.shard >= 0 || pending.empty())
+                    {
+                        continue;
+                    }
+
+                    uint32_t shard = static_cast<uint32_t>(pending.front());
+                    pending.pop_front();
+                    worker.shard = shard;
+                    worker.started = std::chrono::steady_clock::now();
+                    if (!WriteAll(worker.request_fd, reinterpret_cast<const char *>(&shard), sizeof(shard)))
+                    {
+                        fail_worker(worker, true, "can not send the shard");
+                    }
+                }
+
+                std::vector<pollfd> poll_fds;
+                std::vector<Worker *> polled_workers;
+                int timeout_ms = -1;
+                auto now = std::chrono::steady_clock::now();
+                for (auto &worker : workers)
+                {
+                    if (worker.shard < 0)
+                    {
+                        continue;
+                    }
+                    poll_fds.push_back({worker.result_fd, POLLIN, 0});
+                    polled_workers.push_back(&worker);
+
+                    if (shard_timeout_.count() > 0)
+                    {
+                        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(worker.started + shard_timeout_ - now).count();
+                        int remaining_ms = static_cast<int>(std::max<int64_t>(0, remaining));
+                        timeout_ms = timeout_ms < 0 ? remaining_ms : std::min(timeout_ms, remaining_ms);
+                    }
+                }
+
+                if (poll_fds.empty())
+                {
+                    // Only possible if a shard could not be sent and nothing else is in flight
+                    continue;
+                }
+
+                int ready = poll(poll_fds.data(), poll_fds.size(), timeout_ms);
+                if (ready < 0 && errno != EINTR)
+                {
+                    throw std::runtime_error("Can not poll the parse workers: " + std::string(strerror(errno)));
+                }
+
+                for (size_t i = 0; ready > 0 && i < poll_fds.size(); i++)
+                {
+                    Worker &worker = *polled_workers[i];
+                    if ((poll_fds[i].revents & (POLLIN | POLLHUP | POLLERR)) == 0)
+                    {
+                        continue;
+                    }
+
+                    char chunk[64 * 1024];
+                    ssize_t count = read(worker.result_fd, chunk, sizeof(chunk));
+                    if (count < 0 && errno == EINTR)
+                    {
+                        continue;
+                    }
+                    if (count <= 0)
+                    {
+                        fail_worker(worker, false, "the worker stopped while parsing");
+                        continue;
+                    }
+
+                    worker.buffer.append(chunk, count);
+                    try
+                    {
+                        handle_frames(worker);
+                    }
+                    catch (const std::exception &e)
+                    {
+                        fail_worker(worker, true, e.what());
+                    }
+                }
+
+                if (shard_timeout_.count() > 0)
+                {
+                    now = std::chrono::steady_clock::now();
+                    for (auto &worker : workers)
+                    {
+                        if (worker.shard >= 0 && now - worker.started >= shard_timeout_)
+                        {
+                            fail_worker(worker, true, "the shard timed out");
+                        }
+                    }
+                }
+            }
+
+            for (auto &worker : workers)
+            {
+                StopWorker(worker, false);
+            }
+            signal(SIGPIPE, previous_sigpipe);
+        }
+#endif
+
+    public:
+        /// `worker_count == 0` means one worker per hardware thread, `shard_timeout == 0` means no timeout.
+        ProcessPoolParser(ParserFactory make_parser, size_t worker_count = 0, int max_retries = 1,
+                          std::chrono::milliseconds shard_timeout = std::chrono::milliseconds(0))
+            : make_parser_(std::move(make_parser)), worker_count_(worker_count), max_retries_(max_retries),
+              shard_timeout_(shard_timeout)
+        {
+            if (worker_count_ == 0)
+            {
+                worker_count_ = std::max(1u, std::thread::hardware_concurrency());
+            }
+        }
+
+        /// The headers skipped by the last `Parse`, in the order they were given up.
+        const std::vector<SkippedFile> &SkippedFiles() const
+        {
+            return skipped_files_;
+        }
+
+        bool Parse(const ParseConfig &parse_config, ParseResult &parse_result) override
+        {
+            skipped_files_.clear();
+            std::vector<std::vector<CXXFile>> shard_results(parse_config.parse_files.size());
+
+#if !defined(_WIN32)
+            ParseInWorkers(parse_config, shard_results);
+#else
+            for (size_t shard = 0; shard < shard_results.size(); shard++)
+            {
+                std::string payload;
+                if (ParseShard(parse_config, shard, payload) == kShardParsed)
+                {
+                    BinaryReader reader(payload);
+                    shard_results[shard] = DecodeCXXFiles(reader);
+                }
+                else
+                {
+                    skipped_files_.push_back({parse_config.parse_files[shard], payload});
+                }
+            }
+#endif
+
+            for (auto &cxx_files : shard_results)
+            {
+                for (auto &cxx_file : cxx_files)
+                {
+                    parse_result.cxx_files.push_back(std::move(cxx_file));
+                }
+            }
+            return false;
+        }
+    };
+}
+
+#endif // TERRA_PROCESS_POOL_H_
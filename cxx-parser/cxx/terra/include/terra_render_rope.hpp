@@ -0,0 +1,215 @@
+#ifndef terra_RENDER_ROPE_H_
+#define terra_RENDER_ROPE_H_
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace terra
+{
+
+    /// A rendered text kept as a list of segments, so that the blocks of the nested render hooks can be joined
+    /// without copying their characters at every nesting level. The text is copied once, by `AppendTo` or `WriteTo`.
+    ///
+    /// A segment either points into the rope's own arena (`Append`), which is a list of chunks that keep their
+    /// address when the rope is moved, or into a buffer owned by someone else (`AppendRef`), which must outlive
+    /// the rope, e.g., the names in the `ParseResult` or the member blocks passed to `SyntaxRender::RenderClass`.
+    ///
+    /// Consecutive `Append`s go to the same arena segment, so appending many small pieces does not grow the segment list.
+    class RenderRope
+    {
+    private:
+        static constexpr size_t kChunkSize = 4096;
+
+        std::vector<std::string_view> segments_;
+        std::vector<std::unique_ptr<char[]>> chunks_;
+        // The free space of the last allocated chunk
+        char *cursor_ = nullptr;
+        char *chunk_end_ = nullptr;
+        size_t size_ = 0;
+
+        void AddSegment(std::string_view text)
+        {
+            segments_.push_back(text);
+            size_ += text.size();
+        }
+
+        // Leaves the rope empty, without a chunk to append to
+        void Clear()
+        {
+            segments_.clear();
+            chunks_.clear();
+            cursor_ = nullptr;
+            chunk_end_ = nullptr;
+            size_ = 0;
+        }
+
+    public:
+        RenderRope() = default;
+
+        /// The moved from rope is empty, its free chunk space now belongs to the new rope.
+        RenderRope(RenderRope &&other) noexcept
+            : segments_(std::move(other.segments_)), chunks_(std::move(other.chunks_)),
+              cursor_(other.cursor_), chunk_end_(other.chunk_end_), size_(other.size_)
+        {
+            other.Clear();
+        }
+
+        RenderRope &operator=(RenderRope &&other) noexcept
+        {
+            if (this != &other)
+            {
+                segments_ = std::move(other.segments_);
+                chunks_ = std::move(other.chunks_);
+                cursor_ = other.cursor_;
+                chunk_end_ = other.chunk_end_;
+                size_ = other.size_;
+                other.Clear();
+            }
+            return *this;
+        }
+
+        /// Copies the whole text into a single chunk of the new rope, the referenced buffers are not shared.
+        RenderRope(const RenderRope &other)
+        {
+            if (!other.empty())
+            {
+                chunks_.push_back(std::unique_ptr<char[]>(new char[other.size()]));
+                char *data = chunks_.back().get();
+                other.CopyTo(data);
+                AddSegment(std::string_view(data, other.size()));
+            }
+        }
+
+        RenderRope &operator=(const RenderRope &other)
+        {
+            if (this != &other)
+            {
+                RenderRope copy(other);
+                *this = std::move(copy);
+            }
+            return *this;
+        }
+
+        /// Copies `text` into the arena.
+        RenderRope &Append(std::string_view text)
+        {
+            if (text.empty())
+            {
+                return *this;
+            }
+
+            size_t free_size = static_cast<size_t>(chunk_end_ - cursor_);
+            if (text.size() > free_size)
+            {
+                size_t chunk_size = std::max(kChunkSize, text.size());
+                chunks_.push_back(std::unique_ptr<char[]>(new char[chunk_size]));
+                cursor_ = chunks_.back().get();
+                chunk_end_ = cursor_ + chunk_size;
+            }
+
+            std::memcpy(cursor_, text.data(), text.size());
+            if (!segments_.empty() && segments_.back().data() + segments_.back().size() == cursor_)
+            {
+                segments_.back() = std::string_view(segments_.back().data(), segments_.back().size() + text.size());
+                size_ += text.size();
+            }
+            else
+            {
+                AddSegment(std::string_view(cursor_, text.size()));
+            }
+            cursor_ += text.size();
+            return *this;
+        }
+
+        RenderRope &Append(char c)
+        {
+            return Append(std::string_view(&c, 1));
+        }
+
+        /// Takes over the segments and the arena of `other`, without copying the text.
+        RenderRope &Append(RenderRope &&other)
+        {
+            if (this == &other || other.empty())
+            {
+                return *this;
+            }
+            segments_.insert(segments_.end(), other.segments_.begin(), other.segments_.end());
+            size_ += other.size_;
+            for (auto &chunk : other.chunks_)
+            {
+                chunks_.push_back(std::move(chunk));
+            }
+            other.Clear();
+            return *this;
+        }
+
+        /// References `text` without copying it, the buffer must outlive the rope.
+        RenderRope &AppendRef(std::string_view text)
+        {
+            if (!text.empty())
+            {
+                AddSegment(text);
+            }
+            return *this;
+        }
+
+        /// References the segments of `other` without copying them, `other` must outlive the rope and must not be
+        /// appended to or moved from meanwhile.
+        RenderRope &AppendRef(const RenderRope &other)
+        {
+            segments_.insert(segments_.end(), other.segments_.begin(), other.segments_.end());
+            size_ += other.size_;
+            return *this;
+        }
+
+        size_t size() const
+        {
+            return size_;
+        }
+
+        bool empty() const
+        {
+            return size_ == 0;
+        }
+
+        /// Copies the text to `data`, which must have room for `size()` chars.
+        void CopyTo(char *data) const
+        {
+            for (auto &segment : segments_)
+            {
+                std::memcpy(data, segment.data(), segment.size());
+                data += segment.size();
+            }
+        }
+
+        void AppendTo(std::string &output) const
+        {
+            size_t offset = output.size();
+            output.resize(offset + size_);
+            CopyTo(output.data() + offset);
+        }
+
+        void WriteTo(std::ostream &os) const
+        {
+            for (auto &segment : segments_)
+            {
+                os.write(segment.data(), static_cast<std::streamsize>(segment.size()));
+            }
+        }
+
+        std::string ToString() const
+        {
+            std::string output;
+            AppendTo(output);
+            return output;
+        }
+    };
+}
+
+#endif // terra_RENDER_ROPE_H_
@@ -0,0 +1,155 @@
+#ifndef terra_SHALLOW_REPORT_H_
+#define terra_SHALLOW_REPORT_H_
+
+#include <set>
+#include <string>
+#include <type_traits>
+#include <variant>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "terra_node.hpp"
+#include "terra_parser.hpp"
+
+namespace terra
+{
+
+    /// \exclude
+    namespace detail
+    {
+        class ShallowReportBuilder
+        {
+        private:
+            nlohmann::json nodes_ = nlohmann::json::array();
+            std::set<std::string> unresolved_types_;
+            std::vector<std::string> node_types_;
+
+            static std::string ScopedName(const BaseNode &node)
+            {
+                std::string scope = node.parent_full_scope_name;
+                if (scope.empty())
+                {
+                    for (auto &ns : node.namespaces)
+                    {
+                        if (ns.empty())
+                        {
+                            continue;
+                        }
+                        scope += scope.empty() ? ns : "::" + ns;
+                    }
+                }
+                return scope.empty() ? node.name : scope + "::" + node.name;
+            }
+
+            void AddType(const SimpleType &type)
+            {
+                if (type.is_unresolved)
+                {
+                    node_types_.push_back(type.name);
+                    unresolved_types_.insert(type.name);
+                }
+            }
+
+            void AddParameters(const std::vector<Variable> &parameters)
+            {
+                for (auto &parameter : parameters)
+                {
+                    AddType(parameter.type);
+                }
+            }
+
+            /// Adds `node` if one of the types collected since the last call is unresolved
+            void AddNode(const char *node_type, const BaseNode &node)
+            {
+                if (node_types_.empty())
+                {
+                    return;
+                }
+                nodes_.push_back({{"__TYPE", node_type},
+                                  {"name", ScopedName(node)},
+                                  {"file_path", node.file_path},
+                                  {"unresolved_types", node_types_}});
+                node_types_.clear();
+            }
+
+            void AddClazz(const Clazz &clazz)
+            {
+                for (auto &constructor : clazz.constructors)
+                {
+                    AddParameters(constructor.parameters);
+                    AddNode("Constructor", constructor);
+                }
+                for (auto &method : clazz.methods)
+                {
+                    AddMemberFunction(method);
+                }
+                for (auto &member_variable : clazz.member_variables)
+                {
+                    AddType(member_variable.type);
+                    AddNode("MemberVariable", member_variable);
+                }
+            }
+
+            void AddMemberFunction(const MemberFunction &function)
+            {
+                AddType(function.return_type);
+                AddParameters(function.parameters);
+                AddNode("MemberFunction", function);
+            }
+
+        public:
+            void Add(const NodeType &node)
+            {
+                std::visit([&](auto &&n)
+                           {
+                               using T = std::decay_t<decltype(n)>;
+                               if constexpr (std::is_same_v<T, TypeAlias>)
+                               {
+                                   AddType(n.underlyingType);
+                                   AddNode("TypeAlias", n);
+                               }
+                               else if constexpr (std::is_same_v<T, Variable>)
+                               {
+                                   AddType(n.type);
+                                   AddNode("Variable", n);
+                               }
+                               else if constexpr (std::is_same_v<T, MemberFunction>)
+                               {
+                                   AddMemberFunction(n);
+                               }
+                               else if constexpr (std::is_same_v<T, Clazz> || std::is_same_v<T, Struct>)
+                               {
+                                   AddClazz(n);
+                               } },
+                           node);
+            }
+
+            nlohmann::json Build() const
+            {
+                return {{"unresolved_node_count", nodes_.size()},
+                        {"unresolved_types", unresolved_types_},
+                        {"nodes", nodes_}};
+            }
+        };
+    }
+
+    /// The nodes of a `ParseConfig::shallow` parse which lost semantic precision: the declarations using a type
+    /// that is declared in an included header, see `SimpleType::is_unresolved`.
+    ///
+    /// The report lists every such node with its unresolved types, and all the unresolved types,
+    /// e.g., to check whether a shallow parse is precise enough for a header, or which headers a full parse needs.
+    /// The base classes declared in the included headers are missing from a shallow parse, they are not reported.
+    inline nlohmann::json ShallowParseReport(const ParseResult &parse_result)
+    {
+        detail::ShallowReportBuilder builder;
+        for (auto &cxx_file : parse_result.cxx_files)
+        {
+            for (auto &node : cxx_file.nodes)
+            {
+                builder.Add(node);
+            }
+        }
+        return builder.Build();
+    }
+}
+
+#endif // terra_SHALLOW_REPORT_H_
@@ -8,11 +8,17 @@
 #include <string>
 #include <vector>
 #include <sstream>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <thread>
 
 namespace terra
 {
 
-    bool Replace(std::string &str, const std::string &from, const std::string &to)
+    inline bool Replace(std::string &str, const std::string &from, const std::string &to)
     {
         size_t start_pos = str.find(from);
         if (start_pos == std::string::npos)
@@ -21,7 +27,7 @@ namespace terra
         return true;
     }
 
-    std::string_view ltrim(std::string_view s)
+    inline std::string_view ltrim(std::string_view s)
     {
         s.remove_prefix(
             std::distance(s.cbegin(), std::find_if(s.cbegin(), s.cend(), [](int c)
@@ -30,7 +36,7 @@ namespace terra
         return s;
     }
 
-    std::string_view rtrim(std::string_view s)
+    inline std::string_view rtrim(std::string_view s)
     {
         s.remove_suffix(std::distance(s.crbegin(),
                                       std::find_if(s.crbegin(), s.crend(), [](int c)
@@ -39,13 +45,13 @@ namespace terra
         return s;
     }
 
-    std::string_view trim(std::string_view s) { return ltrim(rtrim(s)); }
+    inline std::string_view trim(std::string_view s) { return ltrim(rtrim(s)); }
 
     /// Handle conditional conditional compilation directives infos.
-    void PreProcessVisitFiles(const std::filesystem::path &work_dir,
-                              const std::vector<std::string> &visit_files,
-                              std::vector<std::string> &pre_processed_files,
-                              bool render_ifdefine_macros = false)
+    inline void PreProcessVisitFiles(const std::filesystem::path &work_dir,
+                                     const std::vector<std::string> &visit_files,
+                                     std::vector<std::string> &pre_processed_files,
+                                     bool render_ifdefine_macros = false)
     {
         // std::filesystem::path tmp_path = std::filesystem::current_path() / "tmp";
         if (std::filesystem::exists(work_dir))
@@ -253,8 +259,8 @@ namespace terra
         // std::filesystem:: ::copy("sandbox/file1.txt", "sandbox/file2.txt");
     };
 
-    std::vector<std::string> Split(const std::string &source,
-                                   const std::string &delimelater)
+    inline std::vector<std::string> Split(const std::string &source,
+                                          const std::string &delimelater)
     {
 
         std::vector<std::string> result;
@@ -272,7 +278,7 @@ namespace terra
         return result;
     }
 
-    std::string JoinToString(const std::vector<std::string> &list, const std::string &delimelater)
+    inline std::string JoinToString(const std::vector<std::string> &list, const std::string &delimelater)
     {
         if (list.empty())
             return "";
@@ -284,6 +290,90 @@ namespace terra
         return vts.str();
     }
 
+    /// 64-bit FNV-1a hash of `content`, formatted as 16 lowercase hex digits.
+    /// Used for content hashes in the generated manifests, it is stable across platforms and runs.
+    inline std::string HashContent(std::string_view content)
+    {
+        uint64_t hash = 14695981039346656037ULL;
+        for (unsigned char c : content)
+        {
+            hash ^= c;
+            hash *= 1099511628211ULL;
+        }
+
+        static const char *digits = "0123456789abcdef";
+        std::string hex(16, '0');
+        for (int i = 15; i >= 0; --i)
+        {
+            hex[i] = digits[hash & 0xf];
+            hash >>= 4;
+        }
+        return hex;
+    }
+
+    /// Run `task(index)` for every index in [0, count) on up to `concurrency` worker threads,
+    /// `concurrency == 0` means one worker per hardware thread.
+    /// The first exception thrown by a task is rethrown on the calling thread after all workers finished.
+    template <typename Task>
+    void ParallelFor(size_t count, size_t concurrency, Task task)
+    {
+        if (concurrency == 0)
+        {
+            concurrency = std::max(1u, std::thread::hardware_concurrency());
+        }
+        concurrency = std::min(concurrency, count);
+
+        if (concurrency <= 1)
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                task(i);
+            }
+            return;
+        }
+
+        std::atomic<size_t> next_index{0};
+        std::exception_ptr first_error;
+        std::mutex error_mutex;
+
+        auto worker = [&]()
+        {
+            size_t i;
+            while ((i = next_index.fetch_add(1)) < count)
+            {
+                try
+                {
+                    task(i);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(error_mutex);
+                    if (!first_error)
+                    {
+                        first_error = std::current_exception();
+                    }
+                }
+            }
+        };
+
+        std::vector<std::thread> workers;
+        workers.reserve(concurrency - 1);
+        for (size_t w = 1; w < concurrency; w++)
+        {
+            workers.emplace_back(worker);
+        }
+        worker();
+        for (auto &t : workers)
+        {
+            t.join();
+        }
+
+        if (first_error)
+        {
+            std::rethrow_exception(first_error);
+        }
+    }
+
 } // namespace terra
 
 #endif // TERRA_UTILS_H_
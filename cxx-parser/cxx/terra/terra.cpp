@@ -2,4 +2,19 @@
 #include "terra_generator.hpp"
 #include "terra_node.hpp"
 #include "terra_parser.hpp"
-#include "terra_utils.hpp"
\ No newline at end of file
+#include "terra_utils.hpp"
+#include "terra_diff.hpp"
+#include "terra_pass.hpp"
+#include "terra_memory.hpp"
+#include "terra_json.hpp"
+#include "terra_flat.hpp"
+#include "terra_codec.hpp"
+#include "terra_process_pool.hpp"
+#include "terra_constant_folding.hpp"
+#include "terra_inheritance.hpp"
+#include "terra_ast_index.hpp"
+#include "terra_render_rope.hpp"
+#include "terra_header_file_system.hpp"
+#include "terra_json_reader.hpp"
+#include "terra_shallow_report.hpp"
+#include "terra_json_render.hpp"
\ No newline at end of file
@@ -0,0 +1,89 @@
+#include "terra_ast_index.hpp"
+#include "terra_inheritance.hpp"
+
+#include <catch2/catch.hpp>
+
+using namespace terra;
+
+namespace
+{
+    template <typename T>
+    T make_class(const std::string &name, const std::vector<std::string> &namespaces,
+                 const std::vector<std::string> &base_clazzs)
+    {
+        T clazz;
+        clazz.name = name;
+        clazz.namespaces = namespaces;
+        clazz.base_clazzs = base_clazzs;
+        MemberFunction method;
+        method.name = "f" + name;
+        method.is_virtual = true;
+        clazz.methods.push_back(method);
+        return clazz;
+    }
+
+    ParseResult make_parse_result()
+    {
+        ParseResult parse_result;
+        CXXFile base_file;
+        base_file.file_path = "AgoraBase.h";
+        base_file.nodes.push_back(make_class<Clazz>("IEngineBase", {"agora", "base"}, {}));
+        base_file.nodes.push_back(make_class<Clazz>("IRtcEngine", {"agora", "rtc"}, {"agora::base::IEngineBase"}));
+        parse_result.cxx_files.push_back(base_file);
+
+        CXXFile ex_file;
+        ex_file.file_path = "IAgoraRtcEngineEx.h";
+        ex_file.nodes.push_back(make_class<Clazz>("IRtcEngineEx", {"agora", "rtc"}, {"IRtcEngine"}));
+        ex_file.nodes.push_back(make_class<Struct>("Observer", {"agora", "rtc", "ext"}, {"::agora::rtc::IRtcEngine", "Unknown<int>"}));
+        parse_result.cxx_files.push_back(ex_file);
+        return parse_result;
+    }
+
+    std::vector<std::string> names(const std::vector<const Clazz *> &clazzs)
+    {
+        std::vector<std::string> result;
+        for (auto clazz : clazzs)
+        {
+            result.push_back(clazz->name);
+        }
+        return result;
+    }
+}
+
+TEST_CASE("AstIndex::DerivedFrom")
+{
+    ParseResult parse_result = make_parse_result();
+
+    SECTION("the written bases are looked up to their full names")
+    {
+        AstIndex ast_index(parse_result);
+        REQUIRE(names(ast_index.DerivedFrom("agora::rtc::IRtcEngine")) == std::vector<std::string>{"IRtcEngineEx", "Observer"});
+        REQUIRE(names(ast_index.DerivedFrom("agora::base::IEngineBase")) == std::vector<std::string>{"IRtcEngine"});
+        // Only the direct bases without InheritancePass
+        REQUIRE(ast_index.DerivedFrom("IRtcEngine").empty());
+        REQUIRE(names(ast_index.DerivedFrom("Unknown<int>")) == std::vector<std::string>{"Observer"});
+    }
+
+    SECTION("all the bases after InheritancePass")
+    {
+        PassManager pass_manager;
+        pass_manager.AddPass(std::make_unique<InheritancePass>());
+        pass_manager.RunPostPasses(parse_result, 1);
+
+        AstIndex ast_index(parse_result);
+        REQUIRE(names(ast_index.DerivedFrom("agora::rtc::IRtcEngine")) == std::vector<std::string>{"IRtcEngineEx", "Observer"});
+        REQUIRE(names(ast_index.DerivedFrom("agora::base::IEngineBase")) == std::vector<std::string>{"IRtcEngine", "IRtcEngineEx", "Observer"});
+    }
+}
+
+TEST_CASE("AstIndex::Lookup")
+{
+    ParseResult parse_result = make_parse_result();
+    AstIndex ast_index(parse_result);
+
+    REQUIRE(ast_index.Lookup<Clazz>({"agora", "rtc", "ext"}, "IRtcEngine") == &std::get<Clazz>(parse_result.cxx_files[0].nodes[1]));
+    REQUIRE(ast_index.Lookup<Clazz>({"agora", "rtc"}, "base::IEngineBase") == &std::get<Clazz>(parse_result.cxx_files[0].nodes[0]));
+    REQUIRE(ast_index.Lookup<Clazz>({"agora", "rtc"}, "::IRtcEngine") == nullptr);
+    REQUIRE(ast_index.Lookup<Clazz>({"agora", "rtc"}, "Observer") == nullptr);
+    REQUIRE(ast_index.LookupClazzOrStruct({"agora", "rtc", "ext"}, "Observer") == &std::get<Struct>(parse_result.cxx_files[1].nodes[1]));
+}
@@ -0,0 +1,250 @@
+#include "terra_constant_folding.hpp"
+
+#include <map>
+
+#include <catch2/catch.hpp>
+
+using namespace terra;
+
+namespace
+{
+    std::optional<int64_t> evaluate(std::string_view expression, const std::map<std::string, int64_t> &identifiers = {})
+    {
+        return ConstantExpressionEvaluator::Evaluate(
+            expression, [&](const std::string &name) -> std::optional<int64_t>
+            {
+                auto found = identifiers.find(name);
+                if (found == identifiers.end())
+                {
+                    return std::nullopt;
+                }
+                return found->second;
+            });
+    }
+
+    Enumz make_enum(const std::string &name, const std::vector<std::string> &namespaces,
+                    const std::vector<std::pair<std::string, std::string>> &constants)
+    {
+        Enumz enumz;
+        enumz.name = name;
+        enumz.namespaces = namespaces;
+        for (auto &constant : constants)
+        {
+            EnumConstant enum_constant;
+            enum_constant.name = constant.first;
+            enum_constant.value = constant.second;
+            enumz.enum_constants.push_back(enum_constant);
+        }
+        return enumz;
+    }
+
+    void fold(ParseResult &parse_result)
+    {
+        PassManager pass_manager;
+        pass_manager.AddPass(std::make_unique<ConstantFoldingPass>());
+        pass_manager.RunPostPasses(parse_result, 1);
+    }
+
+    const Enumz &enum_at(const ParseResult &parse_result, size_t file, size_t node)
+    {
+        return std::get<Enumz>(parse_result.cxx_files[file].nodes[node]);
+    }
+}
+
+TEST_CASE("ConstantExpressionEvaluator")
+{
+    SECTION("literals")
+    {
+        REQUIRE(evaluate("42") == 42);
+        REQUIRE(evaluate("0x2A") == 42);
+        REQUIRE(evaluate("052") == 42);
+        REQUIRE(evaluate("0b101010") == 42);
+        REQUIRE(evaluate("1'000'000") == 1000000);
+        REQUIRE(evaluate("'A'") == 65);
+        REQUIRE(evaluate("'\\n'") == 10);
+        REQUIRE(evaluate("true + true") == 2);
+        REQUIRE(evaluate("1.5") == std::nullopt);
+        REQUIRE(evaluate("\"str\"") == std::nullopt);
+    }
+
+    SECTION("precedence")
+    {
+        REQUIRE(evaluate("1 + 2 * 3") == 7);
+        REQUIRE(evaluate("(1 + 2) * 3") == 9);
+        REQUIRE(evaluate("1 << 2 + 1") == 8);
+        REQUIRE(evaluate("1 | 2 ^ 3 & 4") == 3);
+        REQUIRE(evaluate("-~0") == 1);
+        REQUIRE(evaluate("!5 == 0") == 1);
+        REQUIRE(evaluate("1 ? 2 : 3") == 2);
+        REQUIRE(evaluate("0 ? 2 : 0 ? 3 : 4") == 4);
+        REQUIRE(evaluate("(1 + 2") == std::nullopt);
+        REQUIRE(evaluate("1 +") == std::nullopt);
+    }
+
+    SECTION("shifts")
+    {
+        REQUIRE(evaluate("1 << 4") == 16);
+        REQUIRE(evaluate("1u << 31") == 2147483648);
+        // The result has the type of the left operand, so it overflows the `int`
+        REQUIRE(evaluate("1 << 31") == INT32_MIN);
+        REQUIRE(evaluate("1ll << 40") == 1099511627776);
+        REQUIRE(evaluate("-16 >> 2") == -4);
+        REQUIRE(evaluate("0xFFFFFFFFu >> 4") == 0x0FFFFFFF);
+        REQUIRE(evaluate("1 << 32") == std::nullopt);
+        REQUIRE(evaluate("1ll << 64") == std::nullopt);
+        REQUIRE(evaluate("1 << -1") == std::nullopt);
+    }
+
+    SECTION("division by zero")
+    {
+        REQUIRE(evaluate("7 / 2") == 3);
+        REQUIRE(evaluate("-7 / 2") == -3);
+        REQUIRE(evaluate("-7 % 2") == -1);
+        REQUIRE(evaluate("1 / 0") == std::nullopt);
+        REQUIRE(evaluate("1 % (2 - 2)") == std::nullopt);
+        REQUIRE(evaluate("(-9223372036854775807ll - 1) / -1") == std::nullopt);
+    }
+
+    SECTION("casts")
+    {
+        REQUIRE(evaluate("(unsigned int)-1") == 4294967295);
+        REQUIRE(evaluate("(unsigned char)300") == 44);
+        REQUIRE(evaluate("(signed char)200") == -56);
+        REQUIRE(evaluate("(short)0x18000") == INT16_MIN);
+        REQUIRE(evaluate("(bool)42") == 1);
+        REQUIRE(evaluate("static_cast<uint8_t>(-1)") == 255);
+        REQUIRE(evaluate("std::uint16_t(-1)") == 65535);
+        REQUIRE(evaluate("(const unsigned long long)-1") == -1);
+        REQUIRE(evaluate("(int)4294967296ll") == 0);
+        REQUIRE(evaluate("(float)1") == std::nullopt);
+    }
+
+    SECTION("overflow")
+    {
+        // The arithmetic wraps around in the width of the promoted type
+        REQUIRE(evaluate("2147483647 + 1") == INT32_MIN);
+        REQUIRE(evaluate("4294967295u + 1") == 0);
+        REQUIRE(evaluate("2147483647ll + 1") == 2147483648);
+        REQUIRE(evaluate("0u - 1") == 4294967295);
+        REQUIRE(evaluate("9223372036854775807ll + 1") == INT64_MIN);
+        REQUIRE(evaluate("-2147483648") == INT32_MIN);
+        // The usual arithmetic conversions, -1 is converted to the unsigned type
+        REQUIRE(evaluate("-1 < 0u") == 0);
+        REQUIRE(evaluate("-1 < 0ll") == 1);
+    }
+
+    SECTION("short circuit")
+    {
+        REQUIRE(evaluate("0 && 1 / 0") == 0);
+        REQUIRE(evaluate("1 || 1 / 0") == 1);
+        REQUIRE(evaluate("0 && UNKNOWN") == 0);
+        REQUIRE(evaluate("1 || (1 << 40)") == 1);
+        REQUIRE(evaluate("0 && 1 || 2") == 1);
+        // The right operand is evaluated if it decides the result
+        REQUIRE(evaluate("1 && 1 / 0") == std::nullopt);
+        REQUIRE(evaluate("0 || UNKNOWN") == std::nullopt);
+        // It still has to be well-formed
+        REQUIRE(evaluate("0 && (1 +") == std::nullopt);
+    }
+
+    SECTION("identifiers")
+    {
+        std::map<std::string, int64_t> identifiers = {{"ERR_BASE", 100}, {"ns::Color::kRed", 1}};
+        REQUIRE(evaluate("(ERR_BASE + 4)", identifiers) == 104);
+        REQUIRE(evaluate("ns::Color::kRed << 3", identifiers) == 8);
+        REQUIRE(evaluate("UNKNOWN + 1", identifiers) == std::nullopt);
+        REQUIRE(evaluate("sizeof(int)", identifiers) == std::nullopt);
+        REQUIRE(evaluate("ERR_BASE(1)", identifiers) == std::nullopt);
+    }
+}
+
+TEST_CASE("ConstantFoldingPass")
+{
+    SECTION("implicit values")
+    {
+        ParseResult parse_result;
+        CXXFile cxx_file;
+        cxx_file.nodes.push_back(make_enum("A", {}, {{"A_0", ""}, {"A_1", ""}, {"A_10", "10"}, {"A_11", ""}}));
+        parse_result.cxx_files.push_back(cxx_file);
+        fold(parse_result);
+
+        auto &constants = enum_at(parse_result, 0, 0).enum_constants;
+        REQUIRE(constants[0].evaluated_value == 0);
+        REQUIRE(constants[1].evaluated_value == 1);
+        REQUIRE(constants[2].evaluated_value == 10);
+        REQUIRE(constants[3].evaluated_value == 11);
+    }
+
+    SECTION("cross-enum references")
+    {
+        // The reference to a later file is resolved in the next round
+        ParseResult parse_result;
+        CXXFile first;
+        first.nodes.push_back(make_enum("ERROR_CODE", {"agora"}, {{"ERR_CAMERA", "ERR_BASE + 1"}, {"ERR_MIC", ""}}));
+        parse_result.cxx_files.push_back(first);
+        CXXFile second;
+        second.nodes.push_back(make_enum("BASE", {"agora"}, {{"ERR_BASE", "1 << 10"}}));
+        second.nodes.push_back(make_enum("OTHER", {"other"}, {{"ERR_BASE", "7"}}));
+        second.nodes.push_back(make_enum("QUALIFIED", {}, {{"Q", "agora::BASE::ERR_BASE + other::ERR_BASE"}}));
+        parse_result.cxx_files.push_back(second);
+        fold(parse_result);
+
+        auto &constants = enum_at(parse_result, 0, 0).enum_constants;
+        REQUIRE(constants[0].evaluated_value == 1025);
+        REQUIRE(constants[1].evaluated_value == 1026);
+        REQUIRE(enum_at(parse_result, 1, 2).enum_constants[0].evaluated_value == 1031);
+    }
+
+    SECTION("ambiguous and unknown references")
+    {
+        ParseResult parse_result;
+        CXXFile cxx_file;
+        cxx_file.nodes.push_back(make_enum("X", {"a"}, {{"V", "1"}}));
+        cxx_file.nodes.push_back(make_enum("Y", {"b"}, {{"V", "2"}}));
+        // Both enumerators are visible from the global scope only qualified
+        cxx_file.nodes.push_back(make_enum("Z", {}, {{"Z_0", "V"}, {"Z_1", ""}, {"Z_2", "UNKNOWN"}}));
+        parse_result.cxx_files.push_back(cxx_file);
+        fold(parse_result);
+
+        auto &constants = enum_at(parse_result, 0, 2).enum_constants;
+        REQUIRE(!constants[0].evaluated_value.has_value());
+        REQUIRE(!constants[1].evaluated_value.has_value());
+        REQUIRE(!constants[2].evaluated_value.has_value());
+    }
+
+    SECTION("the innermost scope wins")
+    {
+        ParseResult parse_result;
+        CXXFile cxx_file;
+        cxx_file.nodes.push_back(make_enum("X", {}, {{"V", "1"}}));
+        cxx_file.nodes.push_back(make_enum("Y", {"ns"}, {{"V", "2"}, {"W", "V + 1"}}));
+        cxx_file.nodes.push_back(make_enum("Z", {}, {{"Z_0", "V"}}));
+        parse_result.cxx_files.push_back(cxx_file);
+        fold(parse_result);
+
+        REQUIRE(enum_at(parse_result, 0, 1).enum_constants[1].evaluated_value == 3);
+        REQUIRE(enum_at(parse_result, 0, 2).enum_constants[0].evaluated_value == 1);
+    }
+
+    SECTION("default values")
+    {
+        ParseResult parse_result;
+        CXXFile cxx_file;
+        cxx_file.nodes.push_back(make_enum("MODE", {"ns"}, {{"MODE_A", "4"}}));
+        MemberFunction method;
+        method.namespaces = {"ns"};
+        Variable parameter;
+        parameter.namespaces = {"ns"};
+        parameter.default_value = "MODE_A * 2";
+        method.parameters.push_back(parameter);
+        parameter.default_value = "nullptr";
+        method.parameters.push_back(parameter);
+        cxx_file.nodes.push_back(method);
+        parse_result.cxx_files.push_back(cxx_file);
+        fold(parse_result);
+
+        auto &parameters = std::get<MemberFunction>(parse_result.cxx_files[0].nodes[1]).parameters;
+        REQUIRE(parameters[0].evaluated_value == 8);
+        REQUIRE(!parameters[1].evaluated_value.has_value());
+    }
+}
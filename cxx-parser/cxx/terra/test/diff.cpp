@@ -0,0 +1,171 @@
+#include "random_nodes.hpp"
+#include "terra_diff.hpp"
+#include "terra_json.hpp"
+#include "terra_json_reader.hpp"
+
+#include <catch2/catch.hpp>
+
+using namespace terra;
+using terra_test::RandomNodes;
+
+namespace
+{
+    std::vector<CXXFile> make_cxx_files(unsigned seed)
+    {
+        RandomNodes random_nodes(seed);
+        std::vector<CXXFile> cxx_files;
+        for (int f = 0; f < 4; f++)
+        {
+            CXXFile cxx_file;
+            cxx_file.file_path = "/sdk/include/f" + std::to_string(f) + ".h";
+            // The top-level `MemberFunction`s are dropped from the json dumps
+            while (cxx_file.nodes.size() < 30u)
+            {
+                NodeType node = random_nodes.Node();
+                if (!std::holds_alternative<MemberFunction>(node))
+                {
+                    cxx_file.nodes.push_back(std::move(node));
+                }
+            }
+            cxx_files.push_back(cxx_file);
+        }
+        return cxx_files;
+    }
+
+    void clear_fingerprint(BaseNode &node)
+    {
+        node.fingerprint.clear();
+    }
+
+    void clear_fingerprint(MemberFunction &method)
+    {
+        method.fingerprint.clear();
+        for (auto &param : method.parameters)
+        {
+            clear_fingerprint(param);
+        }
+    }
+
+    void clear_fingerprint(Clazz &clazz)
+    {
+        clazz.fingerprint.clear();
+        for (auto &constructor : clazz.constructors)
+        {
+            constructor.fingerprint.clear();
+            for (auto &param : constructor.parameters)
+            {
+                clear_fingerprint(param);
+            }
+        }
+        for (auto &member_variable : clazz.member_variables)
+        {
+            clear_fingerprint(member_variable);
+        }
+        for (auto &method : clazz.methods)
+        {
+            clear_fingerprint(method);
+        }
+    }
+
+    void clear_fingerprint(Enumz &enumz)
+    {
+        enumz.fingerprint.clear();
+        for (auto &enum_constant : enumz.enum_constants)
+        {
+            clear_fingerprint(enum_constant);
+        }
+    }
+
+    // The dump without the fingerprints, as the default dump of `cppast_backend`
+    std::vector<CXXFile> reload_without_fingerprints(std::vector<CXXFile> cxx_files)
+    {
+        for (auto &cxx_file : cxx_files)
+        {
+            for (auto &node : cxx_file.nodes)
+            {
+                std::visit([](auto &n)
+                           { clear_fingerprint(n); },
+                           node);
+            }
+        }
+
+        JsonWriter writer;
+        WriteCXXFilesJson(writer, cxx_files);
+        REQUIRE(writer.buffer.find("\"fingerprint\"") == std::string::npos);
+        return ReadCXXFilesJson(writer.buffer);
+    }
+
+    template <typename T>
+    T &first_node(std::vector<CXXFile> &cxx_files)
+    {
+        for (auto &cxx_file : cxx_files)
+        {
+            for (auto &node : cxx_file.nodes)
+            {
+                if (std::holds_alternative<T>(node))
+                {
+                    return std::get<T>(node);
+                }
+            }
+        }
+        throw std::runtime_error("No such node");
+    }
+
+    std::vector<std::string> keys(const nlohmann::json &entries)
+    {
+        std::vector<std::string> result;
+        for (auto &entry : entries)
+        {
+            result.push_back(entry["key"].get<std::string>());
+        }
+        return result;
+    }
+}
+
+TEST_CASE("DiffAstDump")
+{
+    std::vector<CXXFile> cxx_files = make_cxx_files(5);
+    std::vector<CXXFile> old_cxx_files = reload_without_fingerprints(cxx_files);
+
+    SECTION("a dump without fingerprints of the same nodes")
+    {
+        nlohmann::json diff = DiffAstDump(old_cxx_files, cxx_files);
+        REQUIRE(diff["added"].empty());
+        REQUIRE(diff["removed"].empty());
+        REQUIRE(diff["modified"].empty());
+    }
+
+    SECTION("only the semantic fields are compared")
+    {
+        Clazz &clazz = first_node<Clazz>(cxx_files);
+        clazz.comment += "changed";
+        clazz.source += "changed";
+        clazz.fingerprint = "stale";
+        REQUIRE(DiffAstDump(old_cxx_files, cxx_files)["modified"].empty());
+    }
+
+    SECTION("added, removed and modified")
+    {
+        Enumz &enumz = first_node<Enumz>(cxx_files);
+        enumz.parent_full_scope_name = "added_ns";
+
+        TypeAlias &type_alias = first_node<TypeAlias>(cxx_files);
+        type_alias.underlyingType.is_const = !type_alias.underlyingType.is_const;
+        std::string type_alias_scope = type_alias.parent_full_scope_name.empty()
+                                           ? JoinToString(type_alias.namespaces, "::")
+                                           : type_alias.parent_full_scope_name;
+        std::string type_alias_key = "TypeAlias:" + (type_alias_scope.empty() ? "" : type_alias_scope + "::") + type_alias.name;
+
+        nlohmann::json diff = DiffAstDump(old_cxx_files, cxx_files);
+        std::vector<std::string> added = keys(diff["added"]);
+        REQUIRE(std::find(added.begin(), added.end(), "Enumz:added_ns::" + enumz.name) != added.end());
+        REQUIRE(diff["removed"].size() == diff["added"].size());
+
+        std::vector<std::string> modified = keys(diff["modified"]);
+        REQUIRE(std::find(modified.begin(), modified.end(), type_alias_key) != modified.end());
+        for (auto &entry : diff["modified"])
+        {
+            REQUIRE(entry["fingerprint"] != entry["old_fingerprint"]);
+        }
+    }
+}
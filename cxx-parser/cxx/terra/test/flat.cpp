@@ -0,0 +1,90 @@
+#include "random_nodes.hpp"
+#include "terra_flat.hpp"
+#include "terra_json.hpp"
+
+#include <catch2/catch.hpp>
+
+using namespace terra;
+using terra_test::RandomNodes;
+
+namespace
+{
+    std::string dump(const std::vector<CXXFile> &cxx_files)
+    {
+        JsonWriter writer;
+        WriteCXXFilesJson(writer, cxx_files);
+        return writer.buffer;
+    }
+}
+
+TEST_CASE("FlatParseResult round trip")
+{
+    // 20 files x 300 random nodes
+    RandomNodes random_nodes(7);
+    ParseResult parse_result;
+    for (int f = 0; f < 20; f++)
+    {
+        CXXFile cxx_file;
+        cxx_file.file_path = "/sdk/include/f" + std::to_string(f) + ".h";
+        for (int n = 0; n < 300; n++)
+        {
+            cxx_file.nodes.push_back(random_nodes.Node());
+        }
+        parse_result.cxx_files.push_back(cxx_file);
+    }
+
+    FlatParseResult flat_parse_result = FlatParseResult::FromParseResult(parse_result);
+    std::string expected = dump(parse_result.cxx_files);
+
+    SECTION("ToParseResult")
+    {
+        REQUIRE(dump(flat_parse_result.ToParseResult().cxx_files) == expected);
+    }
+
+    SECTION("MaterializeFile")
+    {
+        REQUIRE(flat_parse_result.cxx_files.size() == parse_result.cxx_files.size());
+        for (size_t i = 0; i < parse_result.cxx_files.size(); i++)
+        {
+            REQUIRE(flat_parse_result.Nodes(flat_parse_result.cxx_files[i]).size() == 300u);
+            REQUIRE(dump({flat_parse_result.MaterializeFile(i)}) == dump({parse_result.cxx_files[i]}));
+        }
+    }
+
+    SECTION("Files")
+    {
+        std::vector<CXXFile> cxx_files;
+        for (auto &cxx_file : flat_parse_result.Files())
+        {
+            cxx_files.push_back(cxx_file);
+        }
+        REQUIRE(dump(cxx_files) == expected);
+    }
+
+    SECTION("the flat store is smaller")
+    {
+        REQUIRE(flat_parse_result.MemoryFootprint() < MemoryFootprint(parse_result));
+    }
+}
+
+TEST_CASE("FlatParseResult random round trips")
+{
+    RandomNodes random_nodes(42);
+    for (int round = 0; round < 300; round++)
+    {
+        ParseResult parse_result;
+        for (size_t f = random_nodes.Node().index() % 4; f > 0; f--)
+        {
+            CXXFile cxx_file;
+            cxx_file.file_path = "f" + std::to_string(f) + ".h";
+            for (size_t n = random_nodes.Node().index() % 6; n > 0; n--)
+            {
+                cxx_file.nodes.push_back(random_nodes.Node());
+            }
+            parse_result.cxx_files.push_back(cxx_file);
+        }
+
+        INFO("round " << round);
+        REQUIRE(dump(FlatParseResult::FromParseResult(parse_result).ToParseResult().cxx_files) == dump(parse_result.cxx_files));
+    }
+}
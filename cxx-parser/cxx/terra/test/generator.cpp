@@ -0,0 +1,92 @@
+#include "terra.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <unistd.h>
+
+#include <catch2/catch.hpp>
+
+using namespace terra;
+
+namespace
+{
+    // Renders what the hooks see of the other files
+    class ContextSyntaxRender : public SyntaxRender
+    {
+    private:
+        bool supports_flat_render_;
+
+    public:
+        explicit ContextSyntaxRender(bool supports_flat_render) : supports_flat_render_(supports_flat_render) {}
+
+        bool SupportsFlatRender() const override
+        {
+            return supports_flat_render_;
+        }
+
+    protected:
+        bool ShouldRender(const CXXFile &file) override
+        {
+            return true;
+        }
+
+        RenderedBlock RenderedFileName(const std::string &file_path) override
+        {
+            RenderedBlock block;
+            block.rendered_content = std::filesystem::path(file_path).filename().string() + ".txt";
+            return block;
+        }
+
+        RenderedBlock RenderIncludeDirectives(const CXXFile &file, const std::vector<IncludeDirective> &include_directives) override
+        {
+            RenderedBlock block;
+            if (GetFlatParseResult() != nullptr)
+            {
+                block.rendered_content = "flat " + std::to_string(GetFlatParseResult()->cxx_files.size());
+            }
+            else
+            {
+                bool is_indexed = GetAstIndex().FindFile("/sdk/c.h") != nullptr;
+                block.rendered_content = "tree " + std::to_string(GetParseResult().cxx_files.size()) + (is_indexed ? " indexed" : "");
+            }
+            return block;
+        }
+    };
+
+    std::string read_file(const std::filesystem::path &path)
+    {
+        std::ifstream is(path, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+    }
+}
+
+TEST_CASE("DefaultGenerator::Generate(const FlatParseResult &)")
+{
+    std::filesystem::path output_dir = std::filesystem::temp_directory_path() / ("terra_generator_" + std::to_string(getpid()));
+    std::filesystem::remove_all(output_dir);
+
+    ParseResult parse_result;
+    for (auto name : {"/sdk/a.h", "/sdk/b.h", "/sdk/c.h"})
+    {
+        CXXFile cxx_file;
+        cxx_file.file_path = name;
+        parse_result.cxx_files.push_back(cxx_file);
+    }
+    FlatParseResult flat_parse_result = FlatParseResult::FromParseResult(parse_result);
+
+    SECTION("the renders see the whole ParseResult by default")
+    {
+        DefaultGenerator generator(output_dir.string(), std::make_unique<ContextSyntaxRender>(false), 2);
+        REQUIRE(generator.Generate(flat_parse_result));
+        REQUIRE(read_file(output_dir / "b.h.txt") == "tree 3 indexed\n");
+    }
+
+    SECTION("the files are materialized one at a time for the renders which support it")
+    {
+        DefaultGenerator generator(output_dir.string(), std::make_unique<ContextSyntaxRender>(true), 2);
+        REQUIRE(generator.Generate(flat_parse_result));
+        REQUIRE(read_file(output_dir / "b.h.txt") == "flat 3\n");
+    }
+
+    std::filesystem::remove_all(output_dir);
+}
@@ -0,0 +1,173 @@
+#include "terra_inheritance.hpp"
+
+#include <catch2/catch.hpp>
+
+using namespace terra;
+
+namespace
+{
+    MemberFunction make_method(const std::string &name, const std::string &signature, bool is_virtual = true)
+    {
+        MemberFunction method;
+        method.name = name;
+        method.signature = signature;
+        method.is_virtual = is_virtual;
+        return method;
+    }
+
+    Clazz make_class(const std::string &name, const std::vector<std::string> &namespaces,
+                     const std::vector<std::string> &base_clazzs, const std::vector<MemberFunction> &methods)
+    {
+        Clazz clazz;
+        clazz.name = name;
+        clazz.namespaces = namespaces;
+        clazz.base_clazzs = base_clazzs;
+        clazz.methods = methods;
+        return clazz;
+    }
+
+    void resolve(ParseResult &parse_result)
+    {
+        PassManager pass_manager;
+        pass_manager.AddPass(std::make_unique<InheritancePass>());
+        pass_manager.RunPostPasses(parse_result, 1);
+    }
+
+    const Clazz &clazz_at(const ParseResult &parse_result, size_t file, size_t node)
+    {
+        return std::get<Clazz>(parse_result.cxx_files[file].nodes[node]);
+    }
+
+    const MemberFunction &method_of(const Clazz &clazz, const std::string &name)
+    {
+        for (auto &method : clazz.methods)
+        {
+            if (method.name == name)
+            {
+                return method;
+            }
+        }
+        FAIL("no method " << name << " in " << clazz.name);
+        return clazz.methods.front();
+    }
+}
+
+TEST_CASE("InheritancePass")
+{
+    SECTION("IRtcEngineEx : IRtcEngine across files")
+    {
+        ParseResult parse_result;
+
+        CXXFile ex_file;
+        ex_file.file_path = "IAgoraRtcEngineEx.h";
+        // The forward declaration does not hide the definition in the other file
+        ex_file.nodes.push_back(make_class("IRtcEngine", {"agora", "rtc"}, {}, {}));
+        ex_file.nodes.push_back(make_class("IRtcEngineEx", {"agora", "rtc"}, {"IRtcEngine"},
+                                           {make_method("joinChannelEx", "(const char*, RtcConnection)"),
+                                            make_method("leaveChannel", "()"),
+                                            make_method("getConnection", "()", false)}));
+        parse_result.cxx_files.push_back(ex_file);
+
+        CXXFile engine_file;
+        engine_file.file_path = "IAgoraRtcEngine.h";
+        engine_file.nodes.push_back(make_class("IRtcEngine", {"agora", "rtc"}, {"agora::base::IEngineBase"},
+                                               {make_method("release", "(bool)"),
+                                                make_method("joinChannel", "(const char*)"),
+                                                make_method("leaveChannel", "()")}));
+        parse_result.cxx_files.push_back(engine_file);
+
+        CXXFile base_file;
+        base_file.file_path = "AgoraBase.h";
+        base_file.nodes.push_back(make_class("IEngineBase", {"agora", "base"}, {},
+                                             {make_method("queryInterface", "(INTERFACE_ID_TYPE, void**)")}));
+        parse_result.cxx_files.push_back(base_file);
+
+        resolve(parse_result);
+
+        const Clazz &engine_ex = clazz_at(parse_result, 0, 1);
+        REQUIRE(engine_ex.all_base_clazzs == std::vector<std::string>{"agora::rtc::IRtcEngine", "agora::base::IEngineBase"});
+        REQUIRE(engine_ex.virtual_methods == std::vector<std::string>{
+                                                 "agora::base::IEngineBase::queryInterface(INTERFACE_ID_TYPE, void**)",
+                                                 "agora::rtc::IRtcEngine::release(bool)",
+                                                 "agora::rtc::IRtcEngine::joinChannel(const char*)",
+                                                 "agora::rtc::IRtcEngineEx::leaveChannel()",
+                                                 "agora::rtc::IRtcEngineEx::joinChannelEx(const char*, RtcConnection)",
+                                             });
+        REQUIRE(method_of(engine_ex, "leaveChannel").id == "agora::rtc::IRtcEngineEx::leaveChannel()");
+        REQUIRE(method_of(engine_ex, "leaveChannel").overridden_method == "agora::rtc::IRtcEngine::leaveChannel()");
+        REQUIRE(method_of(engine_ex, "joinChannelEx").overridden_method.empty());
+        REQUIRE(method_of(engine_ex, "getConnection").overridden_method.empty());
+
+        const Clazz &engine = clazz_at(parse_result, 1, 0);
+        REQUIRE(engine.all_base_clazzs == std::vector<std::string>{"agora::base::IEngineBase"});
+        REQUIRE(engine.virtual_methods.size() == 4u);
+        REQUIRE(method_of(engine, "leaveChannel").overridden_method.empty());
+
+        // The forward declaration has no bases and no methods of its own
+        REQUIRE(clazz_at(parse_result, 0, 0).virtual_methods.empty());
+    }
+
+    SECTION("multiple bases")
+    {
+        ParseResult parse_result;
+        CXXFile cxx_file;
+        cxx_file.nodes.push_back(make_class("IA", {"ns"}, {}, {make_method("a", "()"), make_method("shared", "(int)")}));
+        cxx_file.nodes.push_back(make_class("IB", {"ns"}, {}, {make_method("b", "()"), make_method("shared", "(int)")}));
+        cxx_file.nodes.push_back(make_class("C", {"ns"}, {"IA", "::ns::IB"},
+                                            {make_method("b", "()"), make_method("c", "()")}));
+        parse_result.cxx_files.push_back(cxx_file);
+        resolve(parse_result);
+
+        // The first base's methods, the own methods which do not override it, then the other bases' methods
+        // which are not in the table yet
+        const Clazz &c = clazz_at(parse_result, 0, 2);
+        REQUIRE(c.all_base_clazzs == std::vector<std::string>{"ns::IA", "ns::IB"});
+        REQUIRE(c.virtual_methods == std::vector<std::string>{"ns::IA::a()", "ns::IA::shared(int)", "ns::C::b()", "ns::C::c()"});
+        REQUIRE(method_of(c, "b").overridden_method == "ns::IB::b()");
+        REQUIRE(method_of(c, "c").overridden_method.empty());
+    }
+
+    SECTION("lookup from the derived class outwards")
+    {
+        ParseResult parse_result;
+        CXXFile cxx_file;
+        cxx_file.nodes.push_back(make_class("Base", {}, {}, {make_method("f", "()")}));
+        cxx_file.nodes.push_back(make_class("Base", {"outer"}, {}, {make_method("g", "()")}));
+        cxx_file.nodes.push_back(make_class("Derived", {"outer", "inner"}, {"Base<int>"}, {}));
+        cxx_file.nodes.push_back(make_class("Global", {"outer", "inner"}, {"::Base"}, {}));
+        parse_result.cxx_files.push_back(cxx_file);
+        resolve(parse_result);
+
+        REQUIRE(clazz_at(parse_result, 0, 2).all_base_clazzs == std::vector<std::string>{"outer::Base"});
+        REQUIRE(clazz_at(parse_result, 0, 2).virtual_methods == std::vector<std::string>{"outer::Base::g()"});
+        REQUIRE(clazz_at(parse_result, 0, 3).virtual_methods == std::vector<std::string>{"Base::f()"});
+    }
+
+    SECTION("unresolved and cyclic bases")
+    {
+        ParseResult parse_result;
+        CXXFile cxx_file;
+        cxx_file.nodes.push_back(make_class("A", {}, {"B", "std::enable_shared_from_this<A>"}, {make_method("a", "()")}));
+        cxx_file.nodes.push_back(make_class("B", {}, {"A"}, {make_method("b", "()")}));
+        parse_result.cxx_files.push_back(cxx_file);
+        resolve(parse_result);
+
+        // The unresolved base is kept as written, the cycle is cut
+        const Clazz &a = clazz_at(parse_result, 0, 0);
+        REQUIRE(a.all_base_clazzs == std::vector<std::string>{"B", "std::enable_shared_from_this<A>"});
+        REQUIRE(a.virtual_methods == std::vector<std::string>{"B::b()", "A::a()"});
+    }
+
+    SECTION("the ids of the free functions")
+    {
+        ParseResult parse_result;
+        CXXFile cxx_file;
+        MemberFunction function = make_method("createAgoraRtcEngine", "()", false);
+        function.namespaces = {"agora", "rtc"};
+        cxx_file.nodes.push_back(function);
+        parse_result.cxx_files.push_back(cxx_file);
+        resolve(parse_result);
+
+        REQUIRE(std::get<MemberFunction>(parse_result.cxx_files[0].nodes[0]).id == "agora::rtc::createAgoraRtcEngine()");
+    }
+}
@@ -0,0 +1,194 @@
+#include "random_nodes.hpp"
+#include "terra.hpp"
+#include "terra_json_render.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <unistd.h>
+
+#include <catch2/catch.hpp>
+
+using namespace terra;
+using terra_test::RandomNodes;
+
+namespace
+{
+    // The top-level `MemberFunction`s are dumped as null and dropped when loaded, so they do not round trip
+    ParseResult make_parse_result(unsigned seed)
+    {
+        RandomNodes random_nodes(seed);
+        ParseResult parse_result;
+        for (int f = 0; f < 8; f++)
+        {
+            CXXFile cxx_file;
+            cxx_file.file_path = "/sdk/include/f" + std::to_string(f) + ".h";
+            while (cxx_file.nodes.size() < static_cast<size_t>(f * 20))
+            {
+                NodeType node = random_nodes.Node();
+                if (!std::holds_alternative<MemberFunction>(node))
+                {
+                    cxx_file.nodes.push_back(std::move(node));
+                }
+            }
+            parse_result.cxx_files.push_back(cxx_file);
+        }
+        return parse_result;
+    }
+
+    std::string dump(const std::vector<CXXFile> &cxx_files)
+    {
+        JsonWriter writer;
+        WriteCXXFilesJson(writer, cxx_files);
+        return writer.buffer;
+    }
+
+    std::string read_file(const std::filesystem::path &path)
+    {
+        std::ifstream is(path, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+    }
+
+    void write_file(const std::filesystem::path &path, const std::string &content)
+    {
+        std::ofstream os(path, std::ios::binary | std::ios::trunc);
+        os << content;
+    }
+
+    // A class named by the json string literal `name_literal`
+    std::string class_dump(const std::string &name_literal)
+    {
+        CXXFile cxx_file;
+        cxx_file.file_path = "escapes.h";
+        Clazz clazz;
+        clazz.name = "PLACEHOLDER";
+        cxx_file.nodes.push_back(clazz);
+
+        std::string json = dump({cxx_file});
+        size_t pos = json.find("\"PLACEHOLDER\"");
+        return json.replace(pos, std::string("\"PLACEHOLDER\"").size(), name_literal);
+    }
+
+    class TempDir
+    {
+    public:
+        std::filesystem::path path;
+
+        TempDir()
+            : path(std::filesystem::temp_directory_path() / ("terra_json_reader_" + std::to_string(getpid())))
+        {
+            std::filesystem::remove_all(path);
+            std::filesystem::create_directories(path);
+        }
+
+        ~TempDir()
+        {
+            std::filesystem::remove_all(path);
+        }
+    };
+}
+
+TEST_CASE("LoadCXXFiles round trip")
+{
+    TempDir temp_dir;
+    ParseResult parse_result = make_parse_result(11);
+    std::string expected = dump(parse_result.cxx_files);
+
+    SECTION("json")
+    {
+        REQUIRE(dump(ReadCXXFilesJson(expected)) == expected);
+
+        write_file(temp_dir.path / "dump.json", expected);
+        REQUIRE(dump(LoadCXXFiles((temp_dir.path / "dump.json").string())) == expected);
+    }
+
+    SECTION("sharded")
+    {
+        std::filesystem::path sharded_dir = temp_dir.path / "sharded";
+        ShardedJsonGenerator generator(sharded_dir.string(), 2);
+        REQUIRE(generator.Generate(parse_result));
+        REQUIRE(dump(LoadCXXFiles(sharded_dir.string())) == expected);
+    }
+
+    SECTION("binary")
+    {
+        BinaryWriter writer;
+        EncodeCXXFiles(writer, parse_result.cxx_files);
+        write_file(temp_dir.path / "dump.bin", writer.buffer);
+        REQUIRE(dump(LoadCXXFiles((temp_dir.path / "dump.bin").string())) == expected);
+    }
+
+    SECTION("empty")
+    {
+        write_file(temp_dir.path / "empty.json", "null");
+        REQUIRE(LoadCXXFiles((temp_dir.path / "empty.json").string()).empty());
+    }
+}
+
+TEST_CASE("ShardedJsonGenerator failed shard write")
+{
+    TempDir temp_dir;
+    ParseResult parse_result = make_parse_result(17);
+
+    std::filesystem::path sharded_dir = temp_dir.path / "sharded";
+    REQUIRE(ShardedJsonGenerator(sharded_dir.string(), 2).Generate(parse_result));
+    REQUIRE(std::filesystem::exists(sharded_dir / ShardedJsonGenerator::kManifestFileName));
+
+    // A directory in place of a shard fails its write
+    std::filesystem::remove(sharded_dir / "f3.h.json");
+    std::filesystem::create_directories(sharded_dir / "f3.h.json");
+
+    // The previous run's manifest must not be taken for this partial output
+    REQUIRE_FALSE(ShardedJsonGenerator(sharded_dir.string(), 2).Generate(parse_result));
+    REQUIRE_FALSE(std::filesystem::exists(sharded_dir / ShardedJsonGenerator::kManifestFileName));
+    REQUIRE_THROWS(LoadCXXFiles(sharded_dir.string()));
+}
+
+TEST_CASE("ReadCXXFilesJson escapes")
+{
+    SECTION("escapes and surrogate pairs")
+    {
+        auto cxx_files = ReadCXXFilesJson(class_dump(R"("a\"b\\c\/d\b\f\n\r\t\u0001\u00e9é\u4e2d中\ud83d\ude00😀")"));
+        REQUIRE(cxx_files.size() == 1u);
+        REQUIRE(cxx_files[0].nodes.size() == 1u);
+        const std::string &name = std::get<Clazz>(cxx_files[0].nodes[0]).name;
+        REQUIRE(name == "a\"b\\c/d\b\f\n\r\t\x01\xc3\xa9\xc3\xa9\xe4\xb8\xad\xe4\xb8\xad\xf0\x9f\x98\x80\xf0\x9f\x98\x80");
+
+        // The writer escapes the quotes, backslashes and control characters, and keeps the UTF-8 as is
+        REQUIRE(dump(ReadCXXFilesJson(dump(cxx_files))) == dump(cxx_files));
+    }
+
+    SECTION("malformed")
+    {
+        REQUIRE_THROWS_AS(ReadCXXFilesJson(class_dump(R"("\ud83dA")")), std::runtime_error);
+        REQUIRE_THROWS_AS(ReadCXXFilesJson(class_dump(R"("\ud83d\u0041")")), std::runtime_error);
+        REQUIRE_THROWS_AS(ReadCXXFilesJson(class_dump(R"("\ude00")")), std::runtime_error);
+        REQUIRE_THROWS_AS(ReadCXXFilesJson(class_dump(R"("\x")")), std::runtime_error);
+        REQUIRE_THROWS_AS(ReadCXXFilesJson(class_dump(R"("\u12")")), std::runtime_error);
+        REQUIRE_THROWS_AS(ReadCXXFilesJson(class_dump(R"("unterminated)")), std::runtime_error);
+        REQUIRE_THROWS_AS(ReadCXXFilesJson(class_dump(R"("a")") + "[]"), std::runtime_error);
+    }
+}
+
+TEST_CASE("JsonSyntaxRender")
+{
+    TempDir temp_dir;
+    ParseResult parse_result = make_parse_result(23);
+
+    auto &factories = SyntaxRenderFactories();
+    auto factory = factories.find(JsonSyntaxRender::kName);
+    REQUIRE(factory != factories.end());
+
+    // What `--render-from` does with `--render json`
+    std::filesystem::path output_dir = temp_dir.path / "rendered";
+    DefaultGenerator generator(output_dir.string(), factory->second(), 2);
+    REQUIRE(generator.Generate(parse_result));
+
+    for (auto &cxx_file : parse_result.cxx_files)
+    {
+        INFO(cxx_file.file_path);
+        JsonWriter writer;
+        WriteCXXFileJson(writer, cxx_file);
+        std::filesystem::path rendered = output_dir / (std::filesystem::path(cxx_file.file_path).relative_path().string() + ".json");
+        REQUIRE(read_file(rendered) == writer.buffer + "\n");
+    }
+}
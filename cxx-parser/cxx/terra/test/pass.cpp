@@ -0,0 +1,135 @@
+#include "terra_pass.hpp"
+
+#include <atomic>
+
+#include <catch2/catch.hpp>
+
+using namespace terra;
+
+namespace
+{
+    // Counts the classes, and the enum constants when the parse is finished
+    class CountingPass : public ReadOnlyPass
+    {
+    public:
+        std::atomic<size_t> class_count{0};
+        size_t enum_constant_count = 0;
+
+        std::vector<size_t> NodeKinds() const override
+        {
+            return {NodeKind<Clazz>()};
+        }
+
+        void OnNode(const NodeType &node, const CXXFile &cxx_file) override
+        {
+            class_count++;
+        }
+
+        void OnFinish(const ParseResult &parse_result) override
+        {
+            for (auto &cxx_file : parse_result.cxx_files)
+            {
+                for (auto &node : cxx_file.nodes)
+                {
+                    if (auto enumz = std::get_if<Enumz>(&node))
+                    {
+                        enum_constant_count += enumz->enum_constants.size();
+                    }
+                }
+            }
+        }
+    };
+
+    // Renames the classes, after all the read-only passes ran
+    class RenamingPass : public Pass
+    {
+    public:
+        std::vector<size_t> NodeKinds() const override
+        {
+            return {NodeKind<Clazz>()};
+        }
+
+        void OnNode(NodeType &node, CXXFile &cxx_file) override
+        {
+            std::get<Clazz>(node).name += "_renamed";
+        }
+    };
+
+    // Records the names of the classes it sees
+    class NameCollectingPass : public ReadOnlyPass
+    {
+    public:
+        std::vector<std::string> names;
+
+        std::vector<size_t> NodeKinds() const override
+        {
+            return {NodeKind<Clazz>()};
+        }
+
+        void OnNode(const NodeType &node, const CXXFile &cxx_file) override
+        {
+            names.push_back(std::get<Clazz>(node).name);
+        }
+    };
+
+    ParseResult make_parse_result()
+    {
+        ParseResult parse_result;
+        for (int i = 0; i < 3; i++)
+        {
+            CXXFile cxx_file;
+            cxx_file.file_path = "file" + std::to_string(i) + ".h";
+
+            Clazz clazz;
+            clazz.name = "IFoo" + std::to_string(i);
+            cxx_file.nodes.push_back(clazz);
+
+            Enumz enumz;
+            enumz.name = "FOO_TYPE";
+            enumz.enum_constants.resize(2);
+            cxx_file.nodes.push_back(enumz);
+
+            parse_result.cxx_files.push_back(cxx_file);
+        }
+        return parse_result;
+    }
+}
+
+TEST_CASE("ReadOnlyPass")
+{
+    ParseResult parse_result = make_parse_result();
+
+    PassManager pass_manager;
+    std::vector<CountingPass *> counting_passes;
+    for (int i = 0; i < 8; i++)
+    {
+        auto pass = std::make_unique<CountingPass>();
+        counting_passes.push_back(pass.get());
+        pass_manager.AddPass(std::move(pass));
+    }
+    pass_manager.AddPass(std::make_unique<RenamingPass>());
+    auto name_collecting_pass = std::make_unique<NameCollectingPass>();
+    NameCollectingPass *names = name_collecting_pass.get();
+    pass_manager.AddPass(std::move(name_collecting_pass));
+
+    pass_manager.RunPostPasses(parse_result, 4);
+
+    SECTION("every read-only pass sees all the nodes")
+    {
+        for (auto pass : counting_passes)
+        {
+            REQUIRE(pass->class_count == 3u);
+            REQUIRE(pass->enum_constant_count == 6u);
+        }
+    }
+
+    SECTION("the read-only passes run before the other passes")
+    {
+        REQUIRE(names->names.size() == 3u);
+        for (auto &name : names->names)
+        {
+            REQUIRE(name.find("_renamed") == std::string::npos);
+        }
+        REQUIRE(std::get<Clazz>(parse_result.cxx_files[0].nodes[0]).name == "IFoo0_renamed");
+    }
+}
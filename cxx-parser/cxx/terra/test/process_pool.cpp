@@ -0,0 +1,93 @@
+#include "terra_process_pool.hpp"
+
+#include <csignal>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <thread>
+#include <unistd.h>
+
+#include <catch2/catch.hpp>
+
+using namespace terra;
+
+namespace
+{
+    // Fails on the files named after a failure, and converts the others to a class named after the file
+    class FakeParser : public Parser
+    {
+    private:
+        std::string flaky_mark_;
+
+    public:
+        explicit FakeParser(std::string flaky_mark) : flaky_mark_(std::move(flaky_mark)) {}
+
+        bool Parse(const ParseConfig &parse_config, ParseResult &parse_result) override
+        {
+            const std::string &file = parse_config.parse_files[0];
+            if (file == "killed")
+            {
+                raise(SIGKILL);
+            }
+            else if (file == "hang")
+            {
+                std::this_thread::sleep_for(std::chrono::hours(1));
+            }
+            else if (file == "throw")
+            {
+                throw std::runtime_error("libclang crashed");
+            }
+            else if (file == "flaky" && !std::filesystem::exists(flaky_mark_))
+            {
+                // Only the first worker parsing the file is killed
+                std::ofstream(flaky_mark_) << 1;
+                raise(SIGKILL);
+            }
+
+            CXXFile cxx_file;
+            cxx_file.file_path = file;
+            Clazz clazz;
+            clazz.name = "C_" + file;
+            cxx_file.nodes.push_back(clazz);
+            parse_result.cxx_files.push_back(cxx_file);
+            return true;
+        }
+    };
+}
+
+TEST_CASE("ProcessPoolParser")
+{
+    std::string flaky_mark = (std::filesystem::temp_directory_path() / ("terra_flaky_" + std::to_string(getpid()))).string();
+    std::filesystem::remove(flaky_mark);
+
+    ParseConfig parse_config;
+    parse_config.parse_files = {"a", "killed", "b", "hang", "throw", "flaky", "c"};
+
+    ProcessPoolParser pool([&]
+                           { return std::make_unique<FakeParser>(flaky_mark); },
+                           3, 1, std::chrono::milliseconds(500));
+    ParseResult parse_result;
+    pool.Parse(parse_config, parse_result);
+    std::filesystem::remove(flaky_mark);
+
+    // The parsed and the retried files are kept in order
+    std::vector<std::string> names;
+    for (auto &cxx_file : parse_result.cxx_files)
+    {
+        REQUIRE(cxx_file.nodes.size() == 1u);
+        names.push_back(std::get<Clazz>(cxx_file.nodes[0]).name);
+    }
+    REQUIRE(names == std::vector<std::string>{"C_a", "C_b", "C_flaky", "C_c"});
+
+    // The failed files are skipped after the retry
+    std::map<std::string, std::string> skipped_files;
+    for (auto &skipped_file : pool.SkippedFiles())
+    {
+        skipped_files[skipped_file.file] = skipped_file.reason;
+    }
+    REQUIRE(skipped_files.size() == 3u);
+    REQUIRE(skipped_files["killed"].find("killed by signal " + std::to_string(SIGKILL)) != std::string::npos);
+    REQUIRE(skipped_files["hang"].find("timed out") != std::string::npos);
+    // An exception is reported by the worker, and not retried
+    REQUIRE(skipped_files["throw"] == "libclang crashed");
+}
@@ -0,0 +1,198 @@
+#ifndef terra_TEST_RANDOM_NODES_H_
+#define terra_TEST_RANDOM_NODES_H_
+
+#include <random>
+#include <string>
+#include <vector>
+#include "terra_node.hpp"
+
+namespace terra_test
+{
+    using namespace terra;
+
+    // Random nodes with all the fields set, the strings include escapes, control and non-ASCII characters
+    class RandomNodes
+    {
+    private:
+        std::mt19937 rng_;
+
+        bool Bool()
+        {
+            return rng_() % 2 == 0;
+        }
+
+        size_t Count(size_t max)
+        {
+            return rng_() % (max + 1);
+        }
+
+        std::string String()
+        {
+            static const char *pieces[] = {"a", "b\"q", "\\", "\n", "\t", "\x01", "\x1f", "\b\f\r", "\x7f", "xyz", "", "中文", "é"};
+            std::string result;
+            for (size_t i = Count(4); i > 0; i--)
+            {
+                result += pieces[rng_() % (sizeof(pieces) / sizeof(pieces[0]))];
+            }
+            return result;
+        }
+
+        std::vector<std::string> Strings()
+        {
+            std::vector<std::string> result;
+            for (size_t i = Count(2); i > 0; i--)
+            {
+                result.push_back(String());
+            }
+            return result;
+        }
+
+        void FillBase(BaseNode &node)
+        {
+            // The json writers drop the classes without a name
+            node.name = "n" + String();
+            node.namespaces = Strings();
+            node.file_path = String();
+            node.parent_name = String();
+            node.parent_full_scope_name = String();
+            node.attributes = Strings();
+            node.comment = String();
+            node.source = String();
+            node.conditional_compilation_directives_infos = Strings();
+            node.fingerprint = String();
+        }
+
+        SimpleType Type()
+        {
+            SimpleType type;
+            type.name = String();
+            type.source = String();
+            type.kind = static_cast<SimpleTypeKind>(100 + rng_() % 5);
+            type.is_const = Bool();
+            type.is_builtin_type = Bool();
+            type.is_unresolved = Bool();
+            type.template_arguments = Strings();
+            return type;
+        }
+
+        Variable Var()
+        {
+            Variable variable;
+            FillBase(variable);
+            variable.type = Type();
+            variable.default_value = String();
+            variable.is_output = Bool();
+            if (Bool())
+            {
+                variable.evaluated_value = static_cast<int64_t>(rng_()) - static_cast<int64_t>(rng_()) * static_cast<int64_t>(rng_());
+            }
+            return variable;
+        }
+
+        MemberFunction Method()
+        {
+            MemberFunction method;
+            FillBase(method);
+            method.is_virtual = Bool();
+            method.return_type = Type();
+            for (size_t i = Count(2); i > 0; i--)
+            {
+                method.parameters.push_back(Var());
+            }
+            method.access_specifier = String();
+            method.is_overriding = Bool();
+            method.is_const = Bool();
+            method.signature = String();
+            method.is_variadic = Bool();
+            method.mangled_name = String();
+            method.id = String();
+            method.overridden_method = String();
+            return method;
+        }
+
+        template <typename T>
+        T Class()
+        {
+            T clazz;
+            FillBase(clazz);
+            for (size_t i = Count(1); i > 0; i--)
+            {
+                Constructor constructor;
+                FillBase(constructor);
+                for (size_t j = Count(2); j > 0; j--)
+                {
+                    constructor.parameters.push_back(Var());
+                }
+                clazz.constructors.push_back(constructor);
+            }
+            for (size_t i = Count(3); i > 0; i--)
+            {
+                clazz.methods.push_back(Method());
+            }
+            for (size_t i = Count(2); i > 0; i--)
+            {
+                MemberVariable member_variable;
+                FillBase(member_variable);
+                member_variable.type = Type();
+                member_variable.is_mutable = Bool();
+                member_variable.access_specifier = String();
+                clazz.member_variables.push_back(member_variable);
+            }
+            clazz.base_clazzs = Strings();
+            clazz.all_base_clazzs = Strings();
+            clazz.virtual_methods = Strings();
+            return clazz;
+        }
+
+    public:
+        explicit RandomNodes(unsigned seed) : rng_(seed) {}
+
+        NodeType Node()
+        {
+            switch (rng_() % 7)
+            {
+            case 0:
+            {
+                IncludeDirective include_directive;
+                FillBase(include_directive);
+                include_directive.include_file_path = String();
+                return include_directive;
+            }
+            case 1:
+            {
+                TypeAlias type_alias;
+                FillBase(type_alias);
+                type_alias.underlyingType = Type();
+                return type_alias;
+            }
+            case 2:
+                return Class<Clazz>();
+            case 3:
+            {
+                Enumz enumz;
+                FillBase(enumz);
+                for (size_t i = Count(3); i > 0; i--)
+                {
+                    EnumConstant enum_constant;
+                    FillBase(enum_constant);
+                    enum_constant.value = String();
+                    if (Bool())
+                    {
+                        enum_constant.evaluated_value = -static_cast<int64_t>(rng_());
+                    }
+                    enumz.enum_constants.push_back(enum_constant);
+                }
+                return enumz;
+            }
+            case 4:
+                return Class<Struct>();
+            case 5:
+                return Method();
+            default:
+                return Var();
+            }
+        }
+    };
+}
+
+#endif // terra_TEST_RANDOM_NODES_H_
@@ -0,0 +1,72 @@
+#include "terra_render_rope.hpp"
+
+#include <sstream>
+
+#include <catch2/catch.hpp>
+
+using namespace terra;
+
+TEST_CASE("RenderRope")
+{
+    SECTION("appends")
+    {
+        std::string referenced = "ref";
+        RenderRope rope;
+        rope.Append("a").Append('b').AppendRef(referenced).Append(std::string(5000, 'c'));
+        REQUIRE(rope.size() == 5005u);
+        REQUIRE(rope.ToString() == "abref" + std::string(5000, 'c'));
+
+        std::ostringstream os;
+        rope.WriteTo(os);
+        REQUIRE(os.str() == rope.ToString());
+    }
+
+    SECTION("move, then append, then ToString")
+    {
+        RenderRope source;
+        source.Append("first");
+
+        RenderRope moved(std::move(source));
+        // The moved from rope must not append into the chunk it no longer owns
+        source.Append("second");
+        moved.Append("+moved");
+        REQUIRE(source.size() == 6u);
+        REQUIRE(source.ToString() == "second");
+        REQUIRE(moved.ToString() == "first+moved");
+
+        RenderRope assigned;
+        assigned.Append("old");
+        assigned = std::move(moved);
+        moved.Append("third");
+        assigned.Append("+assigned");
+        REQUIRE(moved.ToString() == "third");
+        REQUIRE(assigned.size() == 20u);
+        REQUIRE(assigned.ToString() == "first+moved+assigned");
+    }
+
+    SECTION("append a moved rope")
+    {
+        RenderRope block;
+        block.Append("block");
+        RenderRope rope;
+        rope.Append("<").Append(std::move(block)).Append(">");
+        block.Append("again");
+        REQUIRE(rope.ToString() == "<block>");
+        REQUIRE(block.ToString() == "again");
+    }
+
+    SECTION("copies do not share the arena")
+    {
+        RenderRope rope;
+        rope.Append("text");
+        RenderRope copy(rope);
+        rope.Append("+rope");
+        copy.Append("+copy");
+        REQUIRE(rope.ToString() == "text+rope");
+        REQUIRE(copy.ToString() == "text+copy");
+
+        RenderRope referencing;
+        referencing.AppendRef(copy).Append("!");
+        REQUIRE(referencing.ToString() == "text+copy!");
+    }
+}
@@ -0,0 +1,153 @@
+#include "terra.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <unistd.h>
+
+#include <catch2/catch.hpp>
+
+using namespace terra;
+
+namespace
+{
+    // Renders the file path of each file, and formats a file by appending a line to it
+    class PathSyntaxRender : public SyntaxRender
+    {
+    public:
+        std::vector<std::string> *formatted_files;
+
+        explicit PathSyntaxRender(std::vector<std::string> *formatted_files) : formatted_files(formatted_files) {}
+
+    protected:
+        bool ShouldRender(const CXXFile &file) override
+        {
+            return true;
+        }
+
+        RenderedBlock RenderedFileName(const std::string &file_path) override
+        {
+            RenderedBlock block;
+            block.rendered_content = std::filesystem::path(file_path).relative_path().string() + ".txt";
+            return block;
+        }
+
+        RenderedBlock RenderIncludeDirectives(const CXXFile &file, const std::vector<IncludeDirective> &include_directives) override
+        {
+            RenderedBlock block;
+            block.rendered_content = file.file_path;
+            return block;
+        }
+
+        void FormatCodes(const std::vector<std::string> &file_paths) override
+        {
+            for (auto &file_path : file_paths)
+            {
+                std::ofstream os(file_path, std::ofstream::app);
+                os << "\n// formatted";
+                formatted_files->push_back(std::filesystem::path(file_path).filename().string());
+            }
+        }
+    };
+
+    ParseResult make_parse_result()
+    {
+        ParseResult parse_result;
+        for (auto name : {"/sdk/a.h", "/sdk/b.h"})
+        {
+            CXXFile cxx_file;
+            cxx_file.file_path = name;
+            parse_result.cxx_files.push_back(cxx_file);
+        }
+        return parse_result;
+    }
+
+    void write_file(const std::filesystem::path &path, const std::string &content)
+    {
+        std::ofstream os(path, std::ios::binary | std::ios::trunc);
+        os << content;
+    }
+
+    class TempDir
+    {
+    public:
+        std::filesystem::path path;
+
+        TempDir()
+            : path(std::filesystem::temp_directory_path() / ("terra_render_stamps_" + std::to_string(getpid())))
+        {
+            std::filesystem::remove_all(path);
+            std::filesystem::create_directories(path);
+        }
+
+        ~TempDir()
+        {
+            std::filesystem::remove_all(path);
+        }
+    };
+}
+
+TEST_CASE("DefaultGenerator render stamps")
+{
+    TempDir temp_dir;
+    ParseResult parse_result = make_parse_result();
+    std::filesystem::path output_dir = temp_dir.path / "generated";
+    std::filesystem::path stamps_path = temp_dir.path / "build" / "render_stamps.json";
+
+    std::vector<std::string> formatted_files;
+    auto generate = [&](const std::string &render_stamps_path)
+    {
+        formatted_files.clear();
+        DefaultGenerator generator(output_dir.string(), std::make_unique<PathSyntaxRender>(&formatted_files), 1, render_stamps_path);
+        REQUIRE(generator.Generate(parse_result));
+    };
+
+    SECTION("the unchanged files are not written and formatted again")
+    {
+        generate(stamps_path.string());
+        REQUIRE(formatted_files == std::vector<std::string>{"a.h.txt", "b.h.txt"});
+        REQUIRE(std::filesystem::exists(stamps_path));
+
+        // Only the rendered files are in the output dir
+        std::vector<std::string> output_files;
+        for (auto &entry : std::filesystem::recursive_directory_iterator(output_dir))
+        {
+            if (entry.is_regular_file())
+            {
+                output_files.push_back(entry.path().filename().string());
+            }
+        }
+        std::sort(output_files.begin(), output_files.end());
+        REQUIRE(output_files == std::vector<std::string>{"a.h.txt", "b.h.txt"});
+
+        generate(stamps_path.string());
+        REQUIRE(formatted_files.empty());
+
+        // A file changed on disk is rendered again
+        write_file(output_dir / "sdk" / "b.h.txt", "edited");
+        generate(stamps_path.string());
+        REQUIRE(formatted_files == std::vector<std::string>{"b.h.txt"});
+    }
+
+    SECTION("without stamps, the formatted files are rendered again")
+    {
+        generate("");
+        generate("");
+        REQUIRE(formatted_files == std::vector<std::string>{"a.h.txt", "b.h.txt"});
+    }
+
+    SECTION("a malformed stamp file or entry is ignored")
+    {
+        generate(stamps_path.string());
+
+        write_file(stamps_path, R"({"sdk/a.h.txt": 1, "sdk/b.h.txt": {"rendered": 2, "output": null}})");
+        generate(stamps_path.string());
+        REQUIRE(formatted_files == std::vector<std::string>{"a.h.txt", "b.h.txt"});
+        generate(stamps_path.string());
+        REQUIRE(formatted_files.empty());
+
+        write_file(stamps_path, "[1, 2");
+        generate(stamps_path.string());
+        REQUIRE(formatted_files == std::vector<std::string>{"a.h.txt", "b.h.txt"});
+    }
+}
@@ -0,0 +1,156 @@
+#include "terra.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <sstream>
+
+#include <catch2/catch.hpp>
+
+using namespace terra;
+
+namespace
+{
+    // The `idx` must outlive the conversion of the file
+    std::unique_ptr<cppast::cpp_file> parse_agora_header(cppast::cpp_entity_index &idx, const std::string &file_name)
+    {
+        cppast::libclang_compile_config config;
+        config.add_include_dir(TERRA_AGORA_HEADERS_DIR);
+        config.add_include_dir(TERRA_SYSTEM_FAKE_DIR);
+        config.set_flags(cppast::cpp_standard::cpp_latest);
+
+        cppast::stderr_diagnostic_logger logger;
+        cppast::libclang_parser parser(type_safe::ref(logger));
+        return parser.parse(idx, std::string(TERRA_AGORA_HEADERS_DIR) + "/" + file_name, config);
+    }
+
+    std::vector<std::string> agora_header_names()
+    {
+        std::vector<std::string> file_names;
+        for (auto &entry : std::filesystem::directory_iterator(TERRA_AGORA_HEADERS_DIR))
+        {
+            if (entry.path().extension() == ".h")
+            {
+                file_names.push_back(entry.path().filename().string());
+            }
+        }
+        std::sort(file_names.begin(), file_names.end());
+        return file_names;
+    }
+
+    size_t node_count(const ParseResult &parse_result)
+    {
+        size_t count = 0;
+        for (auto &cxx_file : parse_result.cxx_files)
+        {
+            count += cxx_file.nodes.size();
+        }
+        return count;
+    }
+
+    // The json dump of the converted file, the conversion logs are dropped
+    std::string convert_to_json(const cppast::cpp_file &file, size_t conversion_jobs)
+    {
+        std::ostringstream logs;
+        auto cout_buffer = std::cout.rdbuf(logs.rdbuf());
+        RootParser root_parser;
+        root_parser.ConvertFile(file, conversion_jobs);
+        std::cout.rdbuf(cout_buffer);
+
+        JsonWriter writer;
+        WriteCXXFilesJson(writer, root_parser.GetParseResult().cxx_files);
+        return writer.buffer;
+    }
+}
+
+// The concurrent conversion must produce the same dump as the serial one before it can be the default,
+// see `ParseConfig::conversion_jobs`
+TEST_CASE("RootParser concurrent conversion of the Agora headers")
+{
+    std::vector<std::string> file_names = agora_header_names();
+    REQUIRE(file_names.size() > 1u);
+
+    for (auto &file_name : file_names)
+    {
+        INFO(file_name);
+        cppast::cpp_entity_index idx;
+        auto file = parse_agora_header(idx, file_name);
+        REQUIRE(file);
+
+        std::string serial = convert_to_json(*file, 1);
+        for (size_t conversion_jobs : {0, 2, 8})
+        {
+            INFO("conversion_jobs " << conversion_jobs);
+            REQUIRE(convert_to_json(*file, conversion_jobs) == serial);
+        }
+    }
+}
+
+// `--diff` computes the fingerprints of both sides, so a default dump, which has none, can be diffed against
+TEST_CASE("DiffAstDump of a dump without fingerprints against a re-parse of the Agora headers")
+{
+    auto parse_all = []()
+    {
+        std::ostringstream logs;
+        auto cout_buffer = std::cout.rdbuf(logs.rdbuf());
+        RootParser root_parser;
+        for (auto &file_name : agora_header_names())
+        {
+            cppast::cpp_entity_index idx;
+            auto file = parse_agora_header(idx, file_name);
+            REQUIRE(file);
+            root_parser.ConvertFile(*file);
+        }
+        std::cout.rdbuf(cout_buffer);
+        return root_parser.GetParseResult();
+    };
+
+    JsonWriter writer;
+    WriteCXXFilesJson(writer, parse_all().cxx_files);
+    REQUIRE(writer.buffer.find("\"fingerprint\"") == std::string::npos);
+    std::vector<CXXFile> old_cxx_files = ReadCXXFilesJson(writer.buffer);
+
+    ParseResult parse_result = parse_all();
+    REQUIRE(node_count(parse_result) > 0u);
+    nlohmann::json diff = DiffAstDump(old_cxx_files, parse_result.cxx_files);
+    REQUIRE(diff["added"].empty());
+    REQUIRE(diff["removed"].empty());
+    REQUIRE(diff["modified"].empty());
+}
+
+// The conversion of an already parsed header, i.e., `RootParser::print_ast` without the libclang parse,
+// serially and with the top-level classes and enums converted concurrently
+TEST_CASE("print_ast benchmark", "[!hide][!benchmark]")
+{
+    cppast::cpp_entity_index idx;
+    auto file = parse_agora_header(idx, "IAgoraRtcEngine.h");
+    REQUIRE(file);
+
+    const auto iterations = 20;
+    auto measure = [&](const char *name, size_t conversion_jobs)
+    {
+        // The conversion logs are part of the work, but not of the benchmark output
+        std::ostringstream logs;
+        auto cout_buffer = std::cout.rdbuf(logs.rdbuf());
+
+        size_t nodes = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (auto i = 0; i != iterations; ++i)
+        {
+            RootParser root_parser;
+            root_parser.ConvertFile(*file, conversion_jobs);
+            nodes = node_count(root_parser.GetParseResult());
+        }
+        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+        std::cout.rdbuf(cout_buffer);
+        WARN(name << ": " << duration.count() / iterations << "us per print_ast of IAgoraRtcEngine.h, "
+                  << nodes << " top-level nodes");
+        return nodes;
+    };
+
+    auto serial = measure("serial", 1);
+    auto concurrent = measure("concurrent", 0);
+    REQUIRE(serial > 0u);
+    REQUIRE(serial == concurrent);
+}
@@ -23,6 +23,11 @@ public:
     /// \effects Creates it viewing the [std::string]().
     string_view(const std::string& str) noexcept : str_(str.c_str()), length_(str.length()) {}
 
+    /// \effects Creates it viewing the spelling of a token.
+    string_view(const cpp_token_spelling& str) noexcept
+    : str_(str.c_str()), length_(str.length())
+    {}
+
     /// \effects Creates it viewing the C string `str`.
     string_view(const char* str) noexcept : str_(str), length_(std::strlen(str)) {}
 
@@ -4,6 +4,7 @@
 #ifndef CPPAST_CPP_ENTITY_INDEX_HPP_INCLUDED
 #define CPPAST_CPP_ENTITY_INDEX_HPP_INCLUDED
 
+#include <array>
 #include <cstdint>
 #include <mutex>
 #include <string>
@@ -30,6 +31,14 @@ namespace detail
     {
         return *str ? id_hash(str + 1, (hash ^ hash_type(*str)) * fnv_prime) : hash;
     }
+
+    // same as id_hash(), but iterative for long runtime strings
+    inline hash_type runtime_id_hash(const char* str, hash_type hash = fnv_basis) noexcept
+    {
+        for (; *str; ++str)
+            hash = (hash ^ hash_type(*str)) * fnv_prime;
+        return hash;
+    }
 } // namespace detail
 
 /// A [ts::strong_typedef]() representing the unique id of a [cppast::cpp_entity]().
@@ -40,7 +49,13 @@ struct cpp_entity_id : type_safe::strong_typedef<cpp_entity_id, detail::hash_typ
 {
     explicit cpp_entity_id(const std::string& str) : cpp_entity_id(str.c_str()) {}
 
-    explicit cpp_entity_id(const char* str) : strong_typedef(detail::id_hash(str)) {}
+    explicit cpp_entity_id(const char* str) : strong_typedef(detail::runtime_id_hash(str)) {}
+
+    /// \effects Creates the same id as for the concatenation of `str` and `suffix`,
+    /// without creating the concatenated string.
+    explicit cpp_entity_id(const char* str, const char* suffix)
+    : strong_typedef(detail::runtime_id_hash(suffix, detail::runtime_id_hash(str)))
+    {}
 };
 
 inline namespace literals
@@ -55,6 +70,8 @@ inline namespace literals
 /// An index of all [cppast::cpp_entity]() objects created.
 ///
 /// It maps [cppast::cpp_entity_id]() to references to the [cppast::cpp_entity]() objects.
+/// The ids are distributed over multiple independently locked shards,
+/// so multiple threads can register and look up entities concurrently.
 class cpp_entity_index
 {
 public:
@@ -131,11 +148,26 @@ private:
         {}
     };
 
-    mutable std::mutex                                     mutex_;
-    mutable std::unordered_map<cpp_entity_id, value, hash> map_;
-    mutable std::unordered_map<cpp_entity_id,
-                               std::vector<type_safe::object_ref<const cpp_namespace>>, hash>
-        ns_;
+    struct shard
+    {
+        std::mutex                                     mutex;
+        std::unordered_map<cpp_entity_id, value, hash> map;
+        std::unordered_map<cpp_entity_id,
+                           std::vector<type_safe::object_ref<const cpp_namespace>>, hash>
+            ns;
+    };
+
+    static constexpr unsigned shard_bits = 6u;
+
+    shard& get_shard(const cpp_entity_id& id) const noexcept
+    {
+        // the ids are already hashes, use the upper bits for the shard
+        // as the hash map buckets are selected by the lower bits
+        auto index = static_cast<detail::hash_type>(id) >> (64u - shard_bits);
+        return shards_[static_cast<std::size_t>(index)];
+    }
+
+    mutable std::array<shard, std::size_t(1u) << shard_bits> shards_;
 };
 } // namespace cppast
 
@@ -4,8 +4,10 @@
 #ifndef CPPAST_CPP_ENUM_HPP_INCLUDED
 #define CPPAST_CPP_ENUM_HPP_INCLUDED
 
+#include <cstdint>
 #include <memory>
 
+#include <type_safe/optional.hpp>
 #include <type_safe/optional_ref.hpp>
 
 #include <cppast/cpp_entity.hpp>
@@ -25,9 +27,11 @@ public:
 
     /// \returns A newly created and registered enum value.
     /// \notes `value` may be `nullptr`, in which case the enum has an implicit value.
-    static std::unique_ptr<cpp_enum_value> build(const cpp_entity_index& idx, cpp_entity_id id,
-                                                 std::string                     name,
-                                                 std::unique_ptr<cpp_expression> value = nullptr);
+    /// `integer_value` is the value of the enumerator, explicit or implicit, if it is known.
+    static std::unique_ptr<cpp_enum_value> build(
+        const cpp_entity_index& idx, cpp_entity_id id, std::string name,
+        std::unique_ptr<cpp_expression>   value         = nullptr,
+        type_safe::optional<std::int64_t> integer_value = type_safe::nullopt);
 
     /// \returns A [ts::optional_ref]() to the [cppast::cpp_expression]() that is the enum value.
     /// \notes It only has an associated expression if the value is explictly given.
@@ -36,14 +40,23 @@ public:
         return type_safe::opt_cref(value_.get());
     }
 
+    /// \returns The value of the enumerator as evaluated by the parser, if it is known.
+    /// \notes Unlike [*value](), it is also available if the value is implicit.
+    type_safe::optional<std::int64_t> integer_value() const noexcept
+    {
+        return integer_value_;
+    }
+
 private:
-    cpp_enum_value(std::string name, std::unique_ptr<cpp_expression> value)
-    : cpp_entity(std::move(name)), value_(std::move(value))
+    cpp_enum_value(std::string name, std::unique_ptr<cpp_expression> value,
+                   type_safe::optional<std::int64_t> integer_value)
+    : cpp_entity(std::move(name)), value_(std::move(value)), integer_value_(integer_value)
     {}
 
     cpp_entity_kind do_get_entity_kind() const noexcept override;
 
-    std::unique_ptr<cpp_expression> value_;
+    std::unique_ptr<cpp_expression>   value_;
+    type_safe::optional<std::int64_t> integer_value_;
 };
 
 /// A [cppast::cpp_entity]() modelling a C++ enumeration.
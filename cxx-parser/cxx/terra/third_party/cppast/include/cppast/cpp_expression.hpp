@@ -5,8 +5,11 @@
 #define CPPAST_CPP_EXPRESSION_HPP_INCLUDED
 
 #include <atomic>
+#include <cstdint>
 #include <memory>
 
+#include <type_safe/optional.hpp>
+
 #include <cppast/cpp_token.hpp>
 #include <cppast/cpp_type.hpp>
 
@@ -41,6 +44,14 @@ public:
         return *type_;
     }
 
+    /// \returns The value of the expression if it is an integer constant expression,
+    /// as evaluated by the parser.
+    /// \notes Unsigned values that do not fit into `std::int64_t` are wrapped around.
+    type_safe::optional<std::int64_t> integer_value() const noexcept
+    {
+        return integer_value_;
+    }
+
     /// \returns The specified user data.
     void* user_data() const noexcept
     {
@@ -60,9 +71,11 @@ public:
     }
 
 protected:
-    /// \effects Creates it given the type.
+    /// \effects Creates it given the type and the evaluated integer value, if any.
     /// \requires The type must not be `nullptr`.
-    cpp_expression(std::unique_ptr<cpp_type> type) : type_(std::move(type)), user_data_(nullptr)
+    cpp_expression(std::unique_ptr<cpp_type>         type,
+                   type_safe::optional<std::int64_t> integer_value = type_safe::nullopt)
+    : type_(std::move(type)), integer_value_(integer_value), user_data_(nullptr)
     {
         DEBUG_ASSERT(type_ != nullptr, detail::precondition_error_handler{});
     }
@@ -71,8 +84,9 @@ private:
     /// \returns The [cppast::cpp_expression_kind]().
     virtual cpp_expression_kind do_get_kind() const noexcept = 0;
 
-    std::unique_ptr<cpp_type>  type_;
-    mutable std::atomic<void*> user_data_;
+    std::unique_ptr<cpp_type>         type_;
+    type_safe::optional<std::int64_t> integer_value_;
+    mutable std::atomic<void*>        user_data_;
 };
 
 /// An unexposed [cppast::cpp_expression]().
@@ -82,11 +96,12 @@ class cpp_unexposed_expression final : public cpp_expression
 {
 public:
     /// \returns A newly created unexposed expression.
-    static std::unique_ptr<cpp_unexposed_expression> build(std::unique_ptr<cpp_type> type,
-                                                           cpp_token_string          str)
+    static std::unique_ptr<cpp_unexposed_expression> build(
+        std::unique_ptr<cpp_type> type, cpp_token_string str,
+        type_safe::optional<std::int64_t> integer_value = type_safe::nullopt)
     {
         return std::unique_ptr<cpp_unexposed_expression>(
-            new cpp_unexposed_expression(std::move(type), std::move(str)));
+            new cpp_unexposed_expression(std::move(type), std::move(str), integer_value));
     }
 
     /// \returns The expression as a string.
@@ -96,8 +111,9 @@ public:
     }
 
 private:
-    cpp_unexposed_expression(std::unique_ptr<cpp_type> type, cpp_token_string str)
-    : cpp_expression(std::move(type)), str_(std::move(str))
+    cpp_unexposed_expression(std::unique_ptr<cpp_type> type, cpp_token_string str,
+                             type_safe::optional<std::int64_t> integer_value)
+    : cpp_expression(std::move(type), integer_value), str_(std::move(str))
     {}
 
     cpp_expression_kind do_get_kind() const noexcept override
@@ -113,11 +129,12 @@ class cpp_literal_expression final : public cpp_expression
 {
 public:
     /// \returns A newly created literal expression.
-    static std::unique_ptr<cpp_literal_expression> build(std::unique_ptr<cpp_type> type,
-                                                         std::string               value)
+    static std::unique_ptr<cpp_literal_expression> build(
+        std::unique_ptr<cpp_type> type, std::string value,
+        type_safe::optional<std::int64_t> integer_value = type_safe::nullopt)
     {
         return std::unique_ptr<cpp_literal_expression>(
-            new cpp_literal_expression(std::move(type), std::move(value)));
+            new cpp_literal_expression(std::move(type), std::move(value), integer_value));
     }
 
     /// \returns The value of the literal, as string.
@@ -127,8 +144,9 @@ public:
     }
 
 private:
-    cpp_literal_expression(std::unique_ptr<cpp_type> type, std::string value)
-    : cpp_expression(std::move(type)), value_(std::move(value))
+    cpp_literal_expression(std::unique_ptr<cpp_type> type, std::string value,
+                           type_safe::optional<std::int64_t> integer_value)
+    : cpp_expression(std::move(type), integer_value), value_(std::move(value))
     {}
 
     cpp_expression_kind do_get_kind() const noexcept override
@@ -4,6 +4,8 @@
 #ifndef CPPAST_CPP_TOKEN_HPP_INCLUDED
 #define CPPAST_CPP_TOKEN_HPP_INCLUDED
 
+#include <cstring>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -25,14 +27,169 @@ enum class cpp_token_kind
     punctuation     //< Any other punctuation.
 };
 
+/// The spelling of a [cppast::cpp_token]().
+///
+/// It does not own the characters,
+/// a [cppast::cpp_token_string]() stores the spellings of its tokens in a text buffer.
+/// All token strings of a parsed file share the same buffer, which stores identical spellings only
+/// once, so the tokens do not require an allocation each.
+class cpp_token_spelling
+{
+public:
+    /// \effects Creates it viewing the C string `str`.
+    cpp_token_spelling(const char* str) noexcept : str_(str), length_(std::strlen(str)) {}
+
+    /// \effects Creates it viewing the [std::string]().
+    /// \notes The string must outlive the token or the token must be added to a
+    /// [cppast::cpp_token_string::builder]() before the string is destroyed.
+    cpp_token_spelling(const std::string& str) noexcept : str_(str.c_str()), length_(str.length())
+    {}
+
+    /// \notes A temporary string would be destroyed while it is still viewed.
+    cpp_token_spelling(std::string&& str) = delete;
+
+    /// \effects Creates it viewing the first `length` characters of `str`.
+    /// \notes `c_str()` requires that `str[length]` is a null terminator.
+    cpp_token_spelling(const char* str, std::size_t length) noexcept : str_(str), length_(length) {}
+
+    /// \returns The number of characters.
+    std::size_t length() const noexcept
+    {
+        return length_;
+    }
+
+    /// \returns The number of characters.
+    std::size_t size() const noexcept
+    {
+        return length_;
+    }
+
+    /// \returns Whether or not it is empty.
+    bool empty() const noexcept
+    {
+        return length_ == 0u;
+    }
+
+    /// \returns The null-terminated characters.
+    const char* c_str() const noexcept
+    {
+        return str_;
+    }
+
+    /// \returns The characters.
+    const char* data() const noexcept
+    {
+        return str_;
+    }
+
+    /// \returns An iterator to the first character.
+    const char* begin() const noexcept
+    {
+        return str_;
+    }
+
+    /// \returns An iterator one past the last character.
+    const char* end() const noexcept
+    {
+        return str_ + length_;
+    }
+
+    /// \returns The character at the given index.
+    /// \requires `i < length()`.
+    char operator[](std::size_t i) const noexcept
+    {
+        return str_[i];
+    }
+
+    /// \returns The first character.
+    /// \requires `!empty()`.
+    char front() const noexcept
+    {
+        return str_[0u];
+    }
+
+    /// \returns The last character.
+    /// \requires `!empty()`.
+    char back() const noexcept
+    {
+        return str_[length_ - 1u];
+    }
+
+    /// \returns A copy of the characters.
+    std::string str() const
+    {
+        return std::string(str_, length_);
+    }
+
+    /// \returns A copy of the characters.
+    operator std::string() const
+    {
+        return str();
+    }
+
+    friend bool operator==(const cpp_token_spelling& lhs, const cpp_token_spelling& rhs) noexcept
+    {
+        return lhs.length_ == rhs.length_
+               && (lhs.str_ == rhs.str_ || std::memcmp(lhs.str_, rhs.str_, lhs.length_) == 0);
+    }
+
+    friend bool operator==(const cpp_token_spelling& lhs, const char* rhs) noexcept
+    {
+        return std::strncmp(lhs.str_, rhs, lhs.length_) == 0 && rhs[lhs.length_] == '\0';
+    }
+
+    friend bool operator==(const cpp_token_spelling& lhs, const std::string& rhs) noexcept
+    {
+        return lhs == cpp_token_spelling(rhs);
+    }
+
+    friend bool operator==(const char* lhs, const cpp_token_spelling& rhs) noexcept
+    {
+        return rhs == lhs;
+    }
+
+    friend bool operator==(const std::string& lhs, const cpp_token_spelling& rhs) noexcept
+    {
+        return rhs == lhs;
+    }
+
+    friend bool operator!=(const cpp_token_spelling& lhs, const cpp_token_spelling& rhs) noexcept
+    {
+        return !(lhs == rhs);
+    }
+
+    friend bool operator!=(const cpp_token_spelling& lhs, const char* rhs) noexcept
+    {
+        return !(lhs == rhs);
+    }
+
+    friend bool operator!=(const cpp_token_spelling& lhs, const std::string& rhs) noexcept
+    {
+        return !(lhs == rhs);
+    }
+
+    friend bool operator!=(const char* lhs, const cpp_token_spelling& rhs) noexcept
+    {
+        return !(rhs == lhs);
+    }
+
+    friend bool operator!=(const std::string& lhs, const cpp_token_spelling& rhs) noexcept
+    {
+        return !(rhs == lhs);
+    }
+
+private:
+    const char* str_;
+    std::size_t length_;
+};
+
 /// A C++ token.
 struct cpp_token
 {
-    std::string    spelling;
-    cpp_token_kind kind;
+    cpp_token_spelling spelling;
+    cpp_token_kind     kind;
 
-    cpp_token(cpp_token_kind kind, std::string spelling) : spelling(std::move(spelling)), kind(kind)
-    {}
+    cpp_token(cpp_token_kind kind, cpp_token_spelling spelling) : spelling(spelling), kind(kind) {}
 
     friend bool operator==(const cpp_token& lhs, const cpp_token& rhs) noexcept
     {
@@ -45,6 +202,28 @@ struct cpp_token
     }
 };
 
+/// \exclude
+namespace detail
+{
+    class cpp_token_text_buffer;
+
+    /// While it is alive, all [cppast::cpp_token_string]() built on the current thread share one
+    /// text buffer, e.g. all token strings of one file.
+    class cpp_token_text_scope
+    {
+    public:
+        cpp_token_text_scope();
+        ~cpp_token_text_scope() noexcept;
+
+        cpp_token_text_scope(const cpp_token_text_scope&) = delete;
+        cpp_token_text_scope& operator=(const cpp_token_text_scope&) = delete;
+
+    private:
+        std::shared_ptr<cpp_token_text_buffer>  buffer_;
+        std::shared_ptr<cpp_token_text_buffer>* prev_;
+    };
+} // namespace detail
+
 /// A combination of multiple C++ tokens.
 class cpp_token_string
 {
@@ -55,11 +234,8 @@ public:
     public:
         builder() = default;
 
-        /// \effects Adds a token.
-        void add_token(cpp_token tok)
-        {
-            tokens_.push_back(std::move(tok));
-        }
+        /// \effects Adds a token, its spelling is copied into the text buffer.
+        void add_token(const cpp_token& tok);
 
         /// \effects Converts a trailing `>>` to `>` token.
         void unmunch();
@@ -67,11 +243,12 @@ public:
         /// \returns The finished string.
         cpp_token_string finish()
         {
-            return cpp_token_string(std::move(tokens_));
+            return cpp_token_string(std::move(tokens_), std::move(buffer_));
         }
 
     private:
-        std::vector<cpp_token> tokens_;
+        std::vector<cpp_token>                         tokens_;
+        std::shared_ptr<detail::cpp_token_text_buffer> buffer_;
     };
 
     /// Tokenizes a string.
@@ -81,7 +258,8 @@ public:
     static cpp_token_string tokenize(std::string str);
 
     /// \effects Creates it from a sequence of tokens.
-    cpp_token_string(std::vector<cpp_token> tokens) : tokens_(std::move(tokens)) {}
+    /// The spellings of the tokens are copied into a text buffer.
+    cpp_token_string(std::vector<cpp_token> tokens);
 
     /// \exclude target
     using iterator = std::vector<cpp_token>::const_iterator;
@@ -120,7 +298,14 @@ public:
     std::string as_string() const;
 
 private:
+    cpp_token_string(std::vector<cpp_token> tokens,
+                     std::shared_ptr<const detail::cpp_token_text_buffer> buffer)
+    : tokens_(std::move(tokens)), buffer_(std::move(buffer))
+    {}
+
     std::vector<cpp_token> tokens_;
+    // keeps the spellings of the tokens alive
+    std::shared_ptr<const detail::cpp_token_text_buffer> buffer_;
 
     friend bool operator==(const cpp_token_string& lhs, const cpp_token_string& rhs);
 };
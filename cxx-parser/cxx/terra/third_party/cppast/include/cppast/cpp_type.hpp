@@ -205,7 +205,17 @@ public:
     /// \returns A newly created user-defined type.
     static std::unique_ptr<cpp_user_defined_type> build(cpp_type_ref entity)
     {
-        return std::unique_ptr<cpp_user_defined_type>(new cpp_user_defined_type(std::move(entity)));
+        return std::unique_ptr<cpp_user_defined_type>(
+            new cpp_user_defined_type(std::move(entity), false));
+    }
+
+    /// \returns A newly created user-defined type the parser could not resolve,
+    /// see [cppast::libclang_compile_config::single_file_parse]().
+    /// \notes The name and the id of its [cppast::cpp_type_ref]() are the spelling of the type.
+    static std::unique_ptr<cpp_user_defined_type> build_unresolved(const std::string& spelling)
+    {
+        return std::unique_ptr<cpp_user_defined_type>(
+            new cpp_user_defined_type(cpp_type_ref(cpp_entity_id(spelling), spelling), true));
     }
 
     /// \returns A [cppast::cpp_type_ref]() to the associated [cppast::cpp_entity]() that is the
@@ -215,8 +225,17 @@ public:
         return entity_;
     }
 
+    /// \returns Whether or not the type is only known by its spelling, as its declaration
+    /// was not parsed.
+    bool is_unresolved() const noexcept
+    {
+        return is_unresolved_;
+    }
+
 private:
-    cpp_user_defined_type(cpp_type_ref entity) : entity_(std::move(entity)) {}
+    cpp_user_defined_type(cpp_type_ref entity, bool is_unresolved)
+    : entity_(std::move(entity)), is_unresolved_(is_unresolved)
+    {}
 
     cpp_type_kind do_get_kind() const noexcept override
     {
@@ -224,6 +243,7 @@ private:
     }
 
     cpp_type_ref entity_;
+    bool         is_unresolved_;
 };
 
 /// A [cppast::cpp_type]() that isn't given but deduced by `auto`.
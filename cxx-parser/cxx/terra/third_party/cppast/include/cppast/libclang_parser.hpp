@@ -4,7 +4,11 @@
 #ifndef CPPAST_LIBCLANG_PARSER_HPP_INCLUDED
 #define CPPAST_LIBCLANG_PARSER_HPP_INCLUDED
 
+#include <cstddef>
 #include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include <cppast/parser.hpp>
 
@@ -12,6 +16,13 @@ namespace cppast
 {
 namespace detail
 {
+    struct libclang_unsaved_file
+    {
+        std::string path;
+        const char* content;
+        std::size_t length;
+    };
+
     struct libclang_compile_config_access
     {
         static const std::string& clang_binary(const libclang_compile_config& config);
@@ -23,6 +34,13 @@ namespace detail
         static bool fast_preprocessing(const libclang_compile_config& config);
 
         static bool remove_comments_in_macro(const libclang_compile_config& config);
+
+        static bool intern_types(const libclang_compile_config& config);
+
+        static bool single_file_parse(const libclang_compile_config& config);
+
+        static const std::vector<libclang_unsaved_file>& unsaved_files(
+            const libclang_compile_config& config);
     };
 
     void for_each_file(const libclang_compilation_database& database, void* user_data,
@@ -171,6 +189,40 @@ public:
         remove_comments_in_macro_ = b;
     }
 
+    /// \effects Sets whether or not the types are interned per translation unit.
+    /// Default value is `false`.
+    /// \notes A type that is parsed the same wherever it is used (builtin and user-defined types,
+    /// possibly cv-qualified and behind pointers or references, e.g. `const char*`) is parsed once
+    /// per translation unit, every other occurrence gets a copy of it without querying libclang.
+    void intern_types(bool b) noexcept
+    {
+        intern_types_ = b;
+    }
+
+    /// \effects Sets whether or not libclang only parses the given file, without its includes.
+    /// Default value is `false`.
+    /// \notes The bodies of the functions are skipped as well, so this is a lot faster,
+    /// but the types declared in the included files are unknown to libclang.
+    /// A declaration using such a type gets a [cppast::cpp_user_defined_type]() that is
+    /// [cppast::cpp_user_defined_type::is_unresolved]() and spelled as written in the source,
+    /// base classes declared in the included files are missing.
+    /// The preprocessor still resolves the includes, so the macros are expanded as usual.
+    void single_file_parse(bool b) noexcept
+    {
+        single_file_parse_ = b;
+    }
+
+    /// \effects Adds a file whose content libclang uses instead of reading the file from disk.
+    /// \requires `content` must stay valid as long as the configuration is used for parsing.
+    /// \notes This allows reading the headers which are included by many translation units once,
+    /// the path should be spelled as libclang resolves the include, e.g. `<include dir>/<name>`.
+    /// The preprocessor still reads the files from disk, as it is a separate process.
+    /// An unsaved file with the path of the parsed file is ignored.
+    void add_unsaved_file(std::string path, const char* content, std::size_t length)
+    {
+        unsaved_files_.push_back({std::move(path), content, length});
+    }
+
 private:
     void do_set_flags(cpp_standard standard, compile_flags flags) override;
 
@@ -187,10 +239,13 @@ private:
         return "libclang";
     }
 
-    std::string clang_binary_;
-    bool        write_preprocessed_ : 1;
-    bool        fast_preprocessing_ : 1;
-    bool        remove_comments_in_macro_ : 1;
+    std::string                                clang_binary_;
+    std::vector<detail::libclang_unsaved_file> unsaved_files_;
+    bool                                       write_preprocessed_ : 1;
+    bool                                       fast_preprocessing_ : 1;
+    bool                                       remove_comments_in_macro_ : 1;
+    bool                                       intern_types_ : 1;
+    bool                                       single_file_parse_ : 1;
 
     friend detail::libclang_compile_config_access;
 };
@@ -223,6 +278,25 @@ public:
 
     ~libclang_parser() noexcept override;
 
+    /// The memory used by the libclang translation unit of a parsed file,
+    /// as reported by `clang_getCXTUResourceUsage()`.
+    struct tu_memory_usage
+    {
+        std::string file;
+        /// The bytes per kind of memory, e.g. `"ASTContext: expressions, declarations, and types"`.
+        std::vector<std::pair<std::string, unsigned long>> entries;
+        unsigned long                                      total;
+    };
+
+    /// \effects Enables or disables recording the [*tu_memory_usage]() of each parsed file,
+    /// right before its translation unit is disposed.
+    /// It is disabled by default.
+    void record_tu_memory_usage(bool value) noexcept;
+
+    /// \returns The memory usage recorded since the last call, in the order the files were parsed.
+    /// \notes This operation is thread safe.
+    std::vector<tu_memory_usage> take_tu_memory_usage() const;
+
 private:
     std::unique_ptr<cpp_file> do_parse(const cpp_entity_index& idx, std::string path,
                                        const compile_config& config) const override;
@@ -4,7 +4,14 @@
 #ifndef CPPAST_PARSER_HPP_INCLUDED
 #define CPPAST_PARSER_HPP_INCLUDED
 
+#include <algorithm>
 #include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #include <cppast/compile_config.hpp>
 #include <cppast/cpp_file.hpp>
@@ -87,7 +94,7 @@ private:
 
 /// A simple `FileParser` that parses all files synchronously.
 ///
-/// More advanced parsers could use a thread pool, for example.
+/// See [cppast::parallel_file_parser]() for a parser using a thread pool.
 template <class Parser>
 class simple_file_parser
 {
@@ -149,6 +156,229 @@ private:
     type_safe::object_ref<const cpp_entity_index> idx_;
 };
 
+/// \exclude
+namespace detail
+{
+    // stores the diagnostics of one file, so they can be logged once the file has been parsed
+    class buffered_diagnostic_logger final : public diagnostic_logger
+    {
+    public:
+        struct entry
+        {
+            const char* source;
+            diagnostic  d;
+        };
+
+        using diagnostic_logger::diagnostic_logger;
+
+        // returns all diagnostics logged since the last call
+        std::vector<entry> take() noexcept
+        {
+            std::vector<entry> result;
+            result.swap(entries_);
+            return result;
+        }
+
+    private:
+        bool do_log(const char* source, const diagnostic& d) const override
+        {
+            entries_.push_back(entry{source, d});
+            return true;
+        }
+
+        mutable std::vector<entry> entries_;
+    };
+} // namespace detail
+
+/// A `FileParser` that parses the files on a pool of worker threads.
+///
+/// Each worker thread owns its own `Parser`, e.g. with its own `CXIndex` for the
+/// [cppast::libclang_parser](), and all of them populate the same [cppast::cpp_entity_index]().
+/// `parse()` only queues the file, `wait()` waits until all queued files are parsed.
+/// The files are then available in the order of the `parse()` calls,
+/// and the diagnostics of each file are forwarded to the logger in that order as well.
+///
+/// \requires `Parser` must be constructible from a `type_safe::object_ref<const diagnostic_logger>`
+/// and `Parser::config` must be copyable.
+template <class Parser>
+class parallel_file_parser
+{
+    static_assert(std::is_base_of<cppast::parser, Parser>::value,
+                  "Parser must be derived from cppast::parser");
+
+public:
+    using parser = Parser;
+    using config = typename Parser::config;
+
+    /// \effects Creates a file parser populating the given index and logging to the given logger,
+    /// using `thread_count` worker threads, or one per hardware thread if it is `0`.
+    explicit parallel_file_parser(
+        type_safe::object_ref<const cpp_entity_index>  idx,
+        type_safe::object_ref<const diagnostic_logger> logger       = default_logger(),
+        unsigned                                       thread_count = 0u)
+    : idx_(idx), logger_(logger), next_job_(0u), pending_(0u), stop_(false), error_(false)
+    {
+        if (thread_count == 0u)
+            thread_count = std::max(1u, std::thread::hardware_concurrency());
+        for (auto i = 0u; i != thread_count; ++i)
+            workers_.emplace_back(new worker(*this));
+    }
+
+    parallel_file_parser(const parallel_file_parser&) = delete;
+    parallel_file_parser& operator=(const parallel_file_parser&) = delete;
+
+    /// \effects Stops the worker threads, files that are not yet being parsed are discarded.
+    ~parallel_file_parser() noexcept
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        job_queued_.notify_all();
+        for (auto& w : workers_)
+            w->thread.join();
+    }
+
+    /// \effects Queues the given file to be parsed using a copy of the given configuration.
+    void parse(std::string path, const config& c)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            jobs_.emplace_back(std::move(path), c);
+            ++pending_;
+        }
+        job_queued_.notify_one();
+    }
+
+    /// \effects Waits until all queued files are parsed,
+    /// then logs their diagnostics and adds them to the parsed files, both in queue order.
+    /// \throws The first exception thrown while parsing a file, after all files are added.
+    void wait()
+    {
+        std::deque<job> jobs;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            jobs_done_.wait(lock, [&] { return pending_ == 0u; });
+            jobs.swap(jobs_);
+            next_job_ = 0u;
+        }
+
+        std::exception_ptr exception;
+        for (auto& j : jobs)
+        {
+            for (auto& entry : j.diagnostics)
+                logger_->log(entry.source, entry.d);
+
+            if (j.exception && !exception)
+                exception = j.exception;
+            else if (j.file)
+                files_.push_back(std::move(j.file));
+        }
+        if (exception)
+            std::rethrow_exception(exception);
+    }
+
+    /// \returns Whether or not an error occurred while parsing any of the files.
+    bool error() const noexcept
+    {
+        return error_;
+    }
+
+    /// \effects Resets the error state.
+    void reset_error() noexcept
+    {
+        error_ = false;
+    }
+
+    /// \returns The index that is being populated.
+    const cpp_entity_index& index() const noexcept
+    {
+        return *idx_;
+    }
+
+    /// \effects Calls `wait()`.
+    /// \returns An iteratable object iterating over all the files that have been parsed so far.
+    /// \exclude return
+    detail::iteratable_intrusive_list<cpp_file> files()
+    {
+        wait();
+        return type_safe::ref(files_);
+    }
+
+private:
+    struct job
+    {
+        std::string                                            path;
+        config                                                 c;
+        std::unique_ptr<cpp_file>                              file;
+        std::vector<detail::buffered_diagnostic_logger::entry> diagnostics;
+        std::exception_ptr                                     exception;
+
+        job(std::string p, const config& conf) : path(std::move(p)), c(conf) {}
+    };
+
+    struct worker
+    {
+        detail::buffered_diagnostic_logger logger;
+        Parser                             parser;
+        std::thread                        thread;
+
+        explicit worker(parallel_file_parser& self)
+        : logger(self.logger_->is_verbose()), parser(type_safe::ref(logger)),
+          thread(&parallel_file_parser::run, &self, std::ref(*this))
+        {}
+    };
+
+    void run(worker& w)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true)
+        {
+            job_queued_.wait(lock, [&] { return stop_ || next_job_ < jobs_.size(); });
+            if (stop_)
+                return;
+
+            // elements of a deque are not moved when new jobs are queued
+            auto& j = jobs_[next_job_++];
+            lock.unlock();
+
+            w.logger.log("parallel file parser", diagnostic{"parsing file '" + j.path + "'",
+                                                            source_location(), severity::info});
+            try
+            {
+                j.file = w.parser.parse(*idx_, j.path, j.c);
+            }
+            catch (...)
+            {
+                j.exception = std::current_exception();
+            }
+            j.diagnostics = w.logger.take();
+            if (w.parser.error())
+            {
+                error_ = true;
+                w.parser.reset_error();
+            }
+
+            lock.lock();
+            if (--pending_ == 0u)
+                jobs_done_.notify_all();
+        }
+    }
+
+    type_safe::object_ref<const cpp_entity_index>  idx_;
+    type_safe::object_ref<const diagnostic_logger> logger_;
+    detail::intrusive_list<cpp_file>               files_;
+
+    std::mutex              mutex_;
+    std::condition_variable job_queued_, jobs_done_;
+    std::deque<job>         jobs_;
+    std::size_t             next_job_, pending_;
+    bool                    stop_;
+
+    std::atomic<bool>                    error_;
+    std::vector<std::unique_ptr<worker>> workers_;
+};
+
 namespace detail
 {
     struct std_begin
@@ -0,0 +1,260 @@
+// Copyright (C) 2017-2022 Jonathan Müller and cppast contributors
+// SPDX-License-Identifier: MIT
+
+#ifndef CPPAST_STATIC_VISITOR_HPP_INCLUDED
+#define CPPAST_STATIC_VISITOR_HPP_INCLUDED
+
+#include <type_traits>
+#include <utility>
+
+#include <cppast/cpp_alias_template.hpp>
+#include <cppast/cpp_class.hpp>
+#include <cppast/cpp_class_template.hpp>
+#include <cppast/cpp_concept.hpp>
+#include <cppast/cpp_entity.hpp>
+#include <cppast/cpp_entity_kind.hpp>
+#include <cppast/cpp_enum.hpp>
+#include <cppast/cpp_file.hpp>
+#include <cppast/cpp_friend.hpp>
+#include <cppast/cpp_function.hpp>
+#include <cppast/cpp_function_template.hpp>
+#include <cppast/cpp_language_linkage.hpp>
+#include <cppast/cpp_member_function.hpp>
+#include <cppast/cpp_member_variable.hpp>
+#include <cppast/cpp_namespace.hpp>
+#include <cppast/cpp_preprocessor.hpp>
+#include <cppast/cpp_static_assert.hpp>
+#include <cppast/cpp_template_parameter.hpp>
+#include <cppast/cpp_type_alias.hpp>
+#include <cppast/cpp_variable.hpp>
+#include <cppast/cpp_variable_template.hpp>
+#include <cppast/detail/assert.hpp>
+#include <cppast/visitor.hpp>
+
+namespace cppast
+{
+/// A compile-time set of [cppast::cpp_entity_kind]().
+template <cpp_entity_kind... Kinds>
+struct cpp_entity_kind_set;
+
+template <>
+struct cpp_entity_kind_set<>
+{
+    static constexpr bool contains(cpp_entity_kind) noexcept
+    {
+        return false;
+    }
+};
+
+template <cpp_entity_kind Head, cpp_entity_kind... Tail>
+struct cpp_entity_kind_set<Head, Tail...>
+{
+    static constexpr bool contains(cpp_entity_kind kind) noexcept
+    {
+        return kind == Head || cpp_entity_kind_set<Tail...>::contains(kind);
+    }
+};
+
+/// \exclude
+namespace detail
+{
+    template <typename... Ts>
+    struct static_visitor_void
+    {
+        using type = void;
+    };
+
+    // whether Visitor has a handler for the entity type T
+    template <typename Visitor, typename T, typename = void>
+    struct has_static_handler : std::false_type
+    {};
+
+    template <typename Visitor, typename T>
+    struct has_static_handler<
+        Visitor, T,
+        typename static_visitor_void<decltype(std::declval<Visitor&>()(
+            std::declval<const T&>(), std::declval<const visitor_info&>()))>::type>
+    : std::true_type
+    {};
+
+    // the container kinds whose children are visited, all of them by default
+    template <typename Visitor, typename = void>
+    struct static_visitor_children_of
+    {
+        static constexpr bool contains(cpp_entity_kind) noexcept
+        {
+            return true;
+        }
+    };
+
+    template <typename Visitor>
+    struct static_visitor_children_of<
+        Visitor, typename static_visitor_void<typename Visitor::children_of>::type>
+    : Visitor::children_of
+    {};
+
+    template <typename Visitor, typename T>
+    bool invoke_static_handler(std::true_type /* returns void */, Visitor& visitor, const T& e,
+                               const visitor_info& info)
+    {
+        visitor(e, info);
+        return true;
+    }
+
+    template <typename Visitor, typename T>
+    bool invoke_static_handler(std::false_type /* returns void */, Visitor& visitor, const T& e,
+                               const visitor_info& info)
+    {
+        return static_cast<bool>(visitor(e, info));
+    }
+
+    template <typename Visitor, typename T>
+    bool handle_static(std::true_type /* has handler */, Visitor& visitor, const T& e,
+                       const visitor_info& info)
+    {
+        using result = decltype(visitor(e, info));
+        return invoke_static_handler(std::is_void<result>{}, visitor, e, info);
+    }
+
+    template <typename Visitor, typename T>
+    bool handle_static(std::false_type /* has handler */, Visitor&, const T&, const visitor_info&)
+    {
+        return true;
+    }
+
+    template <typename Visitor>
+    bool static_visit(const cpp_entity& e, Visitor& visitor, cpp_access_specifier_kind cur_access,
+                      bool last_child);
+
+    template <typename Visitor, typename T>
+    bool static_visit_leaf(const cpp_entity& e, Visitor& visitor,
+                           cpp_access_specifier_kind cur_access, bool last_child)
+    {
+        return handle_static(has_static_handler<Visitor, T>{}, visitor, static_cast<const T&>(e),
+                             {visitor_info::leaf_entity, cur_access, last_child});
+    }
+
+    template <typename Visitor, typename T>
+    bool static_visit_container(const cpp_entity& e, Visitor& visitor,
+                                cpp_access_specifier_kind cur_access, bool last_child)
+    {
+        using has_handler = has_static_handler<Visitor, T>;
+        auto& container   = static_cast<const T&>(e);
+
+        auto handle_children
+            = handle_static(has_handler{}, visitor, container,
+                            {visitor_info::container_entity_enter, cur_access, last_child});
+        if (handle_children && static_visitor_children_of<Visitor>::contains(T::kind()))
+        {
+            auto child_access = cpp_public;
+            if (e.kind() == cpp_class::kind()
+                && static_cast<const cpp_class&>(e).class_kind() == cpp_class_kind::class_t)
+                child_access = cpp_private;
+
+            for (auto iter = container.begin(); iter != container.end();)
+            {
+                auto& cur = *iter;
+                ++iter;
+
+                if (cur.kind() == cpp_access_specifier::kind())
+                    child_access
+                        = static_cast<const cpp_access_specifier&>(cur).access_specifier();
+
+                if (!static_visit(cur, visitor, child_access, iter == container.end()))
+                    return false;
+            }
+        }
+
+        return handle_static(has_handler{}, visitor, container,
+                             {visitor_info::container_entity_exit, cur_access, last_child});
+    }
+
+    template <typename Visitor>
+    bool static_visit(const cpp_entity& e, Visitor& visitor, cpp_access_specifier_kind cur_access,
+                      bool last_child)
+    {
+#define CPPAST_DETAIL_CONTAINER(Kind, Type)                                                        \
+    case cpp_entity_kind::Kind:                                                                    \
+        return static_visit_container<Visitor, Type>(e, visitor, cur_access, last_child);
+#define CPPAST_DETAIL_LEAF(Kind, Type)                                                             \
+    case cpp_entity_kind::Kind:                                                                    \
+        return static_visit_leaf<Visitor, Type>(e, visitor, cur_access, last_child);
+
+        switch (e.kind())
+        {
+            CPPAST_DETAIL_CONTAINER(file_t, cpp_file)
+            CPPAST_DETAIL_CONTAINER(language_linkage_t, cpp_language_linkage)
+            CPPAST_DETAIL_CONTAINER(namespace_t, cpp_namespace)
+            CPPAST_DETAIL_CONTAINER(enum_t, cpp_enum)
+            CPPAST_DETAIL_CONTAINER(class_t, cpp_class)
+            CPPAST_DETAIL_CONTAINER(alias_template_t, cpp_alias_template)
+            CPPAST_DETAIL_CONTAINER(variable_template_t, cpp_variable_template)
+            CPPAST_DETAIL_CONTAINER(function_template_t, cpp_function_template)
+            CPPAST_DETAIL_CONTAINER(function_template_specialization_t,
+                                    cpp_function_template_specialization)
+            CPPAST_DETAIL_CONTAINER(class_template_t, cpp_class_template)
+            CPPAST_DETAIL_CONTAINER(class_template_specialization_t,
+                                    cpp_class_template_specialization)
+
+            CPPAST_DETAIL_LEAF(macro_parameter_t, cpp_macro_parameter)
+            CPPAST_DETAIL_LEAF(macro_definition_t, cpp_macro_definition)
+            CPPAST_DETAIL_LEAF(include_directive_t, cpp_include_directive)
+            CPPAST_DETAIL_LEAF(namespace_alias_t, cpp_namespace_alias)
+            CPPAST_DETAIL_LEAF(using_directive_t, cpp_using_directive)
+            CPPAST_DETAIL_LEAF(using_declaration_t, cpp_using_declaration)
+            CPPAST_DETAIL_LEAF(type_alias_t, cpp_type_alias)
+            CPPAST_DETAIL_LEAF(enum_value_t, cpp_enum_value)
+            CPPAST_DETAIL_LEAF(access_specifier_t, cpp_access_specifier)
+            CPPAST_DETAIL_LEAF(base_class_t, cpp_base_class)
+            CPPAST_DETAIL_LEAF(variable_t, cpp_variable)
+            CPPAST_DETAIL_LEAF(member_variable_t, cpp_member_variable)
+            CPPAST_DETAIL_LEAF(bitfield_t, cpp_bitfield)
+            CPPAST_DETAIL_LEAF(function_parameter_t, cpp_function_parameter)
+            CPPAST_DETAIL_LEAF(function_t, cpp_function)
+            CPPAST_DETAIL_LEAF(member_function_t, cpp_member_function)
+            CPPAST_DETAIL_LEAF(conversion_op_t, cpp_conversion_op)
+            CPPAST_DETAIL_LEAF(constructor_t, cpp_constructor)
+            CPPAST_DETAIL_LEAF(destructor_t, cpp_destructor)
+            CPPAST_DETAIL_LEAF(friend_t, cpp_friend)
+            CPPAST_DETAIL_LEAF(template_type_parameter_t, cpp_template_type_parameter)
+            CPPAST_DETAIL_LEAF(non_type_template_parameter_t, cpp_non_type_template_parameter)
+            CPPAST_DETAIL_LEAF(template_template_parameter_t, cpp_template_template_parameter)
+            CPPAST_DETAIL_LEAF(concept_t, cpp_concept)
+            CPPAST_DETAIL_LEAF(static_assert_t, cpp_static_assert)
+            CPPAST_DETAIL_LEAF(unexposed_t, cpp_unexposed_entity)
+
+        case cpp_entity_kind::count:
+            break;
+        }
+
+#undef CPPAST_DETAIL_CONTAINER
+#undef CPPAST_DETAIL_LEAF
+
+        DEBUG_UNREACHABLE(detail::assert_handler{});
+        return true;
+    }
+} // namespace detail
+
+/// Visits a [cppast::cpp_entity]() and children with handlers selected at compile time.
+///
+/// \effects It behaves like [cppast::visit()](), but instead of calling one type-erased callback
+/// for every entity, the entity kind is dispatched to a handler of the visitor for the concrete
+/// entity type, e.g. `operator()(const cpp_class&, const visitor_info&)`, which can be inlined.
+/// Entities without a matching handler are skipped without any call,
+/// a handler taking a `const cpp_entity&` matches every entity without a more specific handler.
+///
+/// The children of a container are only visited if the visitor's optional `children_of` member type,
+/// a [cppast::cpp_entity_kind_set](), contains the container kind, all children are visited
+/// without it. The container itself is still reported with the enter and exit events.
+///
+/// \requires The handlers must return `bool` or nothing, with the same meaning as for
+/// [cppast::visit()]().
+template <typename Visitor>
+void static_visit(const cpp_entity& e, Visitor&& visitor)
+{
+    using visitor_type = typename std::decay<Visitor>::type;
+    detail::static_visit<visitor_type>(e, visitor, cpp_public, false);
+}
+} // namespace cppast
+
+#endif // CPPAST_STATIC_VISITOR_HPP_INCLUDED
@@ -10,6 +10,8 @@
 
 using namespace cppast;
 
+constexpr unsigned cpp_entity_index::shard_bits;
+
 cpp_entity_index::duplicate_definition_error::duplicate_definition_error()
 : std::logic_error("duplicate registration of entity definition")
 {}
@@ -19,8 +21,9 @@ void cpp_entity_index::register_definition(cpp_entity_id
 {
     DEBUG_ASSERT(entity->kind() != cpp_entity_kind::namespace_t,
                  detail::precondition_error_handler{}, "must not be a namespace");
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto                        result = map_.emplace(std::move(id), value(entity, true));
+    auto&                       shard = get_shard(id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto                        result = shard.map.emplace(std::move(id), value(entity, true));
     if (!result.second)
     {
         // already in map, override declaration
@@ -38,30 +41,34 @@ void cpp_entity_index::register_definition(cpp_entity_id
 bool cpp_entity_index::register_file(cpp_entity_id                         id,
                                      type_safe::object_ref<const cpp_file> file) const
 {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return map_.emplace(std::move(id), value(file, true)).second;
+    auto&                       shard = get_shard(id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    return shard.map.emplace(std::move(id), value(file, true)).second;
 }
 
 void cpp_entity_index::register_forward_declaration(
     cpp_entity_id id, type_safe::object_ref<const cpp_entity> entity) const
 {
-    std::lock_guard<std::mutex> lock(mutex_);
-    map_.emplace(std::move(id), value(entity, false));
+    auto&                       shard = get_shard(id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.map.emplace(std::move(id), value(entity, false));
 }
 
 void cpp_entity_index::register_namespace(cpp_entity_id                              id,
                                           type_safe::object_ref<const cpp_namespace> ns) const
 {
-    std::lock_guard<std::mutex> lock(mutex_);
-    ns_[std::move(id)].push_back(ns);
+    auto&                       shard = get_shard(id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.ns[std::move(id)].push_back(ns);
 }
 
 type_safe::optional_ref<const cpp_entity> cpp_entity_index::lookup(
     const cpp_entity_id& id) const noexcept
 {
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto                        iter = map_.find(id);
-    if (iter == map_.end())
+    auto&                       shard = get_shard(id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto                        iter = shard.map.find(id);
+    if (iter == shard.map.end())
         return {};
     return type_safe::ref(iter->second.entity.get());
 }
@@ -69,9 +76,10 @@ type_safe::optional_ref<const cpp_entity> cpp_entity_index::lookup(
 type_safe::optional_ref<const cpp_entity> cpp_entity_index::lookup_definition(
     const cpp_entity_id& id) const noexcept
 {
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto                        iter = map_.find(id);
-    if (iter == map_.end() || !iter->second.is_definition)
+    auto&                       shard = get_shard(id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto                        iter = shard.map.find(id);
+    if (iter == shard.map.end() || !iter->second.is_definition)
         return {};
     return type_safe::ref(iter->second.entity.get());
 }
@@ -79,9 +87,10 @@ type_safe::optional_ref<const cpp_entity> cpp_entity_index::lookup_definition(
 auto cpp_entity_index::lookup_namespace(const cpp_entity_id& id) const noexcept
     -> type_safe::array_ref<type_safe::object_ref<const cpp_namespace>>
 {
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto                        iter = ns_.find(id);
-    if (iter == ns_.end())
+    auto&                       shard = get_shard(id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto                        iter = shard.ns.find(id);
+    if (iter == shard.ns.end())
         return nullptr;
     auto& vec = iter->second;
     return type_safe::ref(vec.data(), vec.size());
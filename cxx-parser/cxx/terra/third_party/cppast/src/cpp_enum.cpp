@@ -13,11 +13,12 @@ cpp_entity_kind cpp_enum_value::kind() noexcept
 }
 
 std::unique_ptr<cpp_enum_value> cpp_enum_value::build(const cpp_entity_index& idx, cpp_entity_id id,
-                                                      std::string                     name,
-                                                      std::unique_ptr<cpp_expression> value)
+                                                      std::string                       name,
+                                                      std::unique_ptr<cpp_expression>   value,
+                                                      type_safe::optional<std::int64_t> integer_value)
 {
-    auto result
-        = std::unique_ptr<cpp_enum_value>(new cpp_enum_value(std::move(name), std::move(value)));
+    auto result = std::unique_ptr<cpp_enum_value>(
+        new cpp_enum_value(std::move(name), std::move(value), integer_value));
     idx.register_definition(std::move(id), type_safe::ref(*result));
     return result;
 }
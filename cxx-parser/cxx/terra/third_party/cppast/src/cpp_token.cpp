@@ -6,18 +6,125 @@
 #include <algorithm>
 #include <cctype>
 #include <cstring>
+#include <unordered_set>
 #include <type_safe/optional.hpp>
 
 #include <cppast/detail/assert.hpp>
 
 using namespace cppast;
 
+class detail::cpp_token_text_buffer
+{
+public:
+    // returns a null-terminated copy of the spelling that lives as long as the buffer
+    cpp_token_spelling intern(const cpp_token_spelling& spelling)
+    {
+        auto iter = spellings_.find(spelling);
+        if (iter != spellings_.end())
+            return *iter;
+
+        auto storage = allocate(spelling.length() + 1u);
+        std::memcpy(storage, spelling.data(), spelling.length());
+        storage[spelling.length()] = '\0';
+
+        cpp_token_spelling result(storage, spelling.length());
+        spellings_.insert(result);
+        return result;
+    }
+
+private:
+    static constexpr std::size_t block_size = 4096u;
+
+    char* allocate(std::size_t size)
+    {
+        if (size > remaining_)
+        {
+            auto new_block_size = std::max(block_size, size);
+            blocks_.emplace_back(new char[new_block_size]);
+            cur_       = blocks_.back().get();
+            remaining_ = new_block_size;
+        }
+
+        auto result = cur_;
+        cur_ += size;
+        remaining_ -= size;
+        return result;
+    }
+
+    struct spelling_hash
+    {
+        std::size_t operator()(const cpp_token_spelling& spelling) const noexcept
+        {
+            // FNV-1a
+            std::size_t hash = 2166136261u;
+            for (auto c : spelling)
+            {
+                hash ^= static_cast<unsigned char>(c);
+                hash *= 16777619u;
+            }
+            return hash;
+        }
+    };
+
+    std::vector<std::unique_ptr<char[]>>                          blocks_;
+    char*                                                         cur_       = nullptr;
+    std::size_t                                                   remaining_ = 0u;
+    std::unordered_set<cpp_token_spelling, spelling_hash>         spellings_;
+};
+
+constexpr std::size_t detail::cpp_token_text_buffer::block_size;
+
+namespace
+{
+// the buffer of the innermost cpp_token_text_scope of the current thread, if any
+thread_local std::shared_ptr<detail::cpp_token_text_buffer>* current_text_buffer = nullptr;
+
+std::shared_ptr<detail::cpp_token_text_buffer> get_text_buffer()
+{
+    if (current_text_buffer)
+        return *current_text_buffer;
+    else
+        return std::make_shared<detail::cpp_token_text_buffer>();
+}
+} // namespace
+
+detail::cpp_token_text_scope::cpp_token_text_scope()
+: buffer_(std::make_shared<cpp_token_text_buffer>()), prev_(current_text_buffer)
+{
+    current_text_buffer = &buffer_;
+}
+
+detail::cpp_token_text_scope::~cpp_token_text_scope() noexcept
+{
+    DEBUG_ASSERT(current_text_buffer == &buffer_, detail::assert_handler{},
+                 "token text scopes must be nested");
+    current_text_buffer = prev_;
+}
+
+void cpp_token_string::builder::add_token(const cpp_token& tok)
+{
+    if (!buffer_)
+        buffer_ = get_text_buffer();
+    tokens_.emplace_back(tok.kind, buffer_->intern(tok.spelling));
+}
+
 void cpp_token_string::builder::unmunch()
 {
     DEBUG_ASSERT(!tokens_.empty() && tokens_.back().spelling == ">>", detail::assert_handler{});
     tokens_.back().spelling = ">";
 }
 
+cpp_token_string::cpp_token_string(std::vector<cpp_token> tokens) : tokens_(std::move(tokens))
+{
+    if (tokens_.empty())
+        return;
+
+    auto buffer = get_text_buffer();
+    for (auto& token : tokens_)
+        token.spelling = buffer->intern(token.spelling);
+    buffer_ = std::move(buffer);
+}
+
 namespace
 {
 template <std::size_t N>
@@ -26,9 +133,9 @@ bool starts_with(const char* ptr, const char (&str)[N])
     return std::strncmp(ptr, str, N - 1u) == 0;
 }
 
-bool starts_with(const char* ptr, const std::string& str)
+bool starts_with(const char* ptr, const char* str, std::size_t length)
 {
-    return std::strncmp(ptr, str.c_str(), str.size()) == 0;
+    return std::strncmp(ptr, str, length) == 0;
 }
 
 template <std::size_t N>
@@ -43,11 +150,11 @@ bool bump_if(const char*& ptr, const char (&str)[N])
         return false;
 }
 
-bool bump_if(const char*& ptr, const std::string& str)
+bool bump_if(const char*& ptr, const char* str, std::size_t length)
 {
-    if (starts_with(ptr, str))
+    if (starts_with(ptr, str, length))
     {
-        ptr += str.size();
+        ptr += length;
         return true;
     }
     else
@@ -78,17 +185,18 @@ bool is_hexadecimal_digit(char c)
     return is_digit(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
 }
 
-type_safe::optional<std::string> bump_identifier(const char*& ptr)
+// the spellings of the tokens are views into the tokenized string or string literals,
+// they are copied into the text buffer when added to the builder
+
+type_safe::optional<cpp_token_spelling> bump_identifier(const char*& ptr)
 {
     if (is_identifier_nondigit(*ptr))
     {
-        std::string result;
-        result += *ptr++;
-
+        auto begin = ptr++;
         while (is_identifier_nondigit(*ptr) || is_digit(*ptr))
-            result += *ptr++;
+            ++ptr;
 
-        return result;
+        return cpp_token_spelling(begin, std::size_t(ptr - begin));
     }
     else
         return type_safe::nullopt;
@@ -173,220 +281,207 @@ type_safe::optional<cpp_token> identifier_token(const char*& ptr)
                                                "volatile",
                                                "wchar_t",
                                                "while"};
-    auto find_keyword = std::find(std::begin(keywords), std::end(keywords), identifier.value());
+    auto find_keyword
+        = std::find_if(std::begin(keywords), std::end(keywords),
+                       [&](const char* keyword) { return identifier.value() == keyword; });
     if (find_keyword != std::end(keywords))
         return cpp_token(cpp_token_kind::keyword, identifier.value());
-    else if (identifier == "and")
+    else if (identifier.value() == "and")
         return cpp_token(cpp_token_kind::punctuation, "&&");
-    else if (identifier == "and_eq")
+    else if (identifier.value() == "and_eq")
         return cpp_token(cpp_token_kind::punctuation, "&=");
-    else if (identifier == "bitand")
+    else if (identifier.value() == "bitand")
         return cpp_token(cpp_token_kind::punctuation, "&");
-    else if (identifier == "bitor")
+    else if (identifier.value() == "bitor")
         return cpp_token(cpp_token_kind::punctuation, "|");
-    else if (identifier == "compl")
+    else if (identifier.value() == "compl")
         return cpp_token(cpp_token_kind::punctuation, "~");
-    else if (identifier == "not")
+    else if (identifier.value() == "not")
         return cpp_token(cpp_token_kind::punctuation, "!");
-    else if (identifier == "not_eq")
+    else if (identifier.value() == "not_eq")
         return cpp_token(cpp_token_kind::punctuation, "!=");
-    else if (identifier == "or")
+    else if (identifier.value() == "or")
         return cpp_token(cpp_token_kind::punctuation, "||");
-    else if (identifier == "or_eq")
+    else if (identifier.value() == "or_eq")
         return cpp_token(cpp_token_kind::punctuation, "|=");
-    else if (identifier == "xor")
+    else if (identifier.value() == "xor")
         return cpp_token(cpp_token_kind::punctuation, "^");
-    else if (identifier == "xor_eq")
+    else if (identifier.value() == "xor_eq")
         return cpp_token(cpp_token_kind::punctuation, "^=");
     else
         return cpp_token(cpp_token_kind::identifier, identifier.value());
 }
 
-void append_udl_suffix(std::string& literal, const char*& ptr)
+void bump_udl_suffix(const char*& ptr)
 {
-    if (auto id = identifier_token(ptr))
-        literal += id.value().spelling;
+    identifier_token(ptr);
 }
 
 template <typename DigitPredicate>
-std::string parse_digit_sequence(const char*& ptr, DigitPredicate is_digit)
+void bump_digit_sequence(const char*& ptr, DigitPredicate is_digit)
 {
-    std::string result;
-    for (; is_digit(*ptr) || *ptr == '\''; ++ptr)
-        if (*ptr != '\'')
-            result += *ptr;
-    DEBUG_ASSERT(result.empty() || result.back() != '\'', detail::assert_handler{});
-    return result;
+    while (is_digit(*ptr) || *ptr == '\'')
+        ++ptr;
+    DEBUG_ASSERT(ptr[-1] != '\'', detail::assert_handler{});
 }
 
-void append_integer_suffix(std::string& literal, const char*& ptr)
+void bump_integer_suffix(const char*& ptr)
 {
-    auto append_unsigned_suffix = [](std::string& literal, const char*& ptr) {
+    auto bump_unsigned_suffix = [](const char*& ptr) {
         if (*ptr == 'u' || *ptr == 'U')
         {
-            literal += *ptr++;
+            ++ptr;
             return true;
         }
         else
             return false;
     };
-    auto append_long_suffix = [](std::string& literal, const char*& ptr) {
+    auto bump_long_suffix = [](const char*& ptr) {
         if (starts_with(ptr, "ll") || starts_with(ptr, "LL"))
         {
-            literal += *ptr++;
-            literal += *ptr++;
+            ptr += 2;
             return true;
         }
         else if (*ptr == 'l' || *ptr == 'L')
         {
-            literal += *ptr++;
+            ++ptr;
             return true;
         }
         else
             return false;
     };
 
-    if (append_unsigned_suffix(literal, ptr))
-        append_long_suffix(literal, ptr);
-    else if (append_long_suffix(literal, ptr))
-        append_unsigned_suffix(literal, ptr);
+    if (bump_unsigned_suffix(ptr))
+        bump_long_suffix(ptr);
+    else if (bump_long_suffix(ptr))
+        bump_unsigned_suffix(ptr);
     else
-        append_udl_suffix(literal, ptr);
+        bump_udl_suffix(ptr);
 }
 
-void append_floating_point_suffix(std::string& literal, const char*& ptr)
+void bump_floating_point_suffix(const char*& ptr)
 {
     if (*ptr == 'f' || *ptr == 'F')
-        literal += *ptr++;
+        ++ptr;
     else if (*ptr == 'l' || *ptr == 'L')
-        literal += *ptr++;
+        ++ptr;
     else
-        append_udl_suffix(literal, ptr);
+        bump_udl_suffix(ptr);
 }
 
-type_safe::optional<std::string> parse_floating_point_exponent(const char*& ptr)
+bool bump_floating_point_exponent(const char*& ptr)
 {
     if (*ptr == 'e' || *ptr == 'E' || *ptr == 'p' || *ptr == 'P')
     {
-        std::string result;
-        result += *ptr++;
+        ++ptr;
         if (*ptr == '+' || *ptr == '-')
-            result += *ptr++;
+            ++ptr;
 
-        result += parse_digit_sequence(ptr, &is_digit);
-        return result;
+        bump_digit_sequence(ptr, &is_digit);
+        return true;
     }
     else
-        return type_safe::nullopt;
+        return false;
 }
 
-type_safe::optional<cpp_token> numeric_literal_token(const char*& ptr)
+// digit separators are removed from the spelling, storage is used if there are any
+cpp_token numeric_literal(cpp_token_kind kind, const char* begin, const char* end,
+                          std::string& storage)
 {
+    if (std::find(begin, end, '\'') == end)
+        return cpp_token(kind, cpp_token_spelling(begin, std::size_t(end - begin)));
+
+    storage.assign(begin, end);
+    storage.erase(std::remove(storage.begin(), storage.end(), '\''), storage.end());
+    return cpp_token(kind, storage);
+}
+
+type_safe::optional<cpp_token> numeric_literal_token(const char*& ptr, std::string& storage)
+{
+    auto begin = ptr;
     if (starts_with(ptr, "0b") || starts_with(ptr, "0B")) // binary integer literal
     {
-        std::string result;
-        result += *ptr++;
-        result += *ptr++;
-        result += parse_digit_sequence(ptr, [](char c) { return c == '0' || c == '1'; });
-        append_integer_suffix(result, ptr);
-        return cpp_token(cpp_token_kind::int_literal, result);
+        ptr += 2;
+        bump_digit_sequence(ptr, [](char c) { return c == '0' || c == '1'; });
+        bump_integer_suffix(ptr);
+        return numeric_literal(cpp_token_kind::int_literal, begin, ptr, storage);
     }
     else if (starts_with(ptr, "0x") || starts_with(ptr, "0X")) // hexadecimal literal
     {
-        std::string result;
-        result += *ptr++;
-        result += *ptr++;
-        result += parse_digit_sequence(ptr, &is_hexadecimal_digit);
+        ptr += 2;
+        bump_digit_sequence(ptr, &is_hexadecimal_digit);
 
         auto is_float = false;
         if (*ptr == '.')
         {
             // floating point hexadecimal
             is_float = true;
-            result += *ptr++;
-            result += parse_digit_sequence(ptr, &is_hexadecimal_digit);
+            ++ptr;
+            bump_digit_sequence(ptr, &is_hexadecimal_digit);
         }
 
-        if (auto exp = parse_floating_point_exponent(ptr))
-        {
-            is_float = true;
+        if (bump_floating_point_exponent(ptr))
             // floating point exponent
-            result += exp.value();
-        }
+            is_float = true;
 
         if (is_float)
-            append_floating_point_suffix(result, ptr);
+            bump_floating_point_suffix(ptr);
         else
-            append_integer_suffix(result, ptr);
+            bump_integer_suffix(ptr);
 
-        return cpp_token(is_float ? cpp_token_kind::float_literal : cpp_token_kind::int_literal,
-                         result);
+        return numeric_literal(is_float ? cpp_token_kind::float_literal
+                                        : cpp_token_kind::int_literal,
+                               begin, ptr, storage);
     }
     else if (is_digit(*ptr)) // octal and decimal literals
     {
-        std::string result;
-        result += parse_digit_sequence(ptr, &is_digit);
+        bump_digit_sequence(ptr, &is_digit);
 
         auto is_float = false;
         if (*ptr == '.')
         {
             // floating point decimal
             is_float = true;
-            result += *ptr++;
-            result += parse_digit_sequence(ptr, &is_hexadecimal_digit);
+            ++ptr;
+            bump_digit_sequence(ptr, &is_hexadecimal_digit);
         }
 
-        if (auto exp = parse_floating_point_exponent(ptr))
-        {
+        if (bump_floating_point_exponent(ptr))
             // floating point exponent
             is_float = true;
-            result += exp.value();
-        }
 
         if (is_float)
-            append_floating_point_suffix(result, ptr);
+            bump_floating_point_suffix(ptr);
         else
-            append_integer_suffix(result, ptr);
+            bump_integer_suffix(ptr);
 
-        return cpp_token(is_float ? cpp_token_kind::float_literal : cpp_token_kind::int_literal,
-                         result);
+        return numeric_literal(is_float ? cpp_token_kind::float_literal
+                                        : cpp_token_kind::int_literal,
+                               begin, ptr, storage);
     }
     else if (*ptr == '.' && is_digit(ptr[1]))
     {
-        std::string result;
-
         // floating point fraction
-        result += *ptr++;
-        result += parse_digit_sequence(ptr, &is_digit);
-
-        if (auto exp = parse_floating_point_exponent(ptr))
-            result += exp.value();
-
-        append_floating_point_suffix(result, ptr);
-        return cpp_token(cpp_token_kind::float_literal, result);
+        ++ptr;
+        bump_digit_sequence(ptr, &is_digit);
+        bump_floating_point_exponent(ptr);
+        bump_floating_point_suffix(ptr);
+        return numeric_literal(cpp_token_kind::float_literal, begin, ptr, storage);
     }
     else
         return type_safe::nullopt;
 }
 
-type_safe::optional<std::string> parse_encoding_prefix(const char*& ptr)
+void bump_encoding_prefix(const char*& ptr)
 {
-    if (bump_if(ptr, "u8"))
-        return "u8";
-    else if (bump_if(ptr, "u"))
-        return "u";
-    else if (bump_if(ptr, "U"))
-        return "U";
-    else if (bump_if(ptr, "L"))
-        return "L";
-    else
-        return type_safe::nullopt;
+    if (!bump_if(ptr, "u8") && !bump_if(ptr, "u") && !bump_if(ptr, "U"))
+        bump_if(ptr, "L");
 }
 
 type_safe::optional<cpp_token> character_literal(const char*& ptr)
 {
-    auto save   = ptr;
-    auto prefix = parse_encoding_prefix(ptr);
+    auto save = ptr;
+    bump_encoding_prefix(ptr);
     if (*ptr != '\'')
     {
         ptr = save;
@@ -394,73 +489,68 @@ type_safe::optional<cpp_token> character_literal(const char*& ptr)
     }
     else
     {
-        auto result = prefix.value_or("");
-        result += *ptr++;
-
+        ++ptr;
         while (*ptr != '\'')
         {
             DEBUG_ASSERT(*ptr, detail::assert_handler{});
 
             if (*ptr == '\\')
-                result += *ptr++;
-            result += *ptr++;
+                ++ptr;
+            ++ptr;
         }
-        result += *ptr++;
+        ++ptr;
 
-        append_udl_suffix(result, ptr);
-        return cpp_token(cpp_token_kind::char_literal, result);
+        bump_udl_suffix(ptr);
+        return cpp_token(cpp_token_kind::char_literal,
+                         cpp_token_spelling(save, std::size_t(ptr - save)));
     }
 }
 
 type_safe::optional<cpp_token> string_literal(const char*& ptr)
 {
-    auto save   = ptr;
-    auto prefix = parse_encoding_prefix(ptr);
+    auto save = ptr;
+    bump_encoding_prefix(ptr);
     if (starts_with(ptr, "R\""))
     {
         // raw string literal
-        auto result = prefix.value_or("");
-        result += *ptr++;
-        result += *ptr++;
+        ptr += 2;
 
+        auto delimiter_begin = ptr;
+        while (*ptr != '(')
+            ++ptr;
         std::string terminator;
         terminator += ")";
-        while (*ptr != '(')
-        {
-            result += *ptr;
-            terminator += *ptr++;
-        }
-        result += *ptr++;
+        terminator.append(delimiter_begin, ptr);
         terminator += '"';
+        ++ptr;
 
-        while (!bump_if(ptr, terminator))
+        while (!bump_if(ptr, terminator.c_str(), terminator.size()))
         {
-            DEBUG_ASSERT(ptr, detail::assert_handler{});
-            result += *ptr++;
+            DEBUG_ASSERT(*ptr, detail::assert_handler{});
+            ++ptr;
         }
-        result += terminator;
 
-        append_udl_suffix(result, ptr);
-        return cpp_token(cpp_token_kind::string_literal, result);
+        bump_udl_suffix(ptr);
+        return cpp_token(cpp_token_kind::string_literal,
+                         cpp_token_spelling(save, std::size_t(ptr - save)));
     }
     else if (starts_with(ptr, "\""))
     {
         // regular string literal
-        auto result = prefix.value_or("");
-        result += *ptr++;
-
+        ++ptr;
         while (*ptr != '"')
         {
             DEBUG_ASSERT(*ptr, detail::assert_handler{});
 
             if (*ptr == '\\')
-                result += *ptr++;
-            result += *ptr++;
+                ++ptr;
+            ++ptr;
         }
-        result += *ptr++;
+        ++ptr;
 
-        append_udl_suffix(result, ptr);
-        return cpp_token(cpp_token_kind::string_literal, result);
+        bump_udl_suffix(ptr);
+        return cpp_token(cpp_token_kind::string_literal,
+                         cpp_token_spelling(save, std::size_t(ptr - save)));
     }
     else
     {
@@ -563,7 +653,7 @@ type_safe::optional<cpp_token> punctuation_token(const char*& ptr)
     };
 
     for (auto punct : punctuations)
-        if (bump_if(ptr, punct))
+        if (bump_if(ptr, punct, std::strlen(punct)))
             return cpp_token(cpp_token_kind::punctuation, punct);
 
     return type_safe::nullopt;
@@ -574,10 +664,11 @@ cpp_token_string cpp_token_string::tokenize(std::string str)
 {
     cpp_token_string::builder builder;
 
-    auto ptr = str.c_str();
+    std::string storage;
+    auto        ptr = str.c_str();
     while (*ptr)
     {
-        if (auto num = numeric_literal_token(ptr))
+        if (auto num = numeric_literal_token(ptr, storage))
             builder.add_token(num.value());
         else if (auto char_lit = character_literal(ptr))
             builder.add_token(char_lit.value());
@@ -608,13 +699,18 @@ bool is_identifier(char c)
 
 std::string cpp_token_string::as_string() const
 {
+    std::size_t length = 0u;
+    for (auto& token : tokens_)
+        length += token.spelling.length() + 1u;
+
     std::string result;
+    result.reserve(length);
     for (auto& token : tokens_)
     {
         DEBUG_ASSERT(!token.spelling.empty(), detail::assert_handler{});
         if (!result.empty() && is_identifier(result.back()) && is_identifier(token.spelling[0u]))
             result += ' ';
-        result += token.spelling;
+        result.append(token.spelling.data(), token.spelling.length());
     }
     return result;
 }
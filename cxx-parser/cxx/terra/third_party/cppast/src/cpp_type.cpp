@@ -606,7 +606,8 @@ std::string cppast::to_string(const cpp_type& type)
     } generator;
 
     // just a dummy type for the output
-    static auto dummy_entity = cpp_type_alias::build("foo", cpp_builtin_type::build(cpp_int));
+    // one per thread, as the output must not share the entity with concurrent calls
+    thread_local auto dummy_entity = cpp_type_alias::build("foo", cpp_builtin_type::build(cpp_int));
     to_string_generator::output output(type_safe::ref(generator), type_safe::ref(*dummy_entity),
                                        cpp_public);
     write_type(output, type, "");
@@ -776,7 +776,8 @@ cpp_token_string detail::to_string(cxtoken_stream& stream, cxtoken_iterator end)
     while (stream.cur() != end)
     {
         auto& token = stream.get();
-        builder.add_token(cpp_token(get_kind(token), token.c_str()));
+        builder.add_token(
+            cpp_token(get_kind(token), cpp_token_spelling(token.c_str(), token.value().length())));
     }
 
     if (stream.unmunch())
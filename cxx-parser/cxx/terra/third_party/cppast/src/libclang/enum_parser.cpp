@@ -10,8 +10,10 @@ using namespace cppast;
 
 namespace
 {
+// value_known: whether the value of the previous enumerator is known, updated for this one
 std::unique_ptr<cpp_enum_value> parse_enum_value(const detail::parse_context& context,
-                                                 const CXCursor&              cur)
+                                                 const CXCursor& cur, bool is_unsigned,
+                                                 bool& value_known)
 {
     if (clang_isAttribute(clang_getCursorKind(cur)))
         return nullptr;
@@ -38,8 +40,22 @@ std::unique_ptr<cpp_enum_value> parse_enum_value(const detail::parse_context& co
         });
     }
 
+    // libclang reports a meaningless value for an invalid or a value dependent enumerator,
+    // so only trust it if the explicit value could be evaluated,
+    // or the implicit value follows a known one
+    value_known = value ? value->integer_value().has_value() : value_known;
+    type_safe::optional<std::int64_t> integer_value;
+    if (value_known && !clang_isInvalidDeclaration(cur))
+    {
+        if (is_unsigned)
+            integer_value
+                = static_cast<std::int64_t>(clang_getEnumConstantDeclUnsignedValue(cur));
+        else
+            integer_value = static_cast<std::int64_t>(clang_getEnumConstantDeclValue(cur));
+    }
+
     auto result = cpp_enum_value::build(*context.idx, detail::get_entity_id(cur), name.c_str(),
-                                        std::move(value));
+                                        std::move(value), integer_value);
     result->add_attribute(attributes);
     return result;
 }
@@ -82,10 +98,15 @@ std::unique_ptr<cpp_entity> detail::parse_cpp_enum(const detail::parse_context&
     type_safe::optional<cpp_entity_ref> semantic_parent;
     auto                                builder = make_enum_builder(context, cur, semantic_parent);
     context.comments.match(builder.get(), cur);
+
+    // the signed value of an enumerator with an unsigned underlying type is sign extended
+    auto integer_type = clang_getCanonicalType(clang_getEnumDeclIntegerType(cur));
+    auto is_unsigned  = integer_type.kind >= CXType_Bool && integer_type.kind <= CXType_UInt128;
+    auto value_known  = true;
     detail::visit_children(cur, [&](const CXCursor& child) {
         try
         {
-            auto entity = parse_enum_value(context, child);
+            auto entity = parse_enum_value(context, child, is_unsigned, value_known);
             if (entity)
             {
                 context.comments.match(*entity, child);
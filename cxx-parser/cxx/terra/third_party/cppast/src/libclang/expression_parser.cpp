@@ -7,6 +7,34 @@
 
 using namespace cppast;
 
+type_safe::optional<std::int64_t> detail::evaluate_integer(const CXCursor& cur)
+{
+#if CINDEX_VERSION_MINOR >= 59
+    // older libclang versions don't check for value dependent expressions before evaluating them
+    auto type = clang_getCanonicalType(clang_getCursorType(cur));
+    if ((type.kind < CXType_Bool || type.kind > CXType_Int128) && type.kind != CXType_Enum)
+        return type_safe::nullopt;
+
+    auto result = clang_Cursor_Evaluate(cur);
+    if (!result)
+        return type_safe::nullopt;
+
+    type_safe::optional<std::int64_t> value;
+    if (clang_EvalResult_getKind(result) == CXEval_Int)
+    {
+        if (clang_EvalResult_isUnsignedInt(result))
+            value = static_cast<std::int64_t>(clang_EvalResult_getAsUnsigned(result));
+        else
+            value = static_cast<std::int64_t>(clang_EvalResult_getAsLongLong(result));
+    }
+    clang_EvalResult_dispose(result);
+    return value;
+#else
+    (void)cur;
+    return type_safe::nullopt;
+#endif
+}
+
 std::unique_ptr<cpp_expression> detail::parse_expression(const detail::parse_context& context,
                                                          const CXCursor&              cur)
 {
@@ -16,8 +44,9 @@ std::unique_ptr<cpp_expression> detail::parse_expression(const detail::parse_con
     detail::cxtokenizer    tokenizer(context.tu, context.file, cur);
     detail::cxtoken_stream stream(tokenizer, cur);
 
-    auto type = parse_type(context, cur, clang_getCursorType(cur));
-    auto expr = to_string(stream, stream.end());
+    auto type  = parse_type(context, cur, clang_getCursorType(cur));
+    auto expr  = to_string(stream, stream.end());
+    auto value = evaluate_integer(cur);
     if (kind == CXCursor_CallExpr && (expr.empty() || expr.back().spelling != ")"))
     {
         // we have a call expression that doesn't end in a closing parentheses
@@ -29,19 +58,18 @@ std::unique_ptr<cpp_expression> detail::parse_expression(const detail::parse_con
              || kind == CXCursor_FloatingLiteral || kind == CXCursor_ImaginaryLiteral
              || kind == CXCursor_IntegerLiteral || kind == CXCursor_StringLiteral
              || kind == CXCursor_CXXBoolLiteralExpr || kind == CXCursor_CXXNullPtrLiteralExpr)
-        return cpp_literal_expression::build(std::move(type), expr.as_string());
+        return cpp_literal_expression::build(std::move(type), expr.as_string(), value);
     else
-        return cpp_unexposed_expression::build(std::move(type), std::move(expr));
+        return cpp_unexposed_expression::build(std::move(type), std::move(expr), value);
 }
 
-std::unique_ptr<cpp_expression> detail::parse_raw_expression(const parse_context&,
-                                                             cxtoken_stream&           stream,
-                                                             cxtoken_iterator          end,
-                                                             std::unique_ptr<cpp_type> type)
+std::unique_ptr<cpp_expression> detail::parse_raw_expression(
+    const parse_context&, cxtoken_stream& stream, cxtoken_iterator end,
+    std::unique_ptr<cpp_type> type, type_safe::optional<std::int64_t> integer_value)
 {
     if (stream.done())
         return nullptr;
 
     auto expr = to_string(stream, std::prev(end)->value() == ";" ? std::prev(end) : end);
-    return cpp_unexposed_expression::build(std::move(type), std::move(expr));
+    return cpp_unexposed_expression::build(std::move(type), std::move(expr), integer_value);
 }
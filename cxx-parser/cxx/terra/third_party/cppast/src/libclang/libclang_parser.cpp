@@ -3,8 +3,10 @@
 
 #include <cppast/libclang_parser.hpp>
 
+#include <atomic>
 #include <cstring>
 #include <fstream>
+#include <mutex>
 #include <vector>
 
 #include <clang-c/CXCompilationDatabase.h>
@@ -50,6 +52,23 @@ bool detail::libclang_compile_config_access::remove_comments_in_macro(
     return config.remove_comments_in_macro_;
 }
 
+bool detail::libclang_compile_config_access::intern_types(const libclang_compile_config& config)
+{
+    return config.intern_types_;
+}
+
+bool detail::libclang_compile_config_access::single_file_parse(
+    const libclang_compile_config& config)
+{
+    return config.single_file_parse_;
+}
+
+const std::vector<detail::libclang_unsaved_file>& detail::libclang_compile_config_access::
+    unsaved_files(const libclang_compile_config& config)
+{
+    return config.unsaved_files_;
+}
+
 libclang_compilation_database::libclang_compilation_database(const std::string& build_directory)
 {
     static_assert(std::is_same<database, CXCompilationDatabase>::value, "forgot to update type");
@@ -82,7 +101,7 @@ libclang_compile_config::libclang_compile_config() : libclang_compile_config(CPP
 
 libclang_compile_config::libclang_compile_config(std::string clang_binary)
 : compile_config({}), write_preprocessed_(false), fast_preprocessing_(false),
-  remove_comments_in_macro_(false)
+  remove_comments_in_macro_(false), intern_types_(false), single_file_parse_(false)
 {
     // set given clang binary
     set_clang_binary(clang_binary);
@@ -485,7 +504,13 @@ struct libclang_parser::impl
 {
     detail::cxindex index;
 
-    impl() : index(clang_createIndex(0, 0)) // no diagnostic, other one is irrelevant
+    std::atomic<bool>                             record_tu_memory_usage;
+    std::mutex                                    tu_memory_usage_mutex;
+    std::vector<libclang_parser::tu_memory_usage> tu_memory_usage;
+
+    impl()
+    : index(clang_createIndex(0, 0)), // no diagnostic, other one is irrelevant
+      record_tu_memory_usage(false)
     {}
 };
 
@@ -497,6 +522,19 @@ libclang_parser::libclang_parser(type_safe::object_ref<const diagnostic_logger>
 
 libclang_parser::~libclang_parser() noexcept {}
 
+void libclang_parser::record_tu_memory_usage(bool value) noexcept
+{
+    pimpl_->record_tu_memory_usage = value;
+}
+
+std::vector<libclang_parser::tu_memory_usage> libclang_parser::take_tu_memory_usage() const
+{
+    std::vector<tu_memory_usage> result;
+    std::lock_guard<std::mutex>  lock(pimpl_->tu_memory_usage_mutex);
+    result.swap(pimpl_->tu_memory_usage);
+    return result;
+}
+
 namespace
 {
 std::vector<const char*> get_arguments(const libclang_compile_config& config)
@@ -555,19 +593,28 @@ detail::cxtranslation_unit get_cxunit(const diagnostic_logger& logger, const det
                                       const libclang_compile_config& config, const char* path,
                                       const std::string& source)
 {
-    CXUnsavedFile file{path, source.c_str(), static_cast<unsigned long>(source.length())};
+    std::vector<CXUnsavedFile> files;
+    files.push_back(
+        CXUnsavedFile{path, source.c_str(), static_cast<unsigned long>(source.length())});
+    for (auto& unsaved : detail::libclang_compile_config_access::unsaved_files(config))
+        if (unsaved.path != path)
+            files.push_back(CXUnsavedFile{unsaved.path.c_str(), unsaved.content,
+                                          static_cast<unsigned long>(unsaved.length)});
 
     auto args = get_arguments(config);
 
     CXTranslationUnit tu;
     auto              flags = CXTranslationUnit_Incomplete | CXTranslationUnit_KeepGoing
                  | CXTranslationUnit_DetailedPreprocessingRecord;
+    if (detail::libclang_compile_config_access::single_file_parse(config))
+        flags |= CXTranslationUnit_SingleFileParse | CXTranslationUnit_SkipFunctionBodies;
 
     auto error
         = clang_parseTranslationUnit2(idx.get(), path, // index and path
                                       args.data(),
                                       static_cast<int>(args.size()), // arguments (ptr + size)
-                                      &file, 1,                      // unsaved files (ptr + size)
+                                      files.data(),
+                                      static_cast<unsigned>(files.size()), // unsaved files
                                       unsigned(flags), &tu);
     if (error != CXError_Success)
     {
@@ -621,17 +668,26 @@ try
     auto tu   = get_cxunit(logger(), pimpl_->index, config, path.c_str(), preprocessed.source);
     auto file = clang_getFile(tu.get(), path.c_str());
 
+    // all token strings of the file share one text buffer
+    detail::cpp_token_text_scope token_text_scope;
+
     cpp_file::builder builder(detail::cxstring(clang_getFileName(file)).std_str());
     auto              macro_iter   = preprocessed.macros.begin();
     auto              include_iter = preprocessed.includes.begin();
 
     // convert entity hierarchies
+    detail::type_cache    types;
     detail::parse_context context{tu.get(),
                                   file,
                                   type_safe::ref(logger()),
                                   type_safe::ref(idx),
                                   detail::comment_context(preprocessed.comments),
-                                  false};
+                                  false,
+                                  detail::libclang_compile_config_access::intern_types(config)
+                                      ? &types
+                                      : nullptr,
+                                  detail::libclang_compile_config_access::single_file_parse(
+                                      config)};
     detail::visit_tu(tu, path.c_str(), [&](const CXCursor& cur) {
         if (clang_getCursorKind(cur) == CXCursor_InclusionDirective)
         {
@@ -692,6 +748,23 @@ try
     if (context.error)
         set_error();
 
+    if (pimpl_->record_tu_memory_usage)
+    {
+        tu_memory_usage usage{builder.get().name(), {}, 0u};
+
+        auto resource_usage = clang_getCXTUResourceUsage(tu.get());
+        for (auto i = 0u; i != resource_usage.numEntries; ++i)
+        {
+            auto& entry = resource_usage.entries[i];
+            usage.entries.emplace_back(clang_getTUResourceUsageName(entry.kind), entry.amount);
+            usage.total += entry.amount;
+        }
+        clang_disposeCXTUResourceUsage(resource_usage);
+
+        std::lock_guard<std::mutex> lock(pimpl_->tu_memory_usage_mutex);
+        pimpl_->tu_memory_usage.push_back(std::move(usage));
+    }
+
     return builder.finish(idx);
 }
 catch (detail::parse_error& ex)
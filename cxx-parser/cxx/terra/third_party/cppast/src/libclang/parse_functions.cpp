@@ -23,7 +23,7 @@ cpp_entity_id detail::get_entity_id(const CXCursor& cur)
         // same workaround also applies to conversion functions,
         // there template arguments in the result are ignored
         cxstring type_spelling(clang_getTypeSpelling(clang_getCursorResultType(cur)));
-        return cpp_entity_id(std::string(usr.c_str()) + type_spelling.c_str());
+        return cpp_entity_id(usr.c_str(), type_spelling.c_str());
     }
     else if (clang_getCursorKind(cur) == CXCursor_ClassTemplatePartialSpecialization)
     {
@@ -32,7 +32,7 @@ cpp_entity_id detail::get_entity_id(const CXCursor& cur)
         // same workaround: combine display name with usr
         // (and hope this prevents all collisions...)
         cxstring display_name(clang_getCursorDisplayName(cur));
-        return cpp_entity_id(std::string(usr.c_str()) + display_name.c_str());
+        return cpp_entity_id(usr.c_str(), display_name.c_str());
     }
     else
         return cpp_entity_id(usr.c_str());
@@ -4,6 +4,10 @@
 #ifndef CPPAST_PARSE_FUNCTIONS_HPP_INCLUDED
 #define CPPAST_PARSE_FUNCTIONS_HPP_INCLUDED
 
+#include <functional>
+#include <memory>
+#include <unordered_map>
+
 #include <cppast/cpp_entity.hpp>
 #include <cppast/parser.hpp>
 
@@ -47,6 +51,50 @@ namespace detail
         pp_doc_comment*         end_;
     };
 
+    // the types of a translation unit which are parsed the same wherever they are used,
+    // see libclang_compile_config::intern_types()
+    class type_cache
+    {
+    public:
+        struct key
+        {
+            CXTypeKind kind;
+            // the clang::QualType, which includes the sugar and the cv qualifiers
+            void* type;
+            // whether the scope of a typedef is removed from its spelling, see get_type_spelling()
+            bool scope_removed;
+
+            bool operator==(const key& other) const noexcept
+            {
+                return kind == other.kind && type == other.type
+                       && scope_removed == other.scope_removed;
+            }
+        };
+
+        type_cache();
+        ~type_cache() noexcept;
+
+        type_cache(const type_cache&) = delete;
+        type_cache& operator=(const type_cache&) = delete;
+
+        // nullptr if not interned yet
+        const cpp_type* lookup(const key& k) const;
+
+        void insert(const key& k, std::unique_ptr<cpp_type> type);
+
+    private:
+        struct key_hash
+        {
+            std::size_t operator()(const key& k) const noexcept
+            {
+                return std::hash<void*>()(k.type) ^ (static_cast<std::size_t>(k.kind) << 1u)
+                       ^ static_cast<std::size_t>(k.scope_removed);
+            }
+        };
+
+        std::unordered_map<key, std::unique_ptr<cpp_type>, key_hash> types_;
+    };
+
     struct parse_context
     {
         CXTranslationUnit                              tu;
@@ -55,6 +103,10 @@ namespace detail
         type_safe::object_ref<const cpp_entity_index>  idx;
         comment_context                                comments;
         mutable bool                                   error;
+        // nullptr unless the types are interned
+        type_cache* types;
+        // see libclang_compile_config::single_file_parse()
+        bool single_file_parse;
     };
 
     // parse default value of variable, function parameter...
@@ -78,10 +130,15 @@ namespace detail
     // and ends at the given iterator
     // this is required for situations where there is no expression cursor exposed,
     // like member initializers
-    std::unique_ptr<cpp_expression> parse_raw_expression(const parse_context&      context,
-                                                         cxtoken_stream&           stream,
-                                                         cxtoken_iterator          end,
-                                                         std::unique_ptr<cpp_type> type);
+    std::unique_ptr<cpp_expression> parse_raw_expression(
+        const parse_context& context, cxtoken_stream& stream, cxtoken_iterator end,
+        std::unique_ptr<cpp_type>         type,
+        type_safe::optional<std::int64_t> integer_value = type_safe::nullopt);
+
+    // evaluates an integer constant expression,
+    // or the initializer of a variable or the default argument of a parameter
+    // returns nullopt if it is not one or libclang can't evaluate it
+    type_safe::optional<std::int64_t> evaluate_integer(const CXCursor& cur);
 
     // parse_entity() dispatches on the cursor type
     // it calls one of the other parse functions defined elsewhere
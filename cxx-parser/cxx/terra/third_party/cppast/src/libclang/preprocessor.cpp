@@ -16,6 +16,7 @@
 #include <cppast/diagnostic.hpp>
 
 #include "parse_error.hpp"
+#include "simd_scan.hpp"
 
 using namespace cppast;
 namespace tpl = TinyProcessLib;
@@ -398,6 +399,22 @@ std::string write_macro_file(const libclang_compile_config& c, const std::string
     return file;
 }
 
+// appends the preprocessor output, converting tabs to single spaces and removing \r
+void append_preprocessor_output(std::string& result, const char* str, std::size_t n)
+{
+    auto end = str + n;
+    while (str != end)
+    {
+        auto special = detail::find_first_of<'\t', '\r'>(str, end);
+        result.append(str, special);
+        if (special == end)
+            break;
+        else if (*special == '\t')
+            result += ' ';
+        str = special + 1;
+    }
+}
+
 struct clang_preprocess_result
 {
     std::string              file;
@@ -443,13 +460,7 @@ clang_preprocess_result clang_preprocess_impl(const libclang_compile_config& c,
     auto         cmd = get_preprocess_command(c, full_path.c_str(), macro_path);
     tpl::Process process(
         cmd, "",
-        [&](const char* str, std::size_t n) {
-            for (auto ptr = str; ptr != str + n; ++ptr)
-                if (*ptr == '\t')
-                    result.file += ' '; // convert to single spaces
-                else if (*ptr != '\r')
-                    result.file += *ptr;
-        },
+        [&](const char* str, std::size_t n) { append_preprocessor_output(result.file, str, n); },
         diagnostic_handler);
     // wait for process end
     auto exit_code = process.get_exit_status();
@@ -504,8 +515,8 @@ clang_preprocess_result clang_preprocess(const libclang_compile_config& c, const
 class position
 {
 public:
-    position(ts::object_ref<std::string> result, const char* ptr) noexcept
-    : result_(result), cur_line_(1u), cur_column_(0u), ptr_(ptr), write_(true)
+    position(ts::object_ref<std::string> result, const char* ptr, const char* end) noexcept
+    : result_(result), cur_line_(1u), cur_column_(0u), ptr_(ptr), end_(end), write_(true)
     {}
 
     void set_line(unsigned line)
@@ -555,11 +566,11 @@ public:
     {
         if (write_ == true)
         {
-            for (std::size_t i = 0u; i != offset; ++i)
-                bump();
+            // copy the whole span, then update line and column as if bumped one by one
+            result_->append(ptr_, offset);
+            advance_line_and_column(offset);
         }
-        else
-            skip(offset);
+        ptr_ += offset;
     }
 
     // no write, no newline detection
@@ -584,6 +595,17 @@ public:
         ++ptr_;
     }
 
+    // like skip_with_linecount() offset times
+    void skip_with_linecount(std::size_t offset) noexcept
+    {
+        if (write_ == true)
+        {
+            result_->append(detail::count_char(ptr_, ptr_ + offset, '\n'), '\n');
+            advance_line_and_column(offset);
+        }
+        ptr_ += offset;
+    }
+
     void enable_write() noexcept
     {
         write_.set();
@@ -609,6 +631,12 @@ public:
         return ptr_;
     }
 
+    // the end of the input, i.e. the first '\0'
+    const char* end() const noexcept
+    {
+        return end_;
+    }
+
     unsigned cur_line() const noexcept
     {
         return cur_line_;
@@ -625,9 +653,24 @@ public:
     }
 
 private:
+    // updates line and column for the next offset characters
+    void advance_line_and_column(std::size_t offset) noexcept
+    {
+        auto end      = ptr_ + offset;
+        auto newlines = detail::count_char(ptr_, end, '\n');
+        if (newlines == 0u)
+            cur_column_ += static_cast<unsigned>(offset);
+        else
+        {
+            cur_line_ += static_cast<unsigned>(newlines);
+            cur_column_ = static_cast<unsigned>(end - detail::find_last_char(ptr_, end, '\n') - 1);
+        }
+    }
+
     ts::object_ref<std::string> result_;
     unsigned                    cur_line_, cur_column_;
     const char*                 ptr_;
+    const char*                 end_;
     ts::flag                    write_;
 };
 
@@ -753,8 +796,14 @@ bool skip_c_comment(position& p, detail::preprocessor_output& output)
     }
     else
     {
-        while (!starts_with(p, "*/"))
-            p.skip_with_linecount();
+        auto comment_end = std::strstr(p.ptr(), "*/");
+        if (comment_end == nullptr)
+        {
+            // unterminated comment, skip everything
+            p.skip_with_linecount(std::size_t(p.end() - p.ptr()));
+            return true;
+        }
+        p.skip_with_linecount(std::size_t(comment_end - p.ptr()));
         p.skip(2u);
     }
 
@@ -769,11 +818,9 @@ detail::pp_doc_comment parse_cpp_doc_comment(position& p, bool end_of_line)
         // skip one whitespace at most
         p.skip();
 
-    while (!starts_with(p, "\n"))
-    {
-        result.comment += *p.ptr();
-        p.skip();
-    }
+    auto newline = detail::find_first_of<'\n'>(p.ptr(), p.end());
+    result.comment.append(p.ptr(), newline);
+    p.skip(std::size_t(newline - p.ptr()));
     // don't skip newline
 
     // remove trailing spaces
@@ -1089,12 +1136,23 @@ detail::preprocessor_output detail::preprocess(const libclang_compile_config& co
         else
             xpath += *cpath;
 
-    position p(ts::ref(result.source), preprocessed.file.c_str());
+    // the macros are kept in order, #undef resets them and they are removed at the end
+    std::unordered_map<std::string, std::vector<std::size_t>> macro_index;
+
+    auto source = preprocessed.file.c_str();
+    result.source.reserve(preprocessed.file.size());
+    position p(ts::ref(result.source), source, source + std::strlen(source));
     ts::flag in_string(false), in_char(false), first_line(true);
     while (p)
     {
-        auto next = std::strpbrk(p.ptr(), R"(\"'#/)"); // look for \, ", ', # or /
-        if (next && next > p.ptr())
+        // look for \, ", ', # or /, everything before can be copied as is
+        auto next = detail::find_first_of<'\\', '"', '\'', '#', '/'>(p.ptr(), p.end());
+        if (next == p.end())
+        {
+            p.bump(std::size_t(next - p.ptr()));
+            break;
+        }
+        else if (next > p.ptr())
             p.bump(std::size_t(next - p.ptr() - 1)); // subtract one to get before that character
 
         if (starts_with(p, R"(\\)")) // starts with two backslashes
@@ -1125,6 +1183,7 @@ detail::preprocessor_output detail::preprocess(const libclang_compile_config& co
                                              source_location::make_file(path, p.cur_line()),
                                              "parsing macro '", macro->name(), "'"));
 
+            macro_index[macro->name()].push_back(result.macros.size());
             result.macros.push_back({std::move(macro), p.cur_line()});
         }
         else if (auto undef = parse_undef(p))
@@ -1137,11 +1196,13 @@ detail::preprocessor_output detail::preprocess(const libclang_compile_config& co
                                                  source_location::make_file(path, p.cur_line()),
                                                  "undefining macro '", undef.value(), "'"));
 
-                result.macros.erase(std::remove_if(result.macros.begin(), result.macros.end(),
-                                                   [&](const pp_macro& e) {
-                                                       return e.macro->name() == undef.value();
-                                                   }),
-                                    result.macros.end());
+                auto iter = macro_index.find(undef.value());
+                if (iter != macro_index.end())
+                {
+                    for (auto index : iter->second)
+                        result.macros[index].macro.reset();
+                    macro_index.erase(iter);
+                }
             }
         }
         else if (auto include = parse_include(p))
@@ -1236,6 +1297,10 @@ detail::preprocessor_output detail::preprocess(const libclang_compile_config& co
             p.bump();
     }
 
+    result.macros.erase(std::remove_if(result.macros.begin(), result.macros.end(),
+                                       [](const pp_macro& e) { return e.macro == nullptr; }),
+                        result.macros.end());
+
     // get full path for indirect includes
     // doesn't work if fast preprocessing
     if (!detail::libclang_compile_config_access::fast_preprocessing(config))
@@ -0,0 +1,177 @@
+// Copyright (C) 2017-2022 Jonathan Müller and cppast contributors
+// SPDX-License-Identifier: MIT
+
+#ifndef CPPAST_SIMD_SCAN_HPP_INCLUDED
+#define CPPAST_SIMD_SCAN_HPP_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__AVX2__)
+#    include <immintrin.h>
+#    define CPPAST_SIMD_SCAN_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    include <emmintrin.h>
+#    define CPPAST_SIMD_SCAN_SSE2 1
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#    include <intrin.h>
+#endif
+
+// Block-wise character classification used by the preprocessor output post-processing.
+// All functions work on [begin, end) and never read outside of it,
+// the blocks are classified with AVX2 (32 byte) or SSE2 (16 byte) if available,
+// everything else, including the tail of the range, uses the scalar fallback.
+
+namespace cppast
+{
+namespace detail
+{
+    inline unsigned simd_count_trailing_zeros(std::uint32_t mask) noexcept
+    {
+#if defined(_MSC_VER) && !defined(__clang__)
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return static_cast<unsigned>(index);
+#else
+        return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+    }
+
+    inline unsigned simd_popcount(std::uint32_t mask) noexcept
+    {
+#if defined(_MSC_VER) && !defined(__clang__)
+        return static_cast<unsigned>(__popcnt(mask));
+#else
+        return static_cast<unsigned>(__builtin_popcount(mask));
+#endif
+    }
+
+    template <char... Chars>
+    struct char_set;
+
+    template <>
+    struct char_set<>
+    {
+        static bool contains(char) noexcept
+        {
+            return false;
+        }
+
+#if CPPAST_SIMD_SCAN_AVX2
+        static __m256i match(__m256i) noexcept
+        {
+            return _mm256_setzero_si256();
+        }
+#elif CPPAST_SIMD_SCAN_SSE2
+        static __m128i match(__m128i) noexcept
+        {
+            return _mm_setzero_si128();
+        }
+#endif
+    };
+
+    template <char Head, char... Tail>
+    struct char_set<Head, Tail...>
+    {
+        static bool contains(char c) noexcept
+        {
+            return c == Head || char_set<Tail...>::contains(c);
+        }
+
+#if CPPAST_SIMD_SCAN_AVX2
+        static __m256i match(__m256i block) noexcept
+        {
+            return _mm256_or_si256(_mm256_cmpeq_epi8(block, _mm256_set1_epi8(Head)),
+                                   char_set<Tail...>::match(block));
+        }
+#elif CPPAST_SIMD_SCAN_SSE2
+        static __m128i match(__m128i block) noexcept
+        {
+            return _mm_or_si128(_mm_cmpeq_epi8(block, _mm_set1_epi8(Head)),
+                                char_set<Tail...>::match(block));
+        }
+#endif
+    };
+
+    // returns the first character in [begin, end) that is one of Chars, or end
+    template <char... Chars>
+    const char* find_first_of_scalar(const char* begin, const char* end) noexcept
+    {
+        while (begin != end && !char_set<Chars...>::contains(*begin))
+            ++begin;
+        return begin;
+    }
+
+    // returns the first character in [begin, end) that is one of Chars, or end
+    template <char... Chars>
+    const char* find_first_of(const char* begin, const char* end) noexcept
+    {
+#if CPPAST_SIMD_SCAN_AVX2
+        for (; end - begin >= 32; begin += 32)
+        {
+            auto block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+            auto mask  = static_cast<std::uint32_t>(
+                _mm256_movemask_epi8(char_set<Chars...>::match(block)));
+            if (mask != 0u)
+                return begin + simd_count_trailing_zeros(mask);
+        }
+#elif CPPAST_SIMD_SCAN_SSE2
+        for (; end - begin >= 16; begin += 16)
+        {
+            auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+            auto mask
+                = static_cast<std::uint32_t>(_mm_movemask_epi8(char_set<Chars...>::match(block)));
+            if (mask != 0u)
+                return begin + simd_count_trailing_zeros(mask);
+        }
+#endif
+        return find_first_of_scalar<Chars...>(begin, end);
+    }
+
+    inline std::size_t count_char_scalar(const char* begin, const char* end, char c) noexcept
+    {
+        std::size_t count = 0u;
+        for (; begin != end; ++begin)
+            if (*begin == c)
+                ++count;
+        return count;
+    }
+
+    // returns the number of c in [begin, end)
+    inline std::size_t count_char(const char* begin, const char* end, char c) noexcept
+    {
+        std::size_t count = 0u;
+#if CPPAST_SIMD_SCAN_AVX2
+        auto needle = _mm256_set1_epi8(c);
+        for (; end - begin >= 32; begin += 32)
+        {
+            auto block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+            count += simd_popcount(
+                static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle))));
+        }
+#elif CPPAST_SIMD_SCAN_SSE2
+        auto needle = _mm_set1_epi8(c);
+        for (; end - begin >= 16; begin += 16)
+        {
+            auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+            count += simd_popcount(
+                static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle))));
+        }
+#endif
+        return count + count_char_scalar(begin, end, c);
+    }
+
+    // returns the last c in [begin, end), or nullptr
+    inline const char* find_last_char(const char* begin, const char* end, char c) noexcept
+    {
+        while (end != begin)
+            if (*--end == c)
+                return end;
+        return nullptr;
+    }
+} // namespace detail
+} // namespace cppast
+
+#endif // CPPAST_SIMD_SCAN_HPP_INCLUDED
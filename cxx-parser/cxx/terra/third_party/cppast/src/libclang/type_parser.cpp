@@ -4,6 +4,7 @@
 #include "parse_functions.hpp"
 
 #include <cctype>
+#include <iterator>
 
 #include <cppast/cpp_array_type.hpp>
 #include <cppast/cpp_decltype_type.hpp>
@@ -712,11 +713,247 @@ std::unique_ptr<cpp_type> parse_type_impl(const detail::parse_context& context,
 }
 } // namespace
 
+namespace
+{
+// the types that are parsed the same wherever they are used
+bool is_internable(const cpp_type& type)
+{
+    switch (type.kind())
+    {
+    case cpp_type_kind::builtin_t:
+    case cpp_type_kind::user_defined_t:
+        return true;
+    case cpp_type_kind::cv_qualified_t:
+        return is_internable(static_cast<const cpp_cv_qualified_type&>(type).type());
+    case cpp_type_kind::pointer_t:
+        return is_internable(static_cast<const cpp_pointer_type&>(type).pointee());
+    case cpp_type_kind::reference_t:
+        return is_internable(static_cast<const cpp_reference_type&>(type).referee());
+    default:
+        return false;
+    }
+}
+
+// requires: is_internable(type)
+// if unresolved_spelling is not empty, the builtin type is replaced by that unresolved type
+std::unique_ptr<cpp_type> copy_internable_type(const cpp_type&   type,
+                                               const std::string& unresolved_spelling = "")
+{
+    switch (type.kind())
+    {
+    case cpp_type_kind::builtin_t:
+        if (!unresolved_spelling.empty())
+            return cpp_user_defined_type::build_unresolved(unresolved_spelling);
+        return cpp_builtin_type::build(
+            static_cast<const cpp_builtin_type&>(type).builtin_type_kind());
+    case cpp_type_kind::user_defined_t:
+    {
+        auto& user_defined = static_cast<const cpp_user_defined_type&>(type);
+        if (user_defined.is_unresolved())
+            return cpp_user_defined_type::build_unresolved(user_defined.entity().name());
+        return cpp_user_defined_type::build(user_defined.entity());
+    }
+    case cpp_type_kind::cv_qualified_t:
+    {
+        auto& cv_type = static_cast<const cpp_cv_qualified_type&>(type);
+        return cpp_cv_qualified_type::build(copy_internable_type(cv_type.type(),
+                                                                 unresolved_spelling),
+                                            cv_type.cv_qualifier());
+    }
+    case cpp_type_kind::pointer_t:
+        return cpp_pointer_type::build(
+            copy_internable_type(static_cast<const cpp_pointer_type&>(type).pointee(),
+                                 unresolved_spelling));
+    case cpp_type_kind::reference_t:
+    {
+        auto& ref_type = static_cast<const cpp_reference_type&>(type);
+        return cpp_reference_type::build(copy_internable_type(ref_type.referee(),
+                                                              unresolved_spelling),
+                                         ref_type.reference_kind());
+    }
+    default:
+        DEBUG_UNREACHABLE(detail::assert_handler{});
+        return nullptr;
+    }
+}
+
+// only the types behind which there is a builtin, record, enum or typedef type are interned,
+// the others can depend on the cursor, e.g. template parameters
+bool get_type_cache_key(const CXCursor& cur, const CXType& type, detail::type_cache::key& key)
+{
+    auto leaf = type;
+    while (leaf.kind == CXType_Pointer || leaf.kind == CXType_LValueReference
+           || leaf.kind == CXType_RValueReference)
+        leaf = clang_getPointeeType(leaf);
+
+    switch (leaf.kind)
+    {
+    case CXType_Elaborated:
+        // the instantiation template is looked up from the cursor
+        if (clang_Type_getNumTemplateArguments(leaf) >= 0)
+            return false;
+        break;
+    case CXType_Record:
+    case CXType_Enum:
+    case CXType_Typedef:
+        break;
+    default:
+        if (leaf.kind < CXType_FirstBuiltin || leaf.kind > CXType_LastBuiltin)
+            return false;
+        break;
+    }
+
+    key.kind          = type.kind;
+    key.type          = type.data[0];
+    key.scope_removed = need_to_remove_scope(cur, leaf);
+    return true;
+}
+
+bool is_unresolved_ignored_token(const detail::cxtoken& token)
+{
+    static const char* const ignored[]
+        = {"const",   "volatile", "*",      "&",        "&&",           "static",
+           "extern",  "inline",   "virtual", "explicit", "constexpr",    "friend",
+           "mutable", "typename", "struct", "class",    "thread_local", "register"};
+    for (auto str : ignored)
+        if (token == str)
+            return true;
+    return false;
+}
+
+// in a single file parse, clang declares a variable, parameter, function or typedef
+// whose type it can't resolve with `int` instead and marks the declaration as invalid,
+// returns the leaf type as written in the source then, e.g. `ns::foo` for `const ns::foo&`,
+// and an empty string if the type is a resolved `int`
+std::string get_unresolved_spelling(const detail::parse_context& context, const CXCursor& cur,
+                                    const CXType& type)
+{
+    if (!context.single_file_parse || !clang_isInvalidDeclaration(cur))
+        return "";
+
+    auto leaf = type;
+    while (leaf.kind == CXType_Pointer || leaf.kind == CXType_LValueReference
+           || leaf.kind == CXType_RValueReference)
+        leaf = clang_getPointeeType(leaf);
+    if (leaf.kind != CXType_Int)
+        return "";
+
+    auto kind = clang_getCursorKind(cur);
+    auto name = detail::get_cursor_name(cur);
+    switch (kind)
+    {
+    case CXCursor_ParmDecl:
+    case CXCursor_FieldDecl:
+    case CXCursor_VarDecl:
+    case CXCursor_TypedefDecl:
+    case CXCursor_FunctionDecl:
+    case CXCursor_CXXMethod:
+        break;
+    default:
+        return "";
+    }
+
+    // the type is written before the name, the name of a parameter may be omitted
+    auto is_identifier = [](char c) { return std::isalnum(c) || c == '_'; };
+    detail::cxtokenizer tokenizer(context.tu, context.file, cur);
+    std::string         spelling;
+    auto                depth = 0;
+    for (auto iter = tokenizer.begin(); iter != tokenizer.end(); ++iter)
+    {
+        if (depth == 0)
+        {
+            if ((!name.empty() && *iter == name.c_str()) || *iter == "=" || *iter == ":"
+                || *iter == ";")
+                break;
+            else if (*iter == "__attribute__" || *iter == "__declspec" || *iter == "alignas")
+            {
+                // skip the arguments as well
+                auto args_depth = 0;
+                while (std::next(iter) != tokenizer.end()
+                       && (args_depth > 0 || *std::next(iter) == "("))
+                {
+                    ++iter;
+                    if (*iter == "(")
+                        ++args_depth;
+                    else if (*iter == ")")
+                        --args_depth;
+                }
+                continue;
+            }
+            else if ((kind == CXCursor_TypedefDecl && *iter == "typedef")
+                     || is_unresolved_ignored_token(*iter))
+                continue;
+        }
+
+        if (*iter == "<" || *iter == "(" || *iter == "[")
+            ++depth;
+        else if ((*iter == ">" || *iter == ")" || *iter == "]") && depth > 0)
+            --depth;
+        else if (*iter == ">>" && depth > 1)
+            depth -= 2;
+
+        auto value = iter->value().std_str();
+        if (!spelling.empty() && !value.empty() && is_identifier(spelling.back())
+            && is_identifier(value.front()))
+            spelling += ' ';
+        spelling += value;
+    }
+
+    // a leading attribute, e.g. `[[nodiscard]]`
+    while (spelling.compare(0, 2, "[[") == 0)
+    {
+        auto end = spelling.find("]]");
+        if (end == std::string::npos)
+            break;
+        spelling.erase(0, end + 2u);
+    }
+
+    if (spelling == "int" || spelling == "signed" || spelling == "signed int"
+        || spelling == "int signed")
+        return "";
+    return spelling;
+}
+} // namespace
+
+detail::type_cache::type_cache() = default;
+
+detail::type_cache::~type_cache() noexcept = default;
+
+const cpp_type* detail::type_cache::lookup(const key& k) const
+{
+    auto iter = types_.find(k);
+    return iter == types_.end() ? nullptr : iter->second.get();
+}
+
+void detail::type_cache::insert(const key& k, std::unique_ptr<cpp_type> type)
+{
+    types_.emplace(k, std::move(type));
+}
+
 std::unique_ptr<cpp_type> detail::parse_type(const detail::parse_context& context,
                                              const CXCursor& cur, const CXType& type)
 {
+    auto unresolved_spelling = get_unresolved_spelling(context, cur, type);
+    if (!unresolved_spelling.empty())
+    {
+        auto result = parse_type_impl(context, cur, type);
+        if (is_internable(*result))
+            return copy_internable_type(*result, unresolved_spelling);
+        return result;
+    }
+
+    detail::type_cache::key key{};
+    auto is_cacheable = context.types != nullptr && get_type_cache_key(cur, type, key);
+    if (is_cacheable)
+    {
+        if (auto interned = context.types->lookup(key))
+            return copy_internable_type(*interned);
+    }
+
     auto result = parse_type_impl(context, cur, type);
     DEBUG_ASSERT(result != nullptr, detail::parse_error_handler{}, type, "invalid type");
+    if (is_cacheable && is_internable(*result))
+        context.types->insert(key, copy_internable_type(*result));
     return result;
 }
 
@@ -43,7 +43,8 @@ std::unique_ptr<cpp_expression> detail::parse_default_value(cpp_attribute_list&
     }
     if (has_default)
         return parse_raw_expression(context, stream, stream.end(),
-                                    parse_type(context, cur, clang_getCursorType(cur)));
+                                    parse_type(context, cur, clang_getCursorType(cur)),
+                                    evaluate_integer(cur));
     else
         return nullptr;
 }
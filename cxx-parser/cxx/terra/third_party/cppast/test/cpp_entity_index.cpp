@@ -0,0 +1,116 @@
+// Copyright (C) 2017-2022 Jonathan Müller and cppast contributors
+// SPDX-License-Identifier: MIT
+
+#include <cppast/cpp_entity_index.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <cppast/cpp_entity.hpp>
+
+using namespace cppast;
+
+namespace
+{
+std::string entity_usr(std::size_t i)
+{
+    return "c:@S@entity_" + std::to_string(i);
+}
+
+std::vector<std::unique_ptr<cpp_entity>> build_entities(std::size_t count)
+{
+    std::vector<std::unique_ptr<cpp_entity>> result;
+    result.reserve(count);
+    for (auto i = 0u; i != count; ++i)
+        result.push_back(cpp_unexposed_entity::build(cpp_token_string::builder().finish()));
+    return result;
+}
+
+template <typename Fn>
+void run_threads(std::size_t thread_count, Fn fn)
+{
+    std::vector<std::thread> threads;
+    for (auto i = 0u; i != thread_count; ++i)
+        threads.emplace_back(fn, i);
+    for (auto& thread : threads)
+        thread.join();
+}
+} // namespace
+
+TEST_CASE("cpp_entity_id")
+{
+    REQUIRE(cpp_entity_id("c:@F@foo#") == "c:@F@foo#"_id);
+    REQUIRE(cpp_entity_id("c:@F@foo#", "int") == cpp_entity_id("c:@F@foo#int"));
+    REQUIRE(cpp_entity_id("c:@F@foo#", "") == cpp_entity_id("c:@F@foo#"));
+    REQUIRE(cpp_entity_id("c:@F@foo#", "int") != cpp_entity_id("c:@F@foo#"));
+}
+
+TEST_CASE("cpp_entity_index concurrent registration")
+{
+    const auto thread_count = 4u, per_thread = 1000u;
+
+    auto             entities = build_entities(thread_count * per_thread);
+    cpp_entity_index idx;
+    run_threads(thread_count, [&](std::size_t thread) {
+        for (auto i = thread * per_thread; i != (thread + 1u) * per_thread; ++i)
+        {
+            idx.register_forward_declaration(cpp_entity_id(entity_usr(i)),
+                                             type_safe::ref(*entities[i]));
+            // half of them get a definition as well
+            if (i % 2u == 0u)
+                idx.register_definition(cpp_entity_id(entity_usr(i)),
+                                        type_safe::ref(*entities[i]));
+        }
+    });
+
+    for (auto i = 0u; i != entities.size(); ++i)
+    {
+        auto entity = idx.lookup(cpp_entity_id(entity_usr(i)));
+        REQUIRE(entity);
+        REQUIRE(&entity.value() == entities[i].get());
+        REQUIRE(idx.lookup_definition(cpp_entity_id(entity_usr(i))).has_value() == (i % 2u == 0u));
+    }
+    REQUIRE(!idx.lookup(cpp_entity_id(entity_usr(entities.size()))));
+}
+
+// lookups from multiple threads should scale with the number of threads,
+// i.e. the lookups per second should grow when adding threads
+TEST_CASE("cpp_entity_index contention benchmark", "[!hide][!benchmark]")
+{
+    const auto entity_count = 100000u, lookups_per_thread = 2000000u;
+
+    auto                       entities = build_entities(entity_count);
+    std::vector<cpp_entity_id> ids;
+    cpp_entity_index           idx;
+    for (auto i = 0u; i != entity_count; ++i)
+    {
+        ids.push_back(cpp_entity_id(entity_usr(i)));
+        idx.register_definition(ids.back(), type_safe::ref(*entities[i]));
+    }
+
+    auto max_threads = std::max(4u, std::thread::hardware_concurrency());
+    for (auto thread_count = 1u; thread_count <= max_threads; thread_count *= 2u)
+    {
+        std::atomic<std::size_t> found(0u);
+
+        auto start = std::chrono::steady_clock::now();
+        run_threads(thread_count, [&](std::size_t thread) {
+            std::size_t count = 0u;
+            for (auto i = 0u; i != lookups_per_thread; ++i)
+                if (idx.lookup(ids[(i * 7919u + thread) % entity_count]))
+                    ++count;
+            found += count;
+        });
+        auto duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+
+        REQUIRE(found.load() == thread_count * lookups_per_thread);
+        WARN(thread_count << " threads: "
+                          << static_cast<double>(found.load()) / duration.count() / 1e6
+                          << "M lookups/s");
+    }
+}
@@ -3,6 +3,8 @@
 
 #include <cppast/cpp_enum.hpp>
 
+#include <climits>
+
 #include "test_parser.hpp"
 
 using namespace cppast;
@@ -102,6 +104,10 @@ enum ns::c : int {};
                                     == "a_a+2");
                     if (!equal_types(idx, expr.type(), *cpp_builtin_type::build(cpp_int)))
                         REQUIRE(equal_types(idx, expr.type(), *cpp_builtin_type::build(cpp_uint)));
+                    REQUIRE(expr.integer_value());
+                    REQUIRE(expr.integer_value().value() == 2);
+                    REQUIRE(val.integer_value());
+                    REQUIRE(val.integer_value().value() == 2);
                 }
                 else
                     REQUIRE(false);
@@ -125,6 +131,11 @@ enum ns::c : int {};
                     {
                         ++no_vals;
                         REQUIRE(!val.value());
+                        REQUIRE(val.integer_value());
+                        if (val.name() == "b_a")
+                            REQUIRE(val.integer_value().value() == 0);
+                        else
+                            REQUIRE(val.integer_value().value() == 43);
                     }
                     else if (val.name() == "b_b")
                     {
@@ -134,6 +145,10 @@ enum ns::c : int {};
                         REQUIRE(expr.kind() == cpp_expression_kind::literal_t);
                         REQUIRE(static_cast<const cpp_literal_expression&>(expr).value() == "42");
                         REQUIRE(equal_types(idx, expr.type(), *cpp_builtin_type::build(cpp_int)));
+                        REQUIRE(expr.integer_value());
+                        REQUIRE(expr.integer_value().value() == 42);
+                        REQUIRE(val.integer_value());
+                        REQUIRE(val.integer_value().value() == 42);
                     }
                     else
                         REQUIRE(false);
@@ -173,3 +188,38 @@ enum ns::c : int {};
     });
     REQUIRE(count == 5u);
 }
+
+TEST_CASE("cpp_enum_value integer_value")
+{
+    auto code = R"(
+enum class d : unsigned long long
+{
+    d_a = 0xFFFFFFFFFFFFFFFFull,
+    d_b = 1
+};
+
+enum e : long long
+{
+    e_a = -0x7FFFFFFFFFFFFFFFll - 1,
+    e_b
+};
+)";
+
+    cpp_entity_index idx;
+    auto             file  = parse(idx, "cpp_enum_value_integer_value.cpp", code);
+    auto             count = test_visit<cpp_enum_value>(*file, [&](const cpp_enum_value& val) {
+        // the boundary values are valid enumerators, and not the error values of libclang
+        REQUIRE(val.integer_value());
+        if (val.name() == "d_a")
+            REQUIRE(static_cast<std::uint64_t>(val.integer_value().value()) == ULLONG_MAX);
+        else if (val.name() == "d_b")
+            REQUIRE(val.integer_value().value() == 1);
+        else if (val.name() == "e_a")
+            REQUIRE(val.integer_value().value() == LLONG_MIN);
+        else if (val.name() == "e_b")
+            REQUIRE(val.integer_value().value() == LLONG_MIN + 1);
+        else
+            REQUIRE(false);
+    }, false);
+    REQUIRE(count == 4u);
+}
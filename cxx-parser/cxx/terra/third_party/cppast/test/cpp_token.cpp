@@ -7,6 +7,7 @@
 
 #include <algorithm>
 #include <initializer_list>
+#include <type_traits>
 
 using namespace cppast;
 
@@ -126,3 +127,50 @@ TEST_CASE("tokenizer")
                                              cpp_token(cpp_token_kind::punctuation, ">")});
     }
 }
+
+TEST_CASE("cpp_token_string text buffer")
+{
+    SECTION("spellings are copied")
+    {
+        cpp_token_string::builder builder;
+        {
+            std::string spelling = "foo";
+            builder.add_token(cpp_token(cpp_token_kind::identifier, spelling));
+        }
+        auto str = builder.finish();
+        REQUIRE(str.front().spelling == "foo");
+        REQUIRE(str.front().spelling.c_str()[3] == '\0');
+        REQUIRE(str.as_string() == "foo");
+    }
+    SECTION("spellings are interned")
+    {
+        auto str = cpp_token_string::tokenize("a + a");
+        REQUIRE(str.front().spelling.data() == str.back().spelling.data());
+    }
+    SECTION("scope shares the buffer")
+    {
+        detail::cpp_token_text_scope scope;
+
+        auto a = cpp_token_string::tokenize("foo");
+        auto b = cpp_token_string::tokenize("bar foo");
+        REQUIRE(a.front().spelling.data() == b.back().spelling.data());
+    }
+    SECTION("spelling comparison")
+    {
+        auto str = cpp_token_string::tokenize("foo");
+        auto& spelling = str.front().spelling;
+        REQUIRE(spelling == "foo");
+        REQUIRE(spelling != "fo");
+        REQUIRE(spelling != "fooo");
+        REQUIRE(std::string("foo") == spelling);
+        REQUIRE(spelling.str() == "foo");
+    }
+    SECTION("no views of temporary strings")
+    {
+        static_assert(std::is_constructible<cpp_token_spelling, const std::string&>::value, "");
+        static_assert(!std::is_constructible<cpp_token_spelling, std::string>::value,
+                      "a temporary string would dangle");
+        static_assert(!std::is_constructible<cpp_token, cpp_token_kind, std::string>::value,
+                      "a temporary string would dangle");
+    }
+}
@@ -1,12 +1,15 @@
 // Copyright (C) 2017-2022 Jonathan Müller and cppast contributors
 // SPDX-License-Identifier: MIT
 
-#include <catch2/catch.hpp>
-
 #include <cppast/libclang_parser.hpp>
 
 #include <fstream>
 
+#include <cppast/cpp_function.hpp>
+#include <cppast/cpp_member_function.hpp>
+
+#include "test_parser.hpp"
+
 using namespace cppast;
 
 libclang_compilation_database get_database(const char* json)
@@ -106,3 +109,151 @@ TEST_CASE("libclang_compile_config")
     libclang_compile_config c(database, CPPAST_DETAIL_DRIVE "/c.cpp");
     require_flags(c, "-std=c++14 -fms-extensions -fms-compatibility -fno-strict-aliasing");
 }
+
+TEST_CASE("libclang_compile_config::intern_types")
+{
+    write_file("cpp_type_interning.cpp", R"(
+typedef unsigned int uid_t;
+
+namespace ns
+{
+    struct foo {};
+    enum bar { a };
+}
+
+struct s
+{
+    typedef int value_type;
+
+    value_type get(const value_type* p, value_type& r, value_type v);
+    uid_t id(const char* name, ns::foo f, const ns::foo& cf, ns::bar b);
+};
+
+const char* name(uid_t id, const char* fallback, int n, const int* p, ns::foo* f);
+
+template <typename T>
+T* find(T* first, const T& value, const char* name, uid_t id);
+)");
+
+    // the interned types are copies, so they must print the same as the parsed ones
+    auto parse_types = [](bool intern_types) {
+        auto config = libclang_compile_config();
+        config.set_flags(cpp_standard::cpp_latest);
+        config.intern_types(intern_types);
+
+        cpp_entity_index idx;
+        libclang_parser  p(default_logger());
+        auto             file = p.parse(idx, "cpp_type_interning.cpp", config);
+        REQUIRE(!p.error());
+
+        std::vector<std::string> types;
+        visit(*file, [&](const cpp_entity& e, visitor_info info) {
+            if (info.event == visitor_info::container_entity_exit)
+                return true;
+
+            if (e.kind() == cpp_entity_kind::function_parameter_t)
+                types.push_back(to_string(static_cast<const cpp_function_parameter&>(e).type()));
+            else if (e.kind() == cpp_entity_kind::function_t)
+                types.push_back(to_string(static_cast<const cpp_function&>(e).return_type()));
+            else if (e.kind() == cpp_entity_kind::member_function_t)
+                types.push_back(
+                    to_string(static_cast<const cpp_member_function&>(e).return_type()));
+            return true;
+        });
+        return types;
+    };
+
+    auto types = parse_types(false);
+    REQUIRE(types.size() == 20u);
+    REQUIRE(parse_types(true) == types);
+}
+
+TEST_CASE("libclang_compile_config::add_unsaved_file")
+{
+    write_file("cpp_unsaved_file.hpp", "struct on_disk {};\n");
+    write_file("cpp_unsaved_file.cpp", R"(
+#include "cpp_unsaved_file.hpp"
+
+using a = in_memory;
+)");
+
+    // the included header is given to libclang from memory, only the preprocessor reads it
+    std::string header = "struct in_memory {};\n";
+
+    auto config = libclang_compile_config();
+    config.set_flags(cpp_standard::cpp_latest);
+    config.add_unsaved_file("cpp_unsaved_file.hpp", header.c_str(), header.size());
+    // the parsed file itself is not replaced
+    config.add_unsaved_file("cpp_unsaved_file.cpp", "", 0u);
+
+    cpp_entity_index idx;
+    libclang_parser  p(default_logger());
+    auto             file = p.parse(idx, "cpp_unsaved_file.cpp", config);
+    REQUIRE(!p.error());
+
+    auto count = test_visit<cpp_type_alias>(
+        *file,
+        [&](const cpp_type_alias& alias) {
+            REQUIRE(alias.name() == "a");
+            REQUIRE(to_string(alias.underlying_type()) == "in_memory");
+        },
+        false);
+    REQUIRE(count == 1u);
+}
+
+TEST_CASE("libclang_compile_config::single_file_parse")
+{
+    write_file("cpp_single_file_parse.hpp", "namespace ns { struct dep {}; }\n");
+    write_file("cpp_single_file_parse.cpp", R"(
+#include "cpp_single_file_parse.hpp"
+
+struct local {};
+
+const ns::dep* get(const ns::dep& a, local* b, int c);
+)");
+
+    auto config = libclang_compile_config();
+    config.set_flags(cpp_standard::cpp_latest);
+    config.single_file_parse(true);
+
+    cpp_entity_index idx;
+    libclang_parser  p(default_logger());
+    auto             file = p.parse(idx, "cpp_single_file_parse.cpp", config);
+    REQUIRE(file);
+
+    // the type is the leaf of the cv qualified, pointer and reference types
+    auto is_unresolved = [](const cpp_type& type) {
+        auto leaf = &type;
+        while (true)
+            if (leaf->kind() == cpp_type_kind::cv_qualified_t)
+                leaf = &static_cast<const cpp_cv_qualified_type*>(leaf)->type();
+            else if (leaf->kind() == cpp_type_kind::pointer_t)
+                leaf = &static_cast<const cpp_pointer_type*>(leaf)->pointee();
+            else if (leaf->kind() == cpp_type_kind::reference_t)
+                leaf = &static_cast<const cpp_reference_type*>(leaf)->referee();
+            else
+                break;
+        return leaf->kind() == cpp_type_kind::user_defined_t
+               && static_cast<const cpp_user_defined_type*>(leaf)->is_unresolved();
+    };
+
+    auto count = test_visit<cpp_function>(
+        *file,
+        [&](const cpp_function& func) {
+            // the header is not parsed, so ns::dep is only known by its spelling
+            REQUIRE(to_string(func.return_type()) == "const ns::dep*");
+            REQUIRE(is_unresolved(func.return_type()));
+
+            std::vector<std::string> types;
+            std::vector<bool>        unresolved;
+            for (auto& param : func.parameters())
+            {
+                types.push_back(to_string(param.type()));
+                unresolved.push_back(is_unresolved(param.type()));
+            }
+            REQUIRE(types == std::vector<std::string>{"const ns::dep&", "local*", "int"});
+            REQUIRE(unresolved == std::vector<bool>{true, false, false});
+        },
+        false);
+    REQUIRE(count == 1u);
+}
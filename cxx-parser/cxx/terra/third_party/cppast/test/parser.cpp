@@ -5,6 +5,9 @@
 
 #include <catch2/catch.hpp>
 
+#include <string>
+#include <vector>
+
 using namespace cppast;
 
 TEST_CASE("parse_files")
@@ -56,3 +59,74 @@ TEST_CASE("parse_files")
     for (auto& file : parser.files())
         REQUIRE(file.name() == *iter++);
 }
+
+TEST_CASE("parallel_file_parser")
+{
+    class null_compile_config : public compile_config
+    {
+    public:
+        null_compile_config() : compile_config({}) {}
+
+    private:
+        void do_set_flags(cpp_standard, compile_flags) override {}
+
+        void do_add_include_dir(std::string) override {}
+
+        void do_add_macro_definition(std::string, std::string) override {}
+
+        void do_remove_macro_definition(std::string) override {}
+
+        const char* do_get_name() const noexcept override
+        {
+            return "null";
+        }
+    } config;
+
+    class null_parser : public parser
+    {
+    public:
+        using config = null_compile_config;
+
+        explicit null_parser(type_safe::object_ref<const diagnostic_logger> logger) : parser(logger)
+        {}
+
+    private:
+        std::unique_ptr<cpp_file> do_parse(const cpp_entity_index& idx, std::string path,
+                                           const compile_config&) const override
+        {
+            logger().log("null parser", diagnostic{path, source_location(), severity::warning});
+            return cpp_file::builder(std::move(path)).finish(idx);
+        }
+    };
+
+    class recording_logger : public diagnostic_logger
+    {
+    public:
+        mutable std::vector<std::string> messages;
+
+    private:
+        bool do_log(const char*, const diagnostic& d) const override
+        {
+            if (d.severity == severity::warning)
+                messages.push_back(d.message);
+            return true;
+        }
+    } logger;
+
+    std::vector<std::string> file_names;
+    for (auto i = 0; i != 100; ++i)
+        file_names.push_back("file_" + std::to_string(i) + ".cpp");
+
+    cpp_entity_index                  idx;
+    parallel_file_parser<null_parser> parser(type_safe::ref(idx), type_safe::ref(logger), 4u);
+    parse_files(parser, file_names, config);
+    parser.wait();
+
+    // files and diagnostics are in the order of the parse() calls
+    REQUIRE(logger.messages == file_names);
+    auto iter = file_names.begin();
+    for (auto& file : parser.files())
+        REQUIRE(file.name() == *iter++);
+    REQUIRE(iter == file_names.end());
+    REQUIRE(!parser.error());
+}
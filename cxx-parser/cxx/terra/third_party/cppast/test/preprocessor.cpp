@@ -1,7 +1,11 @@
 #include <catch2/catch.hpp>
+#include <chrono>
+#include <cstdlib>
 #include <fstream>
+#include <sstream>
 
 #include "libclang/preprocessor.hpp"
+#include "libclang/simd_scan.hpp"
 #include "test_parser.hpp"
 
 #include <cppast/cpp_variable.hpp>
@@ -105,6 +109,28 @@ struct foo {};
     }
 }
 
+TEST_CASE("preprocessor undef")
+{
+    auto file_name = "preprocessor_undef.hpp";
+    write_file(file_name, R"(
+#define A 1
+#define B 2
+#define C 3
+#undef A
+#define A 4
+#undef C
+#undef D
+)");
+
+    libclang_compile_config config;
+    config.set_flags(cpp_standard::cpp_latest);
+
+    auto result = detail::preprocess(config, file_name, default_logger().get());
+    REQUIRE(result.macros.size() == 2u);
+    REQUIRE(result.macros[0].macro->name() == "B");
+    REQUIRE(result.macros[1].macro->name() == "A");
+}
+
 TEST_CASE("preprocessor line numbers")
 {
     bool fast_preprocessing = false;
@@ -307,3 +333,67 @@ void j();
     }
     REQUIRE((file->unmatched_comments().size() == 3u + add));
 }
+
+TEST_CASE("preprocessor simd scan")
+{
+    // all block sizes and offsets, including characters with the high bit set
+    std::string str;
+    for (auto i = 0u; i != 200u; ++i)
+        str += "ab\\\"x'#y/\n\t\r\xe4z"[(i * 5u) % 14u];
+
+    for (auto begin = str.data(); begin != str.data() + str.size(); ++begin)
+        for (auto end = begin; end != str.data() + str.size(); ++end)
+        {
+            REQUIRE((detail::find_first_of<'\\', '"', '\'', '#', '/'>(begin, end)
+                     == detail::find_first_of_scalar<'\\', '"', '\'', '#', '/'>(begin, end)));
+            REQUIRE((detail::find_first_of<'\t', '\r'>(begin, end)
+                     == detail::find_first_of_scalar<'\t', '\r'>(begin, end)));
+            REQUIRE(detail::count_char(begin, end, '\n')
+                    == detail::count_char_scalar(begin, end, '\n'));
+        }
+}
+
+// run with `cppast_test "preprocessor benchmark"`, on IAgoraRtcEngine.h of the Agora headers
+// or on the header CPPAST_BENCHMARK_FILE is set to
+TEST_CASE("preprocessor benchmark", "[!hide][!benchmark]")
+{
+    std::string path = CPPAST_BENCHMARK_HEADER;
+    if (auto env = std::getenv("CPPAST_BENCHMARK_FILE"))
+        path = env;
+
+    libclang_compile_config config;
+    config.set_flags(cpp_standard::cpp_14);
+    config.add_include_dir(path.substr(0, path.find_last_of('/')));
+
+    const auto                  iterations = 10;
+    detail::preprocessor_output output;
+    auto                        start = std::chrono::steady_clock::now();
+    for (auto i = 0; i != iterations; ++i)
+        output = detail::preprocess(config, path.c_str(), *default_logger());
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start);
+    REQUIRE(!output.source.empty());
+    WARN("preprocess: " << duration.count() / iterations << "us per run of " << path << ", "
+                        << output.source.size() << " bytes, " << output.macros.size()
+                        << " macros, " << output.comments.size() << " comments");
+
+    // the scan of the preprocessed source for the special characters, which is part of the run
+    auto begin   = output.source.data();
+    auto end     = output.source.data() + output.source.size();
+    auto measure = [&](const char* name, const char* (*find)(const char*, const char*)) {
+        auto        start = std::chrono::steady_clock::now();
+        std::size_t count = 0u;
+        for (auto i = 0; i != 100; ++i)
+            for (auto cur = find(begin, end); cur != end; cur = find(cur + 1, end))
+                ++count;
+        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start);
+        WARN(name << " scan: " << count / 100u << " special characters, "
+                  << duration.count() / 100 << "us per scan");
+        return count;
+    };
+
+    auto simd   = measure("simd", &detail::find_first_of<'\\', '"', '\'', '#', '/'>);
+    auto scalar = measure("scalar", &detail::find_first_of_scalar<'\\', '"', '\'', '#', '/'>);
+    REQUIRE(simd == scalar);
+}
@@ -1,8 +1,12 @@
 #include <cppast/cpp_entity.hpp>
+#include <cppast/static_visitor.hpp>
 using namespace cppast;
 
 #include "test_parser.hpp"
 #include <iostream>
+#include <string>
+#include <tuple>
+#include <vector>
 
 TEST_CASE("visitor_filtered")
 {
@@ -104,3 +108,98 @@ TEST_CASE("visitor_filtered")
         }
     }
 }
+
+namespace
+{
+using visit_event = std::tuple<const cpp_entity*, visitor_info::event_type,
+                               cpp_access_specifier_kind, bool>;
+
+struct recording_visitor
+{
+    std::vector<visit_event> events;
+
+    bool operator()(const cpp_entity& e, const visitor_info& info)
+    {
+        events.emplace_back(&e, info.event, info.access, info.last_child);
+        return true;
+    }
+};
+
+struct class_counting_visitor
+{
+    unsigned classes = 0, functions = 0;
+
+    using children_of = cpp_entity_kind_set<cpp_entity_kind::file_t, cpp_entity_kind::namespace_t>;
+
+    bool operator()(const cpp_class&, const visitor_info& info)
+    {
+        if (info.event != visitor_info::container_entity_exit)
+            ++classes;
+        return true;
+    }
+
+    void operator()(const cpp_member_function&, const visitor_info&)
+    {
+        ++functions;
+    }
+};
+} // namespace
+
+TEST_CASE("static_visit")
+{
+    auto code = R"(
+        namespace the_ns {
+            class foo {
+                enum inner_enum { a, b };
+                void f();
+            public:
+                class bar {};
+            };
+            struct one { int i; }; class two {}; class three {};
+            enum quaz {};
+        }
+        enum outer {};
+    )";
+
+    cpp_entity_index idx;
+    auto             file = parse(idx, "static_visit.cpp", code);
+
+    SECTION("same events as visit")
+    {
+        recording_visitor expected;
+        cppast::visit(*file, [&](const cpp_entity& e, const visitor_info& info) {
+            return expected(e, info);
+        });
+
+        recording_visitor actual;
+        cppast::static_visit(*file, actual);
+        REQUIRE(actual.events == expected.events);
+    }
+
+    SECTION("handlers by type and pruned children")
+    {
+        // the classes of the_ns, but not the nested bar or the member function
+        class_counting_visitor visitor;
+        cppast::static_visit(*file, visitor);
+        REQUIRE(visitor.classes == 4u);
+        REQUIRE(visitor.functions == 0u);
+    }
+
+    SECTION("skip and abort")
+    {
+        // skips the children of inner_enum on enter and aborts on exit
+        unsigned count = 0;
+        struct aborting_visitor
+        {
+            unsigned& count;
+
+            bool operator()(const cpp_enum& e, const visitor_info&)
+            {
+                ++count;
+                return e.name() != "inner_enum";
+            }
+        } visitor{count};
+        cppast::static_visit(*file, visitor);
+        REQUIRE(count == 2u);
+    }
+}
@@ -44,6 +44,52 @@ export function getCppAstBackendDir() {
   return path.join(__dirname, '..', 'cxx', 'cppast_backend');
 }
 
+// <my_project>/.terra/cxx_parser/dump_json_<checksum>.json
+function getCachedCXXAstJsonPath(
+  terraContext: TerraContext,
+  parseFiles: string[],
+  buildDirNamePrefix?: string | undefined
+): string {
+  let parseFilesChecksum = generateChecksum(parseFiles);
+  return path.join(
+    getBuildDir(terraContext, buildDirNamePrefix),
+    `dump_json_${parseFilesChecksum}.json`
+  );
+}
+
+/**
+ * Returns the ast json cached by a previous parse of the same files, or `undefined` if there is none.
+ * The build dir is removed first if `terraContext.clean` is set.
+ */
+function loadCachedCXXAstJson(
+  terraContext: TerraContext,
+  outputJsonPath: string
+): string | undefined {
+  let build_cache_dir_path = path.dirname(outputJsonPath);
+  if (terraContext.clean && fs.existsSync(build_cache_dir_path)) {
+    fs.rmSync(build_cache_dir_path, { recursive: true, force: true });
+  }
+
+  // If the previous output json cache exists, skip the process of cppast parser
+  if (fs.existsSync(outputJsonPath)) {
+    console.log(
+      `Skip the process of cppast parser, use the cached ast json file: ${outputJsonPath}`
+    );
+    let ast_json_file_content = fs.readFileSync(outputJsonPath, 'utf-8');
+    return ast_json_file_content;
+  }
+
+  return undefined;
+}
+
+/**
+ * Cache the `CXXFile`s parsed by the terra addon, the same as the ast json of `dumpCXXAstJson`.
+ */
+function saveCachedCXXAstJson(outputJsonPath: string, cxxFiles: any[]) {
+  fs.mkdirSync(path.dirname(outputJsonPath), { recursive: true });
+  fs.writeFileSync(outputJsonPath, JSON.stringify(cxxFiles));
+}
+
 export function dumpCXXAstJson(
   terraContext: TerraContext,
   includeHeaderDirs: string[],
@@ -63,20 +109,15 @@ export function dumpCXXAstJson(
 
   let build_shell_path = path.join(agora_rtc_ast_dir_path, 'build.sh');
   let build_cache_dir_path = buildDir;
-  let outputJsonFileName = `dump_json_${parseFilesChecksum}.json`;
-  let outputJsonPath = path.join(build_cache_dir_path, outputJsonFileName);
+  let outputJsonPath = getCachedCXXAstJsonPath(
+    terraContext,
+    parseFiles,
+    buildDirNamePrefix
+  );
 
-  if (terraContext.clean && fs.existsSync(build_cache_dir_path)) {
-    fs.rmSync(build_cache_dir_path, { recursive: true, force: true });
-  }
-
-  // If the previous output json cache exists, skip the process of cppast parser
-  if (fs.existsSync(outputJsonPath)) {
-    console.log(
-      `Skip the process of cppast parser, use the cached ast json file: ${outputJsonPath}`
-    );
-    let ast_json_file_content = fs.readFileSync(outputJsonPath, 'utf-8');
-    return ast_json_file_content;
+  let cachedJsonContent = loadCachedCXXAstJson(terraContext, outputJsonPath);
+  if (cachedJsonContent !== undefined) {
+    return cachedJsonContent;
   }
 
   // Ensure the build cache dir exists
@@ -124,6 +165,143 @@ export function genParseResultFromJson(astJsonContent: string): ParseResult {
   return parseResult;
 }
 
+/**
+ * The options of the terra Node-API module, see `cxx/node_addon/src/terra_addon.cc`.
+ */
+export interface TerraAddonParseOptions {
+  includeHeaderDirs: string[];
+  parseFiles: string[];
+  defines: string[];
+  preProcessDir: string;
+}
+
+/**
+ * The terra Node-API module, which parses the headers in-process.
+ */
+export interface TerraAddon {
+  parse(options: TerraAddonParseOptions): Promise<any[]>;
+  parseSync(options: TerraAddonParseOptions): any[];
+}
+
+let terraAddon: TerraAddon | null | undefined;
+
+export function getTerraAddonPath(): string {
+  return (
+    process.env.TERRA_ADDON_PATH ??
+    path.join(__dirname, '..', 'cxx', 'node_addon', 'build', 'terra_addon.node')
+  );
+}
+
+/**
+ * Load the terra Node-API module built by `cxx/node_addon/build.sh`, returns `undefined` if it's not built,
+ * the cppast_backend is used instead in that case.
+ */
+export function loadTerraAddon(): TerraAddon | undefined {
+  if (terraAddon === undefined) {
+    let addonPath = getTerraAddonPath();
+    terraAddon = null;
+    if (fs.existsSync(addonPath)) {
+      try {
+        terraAddon = require(addonPath) as TerraAddon;
+      } catch (e) {
+        console.log(`Failed to load the terra addon ${addonPath}: ${e}`);
+      }
+    }
+  }
+  return terraAddon ?? undefined;
+}
+
+export function getTerraAddonParseOptions(
+  terraContext: TerraContext,
+  includeHeaderDirs: string[],
+  parseFiles: string[],
+  defines: string[],
+  buildDirNamePrefix?: string | undefined
+): TerraAddonParseOptions {
+  let parseFilesChecksum = generateChecksum(parseFiles);
+  let buildDir = getBuildDir(terraContext, buildDirNamePrefix);
+
+  return {
+    // The same system include directories as the cppast_backend
+    includeHeaderDirs: [
+      path.join(getCppAstBackendDir(), 'include', 'system_fake'),
+      '/Applications/Xcode.app/Contents/Developer/Platforms/MacOSX.platform/Developer/SDKs/MacOSX.sdk/usr/include',
+      ...includeHeaderDirs,
+    ],
+    parseFiles: parseFiles,
+    defines: defines,
+    preProcessDir: path.join(buildDir, `preProcess@${parseFilesChecksum}`),
+  };
+}
+
+/**
+ * Same as `genParseResultFromJson`, but for the `CXXFile`s returned by the terra addon.
+ */
+export function genParseResultFromCXXFiles(cxxFilesObject: any[]): ParseResult {
+  // Bottom-up like the reviver of `JSON.parse`
+  function _castRecursively(value: any): any {
+    if (typeof value !== 'object' || value === null) {
+      return value;
+    }
+    if (Array.isArray(value)) {
+      for (let i = 0; i < value.length; i++) {
+        value[i] = _castRecursively(value[i]);
+      }
+      return value;
+    }
+    for (const key of Object.keys(value)) {
+      value[key] = _castRecursively(value[key]);
+    }
+    return cast(value);
+  }
+
+  const cxxFiles: CXXFile[] = _castRecursively(cxxFilesObject);
+
+  const parseResult = new ParseResult();
+  parseResult.nodes = cxxFiles;
+  fillParentNode(parseResult, cxxFiles);
+  return parseResult;
+}
+
+/**
+ * Parse the headers in-process with the terra addon, off the main thread, returns `undefined` if the addon is
+ * not built.
+ */
+export async function parseCXXAstInProcess(
+  terraContext: TerraContext,
+  includeHeaderDirs: string[],
+  parseFiles: string[],
+  defines: string[],
+  buildDirNamePrefix?: string | undefined
+): Promise<ParseResult | undefined> {
+  let addon = loadTerraAddon();
+  if (!addon) {
+    return undefined;
+  }
+
+  let outputJsonPath = getCachedCXXAstJsonPath(
+    terraContext,
+    parseFiles,
+    buildDirNamePrefix
+  );
+  let cachedJsonContent = loadCachedCXXAstJson(terraContext, outputJsonPath);
+  if (cachedJsonContent !== undefined) {
+    return genParseResultFromJson(cachedJsonContent);
+  }
+
+  let cxxFiles = await addon.parse(
+    getTerraAddonParseOptions(
+      terraContext,
+      includeHeaderDirs,
+      parseFiles,
+      defines,
+      buildDirNamePrefix
+    )
+  );
+  saveCachedCXXAstJson(outputJsonPath, cxxFiles);
+  return genParseResultFromCXXFiles(cxxFiles);
+}
+
 export function CXXParser(
   terraContext: TerraContext,
   args: any,
@@ -145,15 +323,42 @@ export function CXXParser(
     });
   }
 
-  let jsonContent = dumpCXXAstJson(
-    terraContext,
-    cxxParserConfigs.includeHeaderDirs,
-    parseFiles,
-    cxxParserConfigs.definesMacros,
-    cxxParserConfigs.buildDirNamePrefix
-  );
+  let newParseResult: ParseResult;
+  let addon = loadTerraAddon();
+  if (addon) {
+    let outputJsonPath = getCachedCXXAstJsonPath(
+      terraContext,
+      parseFiles,
+      cxxParserConfigs.buildDirNamePrefix
+    );
+    let cachedJsonContent = loadCachedCXXAstJson(terraContext, outputJsonPath);
+    if (cachedJsonContent !== undefined) {
+      newParseResult = genParseResultFromJson(cachedJsonContent);
+    } else {
+      // The `Parser` is synchronous, use `parseCXXAstInProcess` to parse off the main thread
+      let cxxFiles = addon.parseSync(
+        getTerraAddonParseOptions(
+          terraContext,
+          cxxParserConfigs.includeHeaderDirs,
+          parseFiles,
+          cxxParserConfigs.definesMacros,
+          cxxParserConfigs.buildDirNamePrefix
+        )
+      );
+      saveCachedCXXAstJson(outputJsonPath, cxxFiles);
+      newParseResult = genParseResultFromCXXFiles(cxxFiles);
+    }
+  } else {
+    let jsonContent = dumpCXXAstJson(
+      terraContext,
+      cxxParserConfigs.includeHeaderDirs,
+      parseFiles,
+      cxxParserConfigs.definesMacros,
+      cxxParserConfigs.buildDirNamePrefix
+    );
 
-  let newParseResult = genParseResultFromJson(jsonContent);
+    newParseResult = genParseResultFromJson(jsonContent);
+  }
 
   // Use the parsed file path from cppast parser to avoid additional operations for the file,
   // e.g., the macros operations
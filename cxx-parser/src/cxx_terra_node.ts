@@ -207,6 +207,10 @@ export class Clazz extends CXXTerraNode {
   methods: MemberFunction[] = [];
   member_variables: MemberVariable[] = [];
   base_clazzs: string[] = [];
+  // The full names of the direct and indirect bases
+  all_base_clazzs: string[] = [];
+  // The `id`s of the final overriders of the virtual methods in vtable order
+  virtual_methods: string[] = [];
 
   findBaseClazzs(cxxfiles: CXXFile[]): Clazz[] {
     if (this.base_clazzs.length === 0) {
@@ -248,6 +252,11 @@ export class MemberFunction extends CXXTerraNode {
 
   mangled_name: string = '';
 
+  // `<class full name>::<name><signature>`
+  id: string = '';
+  // The `id` of the base class method that this method overrides
+  overridden_method: string = '';
+
   override get fullName(): string {
     return `${this.parent?.fullName}.${this.name}`;
   }
@@ -257,6 +266,9 @@ export class Variable extends CXXTerraNode {
   override __TYPE: CXXTYPE = CXXTYPE.Variable;
   type: SimpleType = new SimpleType();
   default_value: string = '';
+  // The value of `default_value` if it is an integer constant expression,
+  // values beyond `Number.MAX_SAFE_INTEGER` lose precision
+  evaluated_value: number | null = null;
   is_output: boolean = false;
 
   override get fullName(): string {
@@ -269,6 +281,9 @@ export class SimpleType extends CXXTerraNode {
   kind: SimpleTypeKind = SimpleTypeKind.value_t;
   is_const: boolean = false;
   is_builtin_type: boolean = false;
+  // the type is declared in a header that was not parsed by a shallow parse,
+  // `name` is the type as spelled in the source
+  is_unresolved: boolean = false;
   template_arguments: string[] = [];
   clang_qualtype: string = ''; // added in runtime
 
@@ -305,6 +320,9 @@ export class EnumConstant extends CXXTerraNode {
   override __TYPE: CXXTYPE = CXXTYPE.EnumConstant;
 
   value: string = '';
+  // The value of the enumerator, explicit or implicit, if it is an integer constant,
+  // values beyond `Number.MAX_SAFE_INTEGER` lose precision
+  evaluated_value: number | null = null;
 }
 
 type ParentNodeType =